@@ -0,0 +1,30 @@
+#!/bin/bash
+#
+TEST="Test --replay-corpus merged summary over two captures"
+NAME=test-0001.sh
+TMPLOG=$TMP/replay.log.$$
+TMPDIR=$TMP/replay.$$
+
+$FWTS --show-tests | grep BERT > /dev/null
+if [ $? -eq 1 ]; then
+	echo SKIP: $TEST, $NAME
+	exit 77
+fi
+
+#
+#  Drop the replay times and the results directory name, these
+#  change from run to run
+#
+$FWTS --log-format="%line %owner " -w 80 --jobs=2 --replay-corpus=$FWTSTESTDIR/replay-0001/corpus --replay-output=$TMPDIR bert - | \
+	cut -c7- | grep "^replay" | grep -v "Replayed\|captures/sec\|Results logs" | \
+	sed 's/|[ 0-9.]*|$/|/' > $TMPLOG
+diff $TMPLOG $FWTSTESTDIR/replay-0001/replay-0001.log >> $FAILURE_LOG
+ret=$?
+if [ $ret -eq 0 ]; then
+	echo PASSED: $TEST, $NAME
+else
+	echo FAILED: $TEST, $NAME
+fi
+
+rm -rf $TMPLOG $TMPDIR
+exit $ret
@@ -0,0 +1,31 @@
+#!/bin/bash
+#
+TEST="Test --replay-corpus per capture results match --dumpfile runs"
+NAME=test-0002.sh
+TMPLOG=$TMP/replay.log.$$
+TMPDIR=$TMP/replay.$$
+
+$FWTS --show-tests | grep BERT > /dev/null
+if [ $? -eq 1 ]; then
+	echo SKIP: $TEST, $NAME
+	exit 77
+fi
+
+$FWTS --log-format="%line %owner " -w 80 --jobs=2 --replay-corpus=$FWTSTESTDIR/replay-0001/corpus --replay-output=$TMPDIR bert - > /dev/null
+ret=0
+for capture in machine-a:bert-0001.log machine-b:bert-0002.log
+do
+	cut -c7- $TMPDIR/${capture%%:*}.log | grep "^bert" > $TMPLOG
+	diff $TMPLOG $FWTSTESTDIR/bert-0001/${capture##*:} >> $FAILURE_LOG
+	if [ $? -ne 0 ]; then
+		ret=1
+	fi
+done
+if [ $ret -eq 0 ]; then
+	echo PASSED: $TEST, $NAME
+else
+	echo FAILED: $TEST, $NAME
+fi
+
+rm -rf $TMPLOG $TMPDIR
+exit $ret
@@ -214,6 +214,6 @@ static fwts_framework_ops acpidump_ops = {
 	.minor_tests = acpidump_tests
 };
 
-FWTS_REGISTER("acpidump", &acpidump_ops, FWTS_TEST_ANYTIME, FWTS_FLAG_UTILS)
+FWTS_REGISTER("acpidump", &acpidump_ops, FWTS_TEST_ANYTIME, FWTS_FLAG_UTILS | FWTS_FLAG_OFFLINE)
 
 #endif
@@ -119,6 +119,6 @@ static fwts_framework_ops acpipld_ops = {
 	.minor_tests = acpipld_tests
 };
 
-FWTS_REGISTER("acpipld", &acpipld_ops, FWTS_TEST_ANYTIME, FWTS_FLAG_BATCH | FWTS_FLAG_ACPI)
+FWTS_REGISTER("acpipld", &acpipld_ops, FWTS_TEST_ANYTIME, FWTS_FLAG_BATCH | FWTS_FLAG_ACPI | FWTS_FLAG_ACPI_NAMESPACE)
 
 #endif
@@ -338,6 +338,6 @@ static fwts_framework_ops aest_ops = {
 	.minor_tests = aest_tests
 };
 
-FWTS_REGISTER("aest", &aest_ops, FWTS_TEST_ANYTIME, FWTS_FLAG_BATCH | FWTS_FLAG_ACPI)
+FWTS_REGISTER("aest", &aest_ops, FWTS_TEST_ANYTIME, FWTS_FLAG_BATCH | FWTS_FLAG_ACPI | FWTS_FLAG_PARALLEL | FWTS_FLAG_OFFLINE)
 
 #endif
@@ -82,6 +82,6 @@ static fwts_framework_ops apicinstance_ops = {
 	.minor_tests = apicinstance_tests
 };
 
-FWTS_REGISTER("apicinstance", &apicinstance_ops, FWTS_TEST_ANYTIME, FWTS_FLAG_BATCH | FWTS_FLAG_ACPI)
+FWTS_REGISTER("apicinstance", &apicinstance_ops, FWTS_TEST_ANYTIME, FWTS_FLAG_BATCH | FWTS_FLAG_ACPI | FWTS_FLAG_OFFLINE)
 
 #endif
@@ -122,6 +122,6 @@ static fwts_framework_ops apmt_ops = {
 	.minor_tests = apmt_tests
 };
 
-FWTS_REGISTER("apmt", &apmt_ops, FWTS_TEST_ANYTIME, FWTS_FLAG_BATCH | FWTS_FLAG_ACPI)
+FWTS_REGISTER("apmt", &apmt_ops, FWTS_TEST_ANYTIME, FWTS_FLAG_BATCH | FWTS_FLAG_ACPI | FWTS_FLAG_PARALLEL | FWTS_FLAG_OFFLINE)
 
 #endif
@@ -223,6 +223,6 @@ static fwts_framework_ops aspt_ops = {
 	.minor_tests = aspt_tests
 };
 
-FWTS_REGISTER("aspt", &aspt_ops, FWTS_TEST_ANYTIME, FWTS_FLAG_BATCH | FWTS_FLAG_ACPI)
+FWTS_REGISTER("aspt", &aspt_ops, FWTS_TEST_ANYTIME, FWTS_FLAG_BATCH | FWTS_FLAG_ACPI | FWTS_FLAG_PARALLEL | FWTS_FLAG_OFFLINE)
 
 #endif
@@ -179,6 +179,6 @@ static fwts_framework_ops bert_ops = {
 	.minor_tests = bert_tests
 };
 
-FWTS_REGISTER("bert", &bert_ops, FWTS_TEST_ANYTIME, FWTS_FLAG_BATCH | FWTS_FLAG_ACPI)
+FWTS_REGISTER("bert", &bert_ops, FWTS_TEST_ANYTIME, FWTS_FLAG_BATCH | FWTS_FLAG_ACPI | FWTS_FLAG_OFFLINE)
 
 #endif
@@ -35,6 +35,10 @@
 #include <dirent.h>
 #include <stdint.h>
 #include <ctype.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <pthread.h>
+#include <time.h>
 
 #define MIN_CSTATE	1
 #define MAX_CSTATE	16
@@ -45,8 +49,57 @@ typedef struct {
 	bool present[MAX_CSTATE];
 } fwts_cstates;
 
+/*
+ *  a CPU exercised by the concurrent test, the state usage
+ *  counters are kept open so each tick is just a pread
+ */
+typedef struct {
+	int cpu;			/* CPU number */
+	int fds[MAX_CSTATE];		/* state usage counters, -1 if not present */
+	fwts_cstates state;		/* counts and states used so far */
+	bool done;			/* all present states have been used */
+	bool affinity_failed;		/* worker could not be pinned to the CPU */
+	pthread_t thread;		/* pinned worker */
+	bool started;			/* worker thread was started */
+} cstates_cpu;
+
+typedef enum {
+	CSTATES_PHASE_IDLE,		/* workers block, letting their CPUs idle */
+	CSTATES_PHASE_BUSY,		/* workers burn cycles for the tick */
+	CSTATES_PHASE_STOP		/* workers exit */
+} cstates_phase;
+
 static int statecount = -1;
 static int firstcpu = -1;
+static bool cstates_concurrent;
+
+static pthread_mutex_t cstates_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cstates_cond = PTHREAD_COND_INITIALIZER;
+static cstates_phase cstates_tick_phase;
+static uint32_t cstates_tick;
+
+/*
+ *  cstate_number()
+ *	get the C state number from a cpuidle state name
+ */
+static long int cstate_number(const char *name)
+{
+	/*
+	 * Names can be "Cx\n", or "ATM-Cx\n", or "SNB-Cx\n",
+	 * or newer kernels can be "Cx\n" or "Cx-SNB\n" etc
+	 * where x is the C state number.
+	 */
+	if ((name[0] == 'C') && isdigit(name[1]))
+		return strtol(name + 1, NULL, 10);
+	else if (strcmp("POLL", name) == 0)
+		return 0;
+	else {
+		const char *ptr = strstr(name, "-C");
+		if (ptr)
+			return strtol(ptr + 2, NULL, 10);
+	}
+	return 0;
+}
 
 static void get_cstates(char *path, fwts_cstates *state)
 {
@@ -75,22 +128,7 @@ static void get_cstates(char *path, fwts_cstates *state)
 			if ((data = fwts_get(filename)) == NULL)
 				break;
 
-			/*
-			 * Names can be "Cx\n", or "ATM-Cx\n", or "SNB-Cx\n",
-			 * or newer kernels can be "Cx\n" or "Cx-SNB\n" etc
-			 * where x is the C state number.
-			 */
-			if ((data[0] == 'C') && isdigit(data[1]))
-				nr = strtol(data + 1, NULL, 10);
-			else if (strcmp("POLL", data) == 0)
-				nr = 0;
-			else {
-				char *ptr = strstr(data, "-C");
-				if (ptr)
-					nr = strtol(ptr + 2, NULL, 10);
-				else
-					nr = 0;
-			}
+			nr = cstate_number(data);
 			free(data);
 
 			snprintf(filename, sizeof(filename), "%s/%s/usage",
@@ -110,57 +148,71 @@ static void get_cstates(char *path, fwts_cstates *state)
 }
 
 #define TOTAL_WAIT_TIME		20
+#define BUSY_TIME_NS		(250000000L)	/* busy tick */
 
-static void do_cpu(fwts_framework *fw, int nth, int cpus, int cpu, char *path)
+/*
+ *  cstates_busy()
+ *	burn CPU cycles for a fixed busy tick, fwts_cpu_benchmark()
+ *	is not used as it stops as soon as its measurement settles
+ */
+static void cstates_busy(void)
 {
-	fwts_cstates initial, current;
-	int	count;
-	char	buffer[128];
-	char	tmp[8];
-	bool	keepgoing = true;
-	int	i;
-
-	get_cstates(path, &initial);
-
-	for (i = 0; (i < TOTAL_WAIT_TIME) && keepgoing; i++) {
-		int j;
+	struct timespec start, now;
+
+	(void)clock_gettime(CLOCK_MONOTONIC, &start);
+	do {
+		fwts_cpu_burn_cycles();
+		(void)clock_gettime(CLOCK_MONOTONIC, &now);
+	} while (((now.tv_sec - start.tv_sec) * 1000000000LL +
+		  (now.tv_nsec - start.tv_nsec)) < BUSY_TIME_NS);
+}
 
-		snprintf(buffer, sizeof(buffer),"(CPU %d of %d)", nth + 1, cpus);
-		fwts_progress_message(fw,
-			100 * (i + (TOTAL_WAIT_TIME*nth)) /
-				(cpus * TOTAL_WAIT_TIME), buffer);
+/*
+ *  cstates_busy_cpu()
+ *	run a busy tick pinned to the given CPU
+ */
+static int cstates_busy_cpu(fwts_framework *fw, const int cpu)
+{
+	cpu_set_t mask, oldset;
 
-		if ((i & 7) < 4)
-			sleep(1);
-		else {
-			fwts_cpu_benchmark_result result;
+	if (sched_getaffinity(0, sizeof(oldset), &oldset) < 0)
+		return FWTS_ERROR;
 
-			if (fwts_cpu_benchmark(fw, cpu, &result) != FWTS_OK) {
-				fwts_failed(fw, LOG_LEVEL_HIGH, "CPUFailedPerformance",
-					"Could not determine the CPU performance, this "
-					"may be due to not being able to get or set the "
-					"CPU affinity for CPU %d.", cpu);
-			}
-		}
+	CPU_ZERO(&mask);
+	CPU_SET(cpu, &mask);
+	if (sched_setaffinity(0, sizeof(mask), &mask) < 0)
+		return FWTS_ERROR;
 
-		get_cstates(path, &current);
+	cstates_busy();
 
-		keepgoing = false;
-		for (j = MIN_CSTATE; j < MAX_CSTATE; j++) {
-			if (initial.counts[j] != current.counts[j]) {
-				initial.counts[j] = current.counts[j];
-				initial.used[j] = true;
-			}
-			if (initial.present[j] && !initial.used[j])
-				keepgoing = true;
-		}
+	if (sched_setaffinity(0, sizeof(oldset), &oldset) < 0) {
+		fwts_log_error(fw, "Cannot restore old CPU affinity settings.");
+		return FWTS_ERROR;
 	}
+	return FWTS_OK;
+}
+
+/*
+ *  cstates_report()
+ *	report the C-states a CPU has reached and
+ *	check it has the same number as the other CPUs
+ */
+static void cstates_report(
+	fwts_framework *fw,
+	const int cpu,
+	const fwts_cstates *state,
+	const bool keepgoing)
+{
+	char	buffer[128];
+	char	tmp[8];
+	int	count;
+	int	i;
 
 	*buffer = '\0';
 	if (keepgoing) {
 		/* Not a failure, but not a pass either! */
 		for (i = MIN_CSTATE; i < MAX_CSTATE; i++)  {
-			if (initial.present[i] && !initial.used[i]) {
+			if (state->present[i] && !state->used[i]) {
 				snprintf(tmp, sizeof(tmp), "C%d ", i);
 				strcat(buffer, tmp);
 			}
@@ -170,7 +222,7 @@ static void do_cpu(fwts_framework *fw, int nth, int cpus, int cpu, char *path)
 				  "complete and thorough test.", cpu, buffer);
 	} else {
 		for (i = MIN_CSTATE; i < MAX_CSTATE; i++)  {
-			if (initial.present[i] && initial.used[i]) {
+			if (state->present[i] && state->used[i]) {
 				snprintf(tmp, sizeof(tmp), "C%d ", i);
 				strcat(buffer, tmp);
 			}
@@ -181,7 +233,7 @@ static void do_cpu(fwts_framework *fw, int nth, int cpus, int cpu, char *path)
 
 	count = 0;
 	for (i = MIN_CSTATE; i < MAX_CSTATE; i++)
-		if (initial.present[i])
+		if (state->present[i])
 			count++;
 
 	if (statecount == -1)
@@ -199,49 +251,323 @@ static void do_cpu(fwts_framework *fw, int nth, int cpus, int cpu, char *path)
 				cpu, firstcpu);
 }
 
-static int cstates_test1(fwts_framework *fw)
+static void do_cpu(fwts_framework *fw, int nth, int cpus, int cpu, char *path)
+{
+	fwts_cstates initial, current;
+	char	buffer[128];
+	bool	keepgoing = true;
+	int	i;
+
+	get_cstates(path, &initial);
+
+	for (i = 0; (i < TOTAL_WAIT_TIME) && keepgoing; i++) {
+		int j;
+
+		snprintf(buffer, sizeof(buffer),"(CPU %d of %d)", nth + 1, cpus);
+		fwts_progress_message(fw,
+			100 * (i + (TOTAL_WAIT_TIME*nth)) /
+				(cpus * TOTAL_WAIT_TIME), buffer);
+
+		if ((i & 7) < 4)
+			sleep(1);
+		else {
+			if (cstates_busy_cpu(fw, cpu) != FWTS_OK) {
+				fwts_failed(fw, LOG_LEVEL_HIGH, "CPUFailedPerformance",
+					"Could not load the CPU, this may be due to "
+					"not being able to get or set the CPU "
+					"affinity for CPU %d.", cpu);
+			}
+		}
+
+		get_cstates(path, &current);
+
+		keepgoing = false;
+		for (j = MIN_CSTATE; j < MAX_CSTATE; j++) {
+			if (initial.counts[j] != current.counts[j]) {
+				initial.counts[j] = current.counts[j];
+				initial.used[j] = true;
+			}
+			if (initial.present[j] && !initial.used[j])
+				keepgoing = true;
+		}
+	}
+
+	cstates_report(fw, cpu, &initial, keepgoing);
+}
+
+/*
+ *  cstates_cpu_open()
+ *	find the C-states of a CPU, open their usage
+ *	counters and read the initial counts
+ */
+static void cstates_cpu_open(cstates_cpu *c, const int cpu, const char *path)
 {
-	DIR *dir;
 	struct dirent *entry;
-	int cpus;
+	DIR *dir;
+	int i;
+
+	memset(c, 0, sizeof(*c));
+	c->cpu = cpu;
+	for (i = 0; i < MAX_CSTATE; i++)
+		c->fds[i] = -1;
+
+	if ((dir = opendir(path)) == NULL)
+		return;
+
+	while ((entry = readdir(dir)) != NULL) {
+		char filename[PATH_MAX];
+		char *data;
+		long int nr;
+		int fd;
+
+		if (strlen(entry->d_name) <= 3)
+			continue;
+
+		snprintf(filename, sizeof(filename), "%s/%s/name",
+			path, entry->d_name);
+		if ((data = fwts_get(filename)) == NULL)
+			break;
+		nr = cstate_number(data);
+		free(data);
+		if ((nr < 0) || (nr >= MAX_CSTATE))
+			continue;
+
+		snprintf(filename, sizeof(filename), "%s/%s/usage",
+			path, entry->d_name);
+		if ((fd = open(filename, O_RDONLY)) < 0)
+			break;
+		if (c->fds[nr] >= 0)
+			(void)close(c->fds[nr]);
+		c->fds[nr] = fd;
+		c->state.present[nr] = true;
+	}
+	closedir(dir);
+
+	for (i = MIN_CSTATE; i < MAX_CSTATE; i++) {
+		if (c->fds[i] >= 0) {
+			char buffer[32];
+			ssize_t n = pread(c->fds[i], buffer, sizeof(buffer) - 1, 0);
+
+			buffer[n > 0 ? n : 0] = '\0';
+			c->state.counts[i] = strtoull(buffer, NULL, 10);
+		}
+	}
+}
+
+/*
+ *  cstates_cpu_close()
+ *	close a CPU's usage counters
+ */
+static void cstates_cpu_close(cstates_cpu *c)
+{
 	int i;
 
+	for (i = 0; i < MAX_CSTATE; i++) {
+		if (c->fds[i] >= 0)
+			(void)close(c->fds[i]);
+		c->fds[i] = -1;
+	}
+}
+
+/*
+ *  cstates_cpu_sample()
+ *	flag the states whose usage counts have changed,
+ *	returns true once all present states have been used
+ */
+static bool cstates_cpu_sample(cstates_cpu *c)
+{
+	bool done = true;
+	int i;
+
+	for (i = MIN_CSTATE; i < MAX_CSTATE; i++) {
+		char buffer[32];
+		ssize_t n;
+		int count;
+
+		if (c->fds[i] < 0)
+			continue;
+		if ((n = pread(c->fds[i], buffer, sizeof(buffer) - 1, 0)) <= 0)
+			continue;
+		buffer[n] = '\0';
+		count = strtoull(buffer, NULL, 10);
+		if (c->state.counts[i] != count) {
+			c->state.counts[i] = count;
+			c->state.used[i] = true;
+		}
+	}
+	for (i = MIN_CSTATE; i < MAX_CSTATE; i++)
+		if (c->state.present[i] && !c->state.used[i])
+			done = false;
+
+	return done;
+}
+
+/*
+ *  cstates_worker()
+ *	worker pinned to a CPU, it blocks during idle ticks so the CPU
+ *	can enter deep C-states and burns cycles during busy ticks
+ */
+static void *cstates_worker(void *arg)
+{
+	cstates_cpu *c = (cstates_cpu *)arg;
+	cpu_set_t mask;
+	uint32_t tick = 0;
+
+	CPU_ZERO(&mask);
+	CPU_SET(c->cpu, &mask);
+	if (pthread_setaffinity_np(pthread_self(), sizeof(mask), &mask) != 0) {
+		c->affinity_failed = true;
+		return NULL;
+	}
+
+	for (;;) {
+		cstates_phase phase;
+
+		pthread_mutex_lock(&cstates_mutex);
+		while ((cstates_tick == tick) && (cstates_tick_phase != CSTATES_PHASE_STOP))
+			pthread_cond_wait(&cstates_cond, &cstates_mutex);
+		tick = cstates_tick;
+		phase = cstates_tick_phase;
+		pthread_mutex_unlock(&cstates_mutex);
+
+		if (phase == CSTATES_PHASE_STOP)
+			break;
+		if (phase == CSTATES_PHASE_BUSY)
+			cstates_busy();
+	}
+	return NULL;
+}
+
+/*
+ *  cstates_tick_start()
+ *	start the next idle or busy tick on all workers
+ */
+static void cstates_tick_start(const cstates_phase phase)
+{
+	pthread_mutex_lock(&cstates_mutex);
+	cstates_tick++;
+	cstates_tick_phase = phase;
+	pthread_cond_broadcast(&cstates_cond);
+	pthread_mutex_unlock(&cstates_mutex);
+}
+
+/*
+ *  cstates_test_concurrent()
+ *	exercise all CPUs at the same time with pinned workers, sampling
+ *	every CPU each tick, until all CPUs have used all their C-states
+ */
+static void cstates_test_concurrent(
+	fwts_framework *fw,
+	const fwts_cpu_topology *topology,
+	const int cpus)
+{
+	cstates_cpu *cpu;
+	const struct timespec busy = { 0, BUSY_TIME_NS };
+	bool keepgoing = true;
+	int i, n;
+
+	if ((cpu = calloc(cpus, sizeof(*cpu))) == NULL) {
+		fwts_log_error(fw, "Cannot allocate CPU C-state data.");
+		return;
+	}
+
+	for (i = 0, n = 0; (n < cpus) && (i < topology->len); i++) {
+		char cpupath[PATH_MAX];
+
+		if (!topology->cpus[i].sysfs)
+			continue;
+		snprintf(cpupath, sizeof(cpupath), "%s/cpu%d/cpuidle",
+			PROCESSOR_PATH, i);
+		cstates_cpu_open(&cpu[n++], i, cpupath);
+	}
+
+	cstates_tick = 0;
+	cstates_tick_phase = CSTATES_PHASE_IDLE;
+	for (i = 0; i < n; i++) {
+		cpu[i].started = (pthread_create(&cpu[i].thread, NULL, cstates_worker, &cpu[i]) == 0);
+		if (!cpu[i].started)
+			fwts_log_error(fw, "Cannot create worker thread for CPU %d.", cpu[i].cpu);
+	}
+
+	for (i = 0; (i < TOTAL_WAIT_TIME) && keepgoing; i++) {
+		char buffer[128];
+		int j;
+
+		snprintf(buffer, sizeof(buffer), "(%d CPUs)", n);
+		fwts_progress_message(fw, 100 * i / TOTAL_WAIT_TIME, buffer);
+
+		if ((i & 7) < 4) {
+			cstates_tick_start(CSTATES_PHASE_IDLE);
+			sleep(1);
+		} else {
+			cstates_tick_start(CSTATES_PHASE_BUSY);
+			(void)nanosleep(&busy, NULL);
+		}
+
+		keepgoing = false;
+		for (j = 0; j < n; j++) {
+			if (!cpu[j].done)
+				cpu[j].done = cstates_cpu_sample(&cpu[j]);
+			if (!cpu[j].done)
+				keepgoing = true;
+		}
+	}
+
+	cstates_tick_start(CSTATES_PHASE_STOP);
+	for (i = 0; i < n; i++)
+		if (cpu[i].started)
+			(void)pthread_join(cpu[i].thread, NULL);
+
+	for (i = 0; i < n; i++) {
+		if (cpu[i].affinity_failed)
+			fwts_failed(fw, LOG_LEVEL_HIGH, "CPUFailedPerformance",
+				"Could not exercise the CPU, this may be due to "
+				"not being able to set the CPU affinity for CPU %d.",
+				cpu[i].cpu);
+		cstates_report(fw, cpu[i].cpu, &cpu[i].state, !cpu[i].done);
+		cstates_cpu_close(&cpu[i]);
+	}
+	free(cpu);
+}
+
+static int cstates_test1(fwts_framework *fw)
+{
+	const fwts_cpu_topology *topology;
+	int cpus;
+	int i, n;
+
 	fwts_log_info(fw,
 		"This test checks if all processors have the same number of "
 		"C-states, if the C-state counter works and if C-state "
 		"transitions happen.");
 
-	if ((dir = opendir(PROCESSOR_PATH)) == NULL) {
+	if (((topology = fwts_cpu_topology_get()) == NULL) ||
+	    (access(PROCESSOR_PATH, R_OK) != 0)) {
 		fwts_failed(fw, LOG_LEVEL_HIGH, "CPUNoSysMounted",
 			"Cannot open %s: /sys not mounted?", PROCESSOR_PATH);
 		return FWTS_ERROR;
 	}
 
 	/* How many CPUs are there? */
-	for (cpus = 0; (entry = readdir(dir)) != NULL; )
-		if (entry &&
-		    (strlen(entry->d_name)>3) &&
-		    (strncmp(entry->d_name, "cpu", 3) == 0) &&
-		    (isdigit(entry->d_name[3])))
+	for (cpus = 0, i = 0; i < topology->len; i++)
+		if (topology->cpus[i].sysfs)
 			cpus++;
 
-	rewinddir(dir);
+	if (cstates_concurrent) {
+		cstates_test_concurrent(fw, topology, cpus);
+		return FWTS_OK;
+	}
 
-	for (i = 0; (cpus > 0) && (entry = readdir(dir)) != NULL; ) {
-		if (entry &&
-		    (strlen(entry->d_name)>3) &&
-		    (strncmp(entry->d_name, "cpu", 3) == 0) &&
-		    (isdigit(entry->d_name[3]))) {
-			char cpupath[PATH_MAX];
+	for (i = 0, n = 0; i < topology->len; i++) {
+		char cpupath[PATH_MAX];
 
-			snprintf(cpupath, sizeof(cpupath), "%s/%s/cpuidle",
-				PROCESSOR_PATH, entry->d_name);
-			do_cpu(fw, i++, cpus, strtoul(entry->d_name+3, NULL, 10), cpupath);
-		}
+		if (!topology->cpus[i].sysfs)
+			continue;
+		snprintf(cpupath, sizeof(cpupath), "%s/cpu%d/cpuidle",
+			PROCESSOR_PATH, i);
+		do_cpu(fw, n++, cpus, i, cpupath);
 	}
 
-	closedir(dir);
-
 	return FWTS_OK;
 }
 
@@ -250,9 +576,37 @@ static fwts_framework_minor_test cstates_tests[] = {
 	{ NULL, NULL }
 };
 
+static int cstates_options_handler(
+	fwts_framework *fw,
+	int argc,
+	char * const argv[],
+	int option_char,
+	int long_index)
+{
+	FWTS_UNUSED(fw);
+	FWTS_UNUSED(argc);
+	FWTS_UNUSED(argv);
+
+	if (option_char == 0) {
+		switch (long_index) {
+		case 0:	/* --cstates-concurrent */
+			cstates_concurrent = true;
+			break;
+		}
+	}
+	return FWTS_OK;
+}
+
+static fwts_option cstates_options[] = {
+	{ "cstates-concurrent",	"", 0, "Exercise C-states on all CPUs at the same time rather than one CPU at a time." },
+	{ NULL, NULL, 0, NULL }
+};
+
 static fwts_framework_ops cstates_ops = {
-	.description = "Processor C state support test.",
-	.minor_tests = cstates_tests
+	.description     = "Processor C state support test.",
+	.minor_tests     = cstates_tests,
+	.options         = cstates_options,
+	.options_handler = cstates_options_handler,
 };
 
 FWTS_REGISTER("cstates", &cstates_ops, FWTS_TEST_ANYTIME, FWTS_FLAG_BATCH | FWTS_FLAG_ACPI)
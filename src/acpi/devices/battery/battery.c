@@ -47,7 +47,7 @@ static int acpi_battery_init(fwts_framework *fw)
 {
 	ACPI_STATUS status;
 
-	if (fwts_acpica_init(fw) != FWTS_OK)
+	if (fwts_acpi_init(fw) != FWTS_OK)
 		return FWTS_ERROR;
 
 	status = AcpiGetDevices(FWTS_ACPI_DEVICE_HID, get_device_handle, NULL, NULL);
@@ -58,7 +58,7 @@ static int acpi_battery_init(fwts_framework *fw)
 
 	if (!device) {
 		fwts_log_error(fw, "ACPI %s device does not exist, skipping test", FWTS_ACPI_DEVICE);
-		fwts_acpica_deinit();
+		fwts_acpi_deinit(fw);
 		return FWTS_SKIP;
 	} else {
 		ACPI_BUFFER buffer;
@@ -389,8 +389,7 @@ static fwts_framework_minor_test acpi_battery_tests[] = {
 
 static int acpi_battery_deinit(fwts_framework *fw)
 {
-	FWTS_UNUSED(fw);
-	fwts_acpica_deinit();
+	fwts_acpi_deinit(fw);
 
 	return FWTS_OK;
 }
@@ -402,6 +401,6 @@ static fwts_framework_ops acpi_battery_ops = {
 	.minor_tests = acpi_battery_tests
 };
 
-FWTS_REGISTER("acpi_battery", &acpi_battery_ops, FWTS_TEST_ANYTIME, FWTS_FLAG_BATCH | FWTS_FLAG_ACPI)
+FWTS_REGISTER("acpi_battery", &acpi_battery_ops, FWTS_TEST_ANYTIME, FWTS_FLAG_BATCH | FWTS_FLAG_ACPI | FWTS_FLAG_ACPI_NAMESPACE)
 
 #endif
@@ -47,7 +47,7 @@ static int sleep_button_init(fwts_framework *fw)
 {
 	ACPI_STATUS status;
 
-	if (fwts_acpica_init(fw) != FWTS_OK)
+	if (fwts_acpi_init(fw) != FWTS_OK)
 		return FWTS_ERROR;
 
 	status = AcpiGetDevices(FWTS_ACPI_DEVICE_HID, get_device_handle, NULL, NULL);
@@ -58,7 +58,7 @@ static int sleep_button_init(fwts_framework *fw)
 
 	if (!device) {
 		fwts_log_error(fw, "ACPI %s device does not exist, skipping test", FWTS_ACPI_DEVICE);
-		fwts_acpica_deinit();
+		fwts_acpi_deinit(fw);
 		return FWTS_SKIP;
 	} else {
 		ACPI_BUFFER buffer;
@@ -157,8 +157,7 @@ static fwts_framework_minor_test sleep_button_tests[] = {
 
 static int sleep_button_deinit(fwts_framework *fw)
 {
-	FWTS_UNUSED(fw);
-	fwts_acpica_deinit();
+	fwts_acpi_deinit(fw);
 
 	return FWTS_OK;
 }
@@ -170,6 +169,6 @@ static fwts_framework_ops sleep_button_ops = {
 	.minor_tests = sleep_button_tests
 };
 
-FWTS_REGISTER("acpi_slpb", &sleep_button_ops, FWTS_TEST_ANYTIME, FWTS_FLAG_BATCH | FWTS_FLAG_ACPI)
+FWTS_REGISTER("acpi_slpb", &sleep_button_ops, FWTS_TEST_ANYTIME, FWTS_FLAG_BATCH | FWTS_FLAG_ACPI | FWTS_FLAG_ACPI_NAMESPACE)
 
 #endif
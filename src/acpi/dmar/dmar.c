@@ -99,31 +99,19 @@ struct acpi_pci_path {
  * = 0, normal pci device
  * = 1, pci bridge, sec_bus gets set
  */
-static int read_pci_device_secondary_bus_number(const uint8_t seg,
-	const uint8_t bus, const uint8_t dev,
+static int read_pci_device_secondary_bus_number(fwts_framework *fw,
+	const uint16_t seg, const uint8_t bus, const uint8_t dev,
 	const uint8_t fn, uint8_t *sec_bus)
 {
-	FILE *file;
-	char path[PATH_MAX];
-	char configs[64];
-	size_t count;
-
-	snprintf(path, sizeof(path),
-		"/sys/bus/pci/devices/%04x:%02x:%02x.%" PRIu8 "/config",
-		seg, bus, dev, fn);
-	if ((file = fopen(path, "r")) == NULL)
-		return -1;
-
-	count = fread(configs, sizeof(char), 64, file);
-	(void)fclose(file);
+	fwts_pci_device *device;
 
-	if (count < 64)
+	device = fwts_pci_topology_find(fwts_pci_topology_get(fw), seg, bus, dev, fn);
+	if ((device == NULL) || (device->config_len < 64))
 		return -1;
 
-	/* header type is at 0x0e */
-	if ((configs[0xe] & 0x7f) != 1) /* not a pci bridge */
+	if (device->header_type != FWTS_PCI_CONFIG_HEADER_TYPE_PCI_BRIDGE)
 		return 0;
-	*sec_bus = configs[0x19]; 	/* secondary bus number */
+	*sec_bus = device->secondary_bus;
 	return 1;
 }
 
@@ -164,7 +152,7 @@ static int acpi_parse_one_dev_scope(fwts_framework *fw,
 	while (count) {
 		if (dev_type <= 0) /* last device isn't a pci bridge */
 			goto error;
-		dev_type = read_pci_device_secondary_bus_number(seg, bus,
+		dev_type = read_pci_device_secondary_bus_number(fw, seg, bus,
 			path->dev, path->fn, &sec_bus);
 		if (dev_type < 0) {	/* no such device */
 			fwts_warning(fw, "PCI device %04Xh:%02Xh:%02Xh.%02Xh is not found.",
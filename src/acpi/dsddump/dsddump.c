@@ -194,6 +194,6 @@ static fwts_framework_ops dsddump_ops = {
 	.minor_tests = dsddump_tests
 };
 
-FWTS_REGISTER("dsddump", &dsddump_ops, FWTS_TEST_ANYTIME, FWTS_FLAG_UTILS)
+FWTS_REGISTER("dsddump", &dsddump_ops, FWTS_TEST_ANYTIME, FWTS_FLAG_UTILS | FWTS_FLAG_ACPI_NAMESPACE)
 
 #endif
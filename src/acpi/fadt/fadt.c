@@ -44,6 +44,7 @@ static inline int ioperm(int a, ...)
 
 static const fwts_acpi_table_fadt *fadt;
 static int fadt_size;
+static bool fadt_from_firmware;
 
 static const fwts_acpi_table_facs *facs;
 
@@ -61,6 +62,7 @@ static int fadt_init(fwts_framework *fw)
 	}
 	fadt = (const fwts_acpi_table_fadt *)table->data;
 	fadt_size = table->length;
+	fadt_from_firmware = (table->provenance == FWTS_ACPI_TABLE_FROM_FIRMWARE);
 
 	/*  Not having a FADT is not a failure on x86 */
 	if (fadt_size == 0) {
@@ -1760,6 +1762,17 @@ static int fadt_test2(fwts_framework *fw)
 		width = fadt->x_pm1a_cnt_blk.register_bit_width;
 	}
 
+	/*
+	 * The PM1a control register can only be read if the table
+	 * is directly from the machine we're running on.
+	 */
+	if (!fadt_from_firmware) {
+		fwts_log_info(fw, "ACPI table loaded from file so fwts will not read "
+			"PM1a control register at port 0x%" PRIx32 ", skipping SCI_EN check.",
+			port);
+		return FWTS_OK;
+	}
+
 	switch (width) {
 	case 8:
 		if (ioperm(port, width/8, 1) < 0)
@@ -1897,5 +1910,5 @@ static fwts_framework_ops fadt_ops = {
 };
 
 FWTS_REGISTER("fadt", &fadt_ops, FWTS_TEST_ANYTIME, FWTS_FLAG_BATCH |
-	      FWTS_FLAG_ROOT_PRIV | FWTS_FLAG_ACPI | FWTS_FLAG_COMPLIANCE_ACPI)
+	      FWTS_FLAG_ROOT_PRIV | FWTS_FLAG_ACPI | FWTS_FLAG_COMPLIANCE_ACPI | FWTS_FLAG_ACPI_NAMESPACE | FWTS_FLAG_OFFLINE)
 #endif
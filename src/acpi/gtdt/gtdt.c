@@ -259,6 +259,6 @@ static fwts_framework_ops gtdt_ops = {
 	.minor_tests = gtdt_tests
 };
 
-FWTS_REGISTER("gtdt", &gtdt_ops, FWTS_TEST_ANYTIME, FWTS_FLAG_BATCH | FWTS_FLAG_ACPI | FWTS_FLAG_SBBR)
+FWTS_REGISTER("gtdt", &gtdt_ops, FWTS_TEST_ANYTIME, FWTS_FLAG_BATCH | FWTS_FLAG_ACPI | FWTS_FLAG_SBBR | FWTS_FLAG_PARALLEL | FWTS_FLAG_OFFLINE)
 
 #endif
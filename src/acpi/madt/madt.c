@@ -438,7 +438,7 @@ static int madt_init(fwts_framework *fw)
 	fwts_list_init(&its_ids);
 	fwts_list_init(&processor_uids);
 
-	if (fwts_acpica_init(fw) != FWTS_OK)
+	if (fwts_acpi_init(fw) != FWTS_OK)
 		return FWTS_ERROR;
 
 PRAGMA_PUSH
@@ -449,7 +449,7 @@ PRAGMA_POP
 	AcpiGetDevices("ACPI0007", madt_processor_handler, NULL, NULL);
 
 	if (!spec_data)
-		fwts_acpica_deinit();
+		fwts_acpi_deinit(fw);
 
 	return (spec_data) ? FWTS_OK : FWTS_ERROR;
 }
@@ -2212,7 +2212,7 @@ static int madt_subtables(fwts_framework *fw)
 
 static int madt_deinit(fwts_framework *fw)
 {
-	fwts_acpica_deinit();
+	fwts_acpi_deinit(fw);
 
 	/* only minor clean up needed */
 	fwts_list_free_items(&msi_frame_ids, NULL);
@@ -2238,6 +2238,6 @@ static fwts_framework_ops madt_ops = {
 	.minor_tests = madt_tests
 };
 
-FWTS_REGISTER("madt", &madt_ops, FWTS_TEST_ANYTIME, FWTS_FLAG_BATCH | FWTS_FLAG_ACPI | FWTS_FLAG_COMPLIANCE_ACPI | FWTS_FLAG_SBBR)
+FWTS_REGISTER("madt", &madt_ops, FWTS_TEST_ANYTIME, FWTS_FLAG_BATCH | FWTS_FLAG_ACPI | FWTS_FLAG_COMPLIANCE_ACPI | FWTS_FLAG_SBBR | FWTS_FLAG_PARALLEL | FWTS_FLAG_ACPI_NAMESPACE | FWTS_FLAG_OFFLINE)
 
 #endif
@@ -37,10 +37,9 @@ static int compare_config_space(
 {
 	uint8_t *mapped_config_space;
 	uint8_t config_space[16];
-	size_t page_size, n;
+	size_t page_size;
 	bool match;
-	char path[PATH_MAX];
-	FILE *fp;
+	fwts_pci_device *device;
 	int i;
 
 	page_size = fwts_page_size();
@@ -49,20 +48,19 @@ static int compare_config_space(
  	 * Sanity check on first config, this is enough to
 	 * see if MMIO base is OK or not
 	 */
-	snprintf(path, sizeof(path),
-		"/sys/bus/pci/devices/%4.4" PRIx16 ":00:00.0/config",
-		config->pci_segment_group_number);
-
-	if ((fp = fopen(path, "r")) == NULL) {
-		fwts_warning(fw, "Could not open %s.", path);
+	device = fwts_pci_topology_find(fwts_pci_topology_get(fw),
+		config->pci_segment_group_number, 0, 0, 0);
+	if (device == NULL) {
+		fwts_warning(fw, "Could not read PCI config of device %4.4" PRIx16 ":00:00.0.",
+			config->pci_segment_group_number);
 		return FWTS_ERROR;
 	}
-	n = fread(config_space, 1, sizeof(config_space), fp);
-	(void)fclose(fp);
-	if (n != sizeof(config_space)) {
-		fwts_warning(fw, "Could only read %zd bytes from %s, expecting %zd.", n, path, sizeof(config_space));
+	if (device->config_len < sizeof(config_space)) {
+		fwts_warning(fw, "Could only read %" PRIu16 " bytes from PCI device %s, expecting %zd.",
+			device->config_len, device->name, sizeof(config_space));
 		return FWTS_ERROR;
 	}
+	memcpy(config_space, device->config, sizeof(config_space));
 
 	if ((mapped_config_space = fwts_mmap(config->base_address, page_size)) == FWTS_MAP_FAILED) {
 		char *data;
@@ -274,8 +274,22 @@
 #define DEVICE_D3HOT	3
 #define DEVICE_D3COLD	4
 
+#define METHOD_JOBS_MAX	(256)
+
 static bool fadt_mobile_platform;	/* True if a mobile platform */
 static uint32_t gcp_return_value;
+static int method_jobs = 1;		/* --method-jobs */
+
+/*
+ *  Objects with no side effects that can be evaluated in parallel
+ *  forked workers when --method-jobs is more than 1
+ */
+static const char *const method_parallel_names[] = {
+	"_ADR", "_BBN", "_CCA", "_CID", "_CLS", "_CRS", "_DDN", "_DEP",
+	"_DSD", "_HID", "_HRV", "_MLS", "_PLD", "_PRS", "_PRT", "_PXM",
+	"_SEG", "_STA", "_STR", "_SUB", "_SUN", "_UID", "_UPC",
+	NULL
+};
 
 #define method_test_integer(name, type)				\
 static int method_test ## name(fwts_framework *fw)		\
@@ -340,6 +354,31 @@ static int method_deinit(fwts_framework *fw)
 	return fwts_acpi_deinit(fw);
 }
 
+/*
+ *  method_check_locks
+ *	check an evaluation released all the locks it acquired
+ */
+static void method_check_locks(
+	fwts_framework *fw,
+	const char *name,
+	const int sem_acquired,
+	const int sem_released)
+{
+	if (sem_acquired != sem_released) {
+		fwts_failed(fw, LOG_LEVEL_MEDIUM, "AMLLocksAcquired",
+			"%s left %d locks in an acquired state.",
+			name, sem_acquired - sem_released);
+		fwts_advice(fw,
+			"Locks left in an acquired state generally indicates "
+			"that the AML code is not releasing a lock. This can "
+			"sometimes occur when a method hits an error "
+			"condition and exits prematurely without releasing an "
+			"acquired lock. It may be occurring in the method "
+			"being tested or other methods used while evaluating "
+			"the method.");
+	}
+}
+
 /*
  *  method_evaluate_found_method
  *	find a given object name and evaluate it
@@ -371,19 +410,85 @@ void method_evaluate_found_method(
 	free(buf.Pointer);
 
 	fwts_acpica_sem_count_get(&sem_acquired, &sem_released);
-	if (sem_acquired != sem_released) {
-		fwts_failed(fw, LOG_LEVEL_MEDIUM, "AMLLocksAcquired",
-			"%s left %d locks in an acquired state.",
-			name, sem_acquired - sem_released);
-		fwts_advice(fw,
-			"Locks left in an acquired state generally indicates "
-			"that the AML code is not releasing a lock. This can "
-			"sometimes occur when a method hits an error "
-			"condition and exits prematurely without releasing an "
-			"acquired lock. It may be occurring in the method "
-			"being tested or other methods used while evaluating "
-			"the method.");
+	method_check_locks(fw, name, sem_acquired, sem_released);
+}
+
+/*
+ *  method_can_evaluate_parallel
+ *	true if the named object can be evaluated in parallel workers
+ */
+static bool method_can_evaluate_parallel(
+	fwts_framework *fw,
+	const char *name,
+	const int num_args)
+{
+	int i;
+
+	/*
+	 * ACPICA debug output must stay in evaluation order and
+	 * profiling data gathered in the workers would be lost
+	 */
+	if ((method_jobs < 2) || (num_args > 0) ||
+	    (fw->flags & (FWTS_FLAG_ACPICA_DEBUG | FWTS_FLAG_ACPICA_PROFILE)))
+		return false;
+
+	for (i = 0; method_parallel_names[i]; i++)
+		if (!strcmp(name, method_parallel_names[i]))
+			return true;
+
+	return false;
+}
+
+/*
+ *  method_evaluate_found_methods_parallel
+ *	evaluate objects in parallel workers and then check the
+ *	results in namespace order
+ */
+static void method_evaluate_found_methods_parallel(
+	fwts_framework *fw,
+	char **names,
+	const int n,
+	fwts_method_return check_func,
+	void *private)
+{
+	fwts_acpi_object_result *results;
+	int i;
+
+	if ((results = calloc(n, sizeof(*results))) == NULL) {
+		fwts_log_error(fw, "Out of memory allocating method results.");
+		return;
 	}
+	if (fwts_acpi_object_evaluate_parallel(fw, names, n, NULL,
+		method_jobs, results) != FWTS_OK) {
+		fwts_log_error(fw, "Cannot start method evaluation workers.");
+		free(results);
+		return;
+	}
+
+	for (i = 0; i < n; i++) {
+		fwts_acpi_object_result *result = &results[i];
+
+		if (!result->evaluated) {
+			fwts_log_error(fw, "Worker failed to evaluate %s.",
+				result->name);
+			continue;
+		}
+		(void)fwts_log_capture_replay(fw, result->log, result->log_len);
+		fwts_framework_summate_results(&fw->minor_tests, &result->results);
+
+		if (ACPI_FAILURE(result->status) != AE_OK) {
+			fwts_acpi_object_evaluate_report_error(fw,
+				result->name, result->status);
+		} else if (check_func != NULL) {
+			ACPI_OBJECT *obj = result->buf.Pointer;
+			check_func(fw, result->name, &result->buf, obj, private);
+		}
+		method_check_locks(fw, result->name,
+			result->sem_acquired, result->sem_released);
+	}
+
+	fwts_acpi_object_results_free(results, n);
+	free(results);
 }
 
 /*
@@ -401,44 +506,56 @@ static int method_evaluate_method(fwts_framework *fw,
 	void *private)
 {
 	fwts_list *methods;
-	size_t name_len = strlen(name);
 	bool found = false;
+	const bool parallel = method_can_evaluate_parallel(fw, name, num_args);
 
 
-	if ((methods = fwts_acpi_object_get_names()) != NULL) {
+	if ((methods = fwts_acpi_object_find_all(name)) != NULL) {
 		fwts_list_link	*item;
+		char **found_names = NULL;
+		int n = 0;
+
+		if (parallel)
+			found_names = calloc(fwts_list_len(methods), sizeof(char *));
 
 		fwts_list_foreach(item, methods) {
 			char *method_name = fwts_list_data(char*, item);
 			ACPI_HANDLE method_handle;
 			ACPI_OBJECT_TYPE type;
 			ACPI_STATUS status;
+			ACPI_OBJECT_LIST  arg_list;
 
-			size_t len = strlen(method_name);
-			if (strncmp(name, method_name + len - name_len, name_len) == 0) {
-				ACPI_OBJECT_LIST  arg_list;
-
-				status = AcpiGetHandle (NULL, method_name, &method_handle);
-				if (ACPI_FAILURE(status)) {
-					fwts_warning(fw, "Failed to get handle for object %s.", name);
-					continue;
-				}
-				status = AcpiGetType(method_handle, &type);
-				if (ACPI_FAILURE(status)) {
-					fwts_warning(fw, "Failed to get object type for %s.",name);
-					continue;
-				}
+			status = AcpiGetHandle (NULL, method_name, &method_handle);
+			if (ACPI_FAILURE(status)) {
+				fwts_warning(fw, "Failed to get handle for object %s.", name);
+				continue;
+			}
+			status = AcpiGetType(method_handle, &type);
+			if (ACPI_FAILURE(status)) {
+				fwts_warning(fw, "Failed to get object type for %s.",name);
+				continue;
+			}
 
-				if (type == ACPI_TYPE_LOCAL_SCOPE)
-					continue;
+			if (type == ACPI_TYPE_LOCAL_SCOPE)
+				continue;
 
-				found = true;
-				arg_list.Count   = num_args;
-				arg_list.Pointer = args;
-				method_evaluate_found_method(fw, method_name,
-					check_func, private, &arg_list);
+			found = true;
+			if (found_names) {
+				found_names[n++] = method_name;
+				continue;
 			}
+			arg_list.Count   = num_args;
+			arg_list.Pointer = args;
+			method_evaluate_found_method(fw, method_name,
+				check_func, private, &arg_list);
+		}
+		if (found_names) {
+			if (n > 0)
+				method_evaluate_found_methods_parallel(fw,
+					found_names, n, check_func, private);
+			free(found_names);
 		}
+		fwts_list_free(methods, NULL);
 	}
 
 	if (found) {
@@ -5531,14 +5648,55 @@ static fwts_framework_minor_test method_tests[] = {
 	{ NULL, NULL }
 };
 
+static int method_options_check(fwts_framework *fw)
+{
+	FWTS_UNUSED(fw);
+
+	if ((method_jobs < 1) || (method_jobs > METHOD_JOBS_MAX)) {
+		fprintf(stderr, "--method-jobs is %d, it should be 1..%d\n",
+			method_jobs, METHOD_JOBS_MAX);
+		return FWTS_ERROR;
+	}
+	return FWTS_OK;
+}
+
+static int method_options_handler(
+	fwts_framework *fw,
+	int argc,
+	char * const argv[],
+	int option_char,
+	int long_index)
+{
+	FWTS_UNUSED(fw);
+	FWTS_UNUSED(argc);
+	FWTS_UNUSED(argv);
+
+	if (option_char == 0) {
+		switch (long_index) {
+		case 0:	/* --method-jobs */
+			method_jobs = atoi(optarg);
+			break;
+		}
+	}
+	return FWTS_OK;
+}
+
+static fwts_option method_options[] = {
+	{ "method-jobs",	"", 1, "Evaluate side effect free methods in N parallel processes, e.g. --method-jobs=8." },
+	{ NULL, NULL, 0, NULL }
+};
+
 static fwts_framework_ops method_ops = {
-	.description = "ACPI DSDT Method Semantic tests.",
-	.init        = method_init,
-	.deinit      = method_deinit,
-	.minor_tests = method_tests
+	.description     = "ACPI DSDT Method Semantic tests.",
+	.init            = method_init,
+	.deinit          = method_deinit,
+	.minor_tests     = method_tests,
+	.options         = method_options,
+	.options_handler = method_options_handler,
+	.options_check   = method_options_check,
 };
 
 FWTS_REGISTER("method", &method_ops, FWTS_TEST_ANYTIME,
-	       FWTS_FLAG_BATCH | FWTS_FLAG_ACPI | FWTS_FLAG_SBBR)
+	       FWTS_FLAG_BATCH | FWTS_FLAG_ACPI | FWTS_FLAG_SBBR | FWTS_FLAG_ACPI_NAMESPACE | FWTS_FLAG_OFFLINE)
 
 #endif
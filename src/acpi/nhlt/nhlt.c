@@ -283,6 +283,6 @@ static fwts_framework_ops nhlt_ops = {
 	.minor_tests = nhlt_tests
 };
 
-FWTS_REGISTER("nhlt", &nhlt_ops, FWTS_TEST_ANYTIME, FWTS_FLAG_BATCH | FWTS_FLAG_ACPI)
+FWTS_REGISTER("nhlt", &nhlt_ops, FWTS_TEST_ANYTIME, FWTS_FLAG_BATCH | FWTS_FLAG_ACPI | FWTS_FLAG_OFFLINE)
 
 #endif
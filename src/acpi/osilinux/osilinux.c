@@ -115,6 +115,6 @@ static fwts_framework_ops osilinux_ops = {
 	.minor_tests = osilinux_tests
 };
 
-FWTS_REGISTER("osilinux", &osilinux_ops, FWTS_TEST_ANYTIME, FWTS_FLAG_BATCH)
+FWTS_REGISTER("osilinux", &osilinux_ops, FWTS_TEST_ANYTIME, FWTS_FLAG_BATCH | FWTS_FLAG_OFFLINE)
 
 #endif
@@ -189,6 +189,6 @@ static fwts_framework_ops pptt_ops = {
 	.minor_tests = pptt_tests
 };
 
-FWTS_REGISTER("pptt", &pptt_ops, FWTS_TEST_ANYTIME, FWTS_FLAG_BATCH | FWTS_FLAG_ACPI | FWTS_FLAG_SBBR)
+FWTS_REGISTER("pptt", &pptt_ops, FWTS_TEST_ANYTIME, FWTS_FLAG_BATCH | FWTS_FLAG_ACPI | FWTS_FLAG_SBBR | FWTS_FLAG_PARALLEL | FWTS_FLAG_OFFLINE)
 
 #endif
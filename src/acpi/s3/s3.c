@@ -59,6 +59,9 @@ static bool s3_hybrid = false;
 static char *s3_hook = NULL;		/* Hook to run after each S3 */
 static char *s3_sleep_type = NULL;	/* The sleep type(s3 or s2idle) */
 static bool s3_wakeup_src = false;	/* dump wakeup source for debug */
+static char *s3_timing_export = NULL;	/* File to export cycle timings to */
+static int  s3_timing_drift = FWTS_PM_TIMING_DRIFT_DEFAULT;	/* Allowed timing drift, percent */
+static bool s3_device_times = false;	/* Log per-device suspend/resume times */
 
 typedef struct {
 	char		name[32];
@@ -672,6 +675,8 @@ tidy:
 static int s3_scan_times(
 	fwts_framework *fw,
 	fwts_list *klog,
+	fwts_pm_timing *timing,
+	fwts_pm_timing_cycle *cycle,
 	int *suspend_too_long,
 	int *resume_too_long)
 {
@@ -749,12 +754,18 @@ static int s3_scan_times(
 			s3_resume_finish = ts;
 			break;
 		}
+
+		/* Device resume times, if pm_print_times is enabled */
+		if (timing && s3_resume_start > 0.0)
+			(void)fwts_pm_timing_device_line(timing, fwts_klog_remove_timestamp(txt));
 	}
 
 	fwts_log_info(fw, "Suspend/Resume Timings:");
 	if (s3_suspend_start > 0.0 && s3_suspend_finish > 0.0) {
 		fwts_log_info_verbatim(fw, "  Suspend: %.3f seconds.",
 			s3_suspend_finish - s3_suspend_start);
+		cycle->phase[FWTS_PM_TIMING_SUSPEND] =
+			(uint32_t)((s3_suspend_finish - s3_suspend_start) * 1000000.0);
 		if (s3_suspend_finish - s3_suspend_start > s3_suspend_time)
 			(*suspend_too_long)++;
 	} else
@@ -763,6 +774,8 @@ static int s3_scan_times(
 	if (s3_resume_start > 0.0 && s3_resume_finish > 0.0) {
 		fwts_log_info_verbatim(fw, "  Resume:  %.3f seconds.",
 			s3_resume_finish - s3_resume_start);
+		cycle->phase[FWTS_PM_TIMING_KERNEL_RESUME] =
+			(uint32_t)((s3_resume_finish - s3_resume_start) * 1000000.0);
 		if (s3_resume_finish - s3_resume_start > s3_resume_time)
 			(*resume_too_long)++;
 	} else
@@ -773,7 +786,9 @@ static int s3_scan_times(
 
 static int s3_check_log(
 	fwts_framework *fw,
-	fwts_list *klog,
+	fwts_klog_follower *follower,
+	fwts_pm_timing *timing,
+	fwts_pm_timing_cycle *cycle,
 	int *errors,
 	int *oopses,
 	int *warn_ons,
@@ -783,22 +798,27 @@ static int s3_check_log(
 	int error = 0;
 	int oops;
 	int warn_on;
+	fwts_list *klog;
 
-	if (fwts_klog_pm_check(fw, NULL, klog, &error))
+	if (fwts_klog_follower_pm_check(fw, follower, &error))
 		fwts_log_error(fw, "Error parsing kernel log.");
 	*errors += error;
 
-	if (fwts_klog_firmware_check(fw, NULL, klog, &error))
+	if (fwts_klog_follower_firmware_check(fw, follower, &error))
 		fwts_log_error(fw, "Error parsing kernel log.");
 	*errors += error;
 
+	if ((klog = fwts_klog_follower_list(follower)) == NULL)
+		return FWTS_ERROR;
+
 	if (fwts_oops_check(fw, klog, &oops, &warn_on))
 		fwts_log_error(fw, "Error parsing kernel log.");
 
 	*oopses += oops;
 	*warn_ons += warn_on;
 
-	s3_scan_times(fw, klog, suspend_too_long, resume_too_long);
+	s3_scan_times(fw, klog, timing, cycle, suspend_too_long, resume_too_long);
+	fwts_list_free(klog, NULL);
 
 	return FWTS_OK;
 }
@@ -819,6 +839,9 @@ static int s3_test_multiple(fwts_framework *fw)
 	int delta = (int)(s3_delay_delta * 1000.0);
 	uint64_t total_s2idle_residency = get_total_s2idle_residency(NULL);
 	int pm_debug;
+	int pm_print_times = -1;
+	fwts_klog_follower *follower;
+	fwts_pm_timing *timing;
 
 #if FWTS_ENABLE_LOGIND
 #if !GLIB_CHECK_VERSION(2,35,0)
@@ -829,44 +852,61 @@ static int s3_test_multiple(fwts_framework *fw)
 
 	(void)fwts_pm_debug_get(&pm_debug);
 	(void)fwts_pm_debug_set(1);
+	/* Per-device times add to the suspend/resume times, so are opt-in */
+	if (s3_device_times) {
+		(void)fwts_pm_print_times_get(&pm_print_times);
+		(void)fwts_pm_print_times_set(1);
+	}
 
 	if (s3_multiple == 1)
 		fwts_log_info(fw, "Defaulted to 1 test, use --s3-multiple=N to run more %s cycles\n", sleep_type);
 
+	/* Just the kernel log lines added during each cycle are read */
+	if ((follower = fwts_klog_follower_new()) == NULL)
+		fwts_log_error(fw, "Cannot read kernel log.");
+	if ((timing = fwts_pm_timing_new()) == NULL)
+		fwts_log_error(fw, "Cannot allocate suspend/resume timings.");
+
 	for (i = 0; i < s3_multiple; i++) {
 		struct timeval tv;
 		int ret, percent = (i * 100) / s3_multiple;
-		fwts_list *klog_pre, *klog_post, *klog_diff;
+		fwts_pm_timing_cycle cycle = {
+			.phase = {
+				FWTS_PM_TIMING_UNKNOWN,
+				FWTS_PM_TIMING_UNKNOWN,
+				FWTS_PM_TIMING_UNKNOWN
+			}
+		};
 		fwts_log_info(fw, "%s cycle %d of %d\n", sleep_type, i+1, s3_multiple);
 
-		if ((klog_pre = fwts_klog_read()) == NULL)
-			fwts_log_error(fw, "Cannot read kernel log.");
-
 		ret = s3_do_suspend_resume(fw, &hw_errors, &pm_errors, &hook_errors,
 					   &s2idle_errors, &total_s2idle_residency,
 					   s3_sleep_delay, percent);
 		if (ret == FWTS_OUT_OF_MEMORY) {
 			fwts_log_error(fw, "%s cycle %d failed - out of memory error.", sleep_type, i+1);
-			fwts_klog_free(klog_pre);
 			break;
 		}
-		if (hook_errors > 0) {
-			fwts_klog_free(klog_pre);
+		if (hook_errors > 0)
 			break;
-		}
 
-		if ((klog_post = fwts_klog_read()) == NULL)
-			fwts_log_error(fw, "Cannot re-read kernel log.");
+		if (follower) {
+			if (fwts_klog_follower_read(follower) != FWTS_OK)
+				fwts_log_error(fw, "Cannot re-read kernel log.");
 
-		fwts_progress_message(fw, percent, "(Checking logs for errors)");
-		klog_diff = fwts_klog_find_changes(klog_pre, klog_post);
-		if (klog_diff)
-			s3_check_log(fw, klog_diff, &klog_errors, &klog_oopses, &klog_warn_ons,
+			fwts_progress_message(fw, percent, "(Checking logs for errors)");
+			s3_check_log(fw, follower, timing, &cycle,
+				&klog_errors, &klog_oopses, &klog_warn_ons,
 				&suspend_too_long, &resume_too_long);
+		}
 
-		fwts_klog_free(klog_pre);
-		fwts_klog_free(klog_post);
-		fwts_list_free(klog_diff, NULL);
+		if (timing) {
+			cycle.phase[FWTS_PM_TIMING_FIRMWARE_RESUME] =
+				fwts_pm_timing_firmware_resume(timing);
+			if (!strncmp(sleep_type, "s2idle", strlen("s2idle")))
+				cycle.s2idle_residency = get_last_s2idle_residency();
+			if (fwts_pm_timing_add(timing, &cycle) != FWTS_OK)
+				fwts_log_error(fw, "Cannot save %s cycle timings.", sleep_type);
+		}
 
 		if (!s3_device_check) {
 			char buffer[80];
@@ -889,12 +929,26 @@ static int s3_test_multiple(fwts_framework *fw)
 		}
 	}
 
-	/* Restore pm debug value */
+	/* Restore pm debug values */
 	if (pm_debug != -1)
 		(void)fwts_pm_debug_set(pm_debug);
+	if (pm_print_times != -1)
+		(void)fwts_pm_print_times_set(pm_print_times);
 
 	fwts_log_info(fw, "Completed %s cycle(s)\n", sleep_type);
 
+	if (follower) {
+		fwts_klog_follower_report(fw, follower);
+		fwts_klog_follower_free(follower);
+	}
+
+	if (timing) {
+		fwts_pm_timing_check(fw, timing, s3_timing_drift);
+		if (s3_timing_export)
+			(void)fwts_pm_timing_export(fw, timing, s3_timing_export);
+		fwts_pm_timing_free(timing);
+	}
+
 	if (klog_errors > 0)
 		fwts_log_info(fw, "Found %d errors in kernel log.", klog_errors);
 	else
@@ -992,6 +1046,11 @@ static int s3_options_check(fwts_framework *fw)
 		fprintf(stderr, "--s3-resume-time too small.\n");
 		return FWTS_ERROR;
 	}
+	if ((s3_timing_drift < 0) || (s3_timing_drift > 1000)) {
+		fprintf(stderr, "--s3-timing-drift is %d, it should be 0..1000\n",
+			s3_timing_drift);
+		return FWTS_ERROR;
+	}
 	if (s3_hook) {
 		struct stat statbuf;
 		int ret;
@@ -1067,6 +1126,15 @@ static int s3_options_handler(fwts_framework *fw, int argc, char * const argv[],
 		case 13:
 			s3_wakeup_src = true;
 			break;
+		case 14:
+			s3_timing_export = optarg;
+			break;
+		case 15:
+			s3_timing_drift = atoi(optarg);
+			break;
+		case 16:
+			s3_device_times = true;
+			break;
 		}
 	}
 	return FWTS_OK;
@@ -1087,6 +1155,9 @@ static fwts_option s3_options[] = {
 	{ "s3-resume-hook hook","", 1, "Run a hook script after each S3 resume, 0 exit indicates success." },
 	{ "s3-sleep-type",	"", 1, "Set the sleep type for testing S3 or s2idle." },
 	{ "s3-dump-wakeup-src",	"", 0, "dump the all device wakeup sources suspend/resume.(For debug)"}, 
+	{ "s3-timing-export",	"", 1, "Export the timings of each S3 cycle to a file, JSON if the file name ends in .json, CSV otherwise, e.g. --s3-timing-export=s3.csv" },
+	{ "s3-timing-drift",	"", 1, "Maximum allowed increase in median suspend/resume time from the start to the end of a run in percent, default is 20, e.g. --s3-timing-drift=10" },
+	{ "s3-device-times",	"", 0, "Log the time each device takes to suspend and resume and report the slowest devices to resume. This adds to the measured suspend and resume times." },
 	{ NULL, NULL, 0, NULL }
 };
 
@@ -65,7 +65,7 @@ static int s4_init(fwts_framework *fw)
 	return FWTS_OK;
 }
 
-static void s4_check_log(fwts_framework *fw,
+static void s4_check_log(fwts_framework *fw, fwts_klog_follower *follower,
 	fwts_list *klog, int *errors, int *oopses, int *warn_ons)
 {
 	int error = 0;
@@ -73,11 +73,11 @@ static void s4_check_log(fwts_framework *fw,
 	int warn_on;
 
 	/* Check for kernel errors reported in the log */
-	if (fwts_klog_pm_check(fw, NULL, klog, &error))
+	if (fwts_klog_follower_pm_check(fw, follower, &error))
 		fwts_log_error(fw, "Error parsing kernel log.");
 	*errors += error;
 
-	if (fwts_klog_firmware_check(fw, NULL, klog, &error))
+	if (fwts_klog_follower_firmware_check(fw, follower, &error))
 		fwts_log_error(fw, "Error parsing kernel log.");
 	*errors += error;
 
@@ -166,6 +166,7 @@ static int wrap_pmutils_do_s4(fwts_pm_method_vars *fwts_settings,
 }
 
 static int s4_hibernate(fwts_framework *fw,
+	fwts_klog_follower *follower,
 	int *klog_errors,
 	int *hw_errors,
 	int *pm_errors,
@@ -174,7 +175,7 @@ static int s4_hibernate(fwts_framework *fw,
 	int *failed_alloc_image,
 	int percent)
 {
-	fwts_list *klog_pre, *klog_post, *klog_diff;
+	fwts_list *klog_diff = NULL;
 	fwts_hwinfo hwinfo1, hwinfo2;
 	int status;
 	int duration;
@@ -254,12 +255,9 @@ static int s4_hibernate(fwts_framework *fw,
 	fwts_wakealarm_trigger(fw, s4_sleep_delay);
 
 	/* Do s4 here */
-	if ((klog_pre = fwts_klog_read()) == NULL)
-		fwts_log_error(fw, "S4: hibernate: Cannot read kernel log.");
-
 	status = do_s4(fwts_settings, percent, &duration, command);
 
-	if ((klog_post = fwts_klog_read()) == NULL)
+	if (follower && (fwts_klog_follower_read(follower) != FWTS_OK))
 		fwts_log_error(fw, "S4: hibernate: Cannot re-read kernel log.");
 
 	if (s4_device_check) {
@@ -285,10 +283,12 @@ static int s4_hibernate(fwts_framework *fw,
 		}
 	}
 
-	fwts_progress_message(fw, percent, "(Checking for errors)");
+	if (follower) {
+		fwts_progress_message(fw, percent, "(Checking for errors)");
 
-	klog_diff = fwts_klog_find_changes(klog_pre, klog_post);
-	s4_check_log(fw, klog_diff, klog_errors, klog_oopses, klog_warn_ons);
+		klog_diff = fwts_klog_follower_list(follower);
+		s4_check_log(fw, follower, klog_diff, klog_errors, klog_oopses, klog_warn_ons);
+	}
 
 	fwts_progress_message(fw, percent, "(Checking for PM errors)");
 
@@ -310,40 +310,41 @@ static int s4_hibernate(fwts_framework *fw,
 		(*pm_errors)++;
 	}
 
-	if (fwts_klog_regex_find(fw, klog_diff, "Freezing user space processes.*done") < 1) {
-		fwts_failed(fw, LOG_LEVEL_HIGH, "UserSpaceTaskFreeze",
-			"Failed to freeze user space processes.");
-		(*pm_errors)++;
-	}
+	/* The hibernate steps can only be checked with the kernel log */
+	if (klog_diff) {
+		if (fwts_klog_regex_find(fw, klog_diff, "Freezing user space processes.*done") < 1) {
+			fwts_failed(fw, LOG_LEVEL_HIGH, "UserSpaceTaskFreeze",
+				"Failed to freeze user space processes.");
+			(*pm_errors)++;
+		}
 
-	if (fwts_klog_regex_find(fw, klog_diff, "Freezing remaining freezable tasks.*done") < 1) {
-		fwts_failed(fw, LOG_LEVEL_HIGH, "KernelTaskFreeze",
-			"Failed to freeze remaining non-user space processes.");
-		(*pm_errors)++;
-	}
+		if (fwts_klog_regex_find(fw, klog_diff, "Freezing remaining freezable tasks.*done") < 1) {
+			fwts_failed(fw, LOG_LEVEL_HIGH, "KernelTaskFreeze",
+				"Failed to freeze remaining non-user space processes.");
+			(*pm_errors)++;
+		}
 
-	if ((fwts_klog_regex_find(fw, klog_diff, "PM: freeze of devices complete") < 1) &&
-	    (fwts_klog_regex_find(fw, klog_diff, "PM: late freeze of devices complete") < 1)) {
-		fwts_failed(fw, LOG_LEVEL_HIGH, "DeviceFreeze",
-			"Failed to freeze devices.");
-		(*pm_errors)++;
-	}
+		if ((fwts_klog_regex_find(fw, klog_diff, "PM: freeze of devices complete") < 1) &&
+		    (fwts_klog_regex_find(fw, klog_diff, "PM: late freeze of devices complete") < 1)) {
+			fwts_failed(fw, LOG_LEVEL_HIGH, "DeviceFreeze",
+				"Failed to freeze devices.");
+			(*pm_errors)++;
+		}
 
-	if (fwts_klog_regex_find(fw, klog_diff, "PM: Allocated.*kbytes") < 1) {
-		fwts_failed(fw, LOG_LEVEL_HIGH, "HibernateImageAlloc",
-			"Failed to allocate memory for hibernate image.");
-		*failed_alloc_image = 1;
-		(*pm_errors)++;
-	}
+		if (fwts_klog_regex_find(fw, klog_diff, "PM: Allocated.*kbytes") < 1) {
+			fwts_failed(fw, LOG_LEVEL_HIGH, "HibernateImageAlloc",
+				"Failed to allocate memory for hibernate image.");
+			*failed_alloc_image = 1;
+			(*pm_errors)++;
+		}
 
-	if (fwts_klog_regex_find(fw, klog_diff, "PM: Image restored successfully") < 1) {
-		fwts_failed(fw, LOG_LEVEL_HIGH, "HibernateImageRestore",
-			"Failed to restore hibernate image.");
-		(*pm_errors)++;
+		if (fwts_klog_regex_find(fw, klog_diff, "PM: Image restored successfully") < 1) {
+			fwts_failed(fw, LOG_LEVEL_HIGH, "HibernateImageRestore",
+				"Failed to restore hibernate image.");
+			(*pm_errors)++;
+		}
 	}
 
-	fwts_klog_free(klog_pre);
-	fwts_klog_free(klog_post);
 	fwts_list_free(klog_diff, NULL);
 tidy:
 	free(command);
@@ -367,6 +368,7 @@ static int s4_test_multiple(fwts_framework *fw)
 	int ret = FWTS_OK;
 	int pm_debug;
 	bool retried = false;
+	fwts_klog_follower *follower;
 
 #if FWTS_ENABLE_LOGIND
 #if !GLIB_CHECK_VERSION(2,35,0)
@@ -381,6 +383,11 @@ static int s4_test_multiple(fwts_framework *fw)
         if (s4_multiple == 1)
                 fwts_log_info(fw, "Defaulted to run 1 test, run --s4-multiple=N to run more S4 cycles\n");
 
+	/* Just the kernel log lines added during each cycle are read */
+	if ((follower = fwts_klog_follower_new()) == NULL)
+		fwts_log_warning(fw, "S4: hibernate: Cannot read kernel log, "
+			"kernel log checks will be skipped.");
+
 	for (i = 0; i < s4_multiple; i++) {
 		struct timeval tv;
 		int failed_alloc_image = 0;
@@ -388,11 +395,14 @@ static int s4_test_multiple(fwts_framework *fw)
 
 		fwts_log_info(fw, "S4 cycle %d of %d\n",i+1,s4_multiple);
 
-		if (s4_hibernate(fw,
+		if (s4_hibernate(fw, follower,
 			&klog_errors, &hw_errors, &pm_errors,
 			&klog_oopses, &klog_warn_ons,
 			&failed_alloc_image, percent) != FWTS_OK) {
 			fwts_log_error(fw, "Aborting S4 multiple tests.");
+			fwts_klog_follower_free(follower);
+			if (pm_debug != -1)
+				(void)fwts_pm_debug_set(pm_debug);
 			return FWTS_ERROR;
 		}
 
@@ -416,7 +426,7 @@ static int s4_test_multiple(fwts_framework *fw)
 					(void)fwts_set("1", FWTS_TRACING_BUFFER_SIZE);
 					failed_alloc_image = 0;
 
-					if (s4_hibernate(fw,
+					if (s4_hibernate(fw, follower,
 						&klog_errors, &hw_errors, &pm_errors,
 						&klog_oopses, &klog_warn_ons,
 						&failed_alloc_image, percent) != FWTS_OK) {
@@ -466,6 +476,11 @@ static int s4_test_multiple(fwts_framework *fw)
 		(void)fwts_set(tmp, FWTS_TRACING_BUFFER_SIZE);
 	}
 
+	if (follower) {
+		fwts_klog_follower_report(fw, follower);
+		fwts_klog_follower_free(follower);
+	}
+
 	if (klog_errors > 0)
 		fwts_log_info(fw, "Found %d errors in kernel log.", klog_errors);
 	else
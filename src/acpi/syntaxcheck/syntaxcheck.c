@@ -483,29 +483,29 @@ static void syntaxcheck_give_advice(fwts_framework *fw, uint32_t error_code)
 
 /*
  *  syntaxcheck_single_table()
- *	disassemble and reassemble a table, check for errors. which indicates the Nth
- *	table
+ *	check a disassembled and reassembled table for errors, data counts
+ *	the tables checked so far so the Nth table can be reported
  */
-static int syntaxcheck_single_table(
+static void syntaxcheck_single_table(
 	fwts_framework *fw,
 	const fwts_acpi_table_info *info,
-	const int n)
+	const int ret,
+	fwts_list *iasl_disassembly,
+	fwts_list *iasl_stdout,
+	fwts_list *iasl_stderr,
+	void *data)
 {
 	fwts_list_link *item;
 	int errors = 0;
 	int warnings = 0;
 	int remarks = 0;
-	fwts_list *iasl_stdout = NULL,
-		  *iasl_stderr = NULL,
-		  *iasl_disassembly = NULL;
-
-	if (fwts_iasl_reassemble(fw, info,
-		&iasl_disassembly, &iasl_stdout, &iasl_stderr) != FWTS_OK) {
-		fwts_text_list_free(iasl_disassembly);
-		fwts_text_list_free(iasl_stderr);
-		fwts_text_list_free(iasl_stdout);
+	const int n = (*(int *)data)++;
+
+	FWTS_UNUSED(iasl_stdout);
+
+	if (ret != FWTS_OK) {
 		fwts_aborted(fw, "Cannot re-assasemble with iasl.");
-		return FWTS_ERROR;
+		return;
 	}
 
 	fwts_log_nl(fw);
@@ -626,10 +626,6 @@ static int syntaxcheck_single_table(
 		}
 	}
 
-	fwts_text_list_free(iasl_disassembly);
-	fwts_text_list_free(iasl_stdout);
-	fwts_text_list_free(iasl_stderr);
-
 	if (errors + warnings + remarks > 0)
 		fwts_log_info(fw, "Table %s (%d) reassembly: Found %d errors, %d warnings, %d remarks.",
 			info->name, n, errors, warnings, remarks);
@@ -637,24 +633,14 @@ static int syntaxcheck_single_table(
 		fwts_passed(fw, "%s (%d) reassembly, Found 0 errors, 0 warnings, 0 remarks.", info->name, n);
 
 	fwts_log_nl(fw);
-
-	return FWTS_OK;
 }
 
 static int syntaxcheck_tables(fwts_framework *fw)
 {
-	int i, n;
+	int n = 0;
 
-	for (i = 0, n = 0; i < ACPI_MAX_TABLES; i++) {
-		fwts_acpi_table_info *info;
-
-		if (fwts_acpi_get_table(fw, i, &info) != FWTS_OK)
-			break;
-		if (info && info->has_aml)
-			syntaxcheck_single_table(fw, info, n++);
-	}
-
-	return FWTS_OK;
+	/* Tables are reassembled in parallel, results come back in order */
+	return fwts_iasl_reassemble_all(fw, syntaxcheck_single_table, &n);
 }
 
 static fwts_framework_minor_test syntaxcheck_tests[] = {
@@ -669,6 +655,6 @@ static fwts_framework_ops syntaxcheck_ops = {
 	.minor_tests = syntaxcheck_tests
 };
 
-FWTS_REGISTER("syntaxcheck", &syntaxcheck_ops, FWTS_TEST_ANYTIME, FWTS_FLAG_BATCH_EXPERIMENTAL)
+FWTS_REGISTER("syntaxcheck", &syntaxcheck_ops, FWTS_TEST_ANYTIME, FWTS_FLAG_BATCH_EXPERIMENTAL | FWTS_FLAG_OFFLINE)
 
 #endif
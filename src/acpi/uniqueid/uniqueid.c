@@ -64,9 +64,8 @@ static int uniqueid_evaluate_method(fwts_framework *fw,
 	void *private)
 {
 	fwts_list *methods;
-	const size_t name_len = strlen(name);
 
-	if ((methods = fwts_acpi_object_get_names()) != NULL) {
+	if ((methods = fwts_acpi_object_find_all(name)) != NULL) {
 		fwts_list_link	*item;
 
 		fwts_list_foreach(item, methods) {
@@ -74,31 +73,28 @@ static int uniqueid_evaluate_method(fwts_framework *fw,
 			ACPI_HANDLE method_handle;
 			ACPI_OBJECT_TYPE type;
 			ACPI_STATUS status;
+			ACPI_OBJECT_LIST  arg_list;
 
-			size_t len = strlen(method_name);
-			if (strncmp(name, method_name + len - name_len, name_len) == 0) {
-				ACPI_OBJECT_LIST  arg_list;
-
-				status = AcpiGetHandle (NULL, method_name, &method_handle);
-				if (ACPI_FAILURE(status)) {
-					fwts_warning(fw, "Failed to get handle for object %s.", name);
-					continue;
-				}
-				status = AcpiGetType(method_handle, &type);
-				if (ACPI_FAILURE(status)) {
-					fwts_warning(fw, "Failed to get object type for %s.",name);
-					continue;
-				}
+			status = AcpiGetHandle (NULL, method_name, &method_handle);
+			if (ACPI_FAILURE(status)) {
+				fwts_warning(fw, "Failed to get handle for object %s.", name);
+				continue;
+			}
+			status = AcpiGetType(method_handle, &type);
+			if (ACPI_FAILURE(status)) {
+				fwts_warning(fw, "Failed to get object type for %s.",name);
+				continue;
+			}
 
-				if (type == ACPI_TYPE_LOCAL_SCOPE)
-					continue;
+			if (type == ACPI_TYPE_LOCAL_SCOPE)
+				continue;
 
-				arg_list.Count   = num_args;
-				arg_list.Pointer = args;
-				method_evaluate_found_method(fw, method_name,
-					check_func, private, &arg_list);
-			}
+			arg_list.Count   = num_args;
+			arg_list.Pointer = args;
+			method_evaluate_found_method(fw, method_name,
+				check_func, private, &arg_list);
 		}
+		fwts_list_free(methods, NULL);
 	}
 
 	return FWTS_OK;
@@ -263,6 +259,6 @@ static fwts_framework_ops uniqueid_ops = {
 	.minor_tests = uniqueid_tests
 };
 
-FWTS_REGISTER("uniqueid", &uniqueid_ops, FWTS_TEST_ANYTIME, FWTS_FLAG_BATCH)
+FWTS_REGISTER("uniqueid", &uniqueid_ops, FWTS_TEST_ANYTIME, FWTS_FLAG_BATCH | FWTS_FLAG_ACPI_NAMESPACE)
 
 #endif
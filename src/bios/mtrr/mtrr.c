@@ -283,27 +283,23 @@ static int check_prefetchable(
 	const uint64_t address,
 	bool *pref)
 {
-	char path[PATH_MAX];
-	uint8_t config[64];
-	int fd, i, n, bars;
-	uint32_t *bar;
+	fwts_pci_device *pci_device;
+	uint32_t bar[7];	/* 64 bit BAR5 reads one word beyond */
+	int i, bars;
 
 	*pref = false;
-	snprintf(path, sizeof(path), FWTS_PCI_DEV_PATH "/%s/config", device);
-	if ((fd = open(path, O_RDONLY)) < 0) {
+	pci_device = fwts_pci_topology_find_name(fwts_pci_topology_get(fw), device);
+	if (pci_device == NULL) {
 		fwts_log_error(fw, "Cannot read PCI config for device %s\n", device);
 		return FWTS_ERROR;
 	}
 
-	n = read(fd, config, sizeof(config));
-	(void)close(fd);
-
 	/* config space too small? ignore for now */
-	if (n < 64)
+	if (pci_device->config_len < 64)
 		return FWTS_OK;
 
-	/* Type, mask off top bit so we can cater for multi-function devices */
-	switch (config[FWTS_PCI_CONFIG_HEADER_TYPE] & 0x7f) {
+	/* Type, multi-function bit is already masked off */
+	switch (pci_device->header_type) {
 	case FWTS_PCI_CONFIG_HEADER_TYPE_NON_BRIDGE:
 		bars = 6;
 		break;
@@ -319,7 +315,7 @@ static int check_prefetchable(
 	 *  Check BAR addresses, do they match and are they prefetchable
 	 *  See http://wiki.osdev.org/PCI
 	 */
-	bar = (uint32_t*)&config[0x10];
+	memcpy(bar, &pci_device->config[FWTS_PCI_CONFIG_TYPE0_BAR0], sizeof(bar));
 	for (i = 0; i < bars; i++) {
 		if ((bar[i] & 1) == 0) {
 			uint64_t bar_addr;
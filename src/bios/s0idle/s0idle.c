@@ -72,5 +72,5 @@ static fwts_framework_ops s0idle = {
 	.minor_tests = s0idle_tests
 };
 
-FWTS_REGISTER("s0idle", &s0idle, FWTS_TEST_ANYTIME, FWTS_FLAG_UTILS)
+FWTS_REGISTER("s0idle", &s0idle, FWTS_TEST_ANYTIME, FWTS_FLAG_UTILS | FWTS_FLAG_OFFLINE)
 #endif
@@ -24,9 +24,6 @@
 #include <stdio.h>
 #include <fcntl.h>
 
-#define FWTS_INTEL_HOST_PATH	"/sys/bus/pci/devices/0000:00:00.0/config"
-#define FWTS_INTEL_IGD_PATH	"/sys/bus/pci/devices/0000:00:02.0"
-
 #define FWTS_GGC		0x50
 #define FWTS_TSEGMB		0xB8
 #define FWTS_TOLUD		0xBC
@@ -34,24 +31,15 @@
 
 static bool smm_has_intel_igd(fwts_framework *fw)
 {
-	char path[256];
-	char *class_code_str;
-
-	FWTS_UNUSED(fw);
+	fwts_pci_device *igd;
 
-	snprintf(path, sizeof(path), "%s/class", FWTS_INTEL_IGD_PATH);
-	class_code_str = fwts_get(path);
-	if (class_code_str == NULL)
+	/* Integrated graphics device is at 0000:00:02.0 */
+	igd = fwts_pci_topology_find(fwts_pci_topology_get(fw), 0, 0, 2, 0);
+	if ((igd == NULL) || (igd->config_len < 64))
 		return false;
 
 	/* Display controller class code starts with 0x03 */
-	if (strncmp(class_code_str, "0x03", 4) == 0) {
-		free(class_code_str);
-		return true;
-	}
-
-	free(class_code_str);
-	return false;
+	return igd->config[FWTS_PCI_CONFIG_CLASS_CODE] == FWTS_PCI_CLASS_CODE_DISPLAY_CONTROLLER;
 }
 
 static int smm_init(fwts_framework *fw)
@@ -79,20 +67,21 @@ static int smm_deinit(fwts_framework *fw)
 
 static int smm_test0(fwts_framework *fw)
 {
-	uint8_t config[256];
+	fwts_pci_device *host;
+	const uint8_t *config;
 	bool passed = true;
-	int fd;
 
-	if ((fd = open(FWTS_INTEL_HOST_PATH, O_RDONLY)) < 0) {
-		fwts_log_warning(fw, "Could not open PCI HOST bridge config data\n");
+	/* PCI HOST bridge is at 0000:00:00.0 */
+	host = fwts_pci_topology_find(fwts_pci_topology_get(fw), 0, 0, 0, 0);
+	if (host == NULL) {
+		fwts_log_warning(fw, "Could not read PCI HOST bridge config data\n");
 		return FWTS_ERROR;
 	}
-	if (read(fd, config, sizeof(config)) < 0) {
-		fwts_log_warning(fw, "Could not read PCI HOST bridge config data\n");
-		(void)close(fd);
+	if (host->config_len <= FWTS_TOLUD) {
+		fwts_log_warning(fw, "Could not read all PCI HOST bridge config data\n");
 		return FWTS_ERROR;
 	}
-	(void)close(fd);
+	config = host->config;
 
 	if (!smm_has_intel_igd(fw)) {
 		fwts_log_info(fw, "Intel integrated graphics device not found, "
@@ -29,9 +29,7 @@
 #include <stdbool.h>
 #include <unistd.h>
 #include <sys/types.h>
-#include <sys/stat.h>
 #include <limits.h>
-#include <dirent.h>
 #include <stdint.h>
 #include <stdbool.h>
 #include <sched.h>
@@ -39,6 +37,7 @@
 #include <math.h>
 #include <ctype.h>
 #include <inttypes.h>
+#include <pthread.h>
 
 #define FWTS_CPU_PATH	"/sys/devices/system/cpu"
 
@@ -54,6 +53,7 @@ struct cpu {
 	char		sysfs_path[2048];	/* 2K is plenty */
 	bool		online;
 	bool		master;
+	int		package;		/* physical package (socket) id */
 
 	int		n_freqs;
 	fwts_cpu_freq	freqs[MAX_FREQS];
@@ -66,6 +66,8 @@ struct cpu {
 static struct cpu *cpus;
 static int num_cpus;
 static bool cpufreq_settable = true;
+static bool cpufreq_parallel;
+static int cpufreq_package_jobs;	/* 0 is no per-package limit */
 
 #define GET_PERFORMANCE_MAX (0)
 #define GET_PERFORMANCE_MIN (1)
@@ -113,8 +115,12 @@ out:
 	return rc;
 }
 
-static int cpu_set_frequency(
-	fwts_framework *fw,
+/*
+ *  cpu_set_frequency_quiet()
+ *	set the CPU frequency and check it was set, without
+ *	logging so it can be used by sweep workers
+ */
+static int cpu_set_frequency_quiet(
 	const struct cpu *cpu,
 	const uint64_t freq_hz)
 {
@@ -124,19 +130,31 @@ static int cpu_set_frequency(
 
 	cpu_mkpath(path, sizeof(path), cpu, "scaling_setspeed");
 	snprintf(buffer, sizeof(buffer), "%" PRIu64 , freq_hz);
-	rc = fwts_set(path, buffer);
-	if (rc != FWTS_OK)
-		goto out;
+	if (fwts_set(path, buffer) != FWTS_OK)
+		return FWTS_ERROR;
 
 	tmp = fwts_get(path);
 	rc = tmp && !strncmp(tmp, buffer, strlen(buffer))
 		? FWTS_OK : FWTS_ERROR;
 	free(tmp);
 
-out:
-	if (rc != FWTS_OK)
-		fwts_warning(fw, "Cannot set CPU %d frequency to %s when setting %s.",
-			cpu->idx, buffer, path);
+	return rc;
+}
+
+static int cpu_set_frequency(
+	fwts_framework *fw,
+	const struct cpu *cpu,
+	const uint64_t freq_hz)
+{
+	char path[PATH_MAX];
+	int rc;
+
+	rc = cpu_set_frequency_quiet(cpu, freq_hz);
+	if (rc != FWTS_OK) {
+		cpu_mkpath(path, sizeof(path), cpu, "scaling_setspeed");
+		fwts_warning(fw, "Cannot set CPU %d frequency to %" PRIu64 " when setting %s.",
+			cpu->idx, freq_hz, path);
+	}
 	return rc;
 }
 
@@ -284,11 +302,14 @@ static uint64_t get_bios_limit(struct cpu *cpu)
 	return value;
 }
 
-static int test_one_cpu_performance(
+/*
+ *  cpu_performance_report()
+ *	log the scaling table of the benchmarks in cpu->freqs[] and
+ *	check performance increases with frequency
+ */
+static int cpu_performance_report(
 	fwts_framework *fw,
-	struct cpu *cpu,
-	const int cpu_idx,
-	const int n_online_cpus)
+	struct cpu *cpu)
 {
 	uint64_t cpu_top_perf = 1;
 	int i;
@@ -296,20 +317,9 @@ static int test_one_cpu_performance(
 	for (i = 0; i < cpu->n_freqs; i++) {
 		uint64_t perf;
 
-		cpu_set_frequency(fw, cpu, cpu->freqs[i].Hz);
-
-		if (fwts_cpu_benchmark(fw, cpu->idx, &cpu->freqs[i].perf)
-				!= FWTS_OK) {
-			fwts_log_error(fw, "Failed to get CPU performance for "
-				"CPU frequency %" PRId64 " Hz.",
-				cpu->freqs[i].Hz);
-		}
 		perf = fwts_cpu_benchmark_best_result(&cpu->freqs[i].perf);
 		if (perf > cpu_top_perf)
 			cpu_top_perf = perf;
-
-		fwts_progress(fw, (100 * ((cpu_idx * cpu->n_freqs) + i)) /
-				(n_online_cpus * cpu->n_freqs));
 	}
 
 	fwts_log_info(fw, "CPU %d: %i CPU frequency steps supported.",
@@ -363,6 +373,190 @@ static int test_one_cpu_performance(
 	return FWTS_OK;
 }
 
+static int test_one_cpu_performance(
+	fwts_framework *fw,
+	struct cpu *cpu,
+	const int cpu_idx,
+	const int n_online_cpus)
+{
+	int i;
+
+	for (i = 0; i < cpu->n_freqs; i++) {
+		cpu_set_frequency(fw, cpu, cpu->freqs[i].Hz);
+
+		if (fwts_cpu_benchmark(fw, cpu->idx, &cpu->freqs[i].perf)
+				!= FWTS_OK) {
+			fwts_log_error(fw, "Failed to get CPU performance for "
+				"CPU frequency %" PRId64 " Hz.",
+				cpu->freqs[i].Hz);
+		}
+
+		fwts_progress(fw, (100 * ((cpu_idx * cpu->n_freqs) + i)) /
+				(n_online_cpus * cpu->n_freqs));
+	}
+
+	return cpu_performance_report(fw, cpu);
+}
+
+/*
+ *  Parallel sweep, one thread per frequency domain. Workers only
+ *  record what failed, all logging is done by the main thread.
+ */
+typedef struct {
+	pthread_mutex_t	lock;
+	pthread_cond_t	cond;
+	int		*package_busy;	/* domains being swept, per package */
+	int		n_packages;
+	int		steps;		/* frequencies benchmarked so far */
+	int		running;	/* workers yet to finish */
+} cpufreq_sweep;
+
+typedef struct {
+	cpufreq_sweep	*sweep;
+	struct cpu	*cpu;
+	pthread_t	thread;
+	bool		started;
+	bool		set_failed[MAX_FREQS];
+	bool		bench_failed[MAX_FREQS];
+} cpufreq_sweep_job;
+
+/*
+ *  cpufreq_sweep_run()
+ *	benchmark every frequency of one domain, waiting for a free
+ *	slot on the package first if the packages are capped
+ */
+static void *cpufreq_sweep_run(void *arg)
+{
+	cpufreq_sweep_job *job = (cpufreq_sweep_job *)arg;
+	cpufreq_sweep *sweep = job->sweep;
+	struct cpu *cpu = job->cpu;
+	int i, *busy = NULL;
+
+	if (sweep->package_busy) {
+		busy = &sweep->package_busy[cpu->package];
+		pthread_mutex_lock(&sweep->lock);
+		while (*busy >= cpufreq_package_jobs)
+			pthread_cond_wait(&sweep->cond, &sweep->lock);
+		(*busy)++;
+		pthread_mutex_unlock(&sweep->lock);
+	}
+
+	for (i = 0; i < cpu->n_freqs; i++) {
+		job->set_failed[i] =
+			(cpu_set_frequency_quiet(cpu, cpu->freqs[i].Hz) != FWTS_OK);
+		job->bench_failed[i] =
+			(fwts_cpu_benchmark_thread(cpu->idx,
+				FWTS_CPU_BENCHMARK_TOLERANCE, &cpu->freqs[i].perf) != FWTS_OK);
+
+		pthread_mutex_lock(&sweep->lock);
+		sweep->steps++;
+		pthread_cond_broadcast(&sweep->cond);
+		pthread_mutex_unlock(&sweep->lock);
+	}
+
+	pthread_mutex_lock(&sweep->lock);
+	if (busy)
+		(*busy)--;
+	sweep->running--;
+	pthread_cond_broadcast(&sweep->cond);
+	pthread_mutex_unlock(&sweep->lock);
+
+	return NULL;
+}
+
+/*
+ *  cpufreq_sweep_all()
+ *	benchmark all the master CPUs at the same time, filling in
+ *	cpu->freqs[] just as test_one_cpu_performance() does
+ */
+static int cpufreq_sweep_all(
+	fwts_framework *fw,
+	const int n_master_cpus)
+{
+	cpufreq_sweep sweep;
+	cpufreq_sweep_job *jobs;
+	int i, j, n, total = 0;
+
+	if ((jobs = calloc(n_master_cpus, sizeof(*jobs))) == NULL) {
+		fwts_log_error(fw, "Cannot allocate parallel sweep jobs.");
+		return FWTS_ERROR;
+	}
+
+	memset(&sweep, 0, sizeof(sweep));
+	pthread_mutex_init(&sweep.lock, NULL);
+	pthread_cond_init(&sweep.cond, NULL);
+
+	for (i = 0, n = 0; i < num_cpus; i++) {
+		if (!(cpus[i].online && cpus[i].master))
+			continue;
+		jobs[n].sweep = &sweep;
+		jobs[n].cpu = &cpus[i];
+		total += cpus[i].n_freqs;
+		if (cpus[i].package >= sweep.n_packages)
+			sweep.n_packages = cpus[i].package + 1;
+		n++;
+	}
+
+	if (cpufreq_package_jobs > 0) {
+		sweep.package_busy = calloc(sweep.n_packages,
+			sizeof(*sweep.package_busy));
+		if (!sweep.package_busy) {
+			fwts_log_error(fw, "Cannot allocate parallel sweep "
+				"package limits.");
+			pthread_cond_destroy(&sweep.cond);
+			pthread_mutex_destroy(&sweep.lock);
+			free(jobs);
+			return FWTS_ERROR;
+		}
+	}
+
+	for (i = 0; i < n; i++) {
+		pthread_mutex_lock(&sweep.lock);
+		sweep.running++;
+		pthread_mutex_unlock(&sweep.lock);
+		jobs[i].started = (pthread_create(&jobs[i].thread, NULL,
+			cpufreq_sweep_run, &jobs[i]) == 0);
+		/* No thread, sweep this domain here instead */
+		if (!jobs[i].started)
+			(void)cpufreq_sweep_run(&jobs[i]);
+	}
+
+	/* Report progress as the workers get through the frequencies */
+	pthread_mutex_lock(&sweep.lock);
+	while (sweep.running > 0) {
+		pthread_cond_wait(&sweep.cond, &sweep.lock);
+		if (total)
+			fwts_progress(fw, (100 * sweep.steps) / total);
+	}
+	pthread_mutex_unlock(&sweep.lock);
+
+	for (i = 0; i < n; i++) {
+		if (jobs[i].started)
+			(void)pthread_join(jobs[i].thread, NULL);
+	}
+
+	for (i = 0; i < n; i++) {
+		const struct cpu *cpu = jobs[i].cpu;
+
+		for (j = 0; j < cpu->n_freqs; j++) {
+			if (jobs[i].set_failed[j])
+				fwts_warning(fw, "Cannot set CPU %d frequency "
+					"to %" PRIu64 ".", cpu->idx, cpu->freqs[j].Hz);
+			if (jobs[i].bench_failed[j])
+				fwts_log_error(fw, "Failed to get CPU performance "
+					"for CPU %d frequency %" PRId64 " Hz.",
+					cpu->idx, cpu->freqs[j].Hz);
+		}
+	}
+
+	free(sweep.package_busy);
+	pthread_cond_destroy(&sweep.cond);
+	pthread_mutex_destroy(&sweep.lock);
+	free(jobs);
+
+	return FWTS_OK;
+}
+
 static int cpufreq_test_cpu_performance(fwts_framework *fw)
 {
 	int n_master_cpus, i, c, rc;
@@ -384,6 +578,24 @@ static int cpufreq_test_cpu_performance(fwts_framework *fw)
 			cpufreq_settable = false;
 	}
 
+	/* benchmark all the domains at once, then check each one */
+	if (cpufreq_parallel && (n_master_cpus > 1)) {
+		if (cpufreq_sweep_all(fw, n_master_cpus) != FWTS_OK)
+			return FWTS_ERROR;
+
+		for (i = 0; i < num_cpus; i++) {
+			if (!(cpus[i].online && cpus[i].master))
+				continue;
+
+			rc = cpu_performance_report(fw, &cpus[i]);
+			if (rc != FWTS_OK)
+				ok = false;
+
+			cpu_set_lowest_frequency(fw, &cpus[i]);
+		}
+		goto done;
+	}
+
 	/* then do the benchmark */
 	for (i = 0, c = 0; i < num_cpus; i++) {
 		if (!(cpus[i].online && cpus[i].master))
@@ -396,6 +608,8 @@ static int cpufreq_test_cpu_performance(fwts_framework *fw)
 		cpu_set_lowest_frequency(fw, &cpus[i]);
 	}
 
+done:
+
 	if (ok)
 		fwts_passed(fw, "CPU performance scaling OK");
 	else
@@ -762,27 +976,26 @@ static int cpu_freq_compare(const void *v1, const void *v2)
 static int parse_cpu_info(
 	fwts_framework *fw,
 	struct cpu *cpu,
-	const struct dirent *dir)
+	const fwts_cpu_topology_cpu *topology_cpu)
 {
-	char *end, path[PATH_MAX+1], *str, *tmp;
-	struct stat statbuf;
-	int rc, i = 0;
+	char path[PATH_MAX+1], *str, *tmp;
+	int i = 0;
 
-	strcpy(cpu->sysfs_path, dir->d_name);
-	cpu->idx = strtoul(cpu->sysfs_path + strlen("cpu"), &end, 10);
+	snprintf(cpu->sysfs_path, sizeof(cpu->sysfs_path), "cpu%d", topology_cpu->cpu);
+	cpu->idx = topology_cpu->cpu;
 	cpu->online = true;
 
-	/* check if this is the master of a group of CPUs; we only
-	 * need to do perf checks on those that are the master */
-	cpu_mkpath(path, sizeof(path), cpu, NULL);
-	rc = lstat(path, &statbuf);
-	if (rc) {
+	/* CPUs without a cpufreq policy have no cpufreq info */
+	if (topology_cpu->policy == FWTS_CPU_TOPOLOGY_NONE) {
 		fwts_log_warning(fw, "Can't access cpufreq info for CPU %d", cpu->idx);
 		return FWTS_ERROR;
 	}
 
-	/* non-master CPUs will have a link, not a dir */
-	cpu->master = S_ISDIR(statbuf.st_mode);
+	/* we only need to do perf checks on the master of each policy */
+	cpu->master = topology_cpu->policy_master;
+
+	/* package is used to limit the parallel sweep per socket */
+	cpu->package = topology_cpu->package < 0 ? 0 : topology_cpu->package;
 
 	cpu_mkpath(path, sizeof(path), cpu, "scaling_governor");
 	cpu->orig_governor = fwts_get(path);
@@ -838,25 +1051,36 @@ static int parse_cpu_info(
 	return FWTS_OK;
 }
 
-static int is_cpu_dir(const struct dirent *dir)
-{
-	return strncmp(dir->d_name, "cpu", 3) == 0 &&
-		isdigit(dir->d_name[3]);
-}
-
 static int cpufreq_init(fwts_framework *fw)
 {
-	struct dirent **dirs;
+	const fwts_cpu_topology *topology;
 	int i;
 
-	num_cpus = scandir(FWTS_CPU_PATH, &dirs, is_cpu_dir, versionsort);
-	cpus = calloc(num_cpus, sizeof(*cpus));
+	num_cpus = 0;
+	if ((topology = fwts_cpu_topology_get()) == NULL) {
+		fwts_log_error(fw, "Cannot get the CPU topology.");
+		cpufreq_settable = false;
+		return FWTS_ERROR;
+	}
+	cpus = NULL;
+	if (topology->n_cpus &&
+	    ((cpus = calloc(topology->n_cpus, sizeof(*cpus))) == NULL)) {
+		fwts_log_error(fw, "Cannot allocate CPU data.");
+		cpufreq_settable = false;
+		return FWTS_ERROR;
+	}
 
 	/* all test require a userspace governor */
-	for (i = 0; i < num_cpus; i++) {
+	for (i = 0; i < topology->len; i++) {
+		struct cpu *cpu;
 		int rc;
 
-		rc = parse_cpu_info(fw, &cpus[i], dirs[i]);
+		/* CPUs in sysfs, in CPU number order */
+		if (!topology->cpus[i].sysfs)
+			continue;
+		cpu = &cpus[num_cpus++];
+
+		rc = parse_cpu_info(fw, cpu, &topology->cpus[i]);
 		if (rc != FWTS_OK) {
 			fwts_log_warning(fw,
 				"Failed to parse cpufreq for CPU %d", i);
@@ -864,7 +1088,7 @@ static int cpufreq_init(fwts_framework *fw)
 			return FWTS_ERROR;
 		}
 
-		rc = cpu_set_governor(fw, &cpus[i], "userspace");
+		rc = cpu_set_governor(fw, cpu, "userspace");
 		if (rc != FWTS_OK) {
 			fwts_log_info(fw, "Cannot initialize cpufreq "
 					"to set CPU speed for CPU %d", i);
@@ -907,11 +1131,57 @@ static fwts_framework_minor_test cpufreq_tests[] = {
 	{ NULL, NULL }
 };
 
+static int cpufreq_options_check(fwts_framework *fw)
+{
+	FWTS_UNUSED(fw);
+
+	if (cpufreq_package_jobs < 0) {
+		fprintf(stderr, "--cpufreq-package-jobs is %d, it should be "
+			"0 (no limit) or more\n", cpufreq_package_jobs);
+		return FWTS_ERROR;
+	}
+	return FWTS_OK;
+}
+
+static int cpufreq_options_handler(
+	fwts_framework *fw,
+	int argc,
+	char * const argv[],
+	int option_char,
+	int long_index)
+{
+	FWTS_UNUSED(fw);
+	FWTS_UNUSED(argc);
+	FWTS_UNUSED(argv);
+
+	if (option_char == 0) {
+		switch (long_index) {
+		case 0:	/* --cpufreq-parallel */
+			cpufreq_parallel = true;
+			break;
+		case 1:	/* --cpufreq-package-jobs */
+			cpufreq_parallel = true;
+			cpufreq_package_jobs = atoi(optarg);
+			break;
+		}
+	}
+	return FWTS_OK;
+}
+
+static fwts_option cpufreq_options[] = {
+	{ "cpufreq-parallel",	  "", 0, "Benchmark all CPU frequency domains at the same time in the performance test." },
+	{ "cpufreq-package-jobs", "", 1, "Limit --cpufreq-parallel to N frequency domains per CPU package at a time." },
+	{ NULL, NULL, 0, NULL }
+};
+
 static fwts_framework_ops cpufreq_ops = {
-	.init        = cpufreq_init,
-	.deinit      = cpufreq_deinit,
-	.description = "CPU frequency scaling tests.",
-	.minor_tests = cpufreq_tests
+	.init            = cpufreq_init,
+	.deinit          = cpufreq_deinit,
+	.description     = "CPU frequency scaling tests.",
+	.minor_tests     = cpufreq_tests,
+	.options         = cpufreq_options,
+	.options_handler = cpufreq_options_handler,
+	.options_check   = cpufreq_options_check
 };
 
 FWTS_REGISTER("cpufreq", &cpufreq_ops, FWTS_TEST_ANYTIME, FWTS_FLAG_BATCH | FWTS_FLAG_ROOT_PRIV)
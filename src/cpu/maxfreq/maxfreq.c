@@ -20,11 +20,8 @@
 
 #include <stdlib.h>
 #include <stdbool.h>
-#include <sys/types.h>
-#include <dirent.h>
 #include <ctype.h>
 #include <math.h>
-#include <bsd/string.h>
 
 #define CPU_FREQ_PATH	"/sys/devices/system/cpu"
 #define CPU_INFO_PATH	"/proc/cpuinfo"
@@ -50,117 +47,111 @@ static double maxfreq_max(const char *str)
 	return max;
 }
 
+/*
+ *  maxfreq_model()
+ *	maximum frequency in kHz from a model name such as
+ *	"Intel(R) Core(TM) i7-8650U CPU @ 1.90GHz", -1.0 if none
+ */
+static double maxfreq_model(const char *model_name)
+{
+	const char *str;
+	double freq;
+
+	if (!model_name)
+		return -1.0;
+	if ((str = strstr(model_name, "@")) == NULL)
+		return -1.0;
+
+	freq = atof(str + 1);
+	if (strstr(str, "GHz"))
+		freq *= 1000000.0;
+	if (strstr(str, "MHz"))
+		freq *= 1000.0;
+
+	return freq;
+}
+
 static int maxfreq_test1(fwts_framework *fw)
 {
-	double *cpufreq;
-	int cpu, cpus;
+	const fwts_cpu_topology *topology;
+	int i, cpus = 0, sysfs_cpus = 0;
 	bool advice = false, passed = true, cpufreqs_read = false;
-	struct dirent *entry;
-	DIR *dir;
-	fwts_list_link *item;
-	fwts_list *cpuinfo;
 
 	fwts_log_info(fw,
 		"This test checks the maximum CPU frequency as detected by "
 		"the kernel for each CPU against maximum frequency as "
 		"specified by the BIOS frequency scaling settings.");
 
-	cpuinfo = fwts_file_open_and_read(CPU_INFO_PATH);
-	if (cpuinfo == NULL) {
+	if ((topology = fwts_cpu_topology_get()) == NULL) {
 		fwts_log_error(fw, "Cannot create cpu info list.");
 		return FWTS_ERROR;
 	}
 
-	/* Pass 1, figure out number of CPUs */
-	cpus = 0;
-	fwts_list_foreach(item, cpuinfo) {
-		if (strstr(fwts_text_list_text(item), "model name"))
+	for (i = 0; i < topology->len; i++) {
+		const fwts_cpu_topology_cpu *cpu = &topology->cpus[i];
+
+		if (cpu->model_name) {
 			cpus++;
+			if (maxfreq_model(cpu->model_name) >= 0.0)
+				cpufreqs_read = true;
+		}
+		if (cpu->sysfs)
+			sysfs_cpus++;
 	}
 	if (!cpus) {
-		fwts_list_free(cpuinfo, free);
 		fwts_skipped(fw,
 			"Cannot read CPU model names from %s, this generally "
 			"happens on ARM CPUs, skipping test.", CPU_INFO_PATH);
 		return FWTS_SKIP;
 	}
 
-	if ((cpufreq = calloc(cpus, sizeof(double))) == NULL) {
-		fwts_log_error(fw, "Cannot create cpu frequency array.");
-		fwts_list_free(cpuinfo, free);
-		return FWTS_ERROR;
-	}
-
-	/* Pass 2, get speed */
-	cpu = 0;
-	fwts_list_foreach(item, cpuinfo) {
-		char *str = fwts_text_list_text(item);
-		if (strstr(str, "model name")) {
-			if ((str = strstr(str, "@")) != NULL) {
-				cpufreq[cpu] = atof(str+1);
-				if (strstr(str, "GHz"))
-					cpufreq[cpu] *= 1000000.0;
-				if (strstr(str, "MHz"))
-					cpufreq[cpu] *= 1000.0;
-				cpufreqs_read = true;
-			}
-			else
-				cpufreq[cpu] = -1.0;
-
-			cpu++;
-		}
-	}
-	fwts_list_free(cpuinfo, free);
-
 	if (!cpufreqs_read) {
 		fwts_skipped(fw,
 			"Cannot read CPU frequencies from %s, this generally "
 			"happens on AMD CPUs, skipping test.", CPU_INFO_PATH);
-		free(cpufreq);
 		return FWTS_SKIP;
 	}
 
-	if (!(dir = opendir(CPU_FREQ_PATH))) {
+	if (!sysfs_cpus) {
 		fwts_failed(fw, LOG_LEVEL_LOW,
 			"CPUFreqNoPath",
 			"No %s directory available: cannot test.",
 			CPU_FREQ_PATH);
-		free(cpufreq);
 		return FWTS_ERROR;
 	}
 
-	do {
+	for (i = 0; i < topology->len; i++) {
+		const fwts_cpu_topology_cpu *cpu = &topology->cpus[i];
 		char path[PATH_MAX];
 		char *data;
-		double maxfreq, maxfreq_ghz, cpufreq_ghz;
-		int cpunum;
+		double maxfreq, maxfreq_ghz, cpufreq, cpufreq_ghz;
 
-		entry = readdir(dir);
-		if (!entry || entry->d_name[0] == '.' ||
-		    strlen(entry->d_name) < 3)
+		if (!cpu->sysfs)
+			continue;
+		/* No model name frequency to check against */
+		if ((cpufreq = maxfreq_model(cpu->model_name)) < 0.0)
 			continue;
 
-		strlcpy(path, CPU_FREQ_PATH, strlen(CPU_FREQ_PATH) + 1);
-		snprintf(path + strlen(CPU_FREQ_PATH), sizeof(path) - strlen(CPU_FREQ_PATH),
-			"/%s/cpufreq/scaling_available_frequencies", entry->d_name);
+		snprintf(path, sizeof(path),
+			"%s/cpu%d/cpufreq/scaling_available_frequencies",
+			CPU_FREQ_PATH, cpu->cpu);
 
 		if ((data = fwts_get(path)) == NULL)
 			continue;
 		maxfreq = maxfreq_max(data);
 		free(data);
 
-		cpunum = atoi(entry->d_name + 3);
 		if (maxfreq < 0.0) {
 			fwts_failed(fw, LOG_LEVEL_MEDIUM,
 				"CPUFreqReadFailed",
-				"Cannot read cpu frequency from %s for CPU %s.",
-				CPU_FREQ_PATH, entry->d_name);
+				"Cannot read cpu frequency from %s for CPU cpu%d.",
+				CPU_FREQ_PATH, cpu->cpu);
 			passed = false;
 			continue;
 		}
 
 		maxfreq_ghz = maxfreq / 1000000.0;
-		cpufreq_ghz = cpufreq[cpunum] / 1000000.0;
+		cpufreq_ghz = cpufreq / 1000000.0;
 
 		if (fabs(maxfreq_ghz - cpufreq_ghz) > (maxfreq_ghz * 0.005)) {
 			passed = false;
@@ -183,24 +174,21 @@ static int maxfreq_test1(fwts_framework *fw)
 					"States) object. This is described in "
 					"section 8.4.4.2 of the ACPI "
 					"specification.",
-					(double)maxfreq/1000000.0, cpunum, path,
-					(double)cpufreq[cpunum]/1000000.0);
+					(double)maxfreq/1000000.0, cpu->cpu, path,
+					(double)cpufreq/1000000.0);
 			} else {
 				fwts_advice(fw, "See advice for previous CPU.");
 			}
 		} else {
 			fwts_log_info(fw,
 				"CPU %d maximum frequency %f GHz is sane.",
-				cpunum, maxfreq_ghz);
+				cpu->cpu, maxfreq_ghz);
 		}
-	} while (entry);
+	}
 
 	if (passed)
 		fwts_passed(fw, "%d CPUs passed the maximum frequency check.", cpus);
 
-	free(cpufreq);
-	(void)closedir(dir);
-
 	return FWTS_OK;
 }
 
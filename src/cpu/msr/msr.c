@@ -80,8 +80,7 @@ static int msr_deinit(fwts_framework *fw)
 }
 
 static int msr_consistent(
-	fwts_framework *fw,
-	const uint32_t msr,
+	const fwts_cpu_msr_value *const values,
 	const int shift,
 	const uint64_t mask,
 	uint64_t *const vals,
@@ -94,9 +93,10 @@ static int msr_consistent(
 
 	for (cpu = 0; cpu < ncpus; cpu++) {
 		uint64_t val;
-		if (fwts_cpu_readmsr(fw, cpu, msr, &val) != FWTS_OK) {
+
+		if (!values[cpu].ok)
 			return FWTS_ERROR;
-		}
+		val = values[cpu].val;
 		val >>= shift;
 		val &= mask;
 		vals[cpu] = val;
@@ -113,13 +113,18 @@ static int msr_consistent(
 	return FWTS_OK;
 }
 
-static int msr_consistent_check(fwts_framework *fw,
+/*
+ *  msr_consistent_report()
+ *	check an MSR already read across all CPUs is consistent
+ */
+static int msr_consistent_report(fwts_framework *fw,
 	const fwts_log_level level,
 	const char *const msr_name,
 	const uint32_t msr,
 	const int shift,
 	const uint64_t mask,
-	const msr_callback_check callback)
+	const msr_callback_check callback,
+	const fwts_cpu_msr_value *const values)
 {
 	uint64_t *vals;
 	bool *inconsistent;
@@ -134,7 +139,7 @@ static int msr_consistent_check(fwts_framework *fw,
 		free(vals);
 		return FWTS_ERROR;
 	}
-	if (msr_consistent(fw, msr, shift, mask,
+	if (msr_consistent(values, shift, mask,
 		vals, &inconsistent_count, inconsistent) != FWTS_OK) {
 		free(inconsistent);
 		free(vals);
@@ -169,6 +174,29 @@ static int msr_consistent_check(fwts_framework *fw,
 	return FWTS_OK;
 }
 
+static int msr_consistent_check(fwts_framework *fw,
+	const fwts_log_level level,
+	const char *const msr_name,
+	const uint32_t msr,
+	const int shift,
+	const uint64_t mask,
+	const msr_callback_check callback)
+{
+	fwts_cpu_msr_value *values;
+	int ret;
+
+	if ((values = calloc(ncpus, sizeof(*values))) == NULL) {
+		fwts_log_error(fw, "Out of memory allocating msr value buffers.");
+		return FWTS_ERROR;
+	}
+	(void)fwts_cpu_readmsrs(fw, NULL, ncpus, &msr, 1, values, true);
+	ret = msr_consistent_report(fw, level, msr_name, msr,
+		shift, mask, callback, values);
+	free(values);
+
+	return ret;
+}
+
 static int msr_pstate_ratios(fwts_framework *fw)
 {
 	if (intel_cpu) {
@@ -699,11 +727,36 @@ static const msr_info IA32_haswell_MSRs[] = {
 
 static int msr_table_check(fwts_framework *fw, const msr_info *const info)
 {
-	int i;
+	fwts_cpu_msr_value *values;
+	uint32_t *regs;
+	int i, n;
+
+	for (n = 0; info[n].name != NULL; n++)
+		;
+	if (n == 0)
+		return FWTS_OK;
+
+	/* Read the whole table on all CPUs in one go */
+	if ((regs = calloc(n, sizeof(*regs))) == NULL) {
+		fwts_log_error(fw, "Out of memory allocating msr value buffers.");
+		return FWTS_ERROR;
+	}
+	if ((values = calloc((size_t)n * ncpus, sizeof(*values))) == NULL) {
+		fwts_log_error(fw, "Out of memory allocating msr value buffers.");
+		free(regs);
+		return FWTS_ERROR;
+	}
+	for (i = 0; i < n; i++)
+		regs[i] = info[i].msr;
+	(void)fwts_cpu_readmsrs(fw, NULL, ncpus, regs, n, values, true);
+
+	for (i = 0; i < n; i++)
+		msr_consistent_report(fw, LOG_LEVEL_MEDIUM,
+			info[i].name, info[i].msr, 0, info[i].mask, info[i].callback,
+			&values[(size_t)i * ncpus]);
 
-	for (i = 0; info[i].name != NULL; i++)
-		msr_consistent_check(fw, LOG_LEVEL_MEDIUM,
-			info[i].name, info[i].msr, 0, info[i].mask, info[i].callback);
+	free(values);
+	free(regs);
 
 	return FWTS_OK;
 }
@@ -83,9 +83,10 @@ static int nx_test1(fwts_framework *fw)
 
 static int nx_test2(fwts_framework *fw)
 {
-	int i;
-	int n;
-	int cpu0_has_nx = 0;
+	const fwts_cpu_topology *topology;
+	const fwts_cpu_topology_cpu *cpu0 = NULL;
+	int i, n = 0, nx;
+	bool cpu0_has_nx = false;
 	int failed = 0;
 
 	fwts_log_info(fw,
@@ -93,40 +94,40 @@ static int nx_test2(fwts_framework *fw)
 		"Although rare, BIOS may set the NX flag differently "
 		"per CPU.");
 
-	if ((n = fwts_cpu_enumerate()) == FWTS_ERROR) {
+	if ((topology = fwts_cpu_topology_get()) == NULL) {
 		fwts_log_error(fw, "Cannot determine number of CPUs");
 		return FWTS_ERROR;
 	}
 
-	if (n == 1) {
+	if (topology->n_cpus == 1) {
 		fwts_log_info(fw, "Only one CPU, no need to run test.");
 		return FWTS_OK;
 	}
 
-	for (i = 0; i < n; i++) {
-		fwts_cpuinfo_x86 *fwts_nx_cpuinfo;
+	nx = fwts_cpu_topology_flag(topology, "nx");
+	for (i = 0; i < topology->len; i++) {
+		const fwts_cpu_topology_cpu *cpu = fwts_cpu_topology_find(topology, i);
 
-		if ((fwts_nx_cpuinfo = fwts_cpu_get_info(-1)) == NULL) {
+		if (!cpu || !cpu->online)
+			continue;
+		if (!cpu->has_info) {
 			fwts_failed(fw, LOG_LEVEL_MEDIUM, "NXCPUInfoRead", "Cannot get CPU%d info", i);
-			fwts_cpu_free_info(fwts_nx_cpuinfo);
 			return FWTS_ERROR;
 		}
-		if (fwts_nx_cpuinfo->flags == NULL) {
+		if (cpu->flags_text == NULL) {
 			fwts_failed(fw, LOG_LEVEL_MEDIUM, "NXCPUInfoRead", "Cannot get CPU%d flags", i);
-			fwts_cpu_free_info(fwts_nx_cpuinfo);
 			return FWTS_ERROR;
 		}
-		if (i == 0) {
-			cpu0_has_nx = (strstr(fwts_nx_cpuinfo->flags," nx") != NULL);
-		} else {
-			if (cpu0_has_nx != (strstr(fwts_nx_cpuinfo->flags," nx") != NULL)) {
-				fwts_failed(fw, LOG_LEVEL_MEDIUM,
-					"NXCPUFlagsInconsistent",
-					"CPU%d has different NX flags to CPU0.", i);
-				failed++;
-			}
+		if (!cpu0) {
+			cpu0 = cpu;
+			cpu0_has_nx = fwts_cpu_topology_has_flag(cpu, nx);
+		} else if (cpu0_has_nx != fwts_cpu_topology_has_flag(cpu, nx)) {
+			fwts_failed(fw, LOG_LEVEL_MEDIUM,
+				"NXCPUFlagsInconsistent",
+				"CPU%d has different NX flags to CPU%d.", i, cpu0->cpu);
+			failed++;
 		}
-		fwts_cpu_free_info(fwts_nx_cpuinfo);
+		n++;
 	}
 
 	if (!failed)
@@ -375,9 +375,16 @@ static fwts_framework_minor_test dt_sysinfo_tests[] = {
 	{ NULL, NULL },
 };
 
+static const char * const dt_sysinfo_dt_subtrees[] = {
+	opal_firmware,
+	platform_firmware,
+	NULL
+};
+
 static fwts_framework_ops dt_sysinfo_ops = {
 	.description	= "Device tree system information test",
 	.minor_tests	= dt_sysinfo_tests,
+	.dt_subtrees	= dt_sysinfo_dt_subtrees,
 };
 
 FWTS_REGISTER_FEATURES("dt_sysinfo", &dt_sysinfo_ops, FWTS_TEST_ANYTIME,
@@ -31,6 +31,7 @@
 #include <string.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
 #include <unistd.h>
 #include <limits.h>
 #include <fcntl.h>
@@ -361,158 +362,157 @@ static int dmi_load_file(
 	return FWTS_OK;
 }
 
-static int dmi_load_file_variable_size(
-	const char *filename,
-	void *buf,
-	size_t *size)
+/*
+ *  dmi_table_blob_pad()
+ *	the SMBIOS 3.0 table walkers scan up to the table maximum size,
+ *	so zero pad a table that is shorter than that
+ */
+static int dmi_table_blob_pad(fwts_blob *blob, const size_t length)
 {
-	int fd;
-	char *p;
-	ssize_t count;
-	size_t sz, total;
-
-	sz = *size;
-	(void)memset(buf, 0, sz);
+	uint8_t *data;
 
-	if ((fd = open(filename, O_RDONLY)) < 0)
-		return FWTS_ERROR;
+	if (blob->len >= length)
+		return FWTS_OK;
 
-	for (p = buf, total = count = 0; ; p += count) {
-		if (total >= sz) {
-			close(fd);
+	if (blob->map_len) {
+		if ((data = malloc(length)) == NULL)
 			return FWTS_ERROR;
-		}
-		count = read(fd, p, sz - total);
-		if (count == -1) {
-			close(fd);
+		memcpy(data, blob->data, blob->len);
+		(void)munmap(blob->data, blob->map_len);
+		blob->map_len = 0;
+	} else {
+		if ((data = realloc(blob->data, length)) == NULL)
 			return FWTS_ERROR;
-		}
-		if (count == 0)
-			break;
-
-		total += (size_t)count;
 	}
+	(void)memset(data + blob->len, 0, length - blob->len);
+	blob->data = data;
 
-	(void)close(fd);
-	*size = total;
 	return FWTS_OK;
 }
 
-static void* dmi_table_smbios(fwts_framework *fw, fwts_smbios_entry *entry)
+/*
+ *  dmi_table_mem()
+ *	copy a SMBIOS table out of physical memory into a blob
+ */
+static int dmi_table_mem(
+	fwts_framework *fw,
+	const off_t addr,
+	const size_t length,
+	fwts_blob *blob)
+{
+	void *mem;
+
+	mem = fwts_mmap(addr, length);
+	if (mem == FWTS_MAP_FAILED)
+		return FWTS_ERROR;
+
+	/* Can we safely copy the table? */
+	if (fwts_safe_memread((void *)mem, length) != FWTS_OK) {
+		fwts_log_info(fw, "SMBIOS table at %p cannot be read", (void *)addr);
+		(void)fwts_munmap(mem, length);
+		return FWTS_ABORTED;
+	}
+	blob->data = malloc(length);
+	if (blob->data) {
+		memcpy(blob->data, mem, length);
+		blob->len = length;
+		blob->map_len = 0;
+	}
+	(void)fwts_munmap(mem, length);
+
+	return blob->data ? FWTS_OK : FWTS_ABORTED;
+}
+
+static int dmi_table_smbios(fwts_framework *fw, fwts_smbios_entry *entry, fwts_blob *blob)
 {
 	off_t addr = (off_t)entry->struct_table_address;
 	size_t length = (size_t)entry->struct_table_length;
-	void *table;
-	void *mem;
 	char anchor[8];
+	int ret;
+
+	blob->data = NULL;
+	blob->len = 0;
+	blob->map_len = 0;
 
 	/* 32 bit entry sanity check on length */
 	if ((length == 0) || (length > 0xffff)) {
 		fwts_log_info(fw, "SMBIOS table size of %zu bytes looks "
 			"suspicious",  length);
-		return NULL;
+		return FWTS_ERROR;
 	}
 
 	if (dmi_load_file("/sys/firmware/dmi/tables/smbios_entry_point", anchor, 4) == FWTS_OK
 			&& strncmp(anchor, "_SM_", 4) == 0) {
-		table = malloc(length);
-		if (!table)
-			return NULL;
-		if (dmi_load_file("/sys/firmware/dmi/tables/DMI", table, length) == FWTS_OK) {
-			fwts_log_info(fw, "SMBIOS table loaded from /sys/firmware/dmi/tables/DMI");
-			return table;
+		if (fwts_blob_load(blob, "/sys/firmware/dmi/tables/DMI") == FWTS_OK) {
+			if (blob->len >= length) {
+				fwts_log_info(fw, "SMBIOS table loaded from /sys/firmware/dmi/tables/DMI");
+				return FWTS_OK;
+			}
+			fwts_blob_free(blob);
 		}
-		free(table);
 	}
 
 #ifdef FWTS_ARCH_AARCH64
 	if (!fwts_kernel_config_exist() ||
 			fwts_kernel_config_set("CONFIG_STRICT_DEVMEM")) {
 		fwts_warning(fw, "Skipping scanning SMBIOS table in memory for arm64 systems");
-		return NULL;
+		return FWTS_ERROR;
 	}
 #endif
 
-	mem = fwts_mmap(addr, length);
-	if (mem != FWTS_MAP_FAILED) {
-		/* Can we safely copy the table? */
-		if (fwts_safe_memread((void *)mem, length) != FWTS_OK) {
-			fwts_log_info(fw, "SMBIOS table at %p cannot be read", (void *)addr);
-			(void)fwts_munmap(mem, length);
-			return NULL;
-		}
-		table = malloc(length);
-		if (table)
-			memcpy(table, mem, length);
-		(void)fwts_munmap(mem, length);
-		return table;
-	}
-
-
-	fwts_log_error(fw, "Cannot mmap SMBIOS table from %8.8" PRIx32 "..%8.8" PRIx32 ".",
+	ret = dmi_table_mem(fw, addr, length, blob);
+	if (ret == FWTS_ERROR)
+		fwts_log_error(fw, "Cannot mmap SMBIOS table from %8.8" PRIx32 "..%8.8" PRIx32 ".",
 			entry->struct_table_address, entry->struct_table_address + entry->struct_table_length);
-	return NULL;
+
+	return ret == FWTS_OK ? FWTS_OK : FWTS_ERROR;
 }
 
-static void* dmi_table_smbios30(fwts_framework *fw, fwts_smbios30_entry *entry)
+static int dmi_table_smbios30(fwts_framework *fw, fwts_smbios30_entry *entry, fwts_blob *blob)
 {
 	off_t addr = (off_t)entry->struct_table_address;
 	size_t length = (size_t)entry->struct_table_max_size;
-	void *table;
-	void *mem;
 	char anchor[8];
+	int ret;
+
+	blob->data = NULL;
+	blob->len = 0;
+	blob->map_len = 0;
 
 	/* 64 bit entry sanity check on length */
 	if ((length == 0) || (length > 0xffffff)) {
 		fwts_log_info(fw, "SMBIOS table size of %zu bytes looks "
 			"suspicious",  length);
-		return NULL;
+		return FWTS_ERROR;
 	}
 
 	if (dmi_load_file("/sys/firmware/dmi/tables/smbios_entry_point", anchor, 5) == FWTS_OK
 			&& strncmp(anchor, "_SM3_", 5) == 0) {
-		table = malloc(length);
-		if (!table)
-			return NULL;
-		if (dmi_load_file_variable_size("/sys/firmware/dmi/tables/DMI", table, &length) == FWTS_OK) {
-			fwts_log_info(fw, "SMBIOS30 table loaded from /sys/firmware/dmi/tables/DMI");
-			return table;
+		if (fwts_blob_load(blob, "/sys/firmware/dmi/tables/DMI") == FWTS_OK) {
+			/* The table must fit within the maximum size */
+			if ((blob->len > 0) && (blob->len < length) &&
+			    (dmi_table_blob_pad(blob, length) == FWTS_OK)) {
+				fwts_log_info(fw, "SMBIOS30 table loaded from /sys/firmware/dmi/tables/DMI");
+				return FWTS_OK;
+			}
+			fwts_blob_free(blob);
 		}
-		free(table);
 	}
 
 #ifdef FWTS_ARCH_AARCH64
 	if (!fwts_kernel_config_exist() ||
 			fwts_kernel_config_set("CONFIG_STRICT_DEVMEM")) {
 		fwts_warning(fw, "Skipping scanning SMBIOS3 table in memory for arm64 systems");
-		return NULL;
+		return FWTS_ERROR;
 	}
 #endif
 
-	mem = fwts_mmap(addr, length);
-	if (mem != FWTS_MAP_FAILED) {
-		/* Can we safely copy the table? */
-		if (fwts_safe_memread((void *)mem, length) != FWTS_OK) {
-			fwts_log_info(fw, "SMBIOS table at %p cannot be read", (void *)addr);
-			(void)fwts_munmap(mem, length);
-			return NULL;
-		}
-		table = malloc(length);
-		if (table)
-			memcpy(table, mem, length);
-		(void)fwts_munmap(mem, length);
-		return table;
-	}
-
-	fwts_log_error(fw, "Cannot mmap SMBIOS 3.0 table from %16.16" PRIx64 "..%16.16" PRIx64 ".",
+	ret = dmi_table_mem(fw, addr, length, blob);
+	if (ret == FWTS_ERROR)
+		fwts_log_error(fw, "Cannot mmap SMBIOS 3.0 table from %16.16" PRIx64 "..%16.16" PRIx64 ".",
 			entry->struct_table_address, entry->struct_table_address + entry->struct_table_max_size);
-	return NULL;
-}
 
-static void dmi_table_free(void *table)
-{
-	if (table)
-		free(table);
+	return ret == FWTS_OK ? FWTS_OK : FWTS_ERROR;
 }
 
 static void dmi_dump_entry(
@@ -568,15 +568,16 @@ static void dmi_dump_entry30(
 
 static int dmi_sane(fwts_framework *fw, fwts_smbios_entry *entry)
 {
+	fwts_blob blob;
 	uint8_t	*table, *ptr;
 	uint8_t dmi_entry_type = 0;
 	uint16_t i = 0;
 	uint16_t table_length = entry->struct_table_length;
 	int ret = FWTS_OK;
 
-	ptr = table = dmi_table_smbios(fw, entry);
-	if (table == NULL)
+	if (dmi_table_smbios(fw, entry, &blob) != FWTS_OK)
 		return FWTS_ERROR;
+	ptr = table = blob.data;
 
 	for (i = 0; i < entry->number_smbios_structures; i++) {
 		uint8_t dmi_entry_length;
@@ -625,7 +626,7 @@ static int dmi_sane(fwts_framework *fw, fwts_smbios_entry *entry)
 		ret = FWTS_ERROR;
 	}
 
-	dmi_table_free(table);
+	fwts_blob_free(&blob);
 
 	return ret;
 }
@@ -716,14 +717,15 @@ static int smbios_entry_check(fwts_framework *fw)
 
 static int dmi_smbios30_sane(fwts_framework *fw, fwts_smbios30_entry *entry)
 {
+	fwts_blob blob;
 	uint8_t	*table, *ptr;
 	uint16_t i = 0;
 	uint32_t table_length = entry->struct_table_max_size;
 	int ret = FWTS_OK;
 
-	ptr = table = dmi_table_smbios30(fw, entry);
-	if (table == NULL)
+	if (dmi_table_smbios30(fw, entry, &blob) != FWTS_OK)
 		return FWTS_ERROR;
+	ptr = table = blob.data;
 
 	for (;;) {
 		uint8_t struct_length;
@@ -774,7 +776,7 @@ static int dmi_smbios30_sane(fwts_framework *fw, fwts_smbios30_entry *entry)
 		}
 	}
 
-	dmi_table_free(table);
+	fwts_blob_free(&blob);
 
 	return ret;
 }
@@ -2383,7 +2385,7 @@ static int dmicheck_test2(fwts_framework *fw)
 	fwts_smbios_entry entry;
 	fwts_smbios_type  type;
 	uint16_t version = 0;
-	uint8_t  *table;
+	fwts_blob table;
 
 	if (fw->flags & FWTS_FLAG_SBBR)
 		return FWTS_SKIP;
@@ -2410,13 +2412,12 @@ static int dmicheck_test2(fwts_framework *fw)
 	if (dmi_version_check(fw, version) != FWTS_OK)
 		return FWTS_SKIP;
 
-	table = dmi_table_smbios(fw, &entry);
-	if (table == NULL)
+	if (dmi_table_smbios(fw, &entry, &table) != FWTS_OK)
 		return FWTS_ERROR;
 
-	dmi_scan_tables(fw, &entry, table);
+	dmi_scan_tables(fw, &entry, table.data);
 
-	dmi_table_free(table);
+	fwts_blob_free(&table);
 
 	return FWTS_OK;
 }
@@ -2426,7 +2427,7 @@ static int dmicheck_test3(fwts_framework *fw)
 	void *addr;
 	fwts_smbios30_entry entry30;
 	uint16_t version = 0;
-	uint8_t  *table;
+	fwts_blob table;
 
 	if (!smbios30_found) {
 		fwts_skipped(fw, "Cannot find SMBIOS30 table entry, skip the test.");
@@ -2443,13 +2444,12 @@ static int dmicheck_test3(fwts_framework *fw)
 	if (dmi_version_check(fw, version) != FWTS_OK)
 		return FWTS_SKIP;
 
-	table = dmi_table_smbios30(fw, &entry30);
-	if (table == NULL)
+	if (dmi_table_smbios30(fw, &entry30, &table) != FWTS_OK)
 		return FWTS_ERROR;
 
-	dmi_scan_smbios30_table(fw, &entry30, table);
+	dmi_scan_smbios30_table(fw, &entry30, table.data);
 
-	dmi_table_free(table);
+	fwts_blob_free(&table);
 
 	return FWTS_OK;
 }
@@ -2497,6 +2497,6 @@ static fwts_framework_ops dmicheck_ops = {
 	.minor_tests = dmicheck_tests
 };
 
-FWTS_REGISTER("dmicheck", &dmicheck_ops, FWTS_TEST_ANYTIME, FWTS_FLAG_BATCH | FWTS_FLAG_ROOT_PRIV | FWTS_FLAG_SBBR)
+FWTS_REGISTER("dmicheck", &dmicheck_ops, FWTS_TEST_ANYTIME, FWTS_FLAG_BATCH | FWTS_FLAG_ROOT_PRIV | FWTS_FLAG_SBBR | FWTS_FLAG_PARALLEL)
 
 #endif
@@ -171,6 +171,10 @@
 #include "fwts_framework.h"
 #include "fwts_log.h"
 #include "fwts_log_scan.h"
+#include "fwts_log_dedup.h"
+#include "fwts_log_index.h"
+#include "fwts_log_matcher.h"
+#include "fwts_log_pattern_cache.h"
 #include "fwts_list.h"
 #include "fwts_text_list.h"
 #include "fwts_set.h"
@@ -225,6 +229,8 @@
 #include "fwts_safe_mem.h"
 #include "fwts_devicetree.h"
 #include "fwts_pm_debug.h"
+#include "fwts_pm_timing.h"
+#include "fwts_blob.h"
 #include "fwts_modprobe.h"
 
 #endif
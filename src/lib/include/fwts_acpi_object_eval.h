@@ -29,14 +29,36 @@
 
 int fwts_acpi_init(fwts_framework *fw);
 int fwts_acpi_deinit(fwts_framework *fw);
+int fwts_acpi_session_init(fwts_framework *fw);
+void fwts_acpi_session_deinit(fwts_framework *fw);
 char *fwts_acpi_object_exists(const char *name);
 fwts_list *fwts_acpi_object_get_names(void);
+fwts_list *fwts_acpi_object_find_all(const char *name);
+char **fwts_acpi_object_find_seg(const char *seg, size_t *count);
+char **fwts_acpi_object_find_subtree(const char *path, size_t *count);
 void fwts_acpi_object_dump(fwts_framework *fw, const ACPI_OBJECT *obj);
 void fwts_acpi_object_evaluate_report_error(fwts_framework *fw,
 	const char *name, const ACPI_STATUS status);
 ACPI_STATUS fwts_acpi_object_evaluate(fwts_framework *fw, char *name,
 	ACPI_OBJECT_LIST *arg_list, ACPI_BUFFER *buf);
 
+typedef struct {
+	char		*name;		/* object evaluated */
+	bool		evaluated;	/* false if the worker failed */
+	ACPI_STATUS	status;		/* evaluation status */
+	ACPI_BUFFER	buf;		/* returned object, if any */
+	int		sem_acquired;	/* semaphores acquired */
+	int		sem_released;	/* semaphores released */
+	fwts_results	results;	/* results counted while evaluating */
+	void		*log;		/* captured log output */
+	size_t		log_len;	/* size of captured log output */
+} fwts_acpi_object_result;
+
+int fwts_acpi_object_evaluate_parallel(fwts_framework *fw, char **names,
+	const int n, ACPI_OBJECT_LIST *arg_list, int jobs,
+	fwts_acpi_object_result *results);
+void fwts_acpi_object_results_free(fwts_acpi_object_result *results, const int n);
+
 /* Test types */
 #define METHOD_MANDATORY	1
 #define METHOD_OPTIONAL		2
@@ -33,4 +33,10 @@ void fwts_acpica_sem_count_get(int *acquired, int *released);
 void fwts_acpi_region_handler_called_set(const bool val);
 bool fwts_acpi_region_handler_called_get(void);
 
+void fwts_acpica_profile_init(fwts_framework *fw);
+void fwts_acpica_profile_deinit(void);
+bool fwts_acpica_profile_enabled(void);
+void fwts_acpica_profile_region(const uint8_t space_id);
+void fwts_acpica_profile_sem_wait(const uint64_t wait_ns);
+
 #endif
@@ -0,0 +1,43 @@
+/*
+ * Copyright (C) 2026 Canonical
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef __FWTS_BLOB_H__
+#define __FWTS_BLOB_H__
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ *  contents of a file, mapped read only if the file can be
+ *  mapped, otherwise read into a '\0' terminated heap buffer.
+ *  The contents must not be modified.
+ */
+typedef struct {
+	uint8_t *data;			/* file contents, NULL if empty */
+	size_t len;			/* length of contents */
+	size_t map_len;			/* length mapped, 0 if read into the heap */
+} fwts_blob;
+
+#define FWTS_BLOB_INIT	{ NULL, 0, 0 }
+
+int  fwts_blob_load(fwts_blob *blob, const char *filename);
+int  fwts_blob_load_fd(fwts_blob *blob, const int fd);
+void fwts_blob_free(fwts_blob *blob);
+
+#endif
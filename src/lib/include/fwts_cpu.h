@@ -23,6 +23,7 @@
 #include "fwts_framework.h"
 
 #include <stdbool.h>
+#include <stdint.h>
 
 typedef struct cpuinfo_x86 {
 	char *vendor_id;	/* Vendor ID */
@@ -51,13 +52,40 @@ typedef enum proc_gen {
 } proc_gen_t;
 extern proc_gen_t proc_gen;
 
+/*
+ *  The benchmark runs in slices until the loop rate of the last
+ *  FWTS_CPU_BENCHMARK_WINDOW slices agree within the tolerance, and
+ *  for no more than FWTS_CPU_BENCHMARK_MAX_NS
+ */
+#define FWTS_CPU_BENCHMARK_TOLERANCE	(0.01)		/* as fraction */
+#define FWTS_CPU_BENCHMARK_WINDOW	(5)		/* slices */
+#define FWTS_CPU_BENCHMARK_SLICE_NS	(10000000ULL)	/* 10ms */
+#define FWTS_CPU_BENCHMARK_MIN_NS	(50000000ULL)	/* 50ms */
+#define FWTS_CPU_BENCHMARK_MAX_NS	(250000000ULL)	/* 250ms */
+#define FWTS_CPU_BENCHMARK_CHECK_NS	(50000ULL)	/* min time between clock reads */
+
+#define FWTS_CPU_PERF_EVENTS		(3)		/* cycles, instructions, ref-cycles */
+
 typedef struct cpu_benchmark_result {
 	bool		cycles_valid;
-	uint64_t	loops;
-	uint64_t	cycles;
+	uint64_t	loops;		/* per second */
+	uint64_t	cycles;		/* per second */
+	uint64_t	instructions;	/* per second, 0 if not available */
+	uint64_t	ref_cycles;	/* per second, 0 if not available */
+	uint64_t	duration_ns;	/* length of the run */
+	bool		converged;	/* stopped before FWTS_CPU_BENCHMARK_MAX_NS */
 } fwts_cpu_benchmark_result;
 
+typedef struct cpu_msr_value {
+	uint64_t	val;	/* MSR value, 0 if the read failed */
+	bool		ok;	/* true if the MSR was read */
+} fwts_cpu_msr_value;
+
 int fwts_cpu_readmsr(fwts_framework *fw, const int cpu, const uint32_t reg, uint64_t *val);
+int fwts_cpu_readmsrs(fwts_framework *fw, const int *cpus, const int ncpus,
+	const uint32_t *regs, const int nregs, fwts_cpu_msr_value *values,
+	const bool parallel);
+void fwts_cpu_msr_close(void);
 
 int fwts_cpu_is_Intel(bool *is_intel);
 int fwts_cpu_is_AMD(bool *is_amd);
@@ -73,6 +101,55 @@ int fwts_cpu_consume_start(void);
 void fwts_cpu_consume_complete(void);
 int fwts_cpu_benchmark(fwts_framework *fw, const int cpu,
 		fwts_cpu_benchmark_result *result);
+int fwts_cpu_benchmark_thread(const int cpu, const double tolerance,
+		fwts_cpu_benchmark_result *result);
+void fwts_cpu_benchmark_close(void);
+
+#define FWTS_CPU_TOPOLOGY_NONE	(-1)	/* ID or policy not known */
+
+/*
+ *  One logical CPU, from /proc/cpuinfo and sysfs
+ */
+typedef struct {
+	int cpu;			/* logical CPU number */
+	bool sysfs;			/* has a sysfs cpuN directory */
+	bool has_info;			/* listed in /proc/cpuinfo */
+	bool online;
+	const char *vendor_id;		/* strings are shared, NULL if not known */
+	const char *model_name;
+	const char *flags_text;		/* flags line */
+	uint64_t *flags;		/* flags bitset, NULL if no flags */
+	bool flags_owner;		/* flags bitset is not shared */
+	int family;
+	int model;
+	int stepping;
+	int package;			/* physical package (socket) id */
+	int policy;			/* cpufreq policy */
+	bool policy_master;		/* lowest online CPU of the policy */
+} fwts_cpu_topology_cpu;
+
+typedef struct {
+	fwts_cpu_topology_cpu *cpus;	/* indexed by logical CPU number */
+	int len;			/* highest CPU number + 1 */
+	int n_cpus;			/* CPUs in /proc/cpuinfo or sysfs */
+	int first_cpu;			/* first CPU in /proc/cpuinfo */
+	char **strings;			/* distinct vendor, model and flags lines */
+	int strings_len;
+	char **flag_names;		/* bit n of a flags bitset is flag_names[n] */
+	int n_flags;
+	int flag_words;			/* uint64_t words in a flags bitset */
+	uint32_t *flag_hash;		/* flag name hash, flag index + 1, 0 if empty */
+	uint32_t flag_hash_size;
+} fwts_cpu_topology;
+
+fwts_cpu_topology *fwts_cpu_topology_new(void);
+void fwts_cpu_topology_free(fwts_cpu_topology *topology);
+fwts_cpu_topology *fwts_cpu_topology_get(void);
+void fwts_cpu_topology_put(void);
+const fwts_cpu_topology_cpu *fwts_cpu_topology_find(const fwts_cpu_topology *topology, const int cpu);
+int fwts_cpu_topology_flag(const fwts_cpu_topology *topology, const char *name);
+bool fwts_cpu_topology_has_flag(const fwts_cpu_topology_cpu *cpu, const int flag);
+void fwts_cpu_burn_cycles(void);
 
 uint64_t fwts_cpu_benchmark_best_result(fwts_cpu_benchmark_result *res);
 
@@ -29,6 +29,7 @@
 #endif
 
 #define DT_FS_PATH 			 "/sys/firmware/devicetree/base"
+#define DT_FDT_PATH			 "/sys/firmware/fdt"
 #define DT_LINUX_PCI_DEVICES		 "/sys/bus/pci/devices"
 #define DT_PROPERTY_OPAL_PCI_SLOT	 "ibm,slot-label"
 #define DT_PROPERTY_OPAL_SLOT_LOC	 "ibm,slot-location-code"
@@ -41,7 +42,7 @@
 
 #if FWTS_HAS_DEVICETREE
 
-int fwts_devicetree_read(fwts_framework *fwts);
+int fwts_devicetree_read(fwts_framework *fwts, const char * const *subtrees);
 int fwts_dt_property_read_u32(
 	void *fdt,
 	int offset,
@@ -66,9 +67,10 @@ int fwts_dt_stringlist_count(
 	const char *property);
 
 #else /* !FWTS_HAS_DEVICETREE */
-static inline int fwts_devicetree_read(fwts_framework *fwts)
+static inline int fwts_devicetree_read(fwts_framework *fwts, const char * const *subtrees)
 {
 	FWTS_UNUSED(fwts);
+	FWTS_UNUSED(subtrees);
 
 	return FWTS_OK;
 }
@@ -27,5 +27,6 @@ fwts_list* fwts_file_read(FILE *fp);
 fwts_list* fwts_file_open_and_read(const char *file);
 fwts_list* fwts_gzfile_read(gzFile *fp);
 fwts_list* fwts_gzfile_open_and_read(const char *file);
+void fwts_csv_escape(FILE *fp, const char *str);
 
 #endif
@@ -31,6 +31,7 @@ typedef struct fwts_framework fwts_framework;
 #include "fwts_arch.h"
 #include "fwts_log.h"
 #include "fwts_list.h"
+#include "fwts_log_dedup.h"
 #include "fwts_acpica_mode.h"
 #include "fwts_types.h"
 #include "fwts_firmware.h"
@@ -63,6 +64,11 @@ typedef enum {
 	FWTS_FLAG_COMPLIANCE_ACPI		= 0x00800000,
 	FWTS_FLAG_SBBR				= 0x01000000,
 	FWTS_FLAG_EBBR				= 0x02000000,
+	FWTS_FLAG_ACPICA_PROFILE		= 0x04000000,
+	FWTS_FLAG_PARALLEL			= 0x08000000,
+	FWTS_FLAG_ACPI_NAMESPACE		= 0x10000000,
+	FWTS_FLAG_UEFI_LATENCY			= 0x20000000,
+	FWTS_FLAG_OFFLINE			= 0x40000000,
 	FWTS_FLAG_XBBR				= FWTS_FLAG_SBBR | FWTS_FLAG_EBBR
 } fwts_framework_flags;
 
@@ -78,6 +84,11 @@ typedef struct {
 	uint32_t infoonly;
 } fwts_results;
 
+/*
+ *  Failure label counts, see fwts_framework.c
+ */
+typedef struct fwts_framework_labels fwts_framework_labels;
+
 /*
  *  Where to schedule a test, priority sorted lowest first, highest last
  */
@@ -120,6 +131,11 @@ struct fwts_framework {
 	char *olog;				/* path to OLOG */
 	char *json_data_path;			/* path to application json data files, e.g. json klog data */
 	char *json_data_file;			/* json file to use for olog analysis */
+	char *log_pattern_cache_path;		/* directory to cache parsed log pattern tables */
+	char *acpica_profile_path;		/* file to export ACPI method profile to */
+	char *uefi_latency_path;		/* file to export UEFI runtime service latency to */
+	char *replay_corpus_path;		/* directory of captured machines to replay tests on */
+	char *replay_output_path;		/* directory for per capture replay results logs */
 	struct fwts_framework_test *current_major_test; /* current test */
 	void *rsdp;				/* ACPI RSDP address */
 	void *fdt;				/* Flattened device tree data */
@@ -130,6 +146,7 @@ struct fwts_framework {
 	uint32_t major_tests_total;		/* Total number of major tests */
 	uint32_t total_run;			/* total number of major tests run */
 	uint32_t minor_test_progress;		/* Percentage completion of current test */
+	uint32_t jobs;				/* --jobs, max tests to run in parallel */
 
 	fwts_results minor_tests;		/* results for each minor test */
 	fwts_results total;			/* totals over all tests */
@@ -140,6 +157,7 @@ struct fwts_framework {
 	fwts_log_type	log_type;		/* Output log type, default is plain text ASCII */
 	fwts_list errors_filter_keep;		/* Results to keep, empty = keep all */
 	fwts_list errors_filter_discard;	/* Results to discard, empty = discard none */
+	fwts_framework_labels *failed_labels;	/* Counts of failure labels, NULL if not counted */
 	fwts_acpica_mode acpica_mode;		/* ACPICA mode flags */
 	fwts_pm_method pm_method;
 	fwts_architecture host_arch;		/* arch FWTS was built for */
@@ -148,6 +166,7 @@ struct fwts_framework {
 	bool print_summary;			/* Print summary of results at end of test runs */
 	bool error_filtered_out;		/* True if a klog message has been filtered out */
 	bool show_progress;			/* Show progress while running current test */
+	bool devicetree_lazy;			/* Only read the devicetree subtrees tests use */
 };
 
 typedef struct {
@@ -174,6 +193,7 @@ typedef struct fwts_framework_ops {
 	fwts_args_optarg_check   options_check;
 	fwts_framework_minor_test *minor_tests;	/* NULL terminated array of minor tests to run */
 	int total_tests;			/* Number of tests to run */
+	const char * const *dt_subtrees;	/* NULL terminated devicetree subtrees read, NULL for all */
 } fwts_framework_ops;
 
 typedef struct fwts_framework_test {
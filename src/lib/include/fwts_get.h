@@ -21,8 +21,10 @@
 #define __FWTS_GET_H__
 
 #include <stdio.h>
+#include <stdint.h>
 
 char *fwts_get(const char *file);
 int fwts_get_int(const char *file, int *value);
+int fwts_get_uint64(const char *file, uint64_t *value);
 
 #endif
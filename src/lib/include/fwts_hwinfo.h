@@ -22,15 +22,34 @@
 
 #include "fwts.h"
 
+#define FWTS_HWINFO_FIELDS_MAX	(8)
+
+/*
+ *  a device, fields[0] is the device identity that is used to
+ *  match the device between two hwinfo snapshots, e.g. its name
+ */
+typedef struct {
+	char *fields[FWTS_HWINFO_FIELDS_MAX];
+} fwts_hwinfo_device;
+
+/*
+ *  devices of one class, sorted by identity
+ */
+typedef struct {
+	fwts_hwinfo_device *devices;
+	size_t len;		/* number of devices */
+	size_t size;		/* allocated size of devices[] */
+} fwts_hwinfo_devices;
+
 typedef struct {
-	fwts_list network;	/* PCI network config */
-	fwts_list videocard;	/* PCI video card config */
-	fwts_list netdevs;	/* Network devices */
-	fwts_list input;	/* Input device config */
-	fwts_list bluetooth;	/* Bluetooth config */
-	fwts_list typec;	/* USB type c config */
-	fwts_list scsi_disk;	/* SCSI disk config */
-	fwts_list drm;		/* DRM config */
+	fwts_hwinfo_devices network;	/* PCI network config */
+	fwts_hwinfo_devices videocard;	/* PCI video card config */
+	fwts_hwinfo_devices netdevs;	/* Network devices */
+	fwts_hwinfo_devices input;	/* Input device config */
+	fwts_hwinfo_devices bluetooth;	/* Bluetooth config */
+	fwts_hwinfo_devices typec;	/* USB type c config */
+	fwts_hwinfo_devices scsi_disk;	/* SCSI disk config */
+	fwts_hwinfo_devices drm;	/* DRM config */
 } fwts_hwinfo;
 
 int fwts_hwinfo_get(fwts_framework *fw, fwts_hwinfo *hwinfo);
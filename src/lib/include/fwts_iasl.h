@@ -40,6 +40,18 @@ int fwts_iasl_reassemble(fwts_framework *fw,
 	fwts_list **iasl_stdout,
 	fwts_list **iasl_stderr);
 
+typedef void (*fwts_iasl_reassemble_func)(fwts_framework *fw,
+	const fwts_acpi_table_info *info,
+	const int ret,
+	fwts_list *iasl_disassembly,
+	fwts_list *iasl_stdout,
+	fwts_list *iasl_stderr,
+	void *data);
+
+int fwts_iasl_reassemble_all(fwts_framework *fw,
+	fwts_iasl_reassemble_func func,
+	void *data);
+
 const char *fwts_iasl_exception_level(uint8_t level);
 
 #endif
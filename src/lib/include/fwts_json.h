@@ -19,6 +19,8 @@
 #ifndef __FWTS_JSON_H__
 #define __FWTS_JSON_H__
 
+#include <stdio.h>
+
 /*
  *  Minimal subset of json for fwts
  */
@@ -75,4 +77,6 @@ void json_object_put(json_object *obj);
 json_object *json_object_new_string(const char *str);
 int json_object_array_add(json_object *obj, json_object *item);
 
+void fwts_json_escape(FILE *fp, const char *str);
+
 #endif
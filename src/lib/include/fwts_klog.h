@@ -22,16 +22,41 @@
 
 #include <sys/types.h>
 #include <regex.h>
+#include <stdint.h>
 
 #include "fwts_list.h"
 #include "fwts_framework.h"
 #include "fwts_log.h"
+#include "fwts_log_index.h"
 #include "fwts_json.h"
 
 #define KERN_WARNING            0x00000001
 #define KERN_ERROR              0x00000002
 
 
+/*
+ *  kernel log errors with the same label seen over many cycles
+ */
+typedef struct {
+	char *label;			/* pattern label */
+	fwts_log_level level;		/* pattern log level */
+	uint32_t count;			/* matching lines over all cycles */
+	uint32_t cycles;		/* cycles with matching lines */
+	uint32_t first_cycle;		/* first cycle with a match */
+	uint32_t last_cycle;		/* most recent cycle with a match */
+} fwts_klog_follower_label;
+
+/*
+ *  follow the kernel log over many cycles (e.g. s3/s4), each
+ *  read just gets the lines added since the previous read
+ */
+typedef struct {
+	fwts_log_index *klog;		/* lines read by the last read */
+	size_t from;			/* first new line in klog */
+	uint32_t cycle;			/* number of reads so far */
+	fwts_list labels;		/* fwts_klog_follower_label, order first seen */
+} fwts_klog_follower;
+
 typedef void (*fwts_klog_progress_func)(fwts_framework *fw, int percent);
 typedef void (*fwts_klog_scan_func)(fwts_framework *fw, char *line, int repeated, char *prevline, void *private, int *errors);
 
@@ -40,6 +65,15 @@ void       fwts_klog_scan_patterns(fwts_framework *fw, char *line, int repeated,
 fwts_list *fwts_klog_read(void);
 fwts_list *fwts_klog_find_changes(fwts_list *klog_old, fwts_list *klog_new);
 void       fwts_klog_free(fwts_list *list);
+int        fwts_klog_index_update(fwts_log_index *klog);
+fwts_klog_follower *fwts_klog_follower_new(void);
+void       fwts_klog_follower_free(fwts_klog_follower *follower);
+int        fwts_klog_follower_read(fwts_klog_follower *follower);
+fwts_list *fwts_klog_follower_list(const fwts_klog_follower *follower);
+int        fwts_klog_follower_firmware_check(fwts_framework *fw, fwts_klog_follower *follower, int *errors);
+int        fwts_klog_follower_pm_check(fwts_framework *fw, fwts_klog_follower *follower, int *errors);
+void       fwts_klog_follower_report(fwts_framework *fw, const fwts_klog_follower *follower);
+int        fwts_klog_index_scan(fwts_framework *fw, fwts_log_index *klog, const size_t from, fwts_klog_scan_func callback, fwts_klog_progress_func progress, void *private, int *errors);
 
 
 int        fwts_klog_firmware_check(fwts_framework *fw, fwts_klog_progress_func progress, fwts_list *klog, int *errors);
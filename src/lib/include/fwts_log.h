@@ -127,6 +127,11 @@ fwts_log *fwts_log_open(const char* owner, const char *name, const char *mode, c
 int       fwts_log_close(fwts_log *log);
 int       fwts_log_printf(const fwts_framework *fw, const fwts_log_field field, const fwts_log_level level, const char *status, const char *label, const char *prefix, const char *fmt, ...)
 	__attribute__((format(printf, 7, 8)));
+void      fwts_log_capture_begin(void);
+void     *fwts_log_capture_end(size_t *len);
+bool      fwts_log_capturing(void);
+void      fwts_log_capture_summary(const char *test, const fwts_log_level level, const char *text);
+int       fwts_log_capture_replay(fwts_framework *fw, const void *buf, const size_t len);
 void      fwts_log_newline(fwts_log *log);
 void      fwts_log_underline(fwts_log *log, const int ch);
 void      fwts_log_set_field_filter(char *str);
@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2026 Canonical
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef __FWTS_LOG_DEDUP_H__
+#define __FWTS_LOG_DEDUP_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "fwts_list.h"
+
+/*
+ *  a unique log line, lines are kept in the order they were first seen
+ */
+typedef struct {
+	char *line;			/* original log line, not copied */
+	const char *key;		/* line with timestamp optionally stripped */
+	uint64_t hash;			/* hash of key */
+	int repeated;			/* number of repeats after first instance */
+} fwts_log_dedup_item;
+
+/*
+ *  log line interning table, open addressed hash of indexes into items[]
+ */
+typedef struct {
+	fwts_log_dedup_item *items;	/* unique lines, first-seen order */
+	size_t len;			/* number of unique lines */
+	size_t items_size;		/* allocated size of items[] */
+	uint32_t *slots;		/* hash slots, index + 1, 0 = empty */
+	size_t slots_size;		/* number of slots, power of 2 */
+	bool remove_timestamp;		/* strip timestamp to form the key */
+} fwts_log_dedup;
+
+#define fwts_log_dedup_foreach(iterator, dedup) \
+		for (iterator = (dedup)->items; iterator < (dedup)->items + (dedup)->len; iterator++)
+
+fwts_log_dedup *fwts_log_dedup_new(const size_t size_hint, const bool remove_timestamp);
+void            fwts_log_dedup_free(fwts_log_dedup *dedup);
+fwts_log_dedup_item *fwts_log_dedup_add(fwts_log_dedup *dedup, char *line);
+uint64_t        fwts_log_dedup_hash(const char *str, size_t *len);
+
+static inline size_t fwts_log_dedup_len(const fwts_log_dedup *dedup)
+{
+	return dedup ? dedup->len : 0;
+}
+
+#endif
@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2026 Canonical
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef __FWTS_LOG_INDEX_H__
+#define __FWTS_LOG_INDEX_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "fwts_list.h"
+
+/*
+ *  a log line, offsets into the log index buffer
+ */
+typedef struct {
+	uint32_t offset;		/* start of '\0' terminated line */
+	uint32_t text;			/* start of line with timestamp stripped */
+	uint32_t len;			/* length of line */
+} fwts_log_line;
+
+/*
+ *  log held as one buffer of '\0' terminated lines and an index
+ *  of the lines in it. Line pointers are only valid until more
+ *  lines are appended as the buffer may be moved.
+ */
+typedef struct {
+	char *buffer;			/* log text, lines '\0' terminated */
+	size_t buffer_len;		/* bytes used in buffer */
+	size_t buffer_size;		/* allocated size of buffer */
+	fwts_log_line *lines;		/* line index, log order */
+	size_t len;			/* number of lines */
+	size_t lines_size;		/* allocated size of lines[] */
+	int kmsg_fd;			/* /dev/kmsg reader, -1 if not used */
+	uint64_t kmsg_seq;		/* next /dev/kmsg sequence number */
+	uint64_t kmsg_lost;		/* records overwritten before read */
+} fwts_log_index;
+
+#define fwts_log_index_foreach(iterator, index) \
+		for (iterator = (index)->lines; iterator < (index)->lines + (index)->len; iterator++)
+
+#define fwts_log_index_foreach_from(iterator, index, from) \
+		for (iterator = (index)->lines + (from); iterator < (index)->lines + (index)->len; iterator++)
+
+fwts_log_index *fwts_log_index_new(void);
+void            fwts_log_index_free(fwts_log_index *index);
+void            fwts_log_index_clear(fwts_log_index *index);
+char           *fwts_log_index_reserve(fwts_log_index *index, const size_t len);
+int             fwts_log_index_split(fwts_log_index *index, const size_t len);
+int             fwts_log_index_append(fwts_log_index *index, const char *text, const size_t len);
+fwts_list      *fwts_log_index_to_list(const fwts_log_index *index, const size_t from);
+
+static inline char *fwts_log_index_line(const fwts_log_index *index, const fwts_log_line *line)
+{
+	return index->buffer + line->offset;
+}
+
+static inline char *fwts_log_index_text(const fwts_log_index *index, const fwts_log_line *line)
+{
+	return index->buffer + line->text;
+}
+
+#endif
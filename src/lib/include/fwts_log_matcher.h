@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2026 Canonical
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef __FWTS_LOG_MATCHER_H__
+#define __FWTS_LOG_MATCHER_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "fwts_framework.h"
+#include "fwts_log_scan.h"
+
+#define FWTS_LOG_MATCHER_NONE		(0xffffffffU)
+
+/*
+ *  Aho-Corasick automaton state
+ */
+typedef struct {
+	uint32_t fail;			/* failure link */
+	uint32_t edges;			/* index of first edge in edges[] */
+	uint32_t n_edges;		/* number of edges, sorted by char */
+	uint32_t min_string;		/* lowest string pattern index matched on reaching this state */
+	uint32_t regex_out;		/* nearest state on failure chain ending a regex literal, 0 = none */
+	uint32_t regex_keys;		/* list of regexes whose literal ends here, index + 1, 0 = none */
+} fwts_log_matcher_state;
+
+typedef struct {
+	uint32_t next;			/* next state */
+	uint8_t ch;			/* transition char */
+} fwts_log_matcher_edge;
+
+/*
+ *  a regex pattern and the literal string any match must contain
+ */
+typedef struct {
+	uint32_t pattern;		/* index into pattern table */
+	uint32_t next_key;		/* next regex sharing same literal end state, index + 1 */
+	uint32_t seen;			/* generation of line the literal was last seen in */
+	bool has_literal;		/* false if no literal could be extracted */
+} fwts_log_matcher_regex;
+
+/*
+ *  compiled multi-pattern matcher for a fwts_log_pattern table
+ */
+typedef struct {
+	fwts_log_pattern *patterns;	/* pattern table, NULL pattern terminated */
+	uint32_t n_patterns;		/* number of patterns in table */
+	fwts_log_matcher_state *states;	/* automaton states, 0 is root */
+	uint32_t n_states;		/* number of states */
+	fwts_log_matcher_edge *edges;	/* state transitions */
+	uint32_t root_next[256];	/* dense transitions from root */
+	fwts_log_matcher_regex *regexes;/* regex patterns, in table order */
+	uint32_t n_regexes;		/* number of regex patterns */
+	uint32_t generation;		/* current line generation */
+} fwts_log_matcher;
+
+fwts_log_matcher *fwts_log_matcher_new(fwts_log_pattern *patterns);
+void              fwts_log_matcher_free(fwts_log_matcher *matcher);
+fwts_log_pattern *fwts_log_matcher_match(fwts_framework *fw, fwts_log_matcher *matcher, const char *line);
+size_t            fwts_log_matcher_regex_literal(const char *regex, char *literal, const size_t size);
+
+#endif
@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2026 Canonical
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef __FWTS_LOG_PATTERN_CACHE_H__
+#define __FWTS_LOG_PATTERN_CACHE_H__
+
+#include <stdint.h>
+#include <sys/stat.h>
+
+#include "fwts_framework.h"
+#include "fwts_log_scan.h"
+#include "fwts_log_matcher.h"
+
+#define FWTS_LOG_PATTERN_CACHE_MAGIC	(0x4843415053545746ULL)	/* "FWTSPACH" */
+#define FWTS_LOG_PATTERN_CACHE_VERSION	(1)
+
+/*
+ *  on-disk pattern table, all offsets are relative to the start
+ *  of the string area which follows the entries
+ */
+typedef struct {
+	uint64_t magic;			/* FWTS_LOG_PATTERN_CACHE_MAGIC */
+	uint32_t version;		/* FWTS_LOG_PATTERN_CACHE_VERSION */
+	uint32_t n_patterns;		/* number of entries */
+	uint64_t json_size;		/* size of json file table was parsed from */
+	int64_t  json_mtime_sec;	/* modification time of json file */
+	int64_t  json_mtime_nsec;
+	uint32_t strings_size;		/* size of string area */
+	uint32_t reserved;
+} __attribute__ ((packed)) fwts_log_pattern_cache_header;
+
+typedef struct {
+	uint32_t compare_mode;		/* fwts_compare_mode */
+	uint32_t level;			/* fwts_log_level */
+	uint32_t pattern;		/* offset of pattern string */
+	uint32_t advice;		/* offset of advice string */
+	uint32_t label;			/* offset of label string */
+} __attribute__ ((packed)) fwts_log_pattern_cache_entry;
+
+fwts_log_matcher *fwts_log_pattern_cache_get(fwts_framework *fw, const char *json_data_path, const char *table, const char *label);
+void              fwts_log_pattern_cache_free(void);
+int               fwts_log_pattern_cache_save(fwts_framework *fw, const char *filename, fwts_log_pattern *patterns, const struct stat *json_stat);
+fwts_log_pattern *fwts_log_pattern_cache_load(fwts_framework *fw, const char *filename, const struct stat *json_stat);
+
+#endif
@@ -23,6 +23,7 @@
 #include <regex.h>
 
 #include "fwts_json.h"
+#include "fwts_log_index.h"
 
 typedef enum {
 	FWTS_COMPARE_REGEX = 'r',
@@ -33,8 +34,8 @@ typedef enum {
 typedef struct {
 	fwts_compare_mode compare_mode;
 	fwts_log_level level;
-	const char *pattern;
-	const char *advice;
+	char *pattern;
+	char *advice;
 	char *label;
 	regex_t compiled;
 	bool compiled_ok;
@@ -47,10 +48,15 @@ void       fwts_log_free(fwts_list *list);
 fwts_list *fwts_log_find_changes(fwts_list *log_old, fwts_list *log_new);
 char      *fwts_log_remove_timestamp(char *text);
 int        fwts_log_scan(fwts_framework *fw, fwts_list *log, fwts_log_scan_func callback, fwts_log_progress_func progress, void *private, int *errors, bool remove_timestamp);
+int        fwts_log_index_scan(fwts_framework *fw, fwts_log_index *index, const size_t from, fwts_log_scan_func callback, fwts_log_progress_func progress, void *private, int *errors, bool remove_timestamp);
 char *fwts_log_unique_label(const char *str, const char *label);
 void       fwts_log_scan_patterns(fwts_framework *fw, char *line, int repeated, char *prevline, void *private, int *errors, const char *name, const char *advice);
+void       fwts_log_scan_pattern_report(fwts_framework *fw, const fwts_log_pattern *pattern, const char *line, int repeated, int *errors, const char *name, const char *advice);
 fwts_compare_mode fwts_log_compare_mode_str_to_val(const char *str);
 const char *fwts_json_str(fwts_framework *fw, const char *table, int index, json_object *obj, const char *key, bool log_error);
+void        fwts_log_pattern_compile(fwts_framework *fw, fwts_log_pattern *pattern);
+fwts_log_pattern *fwts_log_patterns_load(fwts_framework *fw, const char *json_data_path, const char *table, const char *label);
+void        fwts_log_patterns_free(fwts_log_pattern *patterns);
 int         fwts_log_check(fwts_framework *fw, const char *table, fwts_log_scan_func fwts_log_scan_patterns, fwts_log_progress_func progress, fwts_list *log, int *errors, const char *json_data_path, const char *label, bool remove_timestamp);
 int        fwts_log_regex_find(fwts_framework *fw, fwts_list *log, char *pattern, bool remove_timestamp);
 
@@ -20,6 +20,11 @@
 #ifndef __PCI_H__
 #define __PCI_H__
 
+#include <stdint.h>
+#include <stddef.h>
+
+#include "fwts_framework.h"
+
 /*
  *  PCI specific definitions
  */
@@ -197,14 +202,71 @@ typedef struct {
  	uint16_t slot_status2;
 } __attribute__ ((packed)) fwts_pcie_capability;
 
+/* Config space sizes, extended config space is only on PCIe devices */
+#define FWTS_PCI_CONFIG_HEADER_SIZE			(64)
+#define FWTS_PCI_CONFIG_SIZE				(256)
+#define FWTS_PCI_CONFIG_EXT_SIZE			(4096)
+
+/* Capability IDs cached for each device, lower IDs are all defined ones */
+#define FWTS_PCI_CAP_ID_MAX				(0x20)
+#define FWTS_PCI_EXT_CAP_ID_MAX				(0x40)
+
+/* No such device index in a PCI topology */
+#define FWTS_PCI_DEVICE_NONE				(UINT32_MAX)
+
+/*
+ *  a PCI device in a PCI topology snapshot
+ */
 typedef struct {
-	uint8_t segment;
+	uint16_t segment;
 	uint8_t bus;
 	uint8_t dev;
 	uint8_t func;
-	uint8_t config[256];
+	uint8_t header_type;		/* header type, multi-function bit masked off */
+	uint8_t secondary_bus;		/* bridges only */
+	uint8_t subordinate_bus;	/* bridges only */
+	char name[16];			/* sysfs name, e.g. 0000:00:1c.0 */
+	uint8_t *config;		/* config space */
+	uint16_t config_len;		/* bytes of config space read */
+	uint8_t cap[FWTS_PCI_CAP_ID_MAX];		/* capability offsets, 0 if absent */
+	uint16_t ext_cap[FWTS_PCI_EXT_CAP_ID_MAX];	/* extended capability offsets, 0 if absent */
+	uint32_t parent;		/* upstream bridge */
+	uint32_t child;			/* first device on secondary bus */
+	uint32_t sibling;		/* next device on the same bus */
 } fwts_pci_device;
 
+/*
+ *  snapshot of all PCI devices and their config space, sorted by
+ *  segment, bus and devfn with the config space of all devices held
+ *  in one buffer. Devices are referred to by index into devices[].
+ */
+typedef struct {
+	fwts_pci_device *devices;	/* devices, sorted by segment/bus/devfn */
+	uint32_t len;			/* number of devices */
+	uint8_t *config;		/* config space of all devices */
+	size_t config_len;		/* size of config buffer */
+	uint32_t *hash;			/* segment/bus/devfn to device lookup */
+	uint32_t hash_size;		/* power of 2 */
+} fwts_pci_topology;
+
+#define fwts_pci_topology_foreach(iterator, topology) \
+		for (iterator = (topology)->devices; iterator < (topology)->devices + (topology)->len; iterator++)
+
 const char *fwts_pci_description(const uint8_t class_code, const uint8_t subclass_code);
 
+fwts_pci_topology *fwts_pci_topology_new(fwts_framework *fw);
+fwts_pci_topology *fwts_pci_topology_new_headers(fwts_framework *fw);
+void               fwts_pci_topology_free(fwts_pci_topology *topology);
+fwts_pci_topology *fwts_pci_topology_get(fwts_framework *fw);
+void               fwts_pci_topology_put(void);
+fwts_pci_device   *fwts_pci_topology_find(const fwts_pci_topology *topology,
+	const uint16_t segment, const uint8_t bus, const uint8_t dev, const uint8_t func);
+fwts_pci_device   *fwts_pci_topology_find_name(const fwts_pci_topology *topology, const char *name);
+
+static inline fwts_pci_device *fwts_pci_topology_device(
+	const fwts_pci_topology *topology, const uint32_t index)
+{
+	return index == FWTS_PCI_DEVICE_NONE ? NULL : &topology->devices[index];
+}
+
 #endif
@@ -21,5 +21,7 @@
 
 int fwts_pm_debug_get(int *value);
 int fwts_pm_debug_set(const int value);
+int fwts_pm_print_times_get(int *value);
+int fwts_pm_print_times_set(const int value);
 
 #endif
@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2026 Canonical
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef __FWTS_PM_TIMING_H__
+#define __FWTS_PM_TIMING_H__
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "fwts_framework.h"
+
+/* Phase time that could not be determined */
+#define FWTS_PM_TIMING_UNKNOWN		(UINT32_MAX)
+
+/* Default drift allowed between the start and end of a run, percent */
+#define FWTS_PM_TIMING_DRIFT_DEFAULT	(20)
+
+typedef enum {
+	FWTS_PM_TIMING_SUSPEND,		/* kernel suspend */
+	FWTS_PM_TIMING_FIRMWARE_RESUME,	/* firmware resume, from ACPI FPDT */
+	FWTS_PM_TIMING_KERNEL_RESUME,	/* kernel resume */
+	FWTS_PM_TIMING_PHASES
+} fwts_pm_timing_phase;
+
+/*
+ *  timings of one suspend/resume cycle, in microseconds
+ */
+typedef struct {
+	uint32_t phase[FWTS_PM_TIMING_PHASES];
+	uint64_t s2idle_residency;	/* hardware sleep residency, 0 if not available */
+} fwts_pm_timing_cycle;
+
+/*
+ *  device suspend or resume callback times over all cycles
+ */
+typedef struct {
+	char *name;			/* device, e.g. "pci 0000:00:1f.3" */
+	uint32_t count;			/* callbacks timed */
+	uint64_t total;			/* total time, us */
+	uint32_t max;			/* longest time, us */
+	uint32_t max_cycle;		/* cycle of longest time */
+} fwts_pm_timing_device;
+
+typedef struct {
+	fwts_pm_timing_cycle *cycles;	/* timings, one per cycle */
+	size_t len;
+	size_t size;
+	fwts_pm_timing_device *devices;	/* resume callback times, sorted by name */
+	size_t devices_len;
+	size_t devices_size;
+	uint64_t fpdt_resume_count;	/* FPDT resume count at last read */
+} fwts_pm_timing;
+
+fwts_pm_timing *fwts_pm_timing_new(void);
+void fwts_pm_timing_free(fwts_pm_timing *timing);
+int  fwts_pm_timing_add(fwts_pm_timing *timing, const fwts_pm_timing_cycle *cycle);
+int  fwts_pm_timing_device_line(fwts_pm_timing *timing, const char *line);
+uint32_t fwts_pm_timing_firmware_resume(fwts_pm_timing *timing);
+int  fwts_pm_timing_check(fwts_framework *fw, fwts_pm_timing *timing, const int drift);
+int  fwts_pm_timing_export(fwts_framework *fw, const fwts_pm_timing *timing, const char *filename);
+
+#endif
@@ -186,11 +186,55 @@ typedef struct {
     uint8_t			device_path[0];
 } __attribute__ ((packed)) uefi_image_load_event;
 
+#define TPM2_MAX_DIGEST_SIZE	TPM2_SHA512_DIGEST_SIZE
+
+/* PCR banks replayed, sha1, sha256, sha384 and sha512 */
+#define FWTS_TPM_REPLAY_BANKS	(4)
+
+/* No diverging event found */
+#define FWTS_TPM_REPLAY_EVENT_NONE	(UINT32_MAX)
+
+/*
+ *  event log digest to extend into a PCR
+ */
+typedef struct {
+	uint32_t event;			/* event number in the log */
+	uint8_t pcr;			/* PCR index */
+} fwts_tpm_replay_event;
+
+/*
+ *  event log replay of one PCR bank
+ */
+typedef struct {
+	TPM2_ALG_ID alg;		/* hash algorithm */
+	const char *name;		/* bank name, e.g. "sha256" */
+	uint8_t size;			/* digest size */
+	fwts_tpm_replay_event *events;	/* events to extend, log order */
+	uint8_t *digests;		/* event digests, size bytes each */
+	size_t len;			/* number of events */
+	size_t events_size;		/* allocated size of events[] */
+	bool active;			/* bank read from the TPM */
+	uint8_t pcr[TPM2_FIRMWARE_PCR_COUNT][TPM2_MAX_DIGEST_SIZE];	/* replayed */
+	uint8_t actual[TPM2_FIRMWARE_PCR_COUNT][TPM2_MAX_DIGEST_SIZE];	/* read from TPM */
+	uint32_t pcr_events[TPM2_FIRMWARE_PCR_COUNT];	/* events extended into a PCR */
+	uint32_t diverge[TPM2_FIRMWARE_PCR_COUNT];	/* first diverging event */
+} fwts_tpm_replay_bank;
+
+typedef struct {
+	fwts_tpm_replay_bank banks[FWTS_TPM_REPLAY_BANKS];
+	uint8_t locality;		/* StartupLocality, initial PCR0 value */
+} fwts_tpm_replay;
+
 void fwts_tpm_data_hexdump(fwts_framework *fw, const uint8_t *data,
 	const size_t size, const char *str);
 bool fwts_tpm_extend_pcr(uint8_t *pcr, const size_t pcr_len,
 	TPM2_ALG_ID alg, const uint8_t *data);
 uint8_t fwts_tpm_get_hash_size(const TPM2_ALG_ID hash);
+void fwts_tpm_replay_init(fwts_tpm_replay *replay);
+void fwts_tpm_replay_free(fwts_tpm_replay *replay);
+int fwts_tpm_replay_add(fwts_tpm_replay *replay, const uint32_t event,
+	const uint32_t pcr, const TPM2_ALG_ID alg, const uint8_t *digest);
+int fwts_tpm_replay_verify(fwts_tpm_replay *replay, const char *tpm);
 
 PRAGMA_POP
 
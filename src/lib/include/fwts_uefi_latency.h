@@ -0,0 +1,33 @@
+/*
+ * Copyright (C) 2026 Canonical
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef __FWTS_UEFI_LATENCY_H__
+#define __FWTS_UEFI_LATENCY_H__
+
+#include "fwts_framework.h"
+
+/* Default outlier threshold for all runtime services, in microseconds */
+#define FWTS_UEFI_LATENCY_THRESHOLD_DEFAULT	(100000)
+
+int fwts_uefi_latency_threshold_set(const char *str);
+void fwts_uefi_latency_init(fwts_framework *fw);
+int fwts_uefi_latency_check(fwts_framework *fw);
+int fwts_uefi_rt_ioctl(const int fd, const unsigned long request, void *arg);
+
+#endif
@@ -24,6 +24,10 @@
 #include <string.h>
 #include <unistd.h>
 #include <inttypes.h>
+#include <errno.h>
+#include <poll.h>
+#include <sys/types.h>
+#include <sys/wait.h>
 
 /* acpica headers */
 #pragma GCC diagnostic ignored "-Wunused-parameter"
@@ -289,17 +293,189 @@ static const acpi_eval_error errors[] = {
 static fwts_list *fwts_object_names;
 static bool fwts_acpi_initialized = false;
 
+/*
+ *  Shared namespace session, the namespace is loaded once by the
+ *  framework and tests run in processes forked from it, so they all
+ *  start from the same pristine namespace and anything they change
+ *  is thrown away when they exit
+ */
+static bool fwts_acpi_session;		/* true if namespace is shared */
+static bool fwts_acpi_session_failed;	/* true if it could not be loaded */
+static pid_t fwts_acpi_session_pid;	/* process that loaded it */
+static void *fwts_acpi_session_log;	/* log captured when loading it */
+static size_t fwts_acpi_session_log_len;
+
+/*
+ *  Namespace index, built once the namespace has been loaded. Object
+ *  paths are grouped by their final 4 char NameSeg, kept in namespace
+ *  order within each group, and a hash of the NameSegs gives the
+ *  group for a name. A copy of the paths sorted by name is kept for
+ *  prefix (sub-tree) lookups.
+ */
+typedef struct {
+	uint32_t seg;		/* final NameSeg */
+	uint32_t start;		/* first path in fwts_object_index.seg_paths */
+	uint32_t count;		/* number of paths ending in this NameSeg */
+} fwts_acpi_object_seg;
+
+static struct {
+	fwts_acpi_object_seg *segs;	/* open addressed NameSeg hash */
+	uint32_t segs_size;		/* size of hash, power of 2 */
+	char **seg_paths;		/* paths grouped by final NameSeg */
+	char **sorted_paths;		/* paths in sorted order */
+	size_t n_paths;			/* number of paths in the index */
+} fwts_object_index;
+
+/*
+ *  fwts_acpi_object_seg_key()
+ *	get final 4 char NameSeg of a path as a hash key, false if
+ *	the path is too short to have one
+ */
+static inline bool fwts_acpi_object_seg_key(
+	const char *path,
+	const size_t len,
+	uint32_t *key)
+{
+	if (len < 4)
+		return false;
+	memcpy(key, path + len - 4, sizeof(*key));
+	return true;
+}
+
+/*
+ *  fwts_acpi_object_seg_lookup()
+ *	find hash slot for a NameSeg, the slot is empty (count 0) if
+ *	the NameSeg is not in the index
+ */
+static fwts_acpi_object_seg *fwts_acpi_object_seg_lookup(const uint32_t key)
+{
+	uint32_t mask = fwts_object_index.segs_size - 1;
+	uint32_t i = (key * 0x9e3779b1U) & mask;
+
+	while (fwts_object_index.segs[i].count &&
+	       fwts_object_index.segs[i].seg != key)
+		i = (i + 1) & mask;
+
+	return &fwts_object_index.segs[i];
+}
+
+static int fwts_acpi_object_path_cmp(const void *a, const void *b)
+{
+	return strcmp(*(char * const *)a, *(char * const *)b);
+}
+
+/*
+ *  fwts_acpi_object_index_free()
+ *	free namespace index
+ */
+static void fwts_acpi_object_index_free(void)
+{
+	free(fwts_object_index.segs);
+	free(fwts_object_index.seg_paths);
+	free(fwts_object_index.sorted_paths);
+	memset(&fwts_object_index, 0, sizeof(fwts_object_index));
+}
+
+/*
+ *  fwts_acpi_object_index_build()
+ *	build namespace index from the list of object names
+ */
+static int fwts_acpi_object_index_build(void)
+{
+	fwts_list_link *item;
+	uint32_t size = 16, i, start, len;
+	size_t n = 0;
+
+	if ((fwts_object_names == NULL) ||
+	    (fwts_list_len(fwts_object_names) < 0))
+		return FWTS_ERROR;
+	len = (uint32_t)fwts_list_len(fwts_object_names);
+
+	while (size < 2 * len)
+		size <<= 1;
+
+	fwts_object_index.segs = calloc(size, sizeof(*fwts_object_index.segs));
+	fwts_object_index.seg_paths = calloc(len + 1, sizeof(char *));
+	fwts_object_index.sorted_paths = calloc(len + 1, sizeof(char *));
+	if (!fwts_object_index.segs ||
+	    !fwts_object_index.seg_paths ||
+	    !fwts_object_index.sorted_paths) {
+		fwts_acpi_object_index_free();
+		return FWTS_ERROR;
+	}
+	fwts_object_index.segs_size = size;
+
+	/* Count paths per NameSeg */
+	fwts_list_foreach(item, fwts_object_names) {
+		char *path = fwts_list_data(char *, item);
+		uint32_t key;
+
+		fwts_object_index.sorted_paths[n++] = path;
+		if (fwts_acpi_object_seg_key(path, strlen(path), &key)) {
+			fwts_acpi_object_seg *seg = fwts_acpi_object_seg_lookup(key);
+
+			seg->seg = key;
+			seg->count++;
+		}
+	}
+	fwts_object_index.n_paths = n;
+
+	/* Give each NameSeg its slice of seg_paths */
+	for (start = 0, i = 0; i < size; i++) {
+		fwts_acpi_object_seg *seg = &fwts_object_index.segs[i];
+
+		seg->start = start;
+		start += seg->count;
+	}
+
+	/* Fill the slices in namespace order, start is used as a cursor */
+	fwts_list_foreach(item, fwts_object_names) {
+		char *path = fwts_list_data(char *, item);
+		uint32_t key;
+
+		if (fwts_acpi_object_seg_key(path, strlen(path), &key)) {
+			fwts_acpi_object_seg *seg = fwts_acpi_object_seg_lookup(key);
+
+			fwts_object_index.seg_paths[seg->start++] = path;
+		}
+	}
+	for (i = 0; i < size; i++)
+		fwts_object_index.segs[i].start -= fwts_object_index.segs[i].count;
+
+	qsort(fwts_object_index.sorted_paths, n, sizeof(char *),
+		fwts_acpi_object_path_cmp);
+
+	return FWTS_OK;
+}
+
 /*
  *  fwts_acpi_init()
  *	Initialise ACPIA engine and collect method namespace
  */
 int fwts_acpi_init(fwts_framework *fw)
 {
+	if (fwts_acpi_session) {
+		/*
+		 *  Forked from the session, so use its namespace and
+		 *  log what loading it would have logged. Otherwise
+		 *  this would change the shared namespace, so drop it
+		 */
+		if (getpid() != fwts_acpi_session_pid) {
+			(void)fwts_log_capture_replay(fw, fwts_acpi_session_log,
+				fwts_acpi_session_log_len);
+			return FWTS_OK;
+		}
+		fwts_acpi_session_deinit(fw);
+	}
+
 	if (fwts_acpica_init(fw) != FWTS_OK)
 		return FWTS_ERROR;
 
 	/* Gather all object names */
 	fwts_object_names = fwts_acpica_get_object_names(0);
+	if (fwts_acpi_object_index_build() != FWTS_OK)
+		fwts_log_error(fw, "Cannot build ACPI namespace index, "
+			"falling back to namespace scans.");
 	fwts_acpi_initialized = true;
 
 	return FWTS_OK;
@@ -315,7 +491,12 @@ int fwts_acpi_deinit(fwts_framework *fw)
 
 	FWTS_UNUSED(fw);
 
+	/* Forked from the session, the namespace goes when we exit */
+	if (fwts_acpi_session)
+		return FWTS_OK;
+
 	if (fwts_acpi_initialized) {
+		fwts_acpi_object_index_free();
 		fwts_list_free(fwts_object_names, free);
 		fwts_object_names = NULL;
 		ret = fwts_acpica_deinit();
@@ -326,6 +507,58 @@ int fwts_acpi_deinit(fwts_framework *fw)
 	return ret;
 }
 
+/*
+ *  fwts_acpi_session_init()
+ *	load the namespace to be shared by tests run in processes
+ *	forked from this one, returns FWTS_OK if there is a session
+ */
+int fwts_acpi_session_init(fwts_framework *fw)
+{
+	int ret;
+
+	if (fwts_acpi_session)
+		return FWTS_OK;
+
+	/* Can't capture what loading it logs inside another capture */
+	if (fwts_acpi_session_failed || fwts_acpi_initialized ||
+	    fwts_log_capturing())
+		return FWTS_ERROR;
+
+	fwts_log_capture_begin();
+	ret = fwts_acpi_init(fw);
+	fwts_acpi_session_log = fwts_log_capture_end(&fwts_acpi_session_log_len);
+
+	if (ret != FWTS_OK) {
+		/* Tests load it themselves and log the failure */
+		free(fwts_acpi_session_log);
+		fwts_acpi_session_log = NULL;
+		fwts_acpi_session_log_len = 0;
+		fwts_acpi_session_failed = true;
+		return FWTS_ERROR;
+	}
+	fwts_acpi_session = true;
+	fwts_acpi_session_pid = getpid();
+
+	return FWTS_OK;
+}
+
+/*
+ *  fwts_acpi_session_deinit()
+ *	free the shared namespace
+ */
+void fwts_acpi_session_deinit(fwts_framework *fw)
+{
+	if (!fwts_acpi_session)
+		return;
+
+	fwts_acpi_session = false;
+	(void)fwts_acpi_deinit(fw);
+
+	free(fwts_acpi_session_log);
+	fwts_acpi_session_log = NULL;
+	fwts_acpi_session_log_len = 0;
+}
+
 /*
  *  fwts_acpi_object_get_names()
  *	return list of object names
@@ -335,20 +568,139 @@ fwts_list *fwts_acpi_object_get_names(void)
 	return fwts_object_names;
 }
 
+/*
+ *  fwts_acpi_object_name_matches()
+ *	true if the object path ends with name
+ */
+static inline bool fwts_acpi_object_name_matches(
+	const char *path,
+	const char *name,
+	const size_t name_len)
+{
+	size_t len = strlen(path);
+
+	return (len >= name_len) &&
+	       (strncmp(name, path + len - name_len, name_len) == 0);
+}
+
+/*
+ *  fwts_acpi_object_find_seg()
+ *	return the paths of all objects whose final NameSeg is seg, in
+ *	namespace order, and the number of paths in count. The array
+ *	belongs to the namespace index, returns NULL if none are found.
+ */
+char **fwts_acpi_object_find_seg(const char *seg, size_t *count)
+{
+	const fwts_acpi_object_seg *entry;
+	uint32_t key;
+
+	*count = 0;
+	if (!fwts_object_index.segs || (strlen(seg) != 4))
+		return NULL;
+
+	memcpy(&key, seg, sizeof(key));
+	entry = fwts_acpi_object_seg_lookup(key);
+	if (entry->count == 0)
+		return NULL;
+
+	*count = entry->count;
+	return &fwts_object_index.seg_paths[entry->start];
+}
+
+/*
+ *  fwts_acpi_object_find_subtree()
+ *	return the paths of all objects that start with path, in sorted
+ *	order, and the number of paths in count. The array belongs to
+ *	the namespace index, returns NULL if none are found.
+ */
+char **fwts_acpi_object_find_subtree(const char *path, size_t *count)
+{
+	const size_t path_len = strlen(path);
+	size_t lo = 0, hi = fwts_object_index.n_paths, end;
+
+	*count = 0;
+	if (!fwts_object_index.sorted_paths)
+		return NULL;
+
+	/* Lower bound of path */
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+
+		if (strcmp(fwts_object_index.sorted_paths[mid], path) < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	for (end = lo; end < fwts_object_index.n_paths; end++)
+		if (strncmp(fwts_object_index.sorted_paths[end], path, path_len))
+			break;
+	if (end == lo)
+		return NULL;
+
+	*count = end - lo;
+	return &fwts_object_index.sorted_paths[lo];
+}
+
+/*
+ *  fwts_acpi_object_find_all()
+ *	return a list of all the object paths that end with name, in
+ *	namespace order. Free the list with fwts_list_free(list, NULL).
+ */
+fwts_list *fwts_acpi_object_find_all(const char *name)
+{
+	const size_t name_len = strlen(name);
+	fwts_list *list;
+
+	if (fwts_object_names == NULL)
+		return NULL;
+	if ((list = fwts_list_new()) == NULL)
+		return NULL;
+
+	if (fwts_object_index.segs && (name_len >= 4)) {
+		char **paths;
+		size_t i, count;
+
+		paths = fwts_acpi_object_find_seg(name + name_len - 4, &count);
+		for (i = 0; i < count; i++)
+			if (fwts_acpi_object_name_matches(paths[i], name, name_len))
+				fwts_list_append(list, paths[i]);
+	} else {
+		fwts_list_link *item;
+
+		fwts_list_foreach(item, fwts_object_names) {
+			char *path = fwts_list_data(char *, item);
+
+			if (fwts_acpi_object_name_matches(path, name, name_len))
+				fwts_list_append(list, path);
+		}
+	}
+	return list;
+}
+
 /*
  *  fwts_acpi_object_exists()
  *	return first matching name
  */
 char *fwts_acpi_object_exists(const char *name)
 {
-	size_t name_len = strlen(name);
+	const size_t name_len = strlen(name);
 	fwts_list_link	*item;
 
+	if (fwts_object_index.segs && (name_len >= 4)) {
+		char **paths;
+		size_t i, count;
+
+		paths = fwts_acpi_object_find_seg(name + name_len - 4, &count);
+		for (i = 0; i < count; i++)
+			if (fwts_acpi_object_name_matches(paths[i], name, name_len))
+				return paths[i];
+		return NULL;
+	}
+
 	fwts_list_foreach(item, fwts_object_names) {
 		char *method_name = fwts_list_data(char*, item);
-		size_t len = strlen(method_name);
 
-		if (strncmp(name, method_name + len - name_len, name_len) == 0)
+		if (fwts_acpi_object_name_matches(method_name, name, name_len))
 			return method_name;
 	}
 	return NULL;
@@ -485,6 +837,353 @@ ACPI_STATUS fwts_acpi_object_evaluate(fwts_framework *fw,
 	return AcpiEvaluateObject(NULL, name, arg_list, buf);
 }
 
+/*
+ *  Record sent back from a parallel evaluation worker for each
+ *  object, followed by buf_len bytes of returned object and then
+ *  log_len bytes of captured log output
+ */
+typedef struct {
+	uint32_t index;		/* index of object in names[] */
+	uint32_t status;	/* ACPI_STATUS of evaluation */
+	int32_t sem_acquired;	/* semaphores acquired */
+	int32_t sem_released;	/* semaphores released */
+	fwts_results results;	/* results counted while evaluating */
+	uint64_t buf_base;	/* address of returned buffer in the worker */
+	uint64_t buf_len;	/* size of returned buffer */
+	uint64_t log_len;	/* size of captured log output */
+} fwts_acpi_object_eval_record;
+
+typedef struct {
+	pid_t pid;		/* worker pid */
+	int fd;			/* read end of worker pipe */
+	char *data;		/* data read from worker */
+	size_t len;		/* amount of data read */
+	size_t size;		/* size of data buffer */
+} fwts_acpi_object_eval_worker;
+
+/*
+ *  fwts_acpi_object_write()
+ *	write all of a buffer to a pipe
+ */
+static int fwts_acpi_object_write(const int fd, const void *buf, size_t len)
+{
+	const char *ptr = buf;
+
+	while (len > 0) {
+		ssize_t n = write(fd, ptr, len);
+
+		if (n < 0) {
+			if (errno == EINTR)
+				continue;
+			return FWTS_ERROR;
+		}
+		ptr += n;
+		len -= n;
+	}
+	return FWTS_OK;
+}
+
+/*
+ *  fwts_acpi_object_relocate()
+ *	fix up the pointers of an object returned in an ACPI_ALLOCATE_BUFFER
+ *	buffer after it has been copied from base to new_base
+ */
+static void fwts_acpi_object_relocate(
+	ACPI_OBJECT *obj,
+	const uintptr_t base,
+	const uintptr_t len,
+	char *new_base,
+	const int depth)
+{
+	uint32_t i;
+
+#define RELOCATE(ptr)							\
+	do {								\
+		if (((uintptr_t)(ptr) >= base) &&			\
+		    ((uintptr_t)(ptr) < base + len))			\
+			(ptr) = (void *)(new_base +			\
+				((uintptr_t)(ptr) - base));		\
+	} while (0)
+
+	if (depth > 32)
+		return;
+
+	switch (obj->Type) {
+	case ACPI_TYPE_STRING:
+		RELOCATE(obj->String.Pointer);
+		break;
+	case ACPI_TYPE_BUFFER:
+		RELOCATE(obj->Buffer.Pointer);
+		break;
+	case ACPI_TYPE_PACKAGE:
+		RELOCATE(obj->Package.Elements);
+		for (i = 0; i < obj->Package.Count; i++)
+			fwts_acpi_object_relocate(&obj->Package.Elements[i],
+				base, len, new_base, depth + 1);
+		break;
+	default:
+		break;
+	}
+#undef RELOCATE
+}
+
+/*
+ *  fwts_acpi_object_evaluate_worker()
+ *	evaluate every jobs'th object starting at names[first] and send
+ *	the results down the pipe, this runs in a forked child
+ */
+static void fwts_acpi_object_evaluate_worker(
+	fwts_framework *fw,
+	char **names,
+	const int n,
+	ACPI_OBJECT_LIST *arg_list,
+	const int first,
+	const int jobs,
+	const int fd)
+{
+	int i;
+
+	for (i = first; i < n; i += jobs) {
+		fwts_acpi_object_eval_record record;
+		ACPI_BUFFER buf;
+		ACPI_STATUS status;
+		int sem_acquired, sem_released;
+		size_t log_len;
+		void *log;
+
+		fwts_log_capture_begin();
+		fwts_results_zero(&fw->minor_tests);
+		fwts_acpica_sem_count_clear();
+		status = fwts_acpi_object_evaluate(fw, names[i], arg_list, &buf);
+		fwts_acpica_sem_count_get(&sem_acquired, &sem_released);
+		log = fwts_log_capture_end(&log_len);
+
+		memset(&record, 0, sizeof(record));
+		record.index = i;
+		record.status = status;
+		record.sem_acquired = sem_acquired;
+		record.sem_released = sem_released;
+		record.results = fw->minor_tests;
+		if (ACPI_SUCCESS(status) && buf.Pointer) {
+			record.buf_base = (uintptr_t)buf.Pointer;
+			record.buf_len = buf.Length;
+		}
+		record.log_len = log_len;
+
+		if ((fwts_acpi_object_write(fd, &record, sizeof(record)) != FWTS_OK) ||
+		    (fwts_acpi_object_write(fd, buf.Pointer, record.buf_len) != FWTS_OK) ||
+		    (fwts_acpi_object_write(fd, log, log_len) != FWTS_OK)) {
+			free(log);
+			free(buf.Pointer);
+			_exit(EXIT_FAILURE);
+		}
+		free(log);
+		free(buf.Pointer);
+	}
+	_exit(EXIT_SUCCESS);
+}
+
+/*
+ *  fwts_acpi_object_evaluate_parse()
+ *	unpack the results sent back by a worker
+ */
+static void fwts_acpi_object_evaluate_parse(
+	const fwts_acpi_object_eval_worker *worker,
+	const int n,
+	fwts_acpi_object_result *results)
+{
+	const char *ptr = worker->data;
+	const char *end = ptr + worker->len;
+
+	while (ptr + sizeof(fwts_acpi_object_eval_record) <= end) {
+		fwts_acpi_object_eval_record record;
+		fwts_acpi_object_result *result;
+
+		memcpy(&record, ptr, sizeof(record));
+		ptr += sizeof(record);
+		if ((record.index >= (uint32_t)n) ||
+		    ((uint64_t)(end - ptr) < record.buf_len + record.log_len))
+			break;
+		result = &results[record.index];
+
+		result->status = record.status;
+		result->sem_acquired = record.sem_acquired;
+		result->sem_released = record.sem_released;
+		result->results = record.results;
+		if (record.buf_len && (result->buf.Pointer = malloc(record.buf_len)) != NULL) {
+			memcpy(result->buf.Pointer, ptr, record.buf_len);
+			result->buf.Length = record.buf_len;
+			fwts_acpi_object_relocate(result->buf.Pointer,
+				record.buf_base, record.buf_len,
+				result->buf.Pointer, 0);
+		}
+		ptr += record.buf_len;
+		if (record.log_len && (result->log = malloc(record.log_len)) != NULL) {
+			memcpy(result->log, ptr, record.log_len);
+			result->log_len = record.log_len;
+		}
+		ptr += record.log_len;
+		result->evaluated = true;
+	}
+}
+
+/*
+ *  fwts_acpi_object_evaluate_parallel()
+ *	evaluate n objects in up to jobs forked worker processes, each
+ *	with its own copy of the namespace, so only use this for objects
+ *	that have no side effects. Results are returned in results[] in
+ *	the same order as names[], with the log output from each
+ *	evaluation captured for the caller to replay with
+ *	fwts_log_capture_replay() and the results it counted to add
+ *	to fw->minor_tests. Free them with
+ *	fwts_acpi_object_results_free().
+ */
+int fwts_acpi_object_evaluate_parallel(
+	fwts_framework *fw,
+	char **names,
+	const int n,
+	ACPI_OBJECT_LIST *arg_list,
+	int jobs,
+	fwts_acpi_object_result *results)
+{
+	fwts_acpi_object_eval_worker *workers;
+	struct pollfd *pfds;
+	int i, active = 0;
+
+	memset(results, 0, n * sizeof(*results));
+	for (i = 0; i < n; i++)
+		results[i].name = names[i];
+
+	if (jobs > n)
+		jobs = n;
+	if (jobs < 1)
+		return FWTS_OK;
+
+	if ((workers = calloc(jobs, sizeof(*workers))) == NULL)
+		return FWTS_ERROR;
+	if ((pfds = calloc(jobs, sizeof(*pfds))) == NULL) {
+		free(workers);
+		return FWTS_ERROR;
+	}
+
+	/* Don't let the workers inherit unflushed log output */
+	fflush(NULL);
+
+	for (i = 0; i < jobs; i++) {
+		int fds[2];
+
+		workers[i].fd = -1;
+		workers[i].pid = -1;
+		if (pipe(fds) < 0)
+			continue;
+		workers[i].pid = fork();
+		if (workers[i].pid < 0) {
+			(void)close(fds[0]);
+			(void)close(fds[1]);
+			continue;
+		}
+		if (workers[i].pid == 0) {
+			int j;
+
+			/* Drop read ends of pipes to other workers */
+			for (j = 0; j < i; j++)
+				if (workers[j].fd >= 0)
+					(void)close(workers[j].fd);
+			(void)close(fds[0]);
+			fwts_acpi_object_evaluate_worker(fw, names, n,
+				arg_list, i, jobs, fds[1]);
+		}
+		(void)close(fds[1]);
+		workers[i].fd = fds[0];
+		active++;
+	}
+
+	/* Drain all the pipes so no worker blocks on a full pipe */
+	while (active > 0) {
+		int nfds = 0;
+
+		for (i = 0; i < jobs; i++) {
+			if (workers[i].fd < 0)
+				continue;
+			pfds[nfds].fd = workers[i].fd;
+			pfds[nfds].events = POLLIN;
+			pfds[nfds].revents = 0;
+			nfds++;
+		}
+		if (poll(pfds, nfds, -1) < 0) {
+			if (errno == EINTR)
+				continue;
+			break;
+		}
+		for (i = 0; i < jobs; i++) {
+			fwts_acpi_object_eval_worker *worker = &workers[i];
+			int j;
+			ssize_t len;
+
+			if (worker->fd < 0)
+				continue;
+			for (j = 0; j < nfds; j++)
+				if (pfds[j].fd == worker->fd)
+					break;
+			if ((j == nfds) || !pfds[j].revents)
+				continue;
+
+			if (worker->size - worker->len < 65536) {
+				size_t size = worker->size ? worker->size * 2 : 131072;
+				char *data = realloc(worker->data, size);
+
+				if (!data) {
+					(void)close(worker->fd);
+					worker->fd = -1;
+					active--;
+					continue;
+				}
+				worker->data = data;
+				worker->size = size;
+			}
+			len = read(worker->fd, worker->data + worker->len,
+				worker->size - worker->len);
+			if (len > 0) {
+				worker->len += len;
+			} else if ((len == 0) || (errno != EINTR)) {
+				(void)close(worker->fd);
+				worker->fd = -1;
+				active--;
+			}
+		}
+	}
+
+	for (i = 0; i < jobs; i++) {
+		if (workers[i].fd >= 0)
+			(void)close(workers[i].fd);
+		if (workers[i].pid > 0) {
+			int status;
+
+			(void)waitpid(workers[i].pid, &status, 0);
+		}
+		fwts_acpi_object_evaluate_parse(&workers[i], n, results);
+		free(workers[i].data);
+	}
+	free(pfds);
+	free(workers);
+
+	return FWTS_OK;
+}
+
+/*
+ *  fwts_acpi_object_results_free()
+ *	free results from fwts_acpi_object_evaluate_parallel()
+ */
+void fwts_acpi_object_results_free(fwts_acpi_object_result *results, const int n)
+{
+	int i;
+
+	for (i = 0; i < n; i++) {
+		free(results[i].buf.Pointer);
+		free(results[i].log);
+	}
+}
+
 int fwts_method_check_type__(
 	fwts_framework *fw,
 	const char *name,
@@ -291,6 +291,8 @@ int fwts_acpi_free_tables(void)
 			memset(&tables[i], 0, sizeof(fwts_acpi_table_info));
 		}
 	}
+	acpi_tables_loaded = ACPI_TABLES_NOT_LOADED;
+
 	return FWTS_OK;
 }
 
@@ -556,13 +558,44 @@ static uint32_t fwts_fake_physical_addr(const size_t size)
 	return addr;
 }
 
+/*
+ *  fwts_acpi_dump_gets()
+ *	fgets() equivalent, get the next line of acpidump text that
+ *	spans pos..end, advancing pos past the line
+ */
+static char *fwts_acpi_dump_gets(
+	char *buffer,
+	const size_t size,
+	const char **pos,
+	const char *end)
+{
+	const char *nl;
+	size_t n;
+
+	if (*pos >= end)
+		return NULL;
+
+	n = (size_t)(end - *pos);
+	if (n > size - 1)
+		n = size - 1;
+	if ((nl = memchr(*pos, '\n', n)) != NULL)
+		n = (size_t)(nl - *pos) + 1;
+
+	memcpy(buffer, *pos, n);
+	buffer[n] = '\0';
+	*pos += n;
+
+	return buffer;
+}
+
 /*
  *  fwts_acpi_load_table_from_acpidump()
  *	Load an ACPI table from the output of acpidump or fwts --dump
  */
 static uint8_t *fwts_acpi_load_table_from_acpidump(
 	fwts_framework *fw,
-	FILE *fp,
+	const char **pos,
+	const char *end,
 	char *name,
 	uint64_t *addr,
 	size_t *size)
@@ -573,13 +606,13 @@ static uint8_t *fwts_acpi_load_table_from_acpidump(
 	uint8_t *table;
 	uint8_t *tmp = NULL;
 	char *ptr;
-	size_t len = 0;
+	size_t len = 0, tmp_size = 0;
 	unsigned long long table_addr;
 	ptrdiff_t name_len;
 
 	*size = 0;
 
-	if (fgets(buffer, sizeof(buffer), fp) == NULL)
+	if (fwts_acpi_dump_gets(buffer, sizeof(buffer), pos, end) == NULL)
 		return NULL;
 
 	/*
@@ -621,7 +654,7 @@ static uint8_t *fwts_acpi_load_table_from_acpidump(
 	 *  anything not conforming to this rigid format will be prematurely
 	 *  aborted
 	 */
-	while (fgets(buffer, sizeof(buffer), fp) ) {
+	while (fwts_acpi_dump_gets(buffer, sizeof(buffer), pos, end)) {
 		uint8_t *new_tmp;
 		int n;
 
@@ -680,12 +713,18 @@ static uint8_t *fwts_acpi_load_table_from_acpidump(
 		}
 
 		len += n;
-		if ((new_tmp = realloc(tmp, len)) == NULL) {
-			free(tmp);
-			fwts_log_error(fw, "ACPI table parser run out of memory parsing table '%s'.", name);
-			return NULL;
-		} else
+		if (len > tmp_size) {
+			/* Grow geometrically, tables can be many thousands of rows */
+			const size_t new_size = tmp_size ? tmp_size * 2 : 4096;
+
+			if ((new_tmp = realloc(tmp, new_size)) == NULL) {
+				free(tmp);
+				fwts_log_error(fw, "ACPI table parser run out of memory parsing table '%s'.", name);
+				return NULL;
+			}
 			tmp = new_tmp;
+			tmp_size = new_size;
+		}
 
 		memcpy(tmp + offset, data, n);
 
@@ -724,28 +763,32 @@ static uint8_t *fwts_acpi_load_table_from_acpidump(
  */
 static int fwts_acpi_load_tables_from_acpidump(fwts_framework *fw)
 {
-	FILE *fp;
+	fwts_blob blob;
+	const char *pos, *end;
 
 	if (!fw->acpi_table_acpidump_file)
 		return FWTS_ERROR;
 
-	if ((fp = fopen(fw->acpi_table_acpidump_file, "r")) == NULL) {
+	if (fwts_blob_load(&blob, fw->acpi_table_acpidump_file) != FWTS_OK) {
 		fwts_log_error(fw, "Cannot open '%s' to read ACPI tables.",
 			fw->acpi_table_acpidump_file);
 		return FWTS_ERROR;
 	}
 
-	while (!feof(fp)) {
+	pos = (const char *)blob.data;
+	end = pos + blob.len;
+
+	while (pos < end) {
 		uint64_t addr;
 		uint8_t *table;
 		size_t length;
 		char name[16];
 
-		if ((table = fwts_acpi_load_table_from_acpidump(fw, fp, name, &addr, &length)) != NULL)
+		if ((table = fwts_acpi_load_table_from_acpidump(fw, &pos, end, name, &addr, &length)) != NULL)
 			fwts_acpi_add_table(name, table, addr, length, FWTS_ACPI_TABLE_FROM_FILE);
 	}
 
-	(void)fclose(fp);
+	fwts_blob_free(&blob);
 
 	return FWTS_OK;
 }
@@ -756,61 +799,29 @@ static int fwts_acpi_load_tables_from_acpidump(fwts_framework *fw)
  */
 static uint8_t *fwts_acpi_load_table_from_file(const int fd, size_t *length)
 {
-	uint8_t *ptr = NULL, *tmp;
-	size_t size = 0;
-	char buffer[4096];
+	fwts_blob blob;
+	uint8_t *table;
 
 	*length = 0;
 
-	/*
-	 *  read table into buffer in the normal heap
-	 *  so we don't have to do expensive fwts_low_reallocs
-	 *  per iteration on long tables
-	 */
-	for (;;) {
-		ssize_t n = read(fd, buffer, sizeof(buffer));
-
-		if (n == 0)
-			break;
-		if (n < 0) {
-			if (errno != EINTR && errno != EAGAIN) {
-				fwts_low_free(ptr);
-				return NULL;
-			}
-			continue;
-		}
-		if (n > (ssize_t)sizeof(buffer))
-			goto err;	/* Unlikely */
-		if (size + n > 0xffffffff)
-			goto err;	/* Very unlikely */
-
-		if ((tmp = (uint8_t*)realloc(ptr, size + n + 1)) == NULL) {
-			free(ptr);
-			return NULL;
-		}
-		ptr = tmp;
-		memcpy(ptr + size, buffer, n);
-		size += n;
-	}
-
-	if (!ptr || !size)
-		goto err_no_data;
+	if (fwts_blob_load_fd(&blob, fd) != FWTS_OK)
+		return NULL;
+	if ((blob.len == 0) || (blob.len > 0xffffffff))
+		goto err;	/* Very unlikely */
 
 	/*
 	 *  ..and copy table into a 32 bit memory space buffer
 	 */
-	if ((tmp = fwts_low_malloc(size)) == NULL)
+	if ((table = fwts_low_malloc(blob.len)) == NULL)
 		goto err;
 
-	*length = size;
-	memcpy(tmp, ptr, size);
-	free(ptr);
-	return tmp;
+	*length = blob.len;
+	memcpy(table, blob.data, blob.len);
+	fwts_blob_free(&blob);
+	return table;
 
 err:
-	free(ptr);
-err_no_data:
-	*length = 0;
+	fwts_blob_free(&blob);
 	return NULL;
 }
 
@@ -0,0 +1,189 @@
+/*
+ * Copyright (C) 2026 Canonical
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/vfs.h>
+#include <sys/mman.h>
+
+#include "fwts.h"
+
+/*
+ *  pseudo file systems, the file size is not the size of the
+ *  contents and the files generally cannot be mapped
+ */
+#define PROC_SUPER_MAGIC	((__SWORD_TYPE)0x9fa0)
+#define SYSFS_MAGIC		((__SWORD_TYPE)0x62656572)
+#define SECURITYFS_MAGIC	((__SWORD_TYPE)0x73636673)
+#define DEBUGFS_MAGIC		((__SWORD_TYPE)0x64626720)
+#define TRACEFS_MAGIC		((__SWORD_TYPE)0x74726163)
+#define EFIVARFS_MAGIC		((__SWORD_TYPE)0xde5e81e4)
+
+#define FWTS_BLOB_READ_MIN	(4096)
+
+/*
+ *  fwts_blob_mappable()
+ *	can a file be mapped rather than read
+ */
+static bool fwts_blob_mappable(const int fd, const struct stat *buf)
+{
+	struct statfs statbuf;
+
+	if (!S_ISREG(buf->st_mode) || (buf->st_size <= 0))
+		return false;
+	if ((uint64_t)buf->st_size > SIZE_MAX)
+		return false;
+	if (fstatfs(fd, &statbuf) < 0)
+		return false;
+
+	switch (statbuf.f_type) {
+	case PROC_SUPER_MAGIC:
+	case SYSFS_MAGIC:
+	case SECURITYFS_MAGIC:
+	case DEBUGFS_MAGIC:
+	case TRACEFS_MAGIC:
+	case EFIVARFS_MAGIC:
+		return false;
+	default:
+		return true;
+	}
+}
+
+/*
+ *  fwts_blob_read()
+ *	read a file into a heap buffer, the buffer grows by doubling
+ *	as the size of pseudo files is not known up front
+ */
+static int fwts_blob_read(fwts_blob *blob, const int fd, const size_t hint)
+{
+	size_t size = hint > FWTS_BLOB_READ_MIN ? hint + 1 : FWTS_BLOB_READ_MIN;
+	size_t len = 0;
+	uint8_t *data, *tmp;
+
+	if ((data = malloc(size)) == NULL)
+		return FWTS_ERROR;
+
+	for (;;) {
+		ssize_t n;
+
+		if (len + 1 >= size) {
+			if (size > SIZE_MAX / 2)
+				goto err;
+			if ((tmp = realloc(data, size * 2)) == NULL)
+				goto err;
+			data = tmp;
+			size *= 2;
+		}
+		n = read(fd, data + len, size - len - 1);
+		if (n == 0)
+			break;
+		if (n < 0) {
+			if ((errno == EINTR) || (errno == EAGAIN))
+				continue;
+			goto err;
+		}
+		len += (size_t)n;
+	}
+
+	if (len == 0) {
+		free(data);
+		data = NULL;
+	} else
+		data[len] = '\0';
+
+	blob->data = data;
+	blob->len = len;
+	blob->map_len = 0;
+
+	return FWTS_OK;
+err:
+	free(data);
+	return FWTS_ERROR;
+}
+
+/*
+ *  fwts_blob_load_fd()
+ *	load the contents of an open file, free with fwts_blob_free()
+ */
+int fwts_blob_load_fd(fwts_blob *blob, const int fd)
+{
+	struct stat buf;
+
+	blob->data = NULL;
+	blob->len = 0;
+	blob->map_len = 0;
+
+	if (fstat(fd, &buf) < 0)
+		return FWTS_ERROR;
+
+	if (fwts_blob_mappable(fd, &buf)) {
+		void *data = mmap(NULL, (size_t)buf.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+		if (data != MAP_FAILED) {
+			blob->data = data;
+			blob->len = (size_t)buf.st_size;
+			blob->map_len = (size_t)buf.st_size;
+			return FWTS_OK;
+		}
+	}
+
+	return fwts_blob_read(blob, fd,
+		(S_ISREG(buf.st_mode) && (buf.st_size > 0)) ? (size_t)buf.st_size : 0);
+}
+
+/*
+ *  fwts_blob_load()
+ *	load the contents of a file, free with fwts_blob_free()
+ */
+int fwts_blob_load(fwts_blob *blob, const char *filename)
+{
+	int fd, ret;
+
+	blob->data = NULL;
+	blob->len = 0;
+	blob->map_len = 0;
+
+	if ((fd = open(filename, O_RDONLY)) < 0)
+		return FWTS_ERROR;
+	ret = fwts_blob_load_fd(blob, fd);
+	(void)close(fd);
+
+	return ret;
+}
+
+/*
+ *  fwts_blob_free()
+ *	free the contents of a file loaded by fwts_blob_load()
+ */
+void fwts_blob_free(fwts_blob *blob)
+{
+	if (blob->map_len)
+		(void)munmap(blob->data, blob->map_len);
+	else
+		free(blob->data);
+
+	blob->data = NULL;
+	blob->len = 0;
+	blob->map_len = 0;
+}
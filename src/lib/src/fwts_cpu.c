@@ -36,6 +36,7 @@
 #include <fcntl.h>
 #include <math.h>
 #include <sched.h>
+#include <pthread.h>
 
 #include <linux/perf_event.h>
 
@@ -49,50 +50,226 @@ static pid_t *fwts_cpu_pids;
 #define MSR_AMD64_OSVW_ID_LENGTH	0xc0010140
 #define MSR_AMD64_OSVW_STATUS		0xc0010141
 
+#define FWTS_CPU_MSR_STACK_SIZE		(64 * 1024)
+
 /*
- *  fwts_cpu_readmsr()
- *	Read a given msr on a specified CPU
+ *  Per-CPU /dev/cpu/N/msr file descriptors, opened on first use and
+ *  kept open until fwts_cpu_msr_close() to avoid an open/close pair
+ *  for every MSR read. Entries are -1 when not yet opened.
  */
-int fwts_cpu_readmsr(
-	fwts_framework *fw,
-	const int cpu,
-	const uint32_t reg,
-	uint64_t *val)
+static int *fwts_cpu_msr_fds;
+static int fwts_cpu_msr_fds_size;
+static bool fwts_cpu_msr_module_tried;
+
+typedef struct {
+	int cpu;			/* CPU to read */
+	int fd;				/* /dev/cpu/N/msr fd for the CPU */
+	const uint32_t *regs;		/* MSRs to read */
+	int nregs;			/* number of MSRs */
+	int stride;			/* stride between MSRs in values */
+	fwts_cpu_msr_value *values;	/* values for this CPU */
+	int failed;			/* number of failed reads */
+} fwts_cpu_msr_job;
+
+/*
+ *  fwts_cpu_msr_fd()
+ *	get the pooled msr fd for a given CPU, opening it and
+ *	loading the msr module if required, -1 on failure
+ */
+static int fwts_cpu_msr_fd(fwts_framework *fw, const int cpu)
 {
 	char buffer[PATH_MAX];
-	uint64_t value = 0;
 	int fd;
-	int ret;
+
+	if (cpu < 0)
+		return -1;
+
+	if (cpu >= fwts_cpu_msr_fds_size) {
+		int i, size = cpu + 1;
+		int *fds;
+
+		if ((fds = realloc(fwts_cpu_msr_fds, size * sizeof(*fds))) == NULL)
+			return -1;
+		for (i = fwts_cpu_msr_fds_size; i < size; i++)
+			fds[i] = -1;
+		fwts_cpu_msr_fds = fds;
+		fwts_cpu_msr_fds_size = size;
+	}
+	if (fwts_cpu_msr_fds[cpu] >= 0)
+		return fwts_cpu_msr_fds[cpu];
 
 	snprintf(buffer, sizeof(buffer), "/dev/cpu/%d/msr", cpu);
-	if ((fd = open(buffer, O_RDONLY)) < 0) {
+	if ((fd = open(buffer, O_RDONLY | O_CLOEXEC)) < 0) {
 		bool loaded = false;
 
 		/*
 		 *  msr not there, so force a load of the msr
-		 *  module and retry
+		 *  module and retry, but only try this once
 		 */
+		if (fwts_cpu_msr_module_tried)
+			return -1;
+		fwts_cpu_msr_module_tried = true;
 		if (fwts_module_load(fw, "msr") != FWTS_OK)
-			return FWTS_ERROR;
+			return -1;
 		if (fwts_module_loaded(fw, "msr", &loaded) != FWTS_OK)
-			return FWTS_ERROR;
+			return -1;
 		if (!loaded)
-			return FWTS_ERROR;
-		if ((fd = open(buffer, O_RDONLY)) < 0)
-			return FWTS_ERROR; /* Really failed */
+			return -1;
+		if ((fd = open(buffer, O_RDONLY | O_CLOEXEC)) < 0)
+			return -1;	/* Really failed */
 	}
+	fwts_cpu_msr_fds[cpu] = fd;
+
+	return fd;
+}
 
-	ret = pread(fd, &value, 8, reg);
-	(void)close(fd);
+/*
+ *  fwts_cpu_msr_close()
+ *	close all pooled msr file descriptors
+ */
+void fwts_cpu_msr_close(void)
+{
+	int i;
+
+	for (i = 0; i < fwts_cpu_msr_fds_size; i++)
+		if (fwts_cpu_msr_fds[i] >= 0)
+			(void)close(fwts_cpu_msr_fds[i]);
+
+	free(fwts_cpu_msr_fds);
+	fwts_cpu_msr_fds = NULL;
+	fwts_cpu_msr_fds_size = 0;
+	fwts_cpu_msr_module_tried = false;
+}
+
+/*
+ *  fwts_cpu_readmsr()
+ *	Read a given msr on a specified CPU
+ */
+int fwts_cpu_readmsr(
+	fwts_framework *fw,
+	const int cpu,
+	const uint32_t reg,
+	uint64_t *val)
+{
+	uint64_t value = 0;
+	int fd;
+	ssize_t ret;
+
+	if ((fd = fwts_cpu_msr_fd(fw, cpu)) < 0)
+		return FWTS_ERROR;
+
+	ret = pread(fd, &value, sizeof(value), reg);
 
 	*val = value;
 
-	if (ret < 0)
+	if (ret != sizeof(value))
 		return FWTS_ERROR;
 
 	return FWTS_OK;
 }
 
+/*
+ *  fwts_cpu_msr_job_run()
+ *	read a list of MSRs on one CPU
+ */
+static void *fwts_cpu_msr_job_run(void *arg)
+{
+	fwts_cpu_msr_job *job = (fwts_cpu_msr_job *)arg;
+	int i;
+
+	for (i = 0; i < job->nregs; i++) {
+		fwts_cpu_msr_value *value = &job->values[i * job->stride];
+		uint64_t val = 0;
+
+		value->ok = (job->fd >= 0) &&
+			(pread(job->fd, &val, sizeof(val), job->regs[i]) == sizeof(val));
+		value->val = val;
+		if (!value->ok)
+			job->failed++;
+	}
+	return NULL;
+}
+
+/*
+ *  fwts_cpu_readmsrs()
+ *	Read a list of nregs MSRs on ncpus CPUs. The CPUs are given
+ *	in cpus, or are CPUs 0..ncpus-1 if cpus is NULL. Results are
+ *	stored MSR by MSR, so values[r * ncpus + c] is MSR regs[r] on
+ *	the c'th CPU, and each value is flagged if the read failed.
+ *	If parallel is true each CPU is read by a thread pinned to
+ *	that CPU so the kernel does not need an IPI to read the MSR.
+ *	Returns FWTS_ERROR if any of the reads failed.
+ */
+int fwts_cpu_readmsrs(
+	fwts_framework *fw,
+	const int *cpus,
+	const int ncpus,
+	const uint32_t *regs,
+	const int nregs,
+	fwts_cpu_msr_value *values,
+	const bool parallel)
+{
+	fwts_cpu_msr_job *jobs;
+	pthread_t *threads = NULL;
+	bool *started = NULL;
+	int i, failed = 0;
+
+	if ((ncpus < 1) || (nregs < 1))
+		return FWTS_OK;
+
+	if ((jobs = calloc(ncpus, sizeof(*jobs))) == NULL)
+		return FWTS_ERROR;
+
+	/* Open all the fds up front, workers only ever pread */
+	for (i = 0; i < ncpus; i++) {
+		jobs[i].cpu = cpus ? cpus[i] : i;
+		jobs[i].fd = fwts_cpu_msr_fd(fw, jobs[i].cpu);
+		jobs[i].regs = regs;
+		jobs[i].nregs = nregs;
+		jobs[i].stride = ncpus;
+		jobs[i].values = &values[i];
+	}
+
+	if (parallel && (ncpus > 1)) {
+		threads = calloc(ncpus, sizeof(*threads));
+		started = calloc(ncpus, sizeof(*started));
+	}
+
+	if (threads && started) {
+		for (i = 0; i < ncpus; i++) {
+			pthread_attr_t attr;
+			cpu_set_t mask;
+
+			if (jobs[i].fd < 0)
+				continue;
+			if (pthread_attr_init(&attr))
+				continue;
+			CPU_ZERO(&mask);
+			CPU_SET(jobs[i].cpu, &mask);
+			(void)pthread_attr_setaffinity_np(&attr, sizeof(mask), &mask);
+			(void)pthread_attr_setstacksize(&attr, FWTS_CPU_MSR_STACK_SIZE);
+			started[i] = (pthread_create(&threads[i], &attr,
+				fwts_cpu_msr_job_run, &jobs[i]) == 0);
+			(void)pthread_attr_destroy(&attr);
+		}
+	}
+
+	/* Read any CPUs a thread could not be started for */
+	for (i = 0; i < ncpus; i++) {
+		if (started && started[i])
+			(void)pthread_join(threads[i], NULL);
+		else
+			(void)fwts_cpu_msr_job_run(&jobs[i]);
+		failed += jobs[i].failed;
+	}
+
+	free(started);
+	free(threads);
+	free(jobs);
+
+	return failed ? FWTS_ERROR : FWTS_OK;
+}
+
 /*
  *  fwts_cpu_free_info()
  *	free CPU information
@@ -114,73 +291,29 @@ void fwts_cpu_free_info(fwts_cpuinfo_x86 *cpu)
  */
 fwts_cpuinfo_x86 *fwts_cpu_get_info(int which_cpu)
 {
-	FILE *fp;
-	char buffer[1024];
+	const fwts_cpu_topology *topology;
+	const fwts_cpu_topology_cpu *info;
 	fwts_cpuinfo_x86 *cpu;
-	int cpu_num = -1;
-	bool found = false;
 
-	if ((cpu = (fwts_cpuinfo_x86*)calloc(1, sizeof(fwts_cpuinfo_x86))) == NULL)
+	if ((topology = fwts_cpu_topology_get()) == NULL)
 		return NULL;
-
-	if ((fp = fopen("/proc/cpuinfo", "r")) == NULL) {
-		free(cpu);
+	if (which_cpu == -1)
+		which_cpu = topology->first_cpu;
+	info = fwts_cpu_topology_find(topology, which_cpu);
+	if (!info || !info->has_info)
 		return NULL;
-	}
 
-	while (fgets(buffer, sizeof(buffer), fp) != NULL) {
-		char *ptr = strstr(buffer, ":");
-		if (ptr)
-			ptr += 2;
-		else
-			continue;
-
-		buffer[strlen(buffer)-1] = '\0';
-
-		if (!strncmp(buffer, "processor", 9)) {
-			sscanf(ptr, "%d", &cpu_num);
-			if (which_cpu == -1)
-				which_cpu = cpu_num;
-			if (cpu_num > which_cpu)
-				break;
-			continue;
-		} else {
-			if (cpu_num != which_cpu)
-				continue;
-		}
-
-		found = true;
-
-		if (!cpu->vendor_id && !strncmp(buffer, "vendor_id", 9)) {
-			cpu->vendor_id = strdup(ptr);
-			continue;
-		}
-		if (!strncmp(buffer, "cpu family",10)) {
-			sscanf(ptr, "%d", &cpu->x86);
-			continue;
-		}
-		if (!cpu->model_name && !strncmp(buffer, "model name", 10)) {
-			cpu->model_name = strdup(ptr);
-			continue;
-		}
-		if (!strncmp(buffer, "model", 5)) {
-			sscanf(ptr, "%d", &cpu->x86_model);
-			continue;
-		}
-		if (!strncmp(buffer, "stepping", 8)) {
-			sscanf(ptr, "%d", &cpu->stepping);
-			continue;
-		}
-		if (!cpu->flags && !strncmp(buffer, "flags", 5)) {
-			cpu->flags = strdup(ptr);
-			continue;
-		}
-	}
-	(void)fclose(fp);
+	if ((cpu = (fwts_cpuinfo_x86*)calloc(1, sizeof(fwts_cpuinfo_x86))) == NULL)
+		return NULL;
 
-	if (!found) {
-		free(cpu);
-		cpu = NULL;
+	cpu->x86 = info->family;
+	cpu->x86_model = info->model;
+	cpu->stepping = info->stepping;
+	if ((info->vendor_id && ((cpu->vendor_id = strdup(info->vendor_id)) == NULL)) ||
+	    (info->model_name && ((cpu->model_name = strdup(info->model_name)) == NULL)) ||
+	    (info->flags_text && ((cpu->flags = strdup(info->flags_text)) == NULL))) {
+		fwts_cpu_free_info(cpu);
+		return NULL;
 	}
 
 	return cpu;
@@ -188,17 +321,16 @@ fwts_cpuinfo_x86 *fwts_cpu_get_info(int which_cpu)
 
 static int fwts_cpu_matches_vendor_id(const char *vendor_id, bool *matches)
 {
-	fwts_cpuinfo_x86 *cpu;
+	const fwts_cpu_topology *topology;
+	const fwts_cpu_topology_cpu *cpu;
 
-	if ((cpu = fwts_cpu_get_info(-1)) == NULL)
+	if ((topology = fwts_cpu_topology_get()) == NULL)
 		return FWTS_ERROR;
-	if (cpu->vendor_id == NULL) {
-		fwts_cpu_free_info(cpu);
+	cpu = fwts_cpu_topology_find(topology, topology->first_cpu);
+	if (!cpu || (cpu->vendor_id == NULL))
 		return FWTS_ERROR;
-	}
 
 	*matches = (strstr(cpu->vendor_id, vendor_id) != NULL);
-	fwts_cpu_free_info(cpu);
 
 	return FWTS_OK;
 }
@@ -346,7 +478,7 @@ static void fwts_cpu_sigint_handler(int dummy)
  *  fwts_cpu_burn_cycles()
  *	burn some CPU cycles
  */
-static void fwts_cpu_burn_cycles(void)
+void fwts_cpu_burn_cycles(void)
 {
 	double A = 1.234567;
 	double B = 3.121213;
@@ -368,52 +500,313 @@ static void fwts_cpu_burn_cycles(void)
 	}
 }
 
-static int perf_setup_counter(int cpu)
+/*
+ *  Per-CPU perf event groups for the benchmark: a cycles leader with
+ *  instructions and ref-cycles members, opened on first use and kept
+ *  open until fwts_cpu_benchmark_close(). Groups are allocated one by
+ *  one so a group stays put while another CPU's group is being added.
+ */
+static const uint64_t fwts_cpu_perf_events[FWTS_CPU_PERF_EVENTS] = {
+	PERF_COUNT_HW_CPU_CYCLES,
+	PERF_COUNT_HW_INSTRUCTIONS,
+	PERF_COUNT_HW_REF_CPU_CYCLES,
+};
+
+typedef struct {
+	int fds[FWTS_CPU_PERF_EVENTS];		/* fds[0] is the leader, -1 if not open */
+	int index[FWTS_CPU_PERF_EVENTS];	/* position in a group read, -1 if not open */
+	int n;					/* events open in the group */
+} fwts_cpu_perf_group;
+
+typedef struct {
+	uint64_t nr;
+	uint64_t time_enabled;
+	uint64_t time_running;
+	uint64_t values[FWTS_CPU_PERF_EVENTS];
+} fwts_cpu_perf_read;
+
+/*
+ *  One benchmark sample, taken at the end of each slice
+ */
+typedef struct {
+	uint64_t ns;				/* CLOCK_MONOTONIC_RAW time */
+	uint64_t loops;				/* burn loops so far */
+	uint64_t counts[FWTS_CPU_PERF_EVENTS];	/* perf counts so far */
+	bool counts_ok;				/* perf counts were read */
+} fwts_cpu_benchmark_sample;
+
+static fwts_cpu_perf_group **fwts_cpu_perf_groups;
+static int fwts_cpu_perf_groups_size;
+static pthread_mutex_t fwts_cpu_perf_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/*
+ *  fwts_cpu_perf_group_get()
+ *	get the pooled perf event group for a CPU, opening it if
+ *	required, NULL if the cycles counter can't be opened
+ */
+static fwts_cpu_perf_group *fwts_cpu_perf_group_get(const int cpu)
 {
-	struct perf_event_attr attr;
-	int fd;
+	fwts_cpu_perf_group *group = NULL;
+	int i;
 
-	memset(&attr, 0, sizeof(attr));
-	attr.type = PERF_TYPE_HARDWARE;
-	attr.config = PERF_COUNT_HW_CPU_CYCLES;
-	attr.disabled = 1;
-	attr.size = sizeof(attr);
+	pthread_mutex_lock(&fwts_cpu_perf_lock);
 
-	fd = syscall(__NR_perf_event_open, &attr, -1, cpu, -1, 0);
-	return fd;
+	if (cpu >= fwts_cpu_perf_groups_size) {
+		fwts_cpu_perf_group **groups;
+		int size = cpu + 1;
+
+		groups = realloc(fwts_cpu_perf_groups, size * sizeof(*groups));
+		if (groups == NULL)
+			goto out;
+		for (i = fwts_cpu_perf_groups_size; i < size; i++)
+			groups[i] = NULL;
+		fwts_cpu_perf_groups = groups;
+		fwts_cpu_perf_groups_size = size;
+	}
+	if (fwts_cpu_perf_groups[cpu]) {
+		group = fwts_cpu_perf_groups[cpu];
+		goto out;
+	}
+
+	if ((group = calloc(1, sizeof(*group))) == NULL)
+		goto out;
+
+	for (i = 0; i < FWTS_CPU_PERF_EVENTS; i++) {
+		struct perf_event_attr attr;
+		const int leader = i ? group->fds[0] : -1;
+
+		group->fds[i] = -1;
+		group->index[i] = -1;
+
+		memset(&attr, 0, sizeof(attr));
+		attr.type = PERF_TYPE_HARDWARE;
+		attr.config = fwts_cpu_perf_events[i];
+		attr.disabled = leader < 0;
+		attr.size = sizeof(attr);
+		attr.read_format = PERF_FORMAT_GROUP |
+			PERF_FORMAT_TOTAL_TIME_ENABLED |
+			PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+		group->fds[i] = syscall(__NR_perf_event_open, &attr, -1, cpu, leader, PERF_FLAG_FD_CLOEXEC);
+		if (group->fds[i] < 0) {
+			/* No cycles, no group, the other events are optional */
+			if (i == 0)
+				break;
+			continue;
+		}
+		group->index[i] = group->n++;
+	}
+	fwts_cpu_perf_groups[cpu] = group;
+out:
+	pthread_mutex_unlock(&fwts_cpu_perf_lock);
+
+	return (group && group->n) ? group : NULL;
 }
 
-static int perf_start_counter(int fd)
+/*
+ *  fwts_cpu_benchmark_close()
+ *	close all pooled perf event groups
+ */
+void fwts_cpu_benchmark_close(void)
 {
-	int rc;
+	int i, j;
+
+	pthread_mutex_lock(&fwts_cpu_perf_lock);
+	for (i = 0; i < fwts_cpu_perf_groups_size; i++) {
+		fwts_cpu_perf_group *group = fwts_cpu_perf_groups[i];
 
-	rc = ioctl(fd, PERF_EVENT_IOC_ENABLE);
-	return (rc == 0) ? FWTS_OK : FWTS_ERROR;
+		if (!group)
+			continue;
+		/* Members first, then the leader */
+		for (j = FWTS_CPU_PERF_EVENTS - 1; j >= 0; j--)
+			if (group->fds[j] >= 0)
+				(void)close(group->fds[j]);
+		free(group);
+	}
+	free(fwts_cpu_perf_groups);
+	fwts_cpu_perf_groups = NULL;
+	fwts_cpu_perf_groups_size = 0;
+	pthread_mutex_unlock(&fwts_cpu_perf_lock);
 }
 
-static int perf_stop_counter(int fd)
+/*
+ *  fwts_cpu_perf_group_read()
+ *	read all the counts of a group, scaled up if the group was
+ *	multiplexed with other events
+ */
+static bool fwts_cpu_perf_group_read(
+	const fwts_cpu_perf_group *group,
+	uint64_t *counts)
 {
-	int rc;
+	fwts_cpu_perf_read data;
+	ssize_t len = (3 + group->n) * sizeof(uint64_t);
+	int i;
+
+	if (read(group->fds[0], &data, len) != len)
+		return false;
+	if ((data.nr != (uint64_t)group->n) || (data.time_running == 0))
+		return false;
+
+	for (i = 0; i < FWTS_CPU_PERF_EVENTS; i++) {
+		uint64_t value;
 
-	rc = ioctl(fd, PERF_EVENT_IOC_DISABLE);
-	return (rc == 0) ? FWTS_OK : FWTS_ERROR;
+		if (group->index[i] < 0) {
+			counts[i] = 0;
+			continue;
+		}
+		value = data.values[group->index[i]];
+		if (data.time_running < data.time_enabled)
+			value = (uint64_t)((double)value *
+				data.time_enabled / data.time_running);
+		counts[i] = value;
+	}
+	return true;
 }
 
-static int perf_read_counter(int fd, unsigned long long *result)
+static inline uint64_t fwts_cpu_benchmark_ns(void)
 {
-	unsigned long long buf;
-	int rc;
-
-	rc = read(fd, &buf, sizeof(buf));
-	if (rc == sizeof(buf)) {
-		*result = buf;
-		rc = FWTS_OK;
-	} else {
-		rc = FWTS_ERROR;
+	struct timespec ts;
+
+	(void)clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+
+	return ((uint64_t)ts.tv_sec * 1000000000ULL) + ts.tv_nsec;
+}
+
+/*
+ *  fwts_cpu_benchmark_converged()
+ *	check if the loop rates of the last FWTS_CPU_BENCHMARK_WINDOW
+ *	slices are all within tolerance of their mean
+ */
+static bool fwts_cpu_benchmark_converged(
+	const fwts_cpu_benchmark_sample *samples,
+	const int n,
+	const double tolerance)
+{
+	double rate, min = 0.0, max = 0.0, total = 0.0;
+	int i;
+
+	for (i = n - FWTS_CPU_BENCHMARK_WINDOW; i < n; i++) {
+		const fwts_cpu_benchmark_sample *prev =
+			&samples[(i - 1) % (FWTS_CPU_BENCHMARK_WINDOW + 1)];
+		const fwts_cpu_benchmark_sample *curr =
+			&samples[i % (FWTS_CPU_BENCHMARK_WINDOW + 1)];
+
+		rate = (double)(curr->loops - prev->loops) / (curr->ns - prev->ns);
+		if ((i == n - FWTS_CPU_BENCHMARK_WINDOW) || (rate < min))
+			min = rate;
+		if ((i == n - FWTS_CPU_BENCHMARK_WINDOW) || (rate > max))
+			max = rate;
+		total += rate;
 	}
 
-	(void)close(fd);
-	return rc;
+	return (max - min) <= (tolerance * total / FWTS_CPU_BENCHMARK_WINDOW);
+}
+
+/*
+ *  fwts_cpu_benchmark_measure()
+ *	burn CPU cycles on the current CPU in slices, until the rate of
+ *	the last few slices agree within tolerance or the maximum run
+ *	length is reached. The clock is only read every stride loops,
+ *	stride is doubled until reading it is a small fraction of the
+ *	work. Rates are taken over the converged slices, or over all but
+ *	the first slice if the run did not converge, so that ramping up
+ *	to the frequency at the start of the run is left out.
+ *	Returns false if the perf counts could not be read.
+ */
+static bool fwts_cpu_benchmark_measure(
+	const fwts_cpu_perf_group *group,
+	const double tolerance,
+	fwts_cpu_benchmark_result *result)
+{
+	fwts_cpu_benchmark_sample samples[FWTS_CPU_BENCHMARK_WINDOW + 1], settled;
+	const fwts_cpu_benchmark_sample *first, *last;
+	uint64_t loops = 0, stride = 1, start, now, checked, slice_end;
+	double duration;
+	bool counts_ok = true;
+	int i, n = 0;
+
+	if (group) {
+		(void)ioctl(group->fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+		(void)ioctl(group->fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+	}
+
+	start = checked = fwts_cpu_benchmark_ns();
+	slice_end = start + FWTS_CPU_BENCHMARK_SLICE_NS;
+	memset(&samples[0], 0, sizeof(samples[0]));
+	samples[0].ns = start;
+	samples[0].counts_ok = group && fwts_cpu_perf_group_read(group, samples[0].counts);
+	settled = samples[0];
+	n++;
+
+	/*
+	 * And burn some CPU cycles and get a bogo-compute like
+	 * loop count measure of CPU performance.
+	 */
+	for (;;) {
+		fwts_cpu_benchmark_sample *sample;
+		uint64_t j;
+
+		for (j = 0; j < stride; j++)
+			fwts_cpu_burn_cycles();
+		loops += stride;
+
+		now = fwts_cpu_benchmark_ns();
+		if ((now - checked) < FWTS_CPU_BENCHMARK_CHECK_NS)
+			stride *= 2;
+		checked = now;
+		if (now < slice_end)
+			continue;
+
+		sample = &samples[n % (FWTS_CPU_BENCHMARK_WINDOW + 1)];
+		sample->ns = now;
+		sample->loops = loops;
+		sample->counts_ok = group && fwts_cpu_perf_group_read(group, sample->counts);
+		if (n++ == 1)
+			settled = *sample;
+		slice_end = now + FWTS_CPU_BENCHMARK_SLICE_NS;
+
+		if ((now - start) >= FWTS_CPU_BENCHMARK_MAX_NS)
+			break;
+		if ((tolerance > 0.0) &&
+		    (n > FWTS_CPU_BENCHMARK_WINDOW) &&
+		    ((now - start) >= FWTS_CPU_BENCHMARK_MIN_NS) &&
+		    fwts_cpu_benchmark_converged(samples, n, tolerance)) {
+			result->converged = true;
+			break;
+		}
+	}
+
+	if (group)
+		(void)ioctl(group->fds[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+	if (result->converged)
+		first = &samples[(n - FWTS_CPU_BENCHMARK_WINDOW - 1) % (FWTS_CPU_BENCHMARK_WINDOW + 1)];
+	else if (n > 2)
+		first = &settled;
+	else
+		first = &samples[0];
+	last = &samples[(n - 1) % (FWTS_CPU_BENCHMARK_WINDOW + 1)];
+	duration = (double)(last->ns - first->ns) / 1000000000.0;
+
+	result->duration_ns = now - start;
+	result->loops = (double)(last->loops - first->loops) / duration;
+
+	if (!group)
+		return true;
+	if (!(first->counts_ok && last->counts_ok))
+		counts_ok = false;
+	else {
+		uint64_t *rates[FWTS_CPU_PERF_EVENTS] = {
+			&result->cycles,
+			&result->instructions,
+			&result->ref_cycles,
+		};
+
+		for (i = 0; i < FWTS_CPU_PERF_EVENTS; i++)
+			*rates[i] = (double)(last->counts[i] - first->counts[i]) / duration;
+		result->cycles_valid = true;
+	}
+	return counts_ok;
 }
 
 /*
@@ -425,13 +818,11 @@ int fwts_cpu_benchmark(
 	const int cpu,		/* CPU we want to measure performance */
 	fwts_cpu_benchmark_result *result)
 {
-	struct timeval start, end, duration;
-	unsigned long long perfctr_result;
+	const fwts_cpu_perf_group *group;
 	fwts_cpu_benchmark_result tmp;
 	cpu_set_t mask, oldset;
-	int perfctr, ncpus;
-	double duration_sec;
-	bool perf_ok;
+	int ncpus;
+	bool counts_ok;
 
 	ncpus = fwts_cpu_enumerate();
 	memset(&tmp, 0, sizeof(tmp));
@@ -442,10 +833,9 @@ int fwts_cpu_benchmark(
 	if ((cpu < 0) || (cpu > ncpus))
 		return FWTS_ERROR;
 
-	/* setup perf counter */
-	perf_ok = true;
-	perfctr = perf_setup_counter(cpu);
-	if (perfctr < 0) {
+	/* setup perf counters */
+	group = fwts_cpu_perf_group_get(cpu);
+	if (!group) {
 		static bool warned;
 
 		if (!warned) {
@@ -454,7 +844,6 @@ int fwts_cpu_benchmark(
 					"relative measurements");
 			warned = true;
 		}
-		perf_ok = false;
 	}
 
 	/* Pin to the specified CPU */
@@ -470,49 +859,64 @@ int fwts_cpu_benchmark(
 		return FWTS_ERROR;
 	}
 
-	if (perf_ok)
-		perf_start_counter(perfctr);
-	gettimeofday(&start, NULL);
+	counts_ok = fwts_cpu_benchmark_measure(group, FWTS_CPU_BENCHMARK_TOLERANCE, &tmp);
 
-	/*
-	 * And burn some CPU cycles and get a bogo-compute like
-	 * loop count measure of CPU performance.
-	 */
-	for (;;) {
-		fwts_cpu_burn_cycles();
+	if (sched_setaffinity(0, sizeof(oldset), &oldset) < 0) {
+		fwts_log_error(fw, "Cannot restore old CPU affinity settings.");
+		return FWTS_ERROR;
+	}
 
-		tmp.loops++;
+	if (!counts_ok)
+		fwts_log_warning(fw, "failed to read perf counters");
 
-		gettimeofday(&end, NULL);
-		timersub(&end, &start, &duration);
-		if (duration.tv_usec >= 250000)
-			break;
-	}
+	*result = tmp;
 
-	if (perf_ok)
-		perf_stop_counter(perfctr);
+	return FWTS_OK;
+}
 
-	if (sched_setaffinity(0, sizeof(oldset), &oldset) < 0) {
-		fwts_log_error(fw, "Cannot restore old CPU affinity settings.");
+/*
+ *  fwts_cpu_benchmark_thread()
+ *	thread safe fwts_cpu_benchmark(), only the calling thread is
+ *	pinned to the CPU and nothing is logged, so several threads
+ *	can benchmark different CPUs at the same time. The run stops
+ *	once the rate is stable within tolerance, a tolerance of 0
+ *	always runs for FWTS_CPU_BENCHMARK_MAX_NS. If the perf
+ *	counters can't be used result->cycles_valid is false and
+ *	only the relative loop count is valid.
+ */
+int fwts_cpu_benchmark_thread(
+	const int cpu,
+	const double tolerance,
+	fwts_cpu_benchmark_result *result)
+{
+	const fwts_cpu_perf_group *group;
+	fwts_cpu_benchmark_result tmp;
+	cpu_set_t mask, oldset;
+	pthread_t self = pthread_self();
+	int ncpus;
+
+	ncpus = fwts_cpu_enumerate();
+	memset(&tmp, 0, sizeof(tmp));
+
+	if (ncpus == FWTS_ERROR)
 		return FWTS_ERROR;
-	}
 
-	duration_sec = duration.tv_sec +
-		((1.0 * duration.tv_usec) / 1000000.0);
+	if ((cpu < 0) || (cpu > ncpus))
+		return FWTS_ERROR;
 
-	tmp.loops = (1.0 * tmp.loops) / duration_sec;
+	if (pthread_getaffinity_np(self, sizeof(oldset), &oldset))
+		return FWTS_ERROR;
 
-	if (perf_ok) {
-		int rc = perf_read_counter(perfctr, &perfctr_result);
+	CPU_ZERO(&mask);
+	CPU_SET(cpu, &mask);
+	if (pthread_setaffinity_np(self, sizeof(mask), &mask))
+		return FWTS_ERROR;
 
-		if (rc == FWTS_OK) {
-			tmp.cycles = (1.0 * perfctr_result) / duration_sec;
-			tmp.cycles_valid = true;
-		} else {
-			fwts_log_warning(fw, "failed to read perf counters");
-		}
+	group = fwts_cpu_perf_group_get(cpu);
+	(void)fwts_cpu_benchmark_measure(group, tolerance, &tmp);
 
-	}
+	if (pthread_setaffinity_np(self, sizeof(oldset), &oldset))
+		return FWTS_ERROR;
 
 	*result = tmp;
 
@@ -0,0 +1,673 @@
+/*
+ * Copyright (C) 2026 Canonical
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <limits.h>
+#include <ctype.h>
+#include <dirent.h>
+#include <pthread.h>
+
+#include "fwts.h"
+
+#define FWTS_CPU_TOPOLOGY_SYSFS		"/sys/devices/system/cpu"
+#define FWTS_CPU_TOPOLOGY_CPUINFO	"/proc/cpuinfo"
+#define FWTS_CPU_TOPOLOGY_HASH_MIN	(256)
+
+/* Model shared by all tests in a run */
+static fwts_cpu_topology *cpu_topology;
+static pthread_mutex_t cpu_topology_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/*
+ *  One processor block of /proc/cpuinfo, the values point into
+ *  the file contents and are not '\0' terminated
+ */
+typedef struct {
+	const char *value;
+	size_t len;
+} fwts_cpu_topology_span;
+
+typedef struct {
+	int cpu;
+	fwts_cpu_topology_span vendor_id;
+	fwts_cpu_topology_span model_name;
+	fwts_cpu_topology_span flags;
+	int family;
+	int model;
+	int stepping;
+} fwts_cpu_topology_info;
+
+static inline uint32_t fwts_cpu_topology_hash(const char *str, const size_t len)
+{
+	uint32_t h = 2166136261U;
+	size_t i;
+
+	for (i = 0; i < len; i++)
+		h = (h ^ (uint8_t)str[i]) * 16777619U;
+
+	return h;
+}
+
+/*
+ *  fwts_cpu_topology_intern()
+ *	get a copy of a string shared by all CPUs with the same string,
+ *	there are only ever a few distinct vendor, model and flags lines
+ */
+static const char *fwts_cpu_topology_intern(
+	fwts_cpu_topology *topology,
+	const fwts_cpu_topology_span *span)
+{
+	char **strings;
+	int i;
+
+	if (!span->value)
+		return NULL;
+
+	for (i = 0; i < topology->strings_len; i++) {
+		const char *str = topology->strings[i];
+
+		if (!strncmp(str, span->value, span->len) && (str[span->len] == '\0'))
+			return str;
+	}
+
+	strings = realloc(topology->strings,
+		(topology->strings_len + 1) * sizeof(*strings));
+	if (!strings)
+		return NULL;
+	topology->strings = strings;
+	if ((strings[topology->strings_len] = strndup(span->value, span->len)) == NULL)
+		return NULL;
+
+	return strings[topology->strings_len++];
+}
+
+/*
+ *  fwts_cpu_topology_flag_slot()
+ *	find a flag in the flag name hash, returns its slot or the
+ *	empty slot it would go in
+ */
+static uint32_t fwts_cpu_topology_flag_slot(
+	const fwts_cpu_topology *topology,
+	const char *name,
+	const size_t len)
+{
+	const uint32_t mask = topology->flag_hash_size - 1;
+	uint32_t h = fwts_cpu_topology_hash(name, len) & mask;
+
+	while (topology->flag_hash[h]) {
+		const char *str = topology->flag_names[topology->flag_hash[h] - 1];
+
+		if (!strncmp(str, name, len) && (str[len] == '\0'))
+			break;
+		h = (h + 1) & mask;
+	}
+	return h;
+}
+
+/*
+ *  fwts_cpu_topology_flag_add()
+ *	add a flag name, returns its bit number or -1 on failure
+ */
+static int fwts_cpu_topology_flag_add(
+	fwts_cpu_topology *topology,
+	const char *name,
+	const size_t len)
+{
+	uint32_t h;
+
+	if ((uint32_t)(topology->n_flags + 1) * 2 > topology->flag_hash_size) {
+		uint32_t *old = topology->flag_hash;
+		const uint32_t old_size = topology->flag_hash_size;
+		uint32_t i, size = old_size ? old_size * 2 : FWTS_CPU_TOPOLOGY_HASH_MIN;
+
+		if ((topology->flag_hash = calloc(size, sizeof(uint32_t))) == NULL) {
+			topology->flag_hash = old;
+			return -1;
+		}
+		topology->flag_hash_size = size;
+		for (i = 0; i < old_size; i++) {
+			if (old[i]) {
+				const char *str = topology->flag_names[old[i] - 1];
+
+				h = fwts_cpu_topology_flag_slot(topology, str, strlen(str));
+				topology->flag_hash[h] = old[i];
+			}
+		}
+		free(old);
+	}
+
+	h = fwts_cpu_topology_flag_slot(topology, name, len);
+	if (!topology->flag_hash[h]) {
+		char **names;
+
+		names = realloc(topology->flag_names,
+			(topology->n_flags + 1) * sizeof(*names));
+		if (!names)
+			return -1;
+		topology->flag_names = names;
+		if ((names[topology->n_flags] = strndup(name, len)) == NULL)
+			return -1;
+		topology->flag_hash[h] = ++topology->n_flags;
+	}
+	return topology->flag_hash[h] - 1;
+}
+
+/*
+ *  fwts_cpu_topology_flags()
+ *	add the flags of a flags line, setting their bits in bitset
+ *	if it is not NULL
+ */
+static int fwts_cpu_topology_flags(
+	fwts_cpu_topology *topology,
+	const char *flags,
+	uint64_t *bitset)
+{
+	const char *ptr = flags;
+
+	while (*ptr) {
+		size_t len;
+		int bit;
+
+		while (*ptr == ' ')
+			ptr++;
+		for (len = 0; ptr[len] && (ptr[len] != ' '); len++)
+			;
+		if (!len)
+			break;
+		if ((bit = fwts_cpu_topology_flag_add(topology, ptr, len)) < 0)
+			return FWTS_ERROR;
+		if (bitset)
+			bitset[bit / 64] |= 1ULL << (bit % 64);
+		ptr += len;
+	}
+	return FWTS_OK;
+}
+
+/*
+ *  fwts_cpu_topology_cpuinfo()
+ *	parse /proc/cpuinfo into one info record per processor
+ */
+static int fwts_cpu_topology_cpuinfo(
+	const fwts_blob *blob,
+	fwts_cpu_topology_info **infos,
+	int *n_infos)
+{
+	const char *ptr = (const char *)blob->data;
+	const char *end = ptr + blob->len;
+	fwts_cpu_topology_info *info = NULL;
+	int n = 0, size = 0;
+
+	*infos = NULL;
+	*n_infos = 0;
+
+	while (ptr < end) {
+		const char *eol = memchr(ptr, '\n', end - ptr);
+		const char *colon, *key_end, *value;
+		size_t key_len, value_len;
+
+		if (!eol)
+			eol = end;
+		colon = memchr(ptr, ':', eol - ptr);
+		if (!colon) {
+			ptr = eol + 1;
+			continue;
+		}
+		for (key_end = colon; (key_end > ptr) && isspace((uint8_t)key_end[-1]); key_end--)
+			;
+		key_len = key_end - ptr;
+		value = colon + 1;
+		if ((value < eol) && (*value == ' '))
+			value++;
+		value_len = eol - value;
+
+#define KEY_IS(str)	((key_len == sizeof(str) - 1) && !strncmp(ptr, str, key_len))
+		if (KEY_IS("processor")) {
+			if (n == size) {
+				fwts_cpu_topology_info *tmp;
+
+				size = size ? size * 2 : 64;
+				if ((tmp = realloc(*infos, size * sizeof(*tmp))) == NULL) {
+					free(*infos);
+					*infos = NULL;
+					return FWTS_ERROR;
+				}
+				*infos = tmp;
+			}
+			info = &(*infos)[n++];
+			memset(info, 0, sizeof(*info));
+			info->cpu = strtol(value, NULL, 10);
+		} else if (!info) {
+			/* Not in a processor block */
+		} else if (KEY_IS("vendor_id")) {
+			if (!info->vendor_id.value) {
+				info->vendor_id.value = value;
+				info->vendor_id.len = value_len;
+			}
+		} else if (KEY_IS("cpu family")) {
+			info->family = strtol(value, NULL, 10);
+		} else if (KEY_IS("model name")) {
+			if (!info->model_name.value) {
+				info->model_name.value = value;
+				info->model_name.len = value_len;
+			}
+		} else if (KEY_IS("model")) {
+			info->model = strtol(value, NULL, 10);
+		} else if (KEY_IS("stepping")) {
+			info->stepping = strtol(value, NULL, 10);
+		} else if (KEY_IS("flags")) {
+			if (!info->flags.value) {
+				info->flags.value = value;
+				info->flags.len = value_len;
+			}
+		}
+#undef KEY_IS
+		ptr = eol + 1;
+	}
+
+	*n_infos = n;
+
+	return FWTS_OK;
+}
+
+/*
+ *  fwts_cpu_topology_sysfs_cpus()
+ *	get the numbers of all the CPUs in sysfs
+ */
+static int fwts_cpu_topology_sysfs_cpus(int **cpus, int *n_cpus)
+{
+	struct dirent *entry;
+	DIR *dir;
+	int n = 0, size = 0;
+
+	*cpus = NULL;
+	*n_cpus = 0;
+
+	if ((dir = opendir(FWTS_CPU_TOPOLOGY_SYSFS)) == NULL)
+		return FWTS_OK;
+
+	while ((entry = readdir(dir)) != NULL) {
+		if (strncmp(entry->d_name, "cpu", 3) || !isdigit((uint8_t)entry->d_name[3]))
+			continue;
+		if (n == size) {
+			int *tmp;
+
+			size = size ? size * 2 : 64;
+			if ((tmp = realloc(*cpus, size * sizeof(*tmp))) == NULL) {
+				free(*cpus);
+				*cpus = NULL;
+				(void)closedir(dir);
+				return FWTS_ERROR;
+			}
+			*cpus = tmp;
+		}
+		(*cpus)[n++] = strtol(entry->d_name + 3, NULL, 10);
+	}
+	(void)closedir(dir);
+	*n_cpus = n;
+
+	return FWTS_OK;
+}
+
+/*
+ *  fwts_cpu_topology_get_int()
+ *	read an integer from cpuN/name, def if it can't be read
+ */
+static int fwts_cpu_topology_get_int(const int cpu, const char *name, const int def)
+{
+	char path[PATH_MAX], *data;
+	int value = def;
+
+	snprintf(path, sizeof(path), "%s/cpu%d/%s", FWTS_CPU_TOPOLOGY_SYSFS, cpu, name);
+	if ((data = fwts_get(path)) != NULL) {
+		if (isdigit((uint8_t)data[0]) || (data[0] == '-'))
+			value = strtol(data, NULL, 10);
+		free(data);
+	}
+	return value;
+}
+
+/*
+ *  fwts_cpu_topology_policy()
+ *	the cpufreq policy of a CPU; cpuN/cpufreq links to policyM on
+ *	current kernels and to cpuM/cpufreq on older ones, either way
+ *	the policy is M
+ */
+static int fwts_cpu_topology_policy(const int cpu)
+{
+	char path[PATH_MAX], *real, *name;
+	int policy = FWTS_CPU_TOPOLOGY_NONE;
+
+	snprintf(path, sizeof(path), "%s/cpu%d/cpufreq", FWTS_CPU_TOPOLOGY_SYSFS, cpu);
+	if ((real = realpath(path, NULL)) == NULL)
+		return policy;
+
+	if ((name = strrchr(real, '/')) != NULL) {
+		if (!strncmp(name, "/policy", 7) && isdigit((uint8_t)name[7])) {
+			policy = strtol(name + 7, NULL, 10);
+		} else if (!strcmp(name, "/cpufreq")) {
+			*name = '\0';
+			if (((name = strrchr(real, '/')) != NULL) &&
+			    !strncmp(name, "/cpu", 4) && isdigit((uint8_t)name[4]))
+				policy = strtol(name + 4, NULL, 10);
+		}
+	}
+	free(real);
+
+	return policy;
+}
+
+/*
+ *  fwts_cpu_topology_sysfs()
+ *	fill in the sysfs topology and cpufreq details of a CPU
+ */
+static void fwts_cpu_topology_sysfs(fwts_cpu_topology_cpu *cpu)
+{
+	cpu->sysfs = true;
+	cpu->online = fwts_cpu_topology_get_int(cpu->cpu, "online", 1) != 0;
+	cpu->package = fwts_cpu_topology_get_int(cpu->cpu,
+		"topology/physical_package_id", FWTS_CPU_TOPOLOGY_NONE);
+	cpu->policy = fwts_cpu_topology_policy(cpu->cpu);
+}
+
+/*
+ *  fwts_cpu_topology_info_set()
+ *	fill in the /proc/cpuinfo details of a CPU
+ */
+static int fwts_cpu_topology_info_set(
+	fwts_cpu_topology *topology,
+	fwts_cpu_topology_cpu *cpu,
+	const fwts_cpu_topology_info *info)
+{
+	cpu->has_info = true;
+	cpu->vendor_id = fwts_cpu_topology_intern(topology, &info->vendor_id);
+	cpu->model_name = fwts_cpu_topology_intern(topology, &info->model_name);
+	cpu->flags_text = fwts_cpu_topology_intern(topology, &info->flags);
+	cpu->family = info->family;
+	cpu->model = info->model;
+	cpu->stepping = info->stepping;
+
+	if ((info->vendor_id.value && !cpu->vendor_id) ||
+	    (info->model_name.value && !cpu->model_name) ||
+	    (info->flags.value && !cpu->flags_text))
+		return FWTS_ERROR;
+
+	return FWTS_OK;
+}
+
+/*
+ *  fwts_cpu_topology_bitsets()
+ *	name all the flags, then give each distinct flags line a bitset
+ */
+static int fwts_cpu_topology_bitsets(fwts_cpu_topology *topology)
+{
+	int i, j;
+
+	for (i = 0; i < topology->len; i++) {
+		const char *flags = topology->cpus[i].flags_text;
+
+		/* Lines are interned, so only parse each one once */
+		if (flags && ((i == 0) || (flags != topology->cpus[i - 1].flags_text)))
+			if (fwts_cpu_topology_flags(topology, flags, NULL) != FWTS_OK)
+				return FWTS_ERROR;
+	}
+	topology->flag_words = (topology->n_flags + 63) / 64;
+	if (!topology->flag_words)
+		return FWTS_OK;
+
+	for (i = 0; i < topology->len; i++) {
+		fwts_cpu_topology_cpu *cpu = &topology->cpus[i];
+
+		if (!cpu->flags_text)
+			continue;
+		/* Share the bitset of an earlier CPU with the same line */
+		for (j = i - 1; j >= 0; j--) {
+			if (topology->cpus[j].flags_text == cpu->flags_text) {
+				cpu->flags = topology->cpus[j].flags;
+				break;
+			}
+		}
+		if (cpu->flags)
+			continue;
+		if ((cpu->flags = calloc(topology->flag_words, sizeof(uint64_t))) == NULL)
+			return FWTS_ERROR;
+		cpu->flags_owner = true;
+		if (fwts_cpu_topology_flags(topology, cpu->flags_text, cpu->flags) != FWTS_OK)
+			return FWTS_ERROR;
+	}
+	return FWTS_OK;
+}
+
+/*
+ *  fwts_cpu_topology_masters()
+ *	the lowest online CPU of each cpufreq policy is its master
+ */
+static int fwts_cpu_topology_masters(fwts_cpu_topology *topology)
+{
+	bool *seen;
+	int i, n = 0;
+
+	for (i = 0; i < topology->len; i++)
+		if (topology->cpus[i].policy >= n)
+			n = topology->cpus[i].policy + 1;
+	if (!n)
+		return FWTS_OK;
+	if ((seen = calloc(n, sizeof(*seen))) == NULL)
+		return FWTS_ERROR;
+
+	for (i = 0; i < topology->len; i++) {
+		fwts_cpu_topology_cpu *cpu = &topology->cpus[i];
+
+		if (!cpu->online || (cpu->policy < 0) || seen[cpu->policy])
+			continue;
+		seen[cpu->policy] = true;
+		cpu->policy_master = true;
+	}
+	free(seen);
+
+	return FWTS_OK;
+}
+
+/*
+ *  fwts_cpu_topology_new()
+ *	build a model of all the CPUs from /proc/cpuinfo and sysfs, this
+ *	takes a fresh snapshot, fwts_cpu_topology_get() should be used
+ *	unless CPUs are expected to have been hotplugged
+ */
+fwts_cpu_topology *fwts_cpu_topology_new(void)
+{
+	fwts_cpu_topology *topology;
+	fwts_cpu_topology_info *infos = NULL;
+	fwts_blob blob = FWTS_BLOB_INIT;
+	int *sysfs_cpus = NULL;
+	int i, n_infos = 0, n_sysfs_cpus = 0, len = 0;
+
+	if ((topology = calloc(1, sizeof(*topology))) == NULL)
+		return NULL;
+	topology->first_cpu = FWTS_CPU_TOPOLOGY_NONE;
+
+	/* A missing /proc/cpuinfo or sysfs just leaves those details out */
+	if (fwts_blob_load(&blob, FWTS_CPU_TOPOLOGY_CPUINFO) == FWTS_OK)
+		if (fwts_cpu_topology_cpuinfo(&blob, &infos, &n_infos) != FWTS_OK)
+			goto err;
+	if (fwts_cpu_topology_sysfs_cpus(&sysfs_cpus, &n_sysfs_cpus) != FWTS_OK)
+		goto err;
+
+	for (i = 0; i < n_infos; i++)
+		if (infos[i].cpu >= len)
+			len = infos[i].cpu + 1;
+	for (i = 0; i < n_sysfs_cpus; i++)
+		if (sysfs_cpus[i] >= len)
+			len = sysfs_cpus[i] + 1;
+
+	if (len && ((topology->cpus = calloc(len, sizeof(*topology->cpus))) == NULL))
+		goto err;
+	topology->len = len;
+	for (i = 0; i < len; i++) {
+		fwts_cpu_topology_cpu *cpu = &topology->cpus[i];
+
+		cpu->cpu = i;
+		cpu->package = FWTS_CPU_TOPOLOGY_NONE;
+		cpu->policy = FWTS_CPU_TOPOLOGY_NONE;
+	}
+
+	for (i = 0; i < n_infos; i++) {
+		fwts_cpu_topology_cpu *cpu;
+
+		if (infos[i].cpu < 0)
+			continue;
+		cpu = &topology->cpus[infos[i].cpu];
+		if (cpu->has_info)
+			continue;
+		if (fwts_cpu_topology_info_set(topology, cpu, &infos[i]) != FWTS_OK)
+			goto err;
+		/* Listed CPUs are online, even without a sysfs online file */
+		cpu->online = true;
+		if (topology->first_cpu == FWTS_CPU_TOPOLOGY_NONE)
+			topology->first_cpu = infos[i].cpu;
+	}
+	for (i = 0; i < n_sysfs_cpus; i++)
+		fwts_cpu_topology_sysfs(&topology->cpus[sysfs_cpus[i]]);
+
+	for (i = 0; i < len; i++)
+		if (topology->cpus[i].has_info || topology->cpus[i].sysfs)
+			topology->n_cpus++;
+
+	if ((fwts_cpu_topology_bitsets(topology) != FWTS_OK) ||
+	    (fwts_cpu_topology_masters(topology) != FWTS_OK))
+		goto err;
+
+	free(sysfs_cpus);
+	free(infos);
+	fwts_blob_free(&blob);
+
+	return topology;
+
+err:
+	free(sysfs_cpus);
+	free(infos);
+	fwts_blob_free(&blob);
+	fwts_cpu_topology_free(topology);
+
+	return NULL;
+}
+
+/*
+ *  fwts_cpu_topology_free()
+ *	free a CPU topology
+ */
+void fwts_cpu_topology_free(fwts_cpu_topology *topology)
+{
+	int i;
+
+	if (!topology)
+		return;
+
+	for (i = 0; i < topology->len; i++)
+		if (topology->cpus[i].flags_owner)
+			free(topology->cpus[i].flags);
+	for (i = 0; i < topology->strings_len; i++)
+		free(topology->strings[i]);
+	for (i = 0; i < topology->n_flags; i++)
+		free(topology->flag_names[i]);
+	free(topology->cpus);
+	free(topology->strings);
+	free(topology->flag_names);
+	free(topology->flag_hash);
+	free(topology);
+}
+
+/*
+ *  fwts_cpu_topology_get()
+ *	get the CPU topology shared by all tests, it is built on
+ *	first use and kept until fwts_cpu_topology_put()
+ */
+fwts_cpu_topology *fwts_cpu_topology_get(void)
+{
+	fwts_cpu_topology *topology;
+
+	pthread_mutex_lock(&cpu_topology_lock);
+	if (!cpu_topology)
+		cpu_topology = fwts_cpu_topology_new();
+	topology = cpu_topology;
+	pthread_mutex_unlock(&cpu_topology_lock);
+
+	return topology;
+}
+
+/*
+ *  fwts_cpu_topology_put()
+ *	drop the shared CPU topology
+ */
+void fwts_cpu_topology_put(void)
+{
+	pthread_mutex_lock(&cpu_topology_lock);
+	fwts_cpu_topology_free(cpu_topology);
+	cpu_topology = NULL;
+	pthread_mutex_unlock(&cpu_topology_lock);
+}
+
+/*
+ *  fwts_cpu_topology_find()
+ *	find a CPU by its logical CPU number, NULL if there is no such CPU
+ */
+const fwts_cpu_topology_cpu *fwts_cpu_topology_find(
+	const fwts_cpu_topology *topology,
+	const int cpu)
+{
+	const fwts_cpu_topology_cpu *found;
+
+	if (!topology || (cpu < 0) || (cpu >= topology->len))
+		return NULL;
+
+	found = &topology->cpus[cpu];
+
+	return (found->has_info || found->sysfs) ? found : NULL;
+}
+
+/*
+ *  fwts_cpu_topology_flag()
+ *	get the bit number of a /proc/cpuinfo flag, -1 if no CPU has it
+ */
+int fwts_cpu_topology_flag(const fwts_cpu_topology *topology, const char *name)
+{
+	uint32_t h;
+
+	if (!topology || !topology->flag_hash_size)
+		return -1;
+
+	h = fwts_cpu_topology_flag_slot(topology, name, strlen(name));
+
+	return topology->flag_hash[h] ? (int)topology->flag_hash[h] - 1 : -1;
+}
+
+/*
+ *  fwts_cpu_topology_has_flag()
+ *	check if a CPU has a /proc/cpuinfo flag, by bit number
+ */
+bool fwts_cpu_topology_has_flag(const fwts_cpu_topology_cpu *cpu, const int flag)
+{
+	if (!cpu || !cpu->flags || (flag < 0))
+		return false;
+
+	return (cpu->flags[flag / 64] >> (flag % 64)) & 1;
+}
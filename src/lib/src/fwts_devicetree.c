@@ -20,7 +20,12 @@
 #define _GNU_SOURCE
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <ctype.h>
+#include <limits.h>
+#include <dirent.h>
+#include <sys/stat.h>
 
 #include "fwts.h"
 
@@ -28,42 +33,319 @@
 
 proc_gen_t proc_gen;
 
-int fwts_devicetree_read(fwts_framework *fwts)
+/* Initial size of a devicetree blob built from the live tree */
+#define FWTS_DT_BUILD_SIZE	(64 * 1024)
+
+typedef enum {
+	FWTS_DT_WANT_NONE,		/* node is not needed */
+	FWTS_DT_WANT_PATH,		/* node is on the path to a subtree */
+	FWTS_DT_WANT_ALL,		/* node is in a subtree */
+} fwts_dt_want;
+
+typedef struct {
+	void *fdt;			/* blob being built */
+	int size;			/* size of blob buffer */
+	const char * const *subtrees;	/* subtrees to build, NULL for all */
+} fwts_dt_builder;
+
+/*
+ *  fwts_dt_grow()
+ *	double the size of the blob being built
+ */
+static int fwts_dt_grow(fwts_dt_builder *builder)
 {
-	char *command, *data = NULL;
-	int fd, rc, status;
-	ssize_t len;
-	pid_t pid;
+	void *fdt;
+	int ret;
+
+	if (builder->size > INT_MAX / 2)
+		return -FDT_ERR_NOSPACE;
+	if ((fdt = malloc(builder->size * 2)) == NULL)
+		return -FDT_ERR_NOSPACE;
+	if ((ret = fdt_resize(builder->fdt, fdt, builder->size * 2)) < 0) {
+		free(fdt);
+		return ret;
+	}
+	free(builder->fdt);
+	builder->fdt = fdt;
+	builder->size *= 2;
 
-	if (!fwts_firmware_has_features(FWTS_FW_FEATURE_DEVICETREE))
-		return FWTS_OK;
+	return 0;
+}
 
-	rc = asprintf(&command, "dtc -I fs -O dtb %s", DT_FS_PATH);
-	if (rc < 0)
-		return FWTS_ERROR;
+static int fwts_dt_begin_node(fwts_dt_builder *builder, const char *name)
+{
+	int ret;
 
-	rc = fwts_pipe_open_ro(command, &pid, &fd);
-	if (rc < 0) {
-		free(command);
-		return FWTS_ERROR;
+	while ((ret = fdt_begin_node(builder->fdt, name)) == -FDT_ERR_NOSPACE)
+		if ((ret = fwts_dt_grow(builder)) < 0)
+			break;
+	return ret;
+}
+
+static int fwts_dt_end_node(fwts_dt_builder *builder)
+{
+	int ret;
+
+	while ((ret = fdt_end_node(builder->fdt)) == -FDT_ERR_NOSPACE)
+		if ((ret = fwts_dt_grow(builder)) < 0)
+			break;
+	return ret;
+}
+
+static int fwts_dt_property(
+	fwts_dt_builder *builder,
+	const char *name,
+	const void *value,
+	const int len)
+{
+	int ret;
+
+	while ((ret = fdt_property(builder->fdt, name, value, len)) == -FDT_ERR_NOSPACE)
+		if ((ret = fwts_dt_grow(builder)) < 0)
+			break;
+	return ret;
+}
+
+/*
+ *  fwts_dt_subtree_want()
+ *	how much of a node a subtree needs; a subtree path component
+ *	without a unit address matches any unit address, as it does
+ *	for fdt_path_offset()
+ */
+static fwts_dt_want fwts_dt_subtree_want(const char *subtree, const char *path)
+{
+	for (;;) {
+		size_t subtree_len, path_len;
+
+		while (*subtree == '/')
+			subtree++;
+		while (*path == '/')
+			path++;
+		if (*subtree == '\0')
+			return FWTS_DT_WANT_ALL;
+		if (*path == '\0')
+			return FWTS_DT_WANT_PATH;
+
+		subtree_len = strcspn(subtree, "/");
+		path_len = strcspn(path, "/");
+		if (strncmp(subtree, path, subtree_len))
+			return FWTS_DT_WANT_NONE;
+		if ((path_len != subtree_len) &&
+		    ((path[subtree_len] != '@') || memchr(subtree, '@', subtree_len)))
+			return FWTS_DT_WANT_NONE;
+		subtree += subtree_len;
+		path += path_len;
 	}
-	free(command);
+}
 
-	rc = fwts_pipe_read(fd, &data, &len);
-	if (rc) {
-		fwts_pipe_close(fd, pid);
+/*
+ *  fwts_dt_want_node()
+ *	how much of a node any of the subtrees being built need
+ */
+static fwts_dt_want fwts_dt_want_node(const fwts_dt_builder *builder, const char *path)
+{
+	const char * const *subtree;
+	fwts_dt_want want = FWTS_DT_WANT_NONE;
+
+	if (!builder->subtrees)
+		return FWTS_DT_WANT_ALL;
+
+	for (subtree = builder->subtrees; *subtree; subtree++) {
+		fwts_dt_want subtree_want = fwts_dt_subtree_want(*subtree, path);
+
+		if (subtree_want > want)
+			want = subtree_want;
+	}
+	return want;
+}
+
+/*
+ *  fwts_dt_entry_type()
+ *	get the type of a directory entry, following symbolic links
+ */
+static unsigned char fwts_dt_entry_type(const char *dir, const struct dirent *entry)
+{
+	char path[PATH_MAX];
+	struct stat buf;
+
+	if ((entry->d_type != DT_UNKNOWN) && (entry->d_type != DT_LNK))
+		return entry->d_type;
+
+	snprintf(path, sizeof(path), "%s/%s", dir, entry->d_name);
+	if (stat(path, &buf) < 0)
+		return DT_UNKNOWN;
+	if (S_ISREG(buf.st_mode))
+		return DT_REG;
+	if (S_ISDIR(buf.st_mode))
+		return DT_DIR;
+	return DT_UNKNOWN;
+}
+
+/*
+ *  fwts_dt_build_node()
+ *	add a node of the live devicetree in directory dir to the blob,
+ *	properties are files and subnodes are directories; properties
+ *	have to be added before any subnodes
+ */
+static int fwts_dt_build_node(
+	fwts_dt_builder *builder,
+	const char *dir,
+	const char *path,
+	const char *name,
+	const fwts_dt_want want)
+{
+	struct dirent **namelist;
+	char entry[PATH_MAX], entry_path[PATH_MAX];
+	int i, n, ret;
+
+	if ((n = scandir(dir, &namelist, NULL, alphasort)) < 0)
 		return FWTS_ERROR;
+
+	if (fwts_dt_begin_node(builder, name) < 0)
+		goto err;
+
+	for (i = 0; i < n; i++) {
+		fwts_blob blob = FWTS_BLOB_INIT;
+
+		if (fwts_dt_entry_type(dir, namelist[i]) != DT_REG)
+			continue;
+
+		snprintf(entry, sizeof(entry), "%s/%s", dir, namelist[i]->d_name);
+		if (fwts_blob_load(&blob, entry) != FWTS_OK)
+			goto err;
+		ret = fwts_dt_property(builder, namelist[i]->d_name, blob.data, (int)blob.len);
+		fwts_blob_free(&blob);
+		if (ret < 0)
+			goto err;
+	}
+
+	for (i = 0; i < n; i++) {
+		fwts_dt_want entry_want = want;
+
+		if (!strcmp(namelist[i]->d_name, ".") ||
+		    !strcmp(namelist[i]->d_name, ".."))
+			continue;
+		if (fwts_dt_entry_type(dir, namelist[i]) != DT_DIR)
+			continue;
+
+		snprintf(entry_path, sizeof(entry_path), "%s/%s", path, namelist[i]->d_name);
+		if (want != FWTS_DT_WANT_ALL)
+			entry_want = fwts_dt_want_node(builder, entry_path);
+		if (entry_want == FWTS_DT_WANT_NONE)
+			continue;
+
+		snprintf(entry, sizeof(entry), "%s/%s", dir, namelist[i]->d_name);
+		if (fwts_dt_build_node(builder, entry, entry_path,
+				namelist[i]->d_name, entry_want) != FWTS_OK)
+			goto err;
+	}
+
+	if (fwts_dt_end_node(builder) < 0)
+		goto err;
+
+	for (i = 0; i < n; i++)
+		free(namelist[i]);
+	free(namelist);
+
+	return FWTS_OK;
+err:
+	for (i = 0; i < n; i++)
+		free(namelist[i]);
+	free(namelist);
+
+	return FWTS_ERROR;
+}
+
+/*
+ *  fwts_dt_build()
+ *	flatten the live devicetree, or just the given subtrees of it
+ *	and the nodes on the way to them
+ */
+static void *fwts_dt_build(const char * const *subtrees)
+{
+	fwts_dt_builder builder;
+	void *fdt;
+	int ret;
+
+	builder.size = FWTS_DT_BUILD_SIZE;
+	builder.subtrees = subtrees;
+	if ((builder.fdt = malloc(builder.size)) == NULL)
+		return NULL;
+
+	if ((fdt_create(builder.fdt, builder.size) < 0) ||
+	    (fdt_finish_reservemap(builder.fdt) < 0))
+		goto err;
+	if (fwts_dt_build_node(&builder, DT_FS_PATH, "",
+			"", fwts_dt_want_node(&builder, "")) != FWTS_OK)
+		goto err;
+	while ((ret = fdt_finish(builder.fdt)) == -FDT_ERR_NOSPACE)
+		if ((ret = fwts_dt_grow(&builder)) < 0)
+			break;
+	if (ret < 0)
+		goto err;
+
+	/* Trim the unused end of the buffer */
+	if ((fdt = realloc(builder.fdt, fdt_totalsize(builder.fdt))) != NULL)
+		builder.fdt = fdt;
+
+	return builder.fdt;
+err:
+	free(builder.fdt);
+	return NULL;
+}
+
+/*
+ *  fwts_dt_boot_fdt()
+ *	get a copy of the devicetree blob the kernel was booted with,
+ *	the kernel only provides it if it is unchanged since boot
+ */
+static void *fwts_dt_boot_fdt(void)
+{
+	fwts_blob blob = FWTS_BLOB_INIT;
+	void *fdt;
+
+	if (fwts_blob_load(&blob, DT_FDT_PATH) != FWTS_OK)
+		return NULL;
+
+	if ((blob.len < sizeof(struct fdt_header)) ||
+	    (fdt_check_header(blob.data) != 0) ||
+	    (fdt_totalsize(blob.data) > blob.len)) {
+		fwts_blob_free(&blob);
+		return NULL;
 	}
 
-	status = fwts_pipe_close(fd, pid);
+	/* sysfs files are read into the heap, otherwise take a copy of the mapping */
+	if (!blob.map_len)
+		return blob.data;
+	if ((fdt = malloc(blob.len)) != NULL)
+		memcpy(fdt, blob.data, blob.len);
+	fwts_blob_free(&blob);
+
+	return fdt;
+}
+
+/*
+ *  fwts_devicetree_read()
+ *	read the devicetree into fwts->fdt, preferring the blob the
+ *	kernel was booted with and otherwise flattening the live tree.
+ *	subtrees is a NULL terminated list of the subtrees tests need
+ *	from the live tree, NULL to flatten all of it
+ */
+int fwts_devicetree_read(fwts_framework *fwts, const char * const *subtrees)
+{
+	void *fdt;
+
+	if (!fwts_firmware_has_features(FWTS_FW_FEATURE_DEVICETREE))
+		return FWTS_OK;
 
-	if (!WIFEXITED(status) || WEXITSTATUS(status) != 0 || len == 0) {
-		fprintf(stderr, "Cannot read devicetree data: dtc failed\n");
-		free(data);
+	if ((fdt = fwts_dt_boot_fdt()) == NULL)
+		fdt = fwts_dt_build(subtrees);
+	if (fdt == NULL) {
+		fprintf(stderr, "Cannot read devicetree data from %s\n", DT_FS_PATH);
 		return FWTS_ERROR;
 	}
 
-	fwts->fdt = data;
+	fwts->fdt = fdt;
 
 	return FWTS_OK;
 }
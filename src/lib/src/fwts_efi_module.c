@@ -25,6 +25,7 @@
 #include <unistd.h>
 
 #include "fwts_pipeio.h"
+#include "fwts_uefi_latency.h"
 
 static char *efi_dev_name = NULL;
 static char *module_name = NULL;
@@ -233,6 +234,7 @@ int fwts_lib_efi_runtime_module_init(fwts_framework *fw, int *fd)
 		fwts_log_info(fw, "Cannot open EFI test driver. Aborted.");
 		return FWTS_ABORTED;
 	}
+	fwts_uefi_latency_init(fw);
 
 	return FWTS_OK;
 }
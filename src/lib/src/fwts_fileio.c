@@ -100,3 +100,18 @@ fwts_list* fwts_gzfile_open_and_read(const char *file)
 
 	return list;
 }
+
+/*
+ *  fwts_csv_escape()
+ *	write str to fp as a quoted CSV field, doubling any quotes
+ */
+void fwts_csv_escape(FILE *fp, const char *str)
+{
+	fputc('"', fp);
+	for (; *str; str++) {
+		if (*str == '"')
+			fputc('"', fp);
+		fputc(*str, fp);
+	}
+	fputc('"', fp);
+}
@@ -27,11 +27,22 @@
 #include <time.h>
 #include <getopt.h>
 #include <bsd/string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <poll.h>
 #include <sys/utsname.h>
 #include <sys/time.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/stat.h>
+#include <dirent.h>
 
 #include "fwts.h"
 #include "fwts_pm_method.h"
+#include "fwts_uefi_latency.h"
+#if defined(FWTS_HAS_ACPI)
+#include "fwts_acpi_object_eval.h"
+#endif
 
 typedef struct {
 	const char *title;		/* Test category */
@@ -46,6 +57,8 @@ typedef struct {
 /* Suffix ".log", ".xml", etc gets automatically appended */
 #define RESULTS_LOG	"results"
 
+#define FWTS_FRAMEWORK_JOBS_MAX		(256)
+
 #define FWTS_FLAG_RUN_ALL			\
 	(fwts_framework_flags)			\
 	(FWTS_FLAG_BATCH |			\
@@ -140,6 +153,14 @@ static fwts_option fwts_framework_options[] = {
 	{ "ifv",		"",   0, "Run tests in firmware-vendor modes." },
 	{ "clog",		"",   1, "Specify a coreboot logfile dump" },
 	{ "ebbr",		"",   0, "Run EBBR tests." },
+	{ "log-pattern-cache",	"",   1, "Specify a directory to cache parsed log pattern tables in, e.g. --log-pattern-cache=/var/cache/fwts" },
+	{ "acpica-profile",	"",   2, "Profile ACPI method evaluation, optionally export to a .json or .csv file, e.g. --acpica-profile=profile.csv" },
+	{ "jobs",		"",   1, "Run tests that are safe to run in parallel in N processes, e.g. --jobs=8" },
+	{ "uefi-latency",	"",   2, "Time UEFI runtime service calls, optionally export to a .json or .csv file, e.g. --uefi-latency=latency.csv" },
+	{ "uefi-latency-threshold", "", 1, "Specify UEFI runtime service latency threshold in microseconds, e.g. --uefi-latency-threshold=50000,SetVariable=200000" },
+	{ "replay-corpus",	"",   1, "Run offline tests on each captured machine in a directory, e.g. --replay-corpus=/srv/captures" },
+	{ "replay-output",	"",   1, "Specify directory for per capture --replay-corpus results logs, default is fwts-replay." },
+	{ "devicetree-lazy",	"",   0, "Only read the devicetree subtrees the tests use when flattening the live devicetree." },
 	{ NULL, NULL, 0, NULL }
 };
 
@@ -181,7 +202,9 @@ void fwts_framework_test_add(
 {
 	fwts_framework_test *new_test;
 
-	if (flags & ~(FWTS_FLAG_RUN_ALL | FWTS_FLAG_ROOT_PRIV)) {
+	if (flags & ~(FWTS_FLAG_RUN_ALL | FWTS_FLAG_ROOT_PRIV |
+		      FWTS_FLAG_PARALLEL | FWTS_FLAG_ACPI_NAMESPACE |
+		      FWTS_FLAG_OFFLINE)) {
 		fprintf(stderr, "Test %s flags must be a bit field in 0x%x, got 0x%x\n",
 			name, FWTS_FLAG_RUN_ALL, flags);
 		exit(EXIT_FAILURE);
@@ -566,11 +589,12 @@ static int fwts_framework_total_summary(fwts_framework *fw)
 	return FWTS_OK;
 }
 
-static int fwts_framework_run_test(fwts_framework *fw, fwts_framework_test *test)
+/*
+ *  fwts_framework_test_start()
+ *	set up the framework state to start running a test
+ */
+static void fwts_framework_test_start(fwts_framework *fw, fwts_framework_test *test)
 {
-	fwts_framework_minor_test *minor_test;
-	int ret;
-
 	fw->current_major_test = test;
 	fw->current_minor_test_name = "";
 
@@ -581,9 +605,6 @@ static int fwts_framework_run_test(fwts_framework *fw, fwts_framework_test *test
 
 	fw->failed_level = 0;
 
-	fwts_log_section_begin(fw->results, test->name);
-	fwts_log_set_owner(fw->results, test->name);
-
 	fw->current_minor_test_num = 1;
 	fw->show_progress = (fw->flags & FWTS_FLAG_SHOW_PROGRESS) &&
 			    (FWTS_TEST_INTERACTIVE(test->flags) == 0);
@@ -591,17 +612,76 @@ static int fwts_framework_run_test(fwts_framework *fw, fwts_framework_test *test
 	/* Not a utility test?, then we require a test summary at end of the test run */
 	if (!(test->flags & FWTS_FLAG_UTILS))
 		fw->print_summary = true;
+}
+
+/*
+ *  fwts_framework_test_heading()
+ *	show the test being run
+ */
+static void fwts_framework_test_heading(fwts_framework *fw, fwts_framework_test *test)
+{
+	if (test->ops->description && fw->show_progress) {
+		char buf[70];
+		fwts_framework_strtrunc(buf, test->ops->description, sizeof(buf));
+		fprintf(stderr, "Test: %-70.70s\n", buf);
+	}
+}
+
+/*
+ *  ACPI tables preloaded once per run by fwts_framework_tables_preload()
+ *  and the log output from loading them, which is written out by the
+ *  next ACPI test to run as that is where a serial run would log it
+ */
+static bool fwts_framework_tables_preloaded;
+static bool fwts_framework_tables_ok;
+static void *fwts_framework_tables_log;
+static size_t fwts_framework_tables_log_len;
+
+/*
+ *  fwts_framework_tables_log_drop()
+ *	forget the log output from preloading the ACPI tables
+ */
+static void fwts_framework_tables_log_drop(void)
+{
+	free(fwts_framework_tables_log);
+	fwts_framework_tables_log = NULL;
+	fwts_framework_tables_log_len = 0;
+}
+
+/*
+ *  fwts_framework_tables_log_replay()
+ *	write out the log output from preloading the ACPI tables if
+ *	the test uses them and it has not been written out yet
+ */
+static void fwts_framework_tables_log_replay(fwts_framework *fw, fwts_framework_test *test)
+{
+	if (!fwts_framework_tables_log ||
+	    !(test->flags & (FWTS_FLAG_ACPI | FWTS_FLAG_ACPI_NAMESPACE)))
+		return;
+
+	(void)fwts_log_capture_replay(fw, fwts_framework_tables_log,
+		fwts_framework_tables_log_len);
+	fwts_framework_tables_log_drop();
+}
+
+/*
+ *  fwts_framework_test_body()
+ *	run the test's init, minor tests and deinit
+ */
+static void fwts_framework_test_body(fwts_framework *fw, fwts_framework_test *test)
+{
+	fwts_framework_minor_test *minor_test;
+	int ret;
+
+	fwts_log_section_begin(fw->results, test->name);
+	fwts_log_set_owner(fw->results, test->name);
 
 	if (test->ops->description) {
 		fwts_log_heading(fw, "%s: %s", test->name, test->ops->description);
 		fwts_framework_underline(fw,'-');
-		if (fw->show_progress) {
-			char buf[70];
-			fwts_framework_strtrunc(buf, test->ops->description, sizeof(buf));
-			fprintf(stderr, "Test: %-70.70s\n", buf);
-		}
 	}
 
+	fwts_framework_tables_log_replay(fw, test);
 	fwts_framework_minor_test_progress(fw, 0, "");
 
 	if ((test->flags & FWTS_FLAG_ROOT_PRIV) &&
@@ -613,7 +693,7 @@ static int fwts_framework_run_test(fwts_framework *fw, fwts_framework_test *test
 			fwts_framework_minor_test_progress_clear_line();
 			fprintf(stderr, " Test aborted\n");
 		}
-		goto done;
+		return;
 	}
 
 	if (!fwts_firmware_has_features(test->fw_features)) {
@@ -630,7 +710,7 @@ static int fwts_framework_run_test(fwts_framework *fw, fwts_framework_test *test
 			fprintf(stderr, "  %s: %s\n",
 				msg, fwts_firmware_feature_string(missing));
 		}
-		goto done;
+		return;
 	}
 
 	if ((test->ops->init) &&
@@ -652,7 +732,7 @@ static int fwts_framework_run_test(fwts_framework *fw, fwts_framework_test *test
 			fwts_framework_minor_test_progress_clear_line();
 			fprintf(stderr, " %s.\n", msg);
 		}
-		goto done;
+		return;
 	}
 
 	fwts_log_section_begin(fw->results, "subtests");
@@ -710,8 +790,14 @@ static int fwts_framework_run_test(fwts_framework *fw, fwts_framework_test *test
 
 	if (test->ops->deinit)
 		test->ops->deinit(fw);
+}
 
-done:
+/*
+ *  fwts_framework_test_finish()
+ *	write the test results and close the test's log section
+ */
+static void fwts_framework_test_finish(fwts_framework *fw, fwts_framework_test *test)
+{
 	if (!(test->flags & FWTS_FLAG_UTILS)) {
 		fwts_log_section_begin(fw->results, "results");
 		fwts_framework_test_summary(fw);
@@ -720,10 +806,402 @@ done:
 
 	fwts_log_section_end(fw->results);		/* test->name */
 	fwts_log_set_owner(fw->results, "fwts");
+}
+
+static int fwts_framework_run_test(fwts_framework *fw, fwts_framework_test *test)
+{
+	fwts_framework_test_start(fw, test);
+	fwts_framework_test_heading(fw, test);
+	fwts_framework_test_body(fw, test);
+	fwts_framework_test_finish(fw, test);
+
+	/* PCI config space may have been changed by a suspend or resume */
+	if (test->flags & FWTS_FLAG_POWER_STATES)
+		fwts_pci_topology_put();
+
+	return FWTS_OK;
+}
 
+/*
+ *  test state sent back to the parent by a forked test worker,
+ *  followed by log_len bytes of captured log records
+ */
+typedef struct {
+	fwts_results results;		/* test results */
+	fwts_results total;		/* what the test added to fw->total */
+	fwts_log_level failed_level;	/* failed levels */
+	bool error_filtered_out;	/* last failure was filtered out */
+	uint64_t log_len;		/* size of captured log */
+} fwts_framework_job_record;
+
+typedef struct {
+	fwts_framework_test *test;	/* test being run */
+	uint32_t test_num;		/* test number in run order */
+	pid_t pid;			/* worker pid, -1 if not forked */
+	int fd;				/* read end of pipe, -1 when closed */
+	bool done;			/* worker has finished */
+	bool session;			/* forked from the ACPI namespace session */
+	char *data;			/* data read from worker */
+	size_t len;			/* bytes read */
+	size_t size;			/* size of data */
+} fwts_framework_job;
+
+/*
+ *  fwts_framework_write()
+ *	write all of buf to fd
+ */
+static int fwts_framework_write(const int fd, const void *buf, size_t len)
+{
+	const char *ptr = buf;
+
+	while (len > 0) {
+		ssize_t ret = write(fd, ptr, len);
+
+		if (ret < 0) {
+			if (errno == EINTR)
+				continue;
+			return FWTS_ERROR;
+		}
+		ptr += ret;
+		len -= ret;
+	}
 	return FWTS_OK;
 }
 
+/*
+ *  fwts_framework_test_worker()
+ *	run a test with its log captured and send the captured log
+ *	and results down the pipe, this runs in a forked child
+ */
+static void fwts_framework_test_worker(
+	fwts_framework *fw,
+	fwts_framework_job *job,
+	const int fd)
+{
+	fwts_framework_test *test = job->test;
+	fwts_framework_job_record record;
+	size_t log_len;
+	void *log;
+
+	/*
+	 *  Parallel tests have their progress reported by the parent as
+	 *  the log is replayed, a session test is the only one running
+	 *  so it can report its own
+	 */
+	if (!job->session)
+		fw->flags &= ~(FWTS_FLAG_SHOW_PROGRESS | FWTS_FLAG_SHOW_PROGRESS_DIALOG);
+	fwts_results_zero(&fw->total);
+
+	fwts_log_capture_begin();
+	fwts_framework_test_start(fw, test);
+	fwts_framework_test_heading(fw, test);
+	fwts_framework_test_body(fw, test);
+	log = fwts_log_capture_end(&log_len);
+	fflush(stdout);
+	fflush(stderr);
+
+	memset(&record, 0, sizeof(record));
+	record.results = test->results;
+	record.total = fw->total;
+	record.failed_level = fw->failed_level;
+	record.error_filtered_out = fw->error_filtered_out;
+	record.log_len = log_len;
+
+	if ((fwts_framework_write(fd, &record, sizeof(record)) != FWTS_OK) ||
+	    (fwts_framework_write(fd, log, log_len) != FWTS_OK)) {
+		free(log);
+		_exit(EXIT_FAILURE);
+	}
+	free(log);
+	_exit(EXIT_SUCCESS);
+}
+
+/*
+ *  fwts_framework_job_start()
+ *	fork a worker to run a parallel safe test
+ */
+static void fwts_framework_job_start(
+	fwts_framework *fw,
+	fwts_framework_job *jobs,
+	const int n,
+	const int i)
+{
+	int fds[2];
+
+	jobs[i].pid = -1;
+	jobs[i].fd = -1;
+	jobs[i].done = true;
+
+	if (pipe(fds) < 0)
+		return;
+	jobs[i].pid = fork();
+	if (jobs[i].pid < 0) {
+		(void)close(fds[0]);
+		(void)close(fds[1]);
+		return;
+	}
+	if (jobs[i].pid == 0) {
+		int j;
+
+		/* Drop read ends of pipes to other workers */
+		for (j = 0; j < n; j++)
+			if (jobs[j].fd >= 0)
+				(void)close(jobs[j].fd);
+		(void)close(fds[0]);
+		fw->current_major_test_num = jobs[i].test_num;
+		fwts_framework_test_worker(fw, &jobs[i], fds[1]);
+	}
+	(void)close(fds[1]);
+	jobs[i].fd = fds[0];
+	jobs[i].done = false;
+
+	/* The worker writes out the table loading log, if it is due */
+	if (jobs[i].test->flags & (FWTS_FLAG_ACPI | FWTS_FLAG_ACPI_NAMESPACE))
+		fwts_framework_tables_log_drop();
+}
+
+/*
+ *  fwts_framework_job_read()
+ *	read what is available from a worker, flag the job as done
+ *	on end of file or error
+ */
+static void fwts_framework_job_read(fwts_framework_job *job)
+{
+	ssize_t len;
+
+	if (job->size - job->len < 16384) {
+		size_t size = job->size ? job->size * 2 : 65536;
+		char *data = realloc(job->data, size);
+
+		if (!data) {
+			free(job->data);
+			job->data = NULL;
+			job->len = 0;
+			job->size = 0;
+			(void)close(job->fd);
+			job->fd = -1;
+			job->done = true;
+			return;
+		}
+		job->data = data;
+		job->size = size;
+	}
+	len = read(job->fd, job->data + job->len, job->size - job->len);
+	if (len > 0) {
+		job->len += len;
+	} else if ((len == 0) || (errno != EINTR)) {
+		(void)close(job->fd);
+		job->fd = -1;
+		job->done = true;
+	}
+}
+
+/*
+ *  fwts_framework_job_finish()
+ *	reap a worker and write out its results in the same way a
+ *	serial run would, if the worker failed then run the test
+ *	serially instead
+ */
+static void fwts_framework_job_finish(fwts_framework *fw, fwts_framework_job *job)
+{
+	fwts_framework_test *test = job->test;
+	fwts_framework_job_record record;
+	int status = -1;
+
+	if (job->pid > 0)
+		(void)waitpid(job->pid, &status, 0);
+
+	fw->current_major_test_num = job->test_num;
+
+	memset(&record, 0, sizeof(record));
+	if (job->len >= sizeof(record))
+		memcpy(&record, job->data, sizeof(record));
+
+	if ((job->pid <= 0) ||
+	    !WIFEXITED(status) || (WEXITSTATUS(status) != EXIT_SUCCESS) ||
+	    (job->len < sizeof(record)) ||
+	    (record.log_len != job->len - sizeof(record))) {
+		/* Worker failed, so run the test here instead */
+#if defined(FWTS_HAS_ACPI)
+		if (job->session)
+			fwts_acpi_session_deinit(fw);
+#endif
+		fwts_framework_run_test(fw, test);
+		goto tidy;
+	}
+
+	fwts_framework_test_start(fw, test);
+	if (!job->session)
+		fwts_framework_test_heading(fw, test);
+	test->results = record.results;
+	fwts_framework_summate_results(&fw->total, &record.total);
+	fw->failed_level = record.failed_level;
+	fw->error_filtered_out = record.error_filtered_out;
+
+	(void)fwts_log_capture_replay(fw, job->data + sizeof(record), record.log_len);
+
+	if (job->session)
+		goto finish;
+
+	fwts_framework_minor_test_progress(fw, 100, "");
+	if (fw->show_progress) {
+		char resbuf[128];
+
+		fwts_framework_minor_test_progress_clear_line();
+		fwts_framework_format_results(resbuf, sizeof(resbuf), &test->results, false);
+		fprintf(stderr, "  %-55.55s %s\n", "Ran in parallel",
+			*resbuf ? resbuf : "     ");
+	}
+finish:
+	fwts_framework_test_finish(fw, test);
+tidy:
+	free(job->data);
+	job->data = NULL;
+}
+
+/*
+ *  fwts_framework_tests_run_parallel()
+ *	run n parallel safe tests in up to fw->jobs forked workers,
+ *	the logs are written out in test order so the results are the
+ *	same as a serial run
+ */
+static void fwts_framework_tests_run_parallel(
+	fwts_framework *fw,
+	fwts_framework_job *jobs,
+	const int n)
+{
+	struct pollfd pfds[FWTS_FRAMEWORK_JOBS_MAX];
+	int next_start = 0, next_finish = 0;
+
+	/* Don't let the workers inherit unflushed log output */
+	fflush(NULL);
+
+	while (next_finish < n) {
+		int i, nfds = 0, active = 0;
+
+		for (i = next_finish; i < next_start; i++)
+			if (!jobs[i].done)
+				active++;
+		while ((next_start < n) && (active < (int)fw->jobs)) {
+			fwts_framework_job_start(fw, jobs, n, next_start++);
+			active++;
+		}
+
+		/* Write out finished tests in order */
+		while ((next_finish < next_start) && jobs[next_finish].done) {
+			fwts_framework_job_finish(fw, &jobs[next_finish++]);
+			fflush(NULL);
+		}
+		if (next_finish == next_start)
+			continue;
+
+		for (i = next_finish; i < next_start; i++) {
+			if (jobs[i].fd < 0)
+				continue;
+			pfds[nfds].fd = jobs[i].fd;
+			pfds[nfds].events = POLLIN;
+			pfds[nfds].revents = 0;
+			nfds++;
+		}
+		if (poll(pfds, nfds, -1) < 0) {
+			if (errno == EINTR)
+				continue;
+			/* Should not happen, so just block on the next in order */
+			while (!jobs[next_finish].done)
+				fwts_framework_job_read(&jobs[next_finish]);
+			continue;
+		}
+		for (i = next_finish; i < next_start; i++) {
+			int j;
+
+			if (jobs[i].fd < 0)
+				continue;
+			for (j = 0; j < nfds; j++)
+				if (pfds[j].fd == jobs[i].fd)
+					break;
+			if ((j < nfds) && pfds[j].revents)
+				fwts_framework_job_read(&jobs[i]);
+		}
+	}
+}
+
+/*
+ *  fwts_framework_tables_preload()
+ *	load the ACPI tables once per run rather than in each worker,
+ *	the log output from loading them is kept to be written out by
+ *	the next ACPI test. Returns false to run serially if they
+ *	could not be loaded
+ */
+static bool fwts_framework_tables_preload(fwts_framework *fw)
+{
+#if defined(FWTS_HAS_ACPI)
+	fwts_acpi_table_info *table;
+
+	if (fwts_framework_tables_preloaded)
+		return fwts_framework_tables_ok;
+	fwts_framework_tables_preloaded = true;
+
+	/* Finding a table loads them if they are not loaded yet */
+	fwts_log_capture_begin();
+	fwts_framework_tables_ok =
+		(fwts_acpi_find_table(fw, "FACP", 0, &table) == FWTS_OK);
+	fwts_framework_tables_log = fwts_log_capture_end(&fwts_framework_tables_log_len);
+
+	/* Each test will try to load them and log why it can't */
+	if (!fwts_framework_tables_ok) {
+		fwts_framework_tables_log_drop();
+		fwts_acpi_free_tables();
+	}
+	return fwts_framework_tables_ok;
+#else
+	FWTS_UNUSED(fw);
+	return true;
+#endif
+}
+
+/*
+ *  fwts_framework_test_session()
+ *	return true if the test can be run in a process forked from
+ *	the shared ACPI namespace session, loading it if need be
+ */
+static bool fwts_framework_test_session(fwts_framework *fw, fwts_framework_test *test)
+{
+	if (!(test->flags & FWTS_FLAG_ACPI_NAMESPACE) ||
+	    (fw->flags & FWTS_FLAG_ACPICA_PROFILE))
+		return false;
+#if defined(FWTS_HAS_ACPI)
+	return fwts_framework_tables_preload(fw) &&
+	       (fwts_acpi_session_init(fw) == FWTS_OK);
+#else
+	return false;
+#endif
+}
+
+/*
+ *  fwts_framework_run_test_session()
+ *	run a test in a process forked from the shared ACPI namespace
+ *	session so that it can't change the namespace the next test
+ *	sees, the log is written out when it has finished
+ */
+static void fwts_framework_run_test_session(fwts_framework *fw, fwts_framework_test *test)
+{
+	fwts_framework_job job;
+
+	memset(&job, 0, sizeof(job));
+	job.test = test;
+	job.test_num = fw->current_major_test_num;
+	job.fd = -1;
+	job.session = true;
+
+	/* Don't let the worker inherit unflushed log output */
+	fflush(NULL);
+
+	fwts_framework_job_start(fw, &job, 1, 0);
+	while (!job.done)
+		fwts_framework_job_read(&job);
+	fwts_framework_job_finish(fw, &job);
+}
+
 /*
  *  fwts_framework_tests_run()
  *
@@ -731,15 +1209,68 @@ done:
 static void fwts_framework_tests_run(fwts_framework *fw, fwts_list *tests_to_run)
 {
 	fwts_list_link *item;
+	fwts_framework_job *jobs = NULL;
+	bool parallel = false, acpi = false;
 
 	fw->current_major_test_num = 1;
 	fw->major_tests_total  = fwts_list_len(tests_to_run);
 
-	fwts_list_foreach(item, tests_to_run) {
+	/* Method profiles are collected in this process, so run serially */
+	if ((fw->jobs > 1) && !(fw->flags & FWTS_FLAG_ACPICA_PROFILE)) {
+		fwts_list_foreach(item, tests_to_run) {
+			fwts_framework_test *test = fwts_list_data(fwts_framework_test *, item);
+
+			if (test->flags & FWTS_FLAG_PARALLEL) {
+				parallel = true;
+				if (test->flags & FWTS_FLAG_ACPI)
+					acpi = true;
+			}
+		}
+		if (parallel)
+			jobs = calloc(fw->major_tests_total, sizeof(*jobs));
+	}
+
+	if (jobs && acpi && !fwts_framework_tables_preload(fw)) {
+		free(jobs);
+		jobs = NULL;
+	}
+
+	for (item = tests_to_run->head; item; ) {
 		fwts_framework_test *test = fwts_list_data(fwts_framework_test *, item);
-		fwts_framework_run_test(fw, test);
-		fw->current_major_test_num++;
+		int n = 0;
+
+		if (!jobs || !(test->flags & FWTS_FLAG_PARALLEL)) {
+			if (fwts_framework_test_session(fw, test))
+				fwts_framework_run_test_session(fw, test);
+			else
+				fwts_framework_run_test(fw, test);
+			fw->current_major_test_num++;
+			item = item->next;
+			continue;
+		}
+
+		/* Run the following parallel safe tests together */
+		while (item) {
+			test = fwts_list_data(fwts_framework_test *, item);
+			if (!(test->flags & FWTS_FLAG_PARALLEL))
+				break;
+			/* Workers can share the namespace too */
+			(void)fwts_framework_test_session(fw, test);
+			jobs[n].test = test;
+			jobs[n].test_num = fw->current_major_test_num++;
+			jobs[n].fd = -1;
+			n++;
+			item = item->next;
+		}
+		fwts_framework_tests_run_parallel(fw, jobs, n);
+		memset(jobs, 0, n * sizeof(*jobs));
 	}
+	free(jobs);
+	fwts_framework_tables_log_drop();
+
+#if defined(FWTS_HAS_ACPI)
+	fwts_acpi_session_deinit(fw);
+#endif
 }
 
 /*
@@ -803,6 +1334,97 @@ void fwts_error_inc(fwts_framework *fw, const char *label, int *count)
 		(*count)++;
 }
 
+#define FWTS_FRAMEWORK_LABELS_HASH	(256)
+
+/*
+ *  a failure label and its counts
+ */
+typedef struct fwts_framework_label {
+	struct fwts_framework_label *next;	/* next label in hash chain */
+	uint32_t failures;			/* number of failures */
+	uint32_t captures;			/* number of captures that failed */
+	char label[];				/* failure label */
+} fwts_framework_label;
+
+/*
+ *  failure label counts, labels are kept in the order first seen
+ */
+struct fwts_framework_labels {
+	fwts_list list;					/* list of fwts_framework_label */
+	fwts_framework_label *hash[FWTS_FRAMEWORK_LABELS_HASH];	/* labels by hash */
+};
+
+/*
+ *  fwts_framework_labels_new()
+ *	create empty failure label counts
+ */
+static fwts_framework_labels *fwts_framework_labels_new(void)
+{
+	fwts_framework_labels *labels;
+
+	if ((labels = calloc(1, sizeof(*labels))) == NULL)
+		return NULL;
+	fwts_list_init(&labels->list);
+
+	return labels;
+}
+
+/*
+ *  fwts_framework_labels_free()
+ *	free failure label counts
+ */
+static void fwts_framework_labels_free(fwts_framework_labels *labels)
+{
+	if (!labels)
+		return;
+	fwts_list_free_items(&labels->list, free);
+	free(labels);
+}
+
+/*
+ *  fwts_framework_labels_add()
+ *	add failures to the count for a label, labels may be built in
+ *	a test's local buffer so they are copied, returns NULL if out
+ *	of memory
+ */
+static fwts_framework_label *fwts_framework_labels_add(
+	fwts_framework_labels *labels,
+	const char *label,
+	const uint32_t failures)
+{
+	fwts_framework_label *item;
+	size_t len, h;
+
+	h = (size_t)(fwts_log_dedup_hash(label, &len) % FWTS_FRAMEWORK_LABELS_HASH);
+	for (item = labels->hash[h]; item; item = item->next)
+		if (!strcmp(item->label, label))
+			break;
+
+	if (!item) {
+		if ((item = calloc(1, sizeof(*item) + len + 1)) == NULL)
+			return NULL;
+		memcpy(item->label, label, len + 1);
+		if (fwts_list_append(&labels->list, item) == NULL) {
+			free(item);
+			return NULL;
+		}
+		item->next = labels->hash[h];
+		labels->hash[h] = item;
+	}
+	item->failures += failures;
+
+	return item;
+}
+
+/*
+ *  fwts_framework_label_count()
+ *	count a failure label
+ */
+static void fwts_framework_label_count(fwts_framework *fw, const char *label)
+{
+	(void)fwts_framework_labels_add(fw->failed_labels, label, 1);
+}
+
 /*
  *  fwts_framework_log()
  *	log a test result
@@ -850,6 +1472,8 @@ void fwts_framework_log(
 
 			fw->failed_level |= level;
 			fwts_summary_add(fw, fw->current_major_test->name, level, buffer);
+			if (fw->failed_labels && label)
+				fwts_framework_label_count(fw, label);
 			snprintf(prefix, sizeof(prefix), "%s [%s] %s: Test %d, ",
 				str, fwts_log_level_to_str(level), label, fw->current_minor_test_num);
 			fwts_log_printf(fw, field, level, str, label, prefix, "%s", buffer);
@@ -984,6 +1608,586 @@ static void fwts_framework_heading_info(
 	}
 }
 
+/*
+ *  results sent back to the parent by a forked replay worker, followed
+ *  by the results of each test then the failure label counts, each a
+ *  uint32_t count and a '\0' terminated label
+ */
+typedef struct {
+	fwts_results total;		/* results over all tests */
+	uint32_t tests;			/* number of test results that follow */
+	uint32_t labels;		/* number of label counts that follow */
+} fwts_framework_replay_record;
+
+/*
+ *  a captured machine in the replay corpus
+ */
+typedef struct {
+	char *name;			/* capture directory name */
+	char *acpidump;			/* acpidump file, NULL if none */
+	char *klog;			/* kernel log file, NULL if none */
+	bool tables;			/* has raw ACPI .dat tables */
+	bool finished;			/* results have been collected */
+	bool failed;			/* worker failed to replay the capture */
+	double start;			/* time replay started */
+	double duration;		/* replay time, seconds */
+	fwts_results total;		/* results over all tests */
+	fwts_framework_job job;		/* forked replay worker */
+} fwts_framework_capture;
+
+/*
+ *  fwts_framework_replay_time()
+ *	monotonic time in seconds
+ */
+static double fwts_framework_replay_time(void)
+{
+	struct timespec ts;
+
+	(void)clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + ((double)ts.tv_nsec / 1000000000.0);
+}
+
+/*
+ *  fwts_framework_capture_free()
+ *	free captures
+ */
+static void fwts_framework_capture_free(fwts_framework_capture *captures, const size_t n)
+{
+	size_t i;
+
+	for (i = 0; i < n; i++) {
+		free(captures[i].name);
+		free(captures[i].acpidump);
+		free(captures[i].klog);
+		free(captures[i].job.data);
+	}
+	free(captures);
+}
+
+/*
+ *  fwts_framework_capture_scan()
+ *	find the ACPI tables and kernel log in a capture directory,
+ *	this is an acpidump*, *.dat raw tables and a dmesg* or klog*
+ *	kernel log. Returns false if there is nothing to replay
+ */
+static bool fwts_framework_capture_scan(fwts_framework_capture *capture, const char *path)
+{
+	struct dirent **dir_entries;
+	int i, n;
+
+	if ((n = scandir(path, &dir_entries, NULL, alphasort)) < 0)
+		return false;
+
+	for (i = 0; i < n; i++) {
+		const char *name = dir_entries[i]->d_name;
+		const size_t len = strlen(name);
+		char filename[PATH_MAX];
+		struct stat buf;
+
+		snprintf(filename, sizeof(filename), "%s/%s", path, name);
+		if ((stat(filename, &buf) < 0) || !S_ISREG(buf.st_mode))
+			goto next;
+
+		if (!capture->acpidump && !strncmp(name, "acpidump", 8))
+			capture->acpidump = strdup(filename);
+		else if (!capture->klog &&
+			 (!strncmp(name, "dmesg", 5) || !strncmp(name, "klog", 4)))
+			capture->klog = strdup(filename);
+		else if ((len > 4) && !strcmp(name + len - 4, ".dat"))
+			capture->tables = true;
+next:
+		free(dir_entries[i]);
+	}
+	free(dir_entries);
+
+	return capture->acpidump || capture->klog || capture->tables;
+}
+
+/*
+ *  fwts_framework_capture_load()
+ *	find the captures in the corpus directory, one per sub-directory
+ */
+static fwts_framework_capture *fwts_framework_capture_load(const char *corpus, size_t *count)
+{
+	struct dirent **dir_entries;
+	fwts_framework_capture *captures;
+	size_t n_captures = 0;
+	int i, n;
+
+	*count = 0;
+	if ((n = scandir(corpus, &dir_entries, NULL, alphasort)) < 0)
+		return NULL;
+
+	if ((captures = calloc((size_t)n + 1, sizeof(*captures))) == NULL)
+		goto tidy;
+
+	for (i = 0; i < n; i++) {
+		fwts_framework_capture *capture = &captures[n_captures];
+		char path[PATH_MAX];
+		struct stat buf;
+
+		if (dir_entries[i]->d_name[0] == '.')
+			continue;
+		snprintf(path, sizeof(path), "%s/%s", corpus, dir_entries[i]->d_name);
+		if ((stat(path, &buf) < 0) || !S_ISDIR(buf.st_mode))
+			continue;
+
+		if (!fwts_framework_capture_scan(capture, path)) {
+			fprintf(stderr, "No ACPI tables or kernel log in capture '%s', skipping it.\n", path);
+			continue;
+		}
+		if ((capture->name = strdup(dir_entries[i]->d_name)) == NULL) {
+			fwts_framework_capture_free(captures, n_captures + 1);
+			captures = NULL;
+			goto tidy;
+		}
+		capture->job.pid = -1;
+		capture->job.fd = -1;
+		n_captures++;
+	}
+	*count = n_captures;
+tidy:
+	for (i = 0; i < n; i++)
+		free(dir_entries[i]);
+	free(dir_entries);
+
+	return captures;
+}
+
+/*
+ *  fwts_framework_replay_worker()
+ *	run the tests on a capture, logging to the capture's own results
+ *	log, and send the results down the pipe, this runs in a forked child
+ */
+static void fwts_framework_replay_worker(
+	fwts_framework *fw,
+	fwts_framework_capture *capture,
+	fwts_list *tests_to_run,
+	const int argc,
+	char * const *argv,
+	const int fd)
+{
+	fwts_framework_replay_record record;
+	fwts_list_link *item;
+	char path[PATH_MAX];
+
+	fw->flags &= ~(FWTS_FLAG_SHOW_PROGRESS | FWTS_FLAG_SHOW_PROGRESS_DIALOG);
+	fw->jobs = 1;
+	fwts_results_zero(&fw->total);
+	fw->total_run = 0;
+
+	/*
+	 *  Only use the captured data, an empty dump or kernel
+	 *  log stops the tests from reading them from this machine
+	 */
+	free(fw->acpi_table_path);
+	free(fw->acpi_table_acpidump_file);
+	free(fw->klog);
+	fw->acpi_table_path = NULL;
+	fw->acpi_table_acpidump_file = NULL;
+	fw->klog = NULL;
+
+	snprintf(path, sizeof(path), "%s/%s", fw->replay_corpus_path, capture->name);
+	if (capture->acpidump)
+		fwts_framework_strdup(&fw->acpi_table_acpidump_file, capture->acpidump);
+	else if (capture->tables)
+		fwts_framework_strdup(&fw->acpi_table_path, path);
+	else
+		fwts_framework_strdup(&fw->acpi_table_acpidump_file, "/dev/null");
+	fwts_framework_strdup(&fw->klog, capture->klog ? capture->klog : "/dev/null");
+
+	if ((fw->failed_labels = fwts_framework_labels_new()) == NULL)
+		_exit(EXIT_FAILURE);
+
+	snprintf(path, sizeof(path), "%s/%s", fw->replay_output_path, capture->name);
+	if ((fw->results = fwts_log_open("fwts", path, "w", fw->log_type)) == NULL)
+		_exit(EXIT_FAILURE);
+
+	fwts_log_section_begin(fw->results, "heading");
+	fwts_framework_heading_info(fw, tests_to_run, argc, argv);
+	fwts_log_info(fw, "Replaying capture '%s/%s'.", fw->replay_corpus_path, capture->name);
+	fwts_log_nl(fw);
+	fwts_log_section_end(fw->results);
+
+	fwts_log_section_begin(fw->results, "tests");
+	fwts_framework_tests_run(fw, tests_to_run);
+	fwts_log_section_end(fw->results);
+
+	if (fw->print_summary) {
+		fwts_log_section_begin(fw->results, "summary");
+		fwts_log_set_owner(fw->results, "summary");
+		fwts_log_nl(fw);
+		fwts_framework_total_summary(fw);
+		fwts_log_nl(fw);
+		fwts_summary_report(fw, tests_to_run);
+		fwts_log_section_end(fw->results);
+	}
+	fwts_log_close(fw->results);
+
+	memset(&record, 0, sizeof(record));
+	record.total = fw->total;
+	record.tests = (uint32_t)fwts_list_len(tests_to_run);
+	record.labels = (uint32_t)fwts_list_len(&fw->failed_labels->list);
+	if (fwts_framework_write(fd, &record, sizeof(record)) != FWTS_OK)
+		_exit(EXIT_FAILURE);
+
+	fwts_list_foreach(item, tests_to_run) {
+		fwts_framework_test *test = fwts_list_data(fwts_framework_test *, item);
+		fwts_results results = test->results;
+
+		if (!test->was_run)
+			fwts_results_zero(&results);
+		if (fwts_framework_write(fd, &results, sizeof(results)) != FWTS_OK)
+			_exit(EXIT_FAILURE);
+	}
+	fwts_list_foreach(item, &fw->failed_labels->list) {
+		fwts_framework_label *label = fwts_list_data(fwts_framework_label *, item);
+
+		if ((fwts_framework_write(fd, &label->failures, sizeof(label->failures)) != FWTS_OK) ||
+		    (fwts_framework_write(fd, label->label, strlen(label->label) + 1) != FWTS_OK))
+			_exit(EXIT_FAILURE);
+	}
+	_exit(EXIT_SUCCESS);
+}
+
+/*
+ *  fwts_framework_replay_start()
+ *	fork a worker to replay a capture
+ */
+static void fwts_framework_replay_start(
+	fwts_framework *fw,
+	fwts_framework_capture *captures,
+	const size_t n,
+	const size_t i,
+	fwts_list *tests_to_run,
+	const int argc,
+	char * const *argv)
+{
+	fwts_framework_job *job = &captures[i].job;
+	int fds[2];
+
+	captures[i].start = fwts_framework_replay_time();
+	job->pid = -1;
+	job->fd = -1;
+	job->done = true;
+
+	if (pipe(fds) < 0)
+		return;
+	job->pid = fork();
+	if (job->pid < 0) {
+		(void)close(fds[0]);
+		(void)close(fds[1]);
+		return;
+	}
+	if (job->pid == 0) {
+		size_t j;
+
+		/* Drop read ends of pipes to other workers */
+		for (j = 0; j < n; j++)
+			if (captures[j].job.fd >= 0)
+				(void)close(captures[j].job.fd);
+		(void)close(fds[0]);
+		fwts_framework_replay_worker(fw, &captures[i], tests_to_run, argc, argv, fds[1]);
+	}
+	(void)close(fds[1]);
+	job->fd = fds[0];
+	job->done = false;
+}
+
+/*
+ *  fwts_framework_replay_finish()
+ *	reap a replay worker and add its results to the totals
+ */
+static void fwts_framework_replay_finish(
+	fwts_framework *fw,
+	fwts_framework_capture *capture,
+	fwts_list *tests_to_run)
+{
+	fwts_framework_job *job = &capture->job;
+	fwts_framework_replay_record record;
+	fwts_list_link *item;
+	const char *ptr;
+	int status = -1;
+
+	if (job->pid > 0)
+		(void)waitpid(job->pid, &status, 0);
+	capture->duration = fwts_framework_replay_time() - capture->start;
+	capture->finished = true;
+
+	memset(&record, 0, sizeof(record));
+	if (job->len >= sizeof(record))
+		memcpy(&record, job->data, sizeof(record));
+
+	if ((job->pid <= 0) ||
+	    !WIFEXITED(status) || (WEXITSTATUS(status) != EXIT_SUCCESS) ||
+	    (job->len < sizeof(record)) ||
+	    (record.tests != (uint32_t)fwts_list_len(tests_to_run)) ||
+	    (job->len - sizeof(record) < record.tests * sizeof(fwts_results))) {
+		capture->failed = true;
+		fw->total.aborted++;
+		return;
+	}
+
+	capture->total = record.total;
+	fwts_framework_summate_results(&fw->total, &record.total);
+
+	ptr = job->data + sizeof(record);
+	fwts_list_foreach(item, tests_to_run) {
+		fwts_framework_test *test = fwts_list_data(fwts_framework_test *, item);
+		fwts_results results;
+
+		memcpy(&results, ptr, sizeof(results));
+		fwts_framework_summate_results(&test->results, &results);
+		ptr += sizeof(results);
+	}
+}
+
+/*
+ *  fwts_framework_replay_labels()
+ *	call func on each label count sent back by a replay worker
+ */
+static void fwts_framework_replay_labels(
+	const fwts_framework_capture *capture,
+	void (*func)(char *label, const uint32_t count, void *arg),
+	void *arg)
+{
+	const fwts_framework_job *job = &capture->job;
+	fwts_framework_replay_record record;
+	char *ptr, *end;
+	uint32_t i;
+
+	if (capture->failed)
+		return;
+
+	memcpy(&record, job->data, sizeof(record));
+	ptr = job->data + sizeof(record) + record.tests * sizeof(fwts_results);
+	end = job->data + job->len;
+
+	for (i = 0; i < record.labels; i++) {
+		char *label;
+		uint32_t count;
+
+		if ((size_t)(end - ptr) < sizeof(count) + 1)
+			break;
+		memcpy(&count, ptr, sizeof(count));
+		label = ptr + sizeof(count);
+		if ((ptr = memchr(label, '\0', (size_t)(end - label))) == NULL)
+			break;
+		ptr++;
+		func(label, count, arg);
+	}
+}
+
+/*
+ *  fwts_framework_replay_label_log()
+ *	log a capture's failure label count
+ */
+static void fwts_framework_replay_label_log(char *label, const uint32_t count, void *arg)
+{
+	fwts_log_info_verbatim((fwts_framework *)arg, "  %6" PRIu32 " %s", count, label);
+}
+
+/*
+ *  fwts_framework_replay_label_total()
+ *	add a capture's failure label count to the totals
+ */
+static void fwts_framework_replay_label_total(char *label, const uint32_t count, void *arg)
+{
+	fwts_framework_label *item;
+
+	if ((item = fwts_framework_labels_add((fwts_framework_labels *)arg, label, count)) != NULL)
+		item->captures++;
+}
+
+/*
+ *  fwts_framework_replay_report()
+ *	log the merged replay summary, results for each capture
+ *	followed by the failure labels over all captures
+ */
+static void fwts_framework_replay_report(
+	fwts_framework *fw,
+	fwts_framework_capture *captures,
+	const size_t n,
+	const double duration)
+{
+	fwts_framework_labels *totals;
+	size_t i, failed = 0;
+
+	fwts_log_set_owner(fw->results, "replay");
+	fwts_log_info_verbatim(fw, "Capture                        |Pass |Fail |Abort|Warn |Skip |Info | Time(s)|");
+	fwts_log_info_verbatim(fw, "-------------------------------+-----+-----+-----+-----+-----+-----+--------+");
+	for (i = 0; i < n; i++) {
+		const fwts_framework_capture *capture = &captures[i];
+		const fwts_results *r = &capture->total;
+
+		if (capture->failed) {
+			fwts_log_info_verbatim(fw, "%-31.31s|Replay failed, no results.", capture->name);
+			continue;
+		}
+		if (r->failed || r->aborted)
+			failed++;
+		fwts_log_info_verbatim(fw, "%-31.31s|%5" PRIu32 "|%5" PRIu32 "|%5" PRIu32
+			"|%5" PRIu32 "|%5" PRIu32 "|%5" PRIu32 "|%8.2f|",
+			capture->name, r->passed, r->failed, r->aborted,
+			r->warning, r->skipped, r->infoonly, capture->duration);
+		fwts_framework_replay_labels(capture, fwts_framework_replay_label_log, fw);
+	}
+	fwts_log_info_verbatim(fw, "-------------------------------+-----+-----+-----+-----+-----+-----+--------+");
+	fwts_log_nl(fw);
+
+	if ((totals = fwts_framework_labels_new()) != NULL) {
+		for (i = 0; i < n; i++)
+			fwts_framework_replay_labels(&captures[i], fwts_framework_replay_label_total, totals);
+		if (fwts_list_len(&totals->list)) {
+			fwts_list_link *item;
+
+			fwts_log_info_verbatim(fw, "Failure labels over all captures:");
+			fwts_log_info_verbatim(fw, "Failures Captures Label");
+			fwts_list_foreach(item, &totals->list) {
+				fwts_framework_label *label = fwts_list_data(fwts_framework_label *, item);
+
+				fwts_log_info_verbatim(fw, "%8" PRIu32 " %8" PRIu32 " %s",
+					label->failures, label->captures, label->label);
+			}
+			fwts_log_nl(fw);
+		}
+		fwts_framework_labels_free(totals);
+	}
+
+	fwts_log_info(fw, "%zu of %zu captures had failures or aborted tests.", failed, n);
+	fwts_log_info(fw, "Replayed %zu captures with %" PRIu32 " workers in %.2f seconds, %.2f captures/sec.",
+		n, fw->jobs, duration, duration > 0.0 ? (double)n / duration : 0.0);
+	fwts_log_info(fw, "Results logs for each capture are in '%s'.", fw->replay_output_path);
+	fwts_log_nl(fw);
+	fwts_framework_total_summary(fw);
+	fwts_log_nl(fw);
+}
+
+/*
+ *  fwts_framework_replay()
+ *	run the offline tests on each capture in the replay corpus
+ *	in up to fw->jobs forked workers and log a merged summary
+ */
+static int fwts_framework_replay(
+	fwts_framework *fw,
+	fwts_list *tests_to_run,
+	const int argc,
+	char * const *argv)
+{
+	fwts_framework_capture *captures;
+	fwts_list tests;
+	fwts_list_link *item;
+	size_t i, n, next_start = 0, finished = 0;
+	double start;
+
+	fwts_list_init(&tests);
+	fwts_list_foreach(item, tests_to_run) {
+		fwts_framework_test *test = fwts_list_data(fwts_framework_test *, item);
+
+		if (test->flags & FWTS_FLAG_OFFLINE)
+			fwts_list_append(&tests, test);
+		else if (!(fw->flags & FWTS_FLAG_QUIET))
+			fprintf(stderr, "Test %s cannot be run on captured data, skipping it.\n", test->name);
+	}
+	if (fwts_list_len(&tests) == 0) {
+		fwts_log_error(fw, "No tests to replay, only tests that run on captured data can be replayed.");
+		return FWTS_ERROR;
+	}
+
+	if (!fw->replay_output_path)
+		fwts_framework_strdup(&fw->replay_output_path, "fwts-replay");
+	if ((mkdir(fw->replay_output_path, 0755) < 0) && (errno != EEXIST)) {
+		fwts_log_error(fw, "Cannot create replay results directory '%s'.", fw->replay_output_path);
+		fwts_list_free_items(&tests, NULL);
+		return FWTS_ERROR;
+	}
+
+	captures = fwts_framework_capture_load(fw->replay_corpus_path, &n);
+	if (!captures || !n) {
+		fwts_log_error(fw, "Cannot find any captures in '%s'.", fw->replay_corpus_path);
+		fwts_framework_capture_free(captures, n);
+		fwts_list_free_items(&tests, NULL);
+		return FWTS_ERROR;
+	}
+
+	/* Don't let the workers inherit unflushed log output */
+	fflush(NULL);
+	start = fwts_framework_replay_time();
+
+	while (finished < n) {
+		struct pollfd pfds[FWTS_FRAMEWORK_JOBS_MAX];
+		size_t active = 0;
+		nfds_t nfds = 0;
+
+		for (i = 0; i < next_start; i++)
+			if (!captures[i].job.done)
+				active++;
+		while ((next_start < n) && (active < fw->jobs)) {
+			fwts_framework_replay_start(fw, captures, n, next_start++,
+				&tests, argc, argv);
+			active++;
+		}
+
+		for (i = 0; i < next_start; i++) {
+			fwts_framework_capture *capture = &captures[i];
+
+			if (!capture->job.done || capture->finished)
+				continue;
+			fwts_framework_replay_finish(fw, capture, &tests);
+			finished++;
+			if (fw->flags & FWTS_FLAG_SHOW_PROGRESS) {
+				char resbuf[128];
+
+				fwts_framework_format_results(resbuf, sizeof(resbuf), &capture->total, false);
+				fprintf(stderr, "[%zu/%zu] %-40.40s %s\n", finished, n, capture->name,
+					capture->failed ? "Replay failed" : resbuf);
+			}
+		}
+
+		for (i = 0; i < next_start; i++) {
+			if (captures[i].job.fd < 0)
+				continue;
+			pfds[nfds].fd = captures[i].job.fd;
+			pfds[nfds].events = POLLIN;
+			pfds[nfds].revents = 0;
+			nfds++;
+		}
+		if (nfds == 0)
+			continue;
+		if (poll(pfds, nfds, -1) < 0)
+			continue;
+		for (i = 0; i < next_start; i++) {
+			nfds_t j;
+
+			if (captures[i].job.fd < 0)
+				continue;
+			for (j = 0; j < nfds; j++)
+				if (pfds[j].fd == captures[i].job.fd)
+					break;
+			if ((j < nfds) && pfds[j].revents)
+				fwts_framework_job_read(&captures[i].job);
+		}
+	}
+
+	fwts_framework_replay_report(fw, captures, n, fwts_framework_replay_time() - start);
+
+	if (!(fw->flags & FWTS_FLAG_QUIET)) {
+		const double duration = fwts_framework_replay_time() - start;
+
+		printf("Replayed %zu captures in %.2f seconds (%.2f captures/sec), results logs in %s\n",
+			n, duration, duration > 0.0 ? (double)n / duration : 0.0,
+			fw->replay_output_path);
+	}
+
+	/* The per capture logs have the failure details */
+	fw->print_summary = false;
+
+	fwts_framework_capture_free(captures, n);
+	fwts_list_free_items(&tests, NULL);
+
+	return FWTS_OK;
+}
+
 /*
  *  fwts_framework_skip_test()
  *	try to find a test in list of tests to be skipped, return NULL of cannot be found
@@ -1358,6 +2562,41 @@ int fwts_framework_options_handler(fwts_framework *fw, int argc, char * const ar
 			fprintf(stderr, "option not available on this architecture\n");
 			return FWTS_ERROR;
 #endif
+		case 50: /* --log-pattern-cache */
+			fwts_framework_strdup(&fw->log_pattern_cache_path, optarg);
+			break;
+		case 51: /* --acpica-profile */
+			fw->flags |= FWTS_FLAG_ACPICA_PROFILE;
+			if (optarg)
+				fwts_framework_strdup(&fw->acpica_profile_path, optarg);
+			break;
+		case 52: /* --jobs */
+			fw->jobs = atoi(optarg);
+			if ((fw->jobs < 1) || (fw->jobs > FWTS_FRAMEWORK_JOBS_MAX)) {
+				fprintf(stderr, "--jobs is %s, it should be 1..%d\n",
+					optarg, FWTS_FRAMEWORK_JOBS_MAX);
+				return FWTS_ERROR;
+			}
+			break;
+		case 53: /* --uefi-latency */
+			fw->flags |= FWTS_FLAG_UEFI_LATENCY;
+			if (optarg)
+				fwts_framework_strdup(&fw->uefi_latency_path, optarg);
+			break;
+		case 54: /* --uefi-latency-threshold */
+			if (fwts_uefi_latency_threshold_set(optarg) != FWTS_OK)
+				return FWTS_ERROR;
+			fw->flags |= FWTS_FLAG_UEFI_LATENCY;
+			break;
+		case 55: /* --replay-corpus */
+			fwts_framework_strdup(&fw->replay_corpus_path, optarg);
+			break;
+		case 56: /* --replay-output */
+			fwts_framework_strdup(&fw->replay_output_path, optarg);
+			break;
+		case 57: /* --devicetree-lazy */
+			fw->devicetree_lazy = true;
+			break;
 		}
 		break;
 	case 'a': /* --all */
@@ -1448,6 +2687,57 @@ int fwts_framework_options_handler(fwts_framework *fw, int argc, char * const ar
 	return FWTS_OK;
 }
 
+/*
+ *  fwts_framework_devicetree_read()
+ *	read the devicetree, with --devicetree-lazy just the subtrees
+ *	the devicetree tests to be run use, if they all declare them
+ */
+static int fwts_framework_devicetree_read(fwts_framework *fw, fwts_list *tests)
+{
+	const char **subtrees;
+	fwts_list_link *item;
+	size_t n = 0;
+	int ret;
+
+	if (!fw->devicetree_lazy)
+		return fwts_devicetree_read(fw, NULL);
+
+	fwts_list_foreach(item, tests) {
+		fwts_framework_test *test = fwts_list_data(fwts_framework_test *, item);
+		const char * const *subtree;
+
+		if (!(test->fw_features & FWTS_FW_FEATURE_DEVICETREE))
+			continue;
+		if (!test->ops->dt_subtrees)
+			return fwts_devicetree_read(fw, NULL);
+		for (subtree = test->ops->dt_subtrees; *subtree; subtree++)
+			n++;
+	}
+
+	/* No devicetree tests to run */
+	if (n == 0)
+		return FWTS_OK;
+
+	if ((subtrees = calloc(n + 1, sizeof(*subtrees))) == NULL)
+		return fwts_devicetree_read(fw, NULL);
+
+	n = 0;
+	fwts_list_foreach(item, tests) {
+		fwts_framework_test *test = fwts_list_data(fwts_framework_test *, item);
+		const char * const *subtree;
+
+		if (!(test->fw_features & FWTS_FW_FEATURE_DEVICETREE))
+			continue;
+		for (subtree = test->ops->dt_subtrees; *subtree; subtree++)
+			subtrees[n++] = *subtree;
+	}
+
+	ret = fwts_devicetree_read(fw, subtrees);
+	free(subtrees);
+
+	return ret;
+}
+
 /*
  *  fwts_framework_args()
  *	parse args and run tests
@@ -1483,6 +2773,7 @@ int fwts_framework_args(const int argc, char **argv)
 		    FWTS_FLAG_SHOW_PROGRESS;
 	fw->log_type = LOG_TYPE_PLAINTEXT;
 	fw->filter_level = LOG_LEVEL_ALL;
+	fw->jobs = 1;
 
 	fwts_list_init(&fw->errors_filter_keep);
 	fwts_list_init(&fw->errors_filter_discard);
@@ -1576,9 +2867,6 @@ int fwts_framework_args(const int argc, char **argv)
 		goto tidy_close;
 	}
 
-	/* Init firmware data required by tests */
-	fwts_devicetree_read(fw);
-
 	/* Collect up tests to run */
 	for (i = optind; i < argc; i++) {
 		fwts_framework_test *test;
@@ -1610,6 +2898,9 @@ int fwts_framework_args(const int argc, char **argv)
 				fwts_list_append(&tests_to_run, test);
 	}
 
+	/* Init firmware data required by tests */
+	fwts_framework_devicetree_read(fw, &tests_to_run);
+
 	if (!(fw->flags & FWTS_FLAG_QUIET)) {
 		char *filenames = fwts_log_get_filenames(fw->results_logname, fw->log_type);
 
@@ -1625,9 +2916,16 @@ int fwts_framework_args(const int argc, char **argv)
 	fwts_framework_heading_info(fw, &tests_to_run, argc, argv);
 	fwts_log_section_end(fw->results);
 
-	fwts_log_section_begin(fw->results, "tests");
-	fwts_framework_tests_run(fw, &tests_to_run);
-	fwts_log_section_end(fw->results);
+	if (fw->replay_corpus_path) {
+		fwts_log_section_begin(fw->results, "replay");
+		if (fwts_framework_replay(fw, &tests_to_run, argc, argv) != FWTS_OK)
+			ret = FWTS_ERROR;
+		fwts_log_section_end(fw->results);
+	} else {
+		fwts_log_section_begin(fw->results, "tests");
+		fwts_framework_tests_run(fw, &tests_to_run);
+		fwts_log_section_end(fw->results);
+	}
 
 	if (fw->print_summary) {
 		fwts_log_section_begin(fw->results, "summary");
@@ -1649,6 +2947,11 @@ tidy_close:
 	fwts_acpi_free_tables();
 #endif
 	fwts_summary_deinit();
+	fwts_log_pattern_cache_free();
+	fwts_pci_topology_put();
+	fwts_cpu_msr_close();
+	fwts_cpu_benchmark_close();
+	fwts_cpu_topology_put();
 
 	free(fw->lspci);
 	free(fw->results_logname);
@@ -1657,6 +2960,11 @@ tidy_close:
 	free(fw->olog);
 	free(fw->json_data_path);
 	free(fw->json_data_file);
+	free(fw->log_pattern_cache_path);
+	free(fw->acpica_profile_path);
+	free(fw->uefi_latency_path);
+	free(fw->replay_corpus_path);
+	free(fw->replay_output_path);
 	free(fw->fdt);
 
 	fwts_list_free_items(&fw->errors_filter_discard, NULL);
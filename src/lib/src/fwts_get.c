@@ -65,3 +65,23 @@ int fwts_get_int(const char *file, int *value)
 
 	return FWTS_OK;
 }
+
+/*
+ *  fwts_get_uint64()
+ *	get a uint64_t from a file. used to gather large counters
+ *	from /proc or /sys entries
+ */
+int fwts_get_uint64(const char *file, uint64_t *value)
+{
+	char *data;
+
+	*value = 0;
+
+	if ((data = fwts_get(file)) == NULL)
+		return FWTS_ERROR;
+
+	*value = strtoull(data, NULL, 10);
+	free(data);
+
+	return FWTS_OK;
+}
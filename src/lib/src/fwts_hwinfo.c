@@ -37,9 +37,8 @@
 
 #include "fwts.h"
 
-#define FWTS_HWINFO_LISTS_SAME		(0)
-#define FWTS_HWINFO_LISTS_DIFFER	(1)
-#define FWTS_HWINFO_LISTS_OUT_OF_MEMORY	(-1)
+#define FWTS_HWINFO_DEVICES_MIN		(16)
+#define FWTS_HWINFO_PCI_CONFIG_LEN	(64)
 
 #define FWTS_HWINFO_SYS_NET		"/sys/class/net"
 #define FWTS_HWINFO_SYS_INPUT		"/sys/class/input"
@@ -48,58 +47,64 @@
 #define FWTS_HWINFO_SYS_SCSI_DISK	"/sys/class/scsi_disk"
 #define FWTS_HWINFO_SYS_DRM		"/sys/class/drm"
 
+/*
+ *  class of devices, how its fields are labelled and compared
+ */
 typedef struct {
-	char name[NAME_MAX + 1];	/* PCI name */
-	uint8_t	config[64];		/* PCI config data */
-	ssize_t config_len;		/* Length of config data */
-} fwts_pci_config;
-
-typedef struct {
-	char *name;			/* Network device name */
-	char *addr;			/* Address */
-	char *hw_addr;			/* H/W MAC address */
-} fwts_net_config;
-
-typedef struct {
-	char *name;			/* Input class name */
-	char *dev_name;			/* Input device name */
-	char *phys;			/* Physical name */
-} fwts_input_config;
-
-typedef struct {
-	char *name;			/* class name */
-	char *bt_name;			/* BT name */
-	char *address;			/* BT address */
-	char *bus;			/* Bus device is on */
-	char *type;			/* Type info */
-} fwts_bluetooth_config;
-
-typedef struct {
-	char *name;
-	char *data_role;
-	char *port_type;
-	char *power_role;
-	char *power_operation_mode;
-} fwts_typec_config;
-
-typedef struct {
-	char *name;
-	char *model;
-	char *state;
-	char *vendor;
-} fwts_scsi_disk_config;
-
-typedef struct {
-	char *name;
-	char *status;
-	char *enabled;
-} fwts_drm_config;
-
-/* compare H/W info */
-typedef int (*hwinfo_cmp)(void *data1, void *data2);
-
-/* dump H/W info */
-typedef void (*hwinfo_dump)(fwts_framework *fw, fwts_list *list);
+	const char *message;				/* class name */
+	const char *labels[FWTS_HWINFO_FIELDS_MAX];	/* field labels, NULL terminated */
+	uint32_t ignore;				/* fields that may change, not compared */
+} fwts_hwinfo_class;
+
+/* PCI config is shown 16 bytes per field */
+static const fwts_hwinfo_class hwinfo_pci_network = {
+	"Network Controller",
+	{ "PCI", "Vendor:Device", "Class", "Config 00", "Config 10", "Config 20", "Config 30", NULL },
+	0
+};
+
+static const fwts_hwinfo_class hwinfo_pci_video = {
+	"Video",
+	{ "PCI", "Vendor:Device", "Class", "Config 00", "Config 10", "Config 20", "Config 30", NULL },
+	0
+};
+
+/* IP address may be reassigned on resume, so just check H/W address */
+static const fwts_hwinfo_class hwinfo_net = {
+	"Network",
+	{ "Device", "Address", "H/W Address", NULL },
+	1 << 1
+};
+
+static const fwts_hwinfo_class hwinfo_input = {
+	"Input Devices",
+	{ "Device", "Device Name", "Phy", NULL },
+	0
+};
+
+static const fwts_hwinfo_class hwinfo_bluetooth = {
+	"Bluetooth Device",
+	{ "Device", "Name", "Address", "Bus", "Type", NULL },
+	0
+};
+
+static const fwts_hwinfo_class hwinfo_typec = {
+	"Type-C Device",
+	{ "Name", "Data Role", "Port Type", "Power Role", "Power Mode", NULL },
+	0
+};
+
+static const fwts_hwinfo_class hwinfo_scsi_disk = {
+	"SCSI Disk Device",
+	{ "Name", "Vendor", "Model", "State", NULL },
+	0
+};
+
+static const fwts_hwinfo_class hwinfo_drm = {
+	"DRM Device",
+	{ "Name", "Status", "Enabled", NULL },
+	0
+};
 
 static char *fwts_hwinfo_data_get(const char *sys, const char *dev, const char *file)
 {
@@ -114,286 +119,223 @@ static char *fwts_hwinfo_data_get(const char *sys, const char *dev, const char *
 	return data;
 }
 
-
-/*
- *  fwts_hwinfo_bluetooth_free()
- *	free bluetooth data
- */
-static void fwts_hwinfo_bluetooth_free(void *data)
-{
-	fwts_bluetooth_config *config = (fwts_bluetooth_config *)data;
-
-	free(config->name);
-	free(config->bt_name);
-	free(config->address);
-	free(config->bus);
-	free(config->type);
-	free(config);
-}
-
 /*
- *  fwts_hwinfo_bluetooth_name_cmp()
- *	compare bluetooth config device name for sorting purposes
+ *  fwts_hwinfo_device_free()
+ *	free a device's fields
  */
-static int fwts_hwinfo_bluetooth_name_cmp(void *data1, void *data2)
+static void fwts_hwinfo_device_free(fwts_hwinfo_device *device)
 {
-	fwts_bluetooth_config *config1 = (fwts_bluetooth_config *)data1;
-	fwts_bluetooth_config *config2 = (fwts_bluetooth_config *)data2;
+	int i;
 
-	return strcmp(config1->name, config2->name);
+	for (i = 0; i < FWTS_HWINFO_FIELDS_MAX; i++)
+		free(device->fields[i]);
 }
 
 /*
- *  fwts_hwinfo_bluetooth_cmp()
- *	compare bluetooth config data
+ *  fwts_hwinfo_devices_free()
+ *	free all devices of a class
  */
-static int fwts_hwinfo_bluetooth_config_cmp(void *data1, void *data2)
+static void fwts_hwinfo_devices_free(fwts_hwinfo_devices *devices)
 {
-	fwts_bluetooth_config *config1 = (fwts_bluetooth_config *)data1;
-	fwts_bluetooth_config *config2 = (fwts_bluetooth_config *)data2;
-
-	return strcmp(config1->name, config2->name) ||
-	       strcmp(config1->bt_name, config2->bt_name) ||
-	       strcmp(config1->address, config2->address) ||
-	       strcmp(config1->bus, config2->bus) ||
-	       strcmp(config1->type, config2->type);
+	size_t i;
+
+	for (i = 0; i < devices->len; i++)
+		fwts_hwinfo_device_free(&devices->devices[i]);
+	free(devices->devices);
+	memset(devices, 0, sizeof(*devices));
 }
 
 /*
- *  fwts_hwinfo_bluetooth_get()
- * 	read a specific bluetooth device config
+ *  fwts_hwinfo_device_add()
+ *	add a device named name, its other fields are filled in by the caller
  */
-static int fwts_hwinfo_bluetooth_get(
+static fwts_hwinfo_device *fwts_hwinfo_device_add(
 	fwts_framework *fw,
-	fwts_list *devices)
+	fwts_hwinfo_devices *devices,
+	const char *name)
 {
-	DIR *dp;
-	struct dirent *d;
-
-	fwts_list_init(devices);
-	if ((dp = opendir(FWTS_HWINFO_SYS_BLUETOOTH)) == NULL) {
-		fwts_log_error(fw, "Cannot open %s to scan bluetooth devices.", FWTS_HWINFO_SYS_BLUETOOTH);
-		return FWTS_ERROR;
-	}
+	fwts_hwinfo_device *device;
 
-	while ((d = readdir(dp)) != NULL) {
-		fwts_bluetooth_config *bluetooth_config;
-
-		if (d->d_name[0] == '.')
-			continue;
+	if (devices->len == devices->size) {
+		const size_t size = devices->size ? devices->size * 2 : FWTS_HWINFO_DEVICES_MIN;
 
-		if ((bluetooth_config = calloc(1, sizeof(*bluetooth_config))) == NULL) {
-			fwts_log_error(fw, "Cannot allocate bluetooth config data.");
-			break;
-		}
-		bluetooth_config->name = strdup(d->d_name);
-		bluetooth_config->bt_name = fwts_hwinfo_data_get(FWTS_HWINFO_SYS_BLUETOOTH, d->d_name, "name");
-		bluetooth_config->address = fwts_hwinfo_data_get(FWTS_HWINFO_SYS_BLUETOOTH, d->d_name, "address");
-		bluetooth_config->bus = fwts_hwinfo_data_get(FWTS_HWINFO_SYS_BLUETOOTH, d->d_name, "bus");
-		bluetooth_config->type = fwts_hwinfo_data_get(FWTS_HWINFO_SYS_BLUETOOTH, d->d_name, "type");
-
-		if (bluetooth_config->name == NULL ||
-		    bluetooth_config->bt_name == NULL ||
-		    bluetooth_config->address == NULL ||
-		    bluetooth_config->bus == NULL ||
-		    bluetooth_config->type == NULL) {
-			fwts_log_error(fw, "Cannot allocate bluetooth device attributes.");
-			fwts_hwinfo_bluetooth_free(bluetooth_config);
-			break;
+		if ((device = realloc(devices->devices, size * sizeof(*device))) == NULL) {
+			fwts_log_error(fw, "Cannot allocate device list.");
+			return NULL;
 		}
-		fwts_list_add_ordered(devices, bluetooth_config, fwts_hwinfo_bluetooth_name_cmp);
+		devices->devices = device;
+		devices->size = size;
 	}
-	(void)closedir(dp);
-	return FWTS_OK;
+	device = &devices->devices[devices->len];
+	memset(device, 0, sizeof(*device));
+	if ((device->fields[0] = strdup(name)) == NULL) {
+		fwts_log_error(fw, "Cannot allocate device name.");
+		return NULL;
+	}
+	devices->len++;
+
+	return device;
 }
 
 /*
- *  fwts_hwinfo_bluetooth_dump()
- *	simple bluetooth config dump
+ *  fwts_hwinfo_device_drop()
+ *	drop the device that was just added
  */
-static void fwts_hwinfo_bluetooth_dump(fwts_framework *fw, fwts_list *devices)
+static void fwts_hwinfo_device_drop(fwts_hwinfo_devices *devices)
 {
-	fwts_list_link *item;
-
-	fwts_list_foreach(item, devices) {
-		fwts_bluetooth_config *bluetooth_config = fwts_list_data(fwts_bluetooth_config *, item);
-
-		fwts_log_info_verbatim(fw, "  Device:  %s", bluetooth_config->name);
-		fwts_log_info_verbatim(fw, "  Name:    %s", bluetooth_config->bt_name);
-		fwts_log_info_verbatim(fw, "  Address: %s", bluetooth_config->address);
-		fwts_log_info_verbatim(fw, "  Bus:     %s", bluetooth_config->bus);
-		fwts_log_info_verbatim(fw, "  Type:    %s", bluetooth_config->type);
-		fwts_log_nl(fw);
-	}
+	fwts_hwinfo_device_free(&devices->devices[--devices->len]);
 }
 
 /*
- *  fwts_hwinfo_input_free()
- *	free input data
+ *  fwts_hwinfo_device_check()
+ *	check all n fields of the device that was just added were
+ *	allocated, drop it if not
  */
-static void fwts_hwinfo_input_free(void *data)
-{
-	fwts_input_config *config = (fwts_input_config *)data;
+static int fwts_hwinfo_device_check(
+	fwts_framework *fw,
+	fwts_hwinfo_devices *devices,
+	const int n,
+	const char *what)
+{
+	const fwts_hwinfo_device *device = &devices->devices[devices->len - 1];
+	int i;
+
+	for (i = 0; i < n; i++) {
+		if (device->fields[i] == NULL) {
+			fwts_log_error(fw, "Cannot allocate %s device attributes.", what);
+			fwts_hwinfo_device_drop(devices);
+			return FWTS_ERROR;
+		}
+	}
 
-	free(config->name);
-	free(config->dev_name);
-	free(config->phys);
-	free(config);
+	return FWTS_OK;
 }
 
 /*
- *  fwts_hwinfo_input_name_cmp()
- *	compare input config device class name for sorting purposes
+ *  fwts_hwinfo_device_cmp()
+ *	compare devices by identity for sorting
  */
-static int fwts_hwinfo_input_name_cmp(void *data1, void *data2)
+static int fwts_hwinfo_device_cmp(const void *data1, const void *data2)
 {
-	fwts_input_config *config1 = (fwts_input_config *)data1;
-	fwts_input_config *config2 = (fwts_input_config *)data2;
+	const fwts_hwinfo_device *device1 = (const fwts_hwinfo_device *)data1;
+	const fwts_hwinfo_device *device2 = (const fwts_hwinfo_device *)data2;
 
-	return strcmp(config1->name, config2->name);
+	return strcmp(device1->fields[0], device2->fields[0]);
 }
 
 /*
- *  fwts_hwinfo_input_cmp()
- *	compare input config data
+ *  fwts_hwinfo_devices_sort()
+ *	sort devices by identity once they have all been read
  */
-static int fwts_hwinfo_input_config_cmp(void *data1, void *data2)
+static void fwts_hwinfo_devices_sort(fwts_hwinfo_devices *devices)
 {
-	fwts_input_config *config1 = (fwts_input_config *)data1;
-	fwts_input_config *config2 = (fwts_input_config *)data2;
-
-	return strcmp(config1->name, config2->name) ||
-	       strcmp(config1->dev_name, config2->dev_name) ||
-	       strcmp(config1->phys, config2->phys);
+	if (devices->len > 1)
+		qsort(devices->devices, devices->len, sizeof(*devices->devices), fwts_hwinfo_device_cmp);
 }
 
 /*
- *  fwts_hwinfo_input_get()
- * 	read a specific input device config
+ *  devices in a /sys/class directory whose names start with prefix,
+ *  or any device if prefix is NULL, and the attributes read for
+ *  fields 1 onwards
  */
-static int fwts_hwinfo_input_get(
+typedef struct {
+	const char *prefix;
+	const char *attrs[FWTS_HWINFO_FIELDS_MAX];
+} fwts_hwinfo_sys_rule;
+
+/*
+ *  fwts_hwinfo_sys_get()
+ *	read devices in a /sys/class directory, each device is read
+ *	using the first rule that matches its name
+ */
+static int fwts_hwinfo_sys_get(
 	fwts_framework *fw,
-	fwts_list *devices)
+	const char *sys,
+	const fwts_hwinfo_sys_rule *rules,
+	const size_t nrules,
+	const char *what,
+	fwts_hwinfo_devices *devices)
 {
 	DIR *dp;
 	struct dirent *d;
 
-	fwts_list_init(devices);
-	if ((dp = opendir(FWTS_HWINFO_SYS_INPUT)) == NULL) {
-		fwts_log_error(fw, "Cannot open %s to scan input devices.", FWTS_HWINFO_SYS_INPUT);
+	if ((dp = opendir(sys)) == NULL) {
+		fwts_log_error(fw, "Cannot open %s to scan %s devices.", sys, what);
 		return FWTS_ERROR;
 	}
 
 	while ((d = readdir(dp)) != NULL) {
-		fwts_input_config *input_config;
+		const fwts_hwinfo_sys_rule *rule;
+		fwts_hwinfo_device *device;
+		size_t i;
 
 		if (d->d_name[0] == '.')
 			continue;
-		if (!strncmp(d->d_name, "input", 5)) {
-			if ((input_config = calloc(1, sizeof(*input_config))) == NULL) {
-				fwts_log_error(fw, "Cannot allocate input config data.");
-				break;
-			}
-			input_config->dev_name = fwts_hwinfo_data_get(FWTS_HWINFO_SYS_INPUT, d->d_name, "name");
-			input_config->phys = fwts_hwinfo_data_get(FWTS_HWINFO_SYS_INPUT, d->d_name, "phys");
-		} else if (!strncmp(d->d_name, "event", 5) ||
-			   !strncmp(d->d_name, "mouse", 5)) {
-			if ((input_config = calloc(1, sizeof(*input_config))) == NULL) {
-				fwts_log_error(fw, "Cannot allocate input config data.");
+		for (rule = rules; rule < rules + nrules; rule++)
+			if (!rule->prefix || !strncmp(d->d_name, rule->prefix, strlen(rule->prefix)))
 				break;
-			}
-			input_config->dev_name = fwts_hwinfo_data_get(FWTS_HWINFO_SYS_INPUT, d->d_name, "device/name");
-			input_config->phys = fwts_hwinfo_data_get(FWTS_HWINFO_SYS_INPUT, d->d_name, "device/phys");
-		} else {
-			/* Don't know what type it is, ignore */
+		/* Don't know what type it is, ignore */
+		if (rule == rules + nrules)
 			continue;
-		}
 
-		input_config->name = strdup(d->d_name);
-
-		if (input_config->name == NULL ||
-		    input_config->dev_name == NULL ||
-		    input_config->phys == NULL) {
-			fwts_log_error(fw, "Cannot allocate input device attributes.");
-			fwts_hwinfo_input_free(input_config);
+		if ((device = fwts_hwinfo_device_add(fw, devices, d->d_name)) == NULL)
+			break;
+		for (i = 0; (i < FWTS_HWINFO_FIELDS_MAX - 1) && rule->attrs[i]; i++)
+			device->fields[i + 1] = fwts_hwinfo_data_get(sys, d->d_name, rule->attrs[i]);
+		if (fwts_hwinfo_device_check(fw, devices, i + 1, what) != FWTS_OK)
 			break;
-		}
-		fwts_list_add_ordered(devices, input_config, fwts_hwinfo_input_name_cmp);
 	}
 	(void)closedir(dp);
-	return FWTS_OK;
-}
-
-/*
- *  fwts_hwinfo_input_dump()
- *	simple input config dump
- */
-static void fwts_hwinfo_input_dump(fwts_framework *fw, fwts_list *devices)
-{
-	fwts_list_link *item;
 
-	fwts_list_foreach(item, devices) {
-		fwts_input_config *input_config = fwts_list_data(fwts_input_config *, item);
-
-		fwts_log_info_verbatim(fw, "  Device:      %s", input_config->name);
-		fwts_log_info_verbatim(fw, "  Device Name: %s", input_config->dev_name);
-		fwts_log_info_verbatim(fw, "  Phy:         %s", input_config->phys);
-		fwts_log_nl(fw);
-	}
-}
-
-/*
- *  fwts_hwinfo_net_free()
- *	free net config data
- */
-static void fwts_hwinfo_net_free(void *data)
-{
-	fwts_net_config *config = (fwts_net_config *)data;
-
-	free(config->name);
-	free(config->addr);
-	free(config->hw_addr);
-	free(config);
+	return FWTS_OK;
 }
 
 /*
- *  fwts_hwinfo_net_name_cmp()
- *	compare net config device name for sorting purposes
+ *  fwts_hwinfo_bluetooth_get()
+ * 	read bluetooth device configs
  */
-static int fwts_hwinfo_net_name_cmp(void *data1, void *data2)
+static int fwts_hwinfo_bluetooth_get(
+	fwts_framework *fw,
+	fwts_hwinfo_devices *devices)
 {
-	fwts_net_config *config1 = (fwts_net_config *)data1;
-	fwts_net_config *config2 = (fwts_net_config *)data2;
+	static const fwts_hwinfo_sys_rule rules[] = {
+		{ NULL, { "name", "address", "bus", "type", NULL } },
+	};
 
-	return strcmp(config1->name, config2->name);
+	return fwts_hwinfo_sys_get(fw, FWTS_HWINFO_SYS_BLUETOOTH,
+		rules, FWTS_ARRAY_SIZE(rules), "bluetooth", devices);
 }
 
 /*
- *  fwts_hwinfo_net_cmp()
- *	compare net config data
+ *  fwts_hwinfo_input_get()
+ * 	read input device configs
  */
-static int fwts_hwinfo_net_cmp(void *data1, void *data2)
+static int fwts_hwinfo_input_get(
+	fwts_framework *fw,
+	fwts_hwinfo_devices *devices)
 {
-	fwts_net_config *config1 = (fwts_net_config *)data1;
-	fwts_net_config *config2 = (fwts_net_config *)data2;
+	static const fwts_hwinfo_sys_rule rules[] = {
+		{ "input", { "name", "phys", NULL } },
+		{ "event", { "device/name", "device/phys", NULL } },
+		{ "mouse", { "device/name", "device/phys", NULL } },
+	};
 
-	return strcmp(config1->name, config2->name) ||
-	       strcmp(config1->hw_addr, config2->hw_addr);
+	return fwts_hwinfo_sys_get(fw, FWTS_HWINFO_SYS_INPUT,
+		rules, FWTS_ARRAY_SIZE(rules), "input", devices);
 }
 
 /*
- *  fwts_hwinfo_new_get()
- * 	read a specific network interface config
+ *  fwts_hwinfo_net_get()
+ * 	read network interface configs
  */
 static int fwts_hwinfo_net_get(
 	fwts_framework *fw,
-	fwts_list *devices)
+	fwts_hwinfo_devices *devices)
 {
 	DIR *dp;
 	struct dirent *d;
 	int sock;
 
-	fwts_list_init(devices);
 	if ((sock = socket(PF_INET, SOCK_DGRAM, 0)) < 0) {
 		fwts_log_error(fw, "Cannot open socket to interrogate network devices.");
 		return FWTS_ERROR;
@@ -408,33 +350,22 @@ static int fwts_hwinfo_net_get(
 	while ((d = readdir(dp)) != NULL) {
 		struct ifreq buf;
 		struct sockaddr_in sockaddr;
-		fwts_net_config *net_config;
+		fwts_hwinfo_device *device;
 
 		if (d->d_name[0] == '.')
 			continue;
-		if ((net_config = calloc(1, sizeof(*net_config))) == NULL) {
-			fwts_log_error(fw, "Cannot allocate net config data.");
+		if ((device = fwts_hwinfo_device_add(fw, devices, d->d_name)) == NULL)
 			break;
-		}
-		net_config->name = strdup(d->d_name);
-		if (net_config->name == NULL) {
-			fwts_log_error(fw, "Cannot allocate net config name.");
-			fwts_hwinfo_net_free(net_config);
-			break;
-		}
+
 		memset(&buf, 0, sizeof(buf));
 		strlcpy(buf.ifr_name, d->d_name, sizeof(buf.ifr_name));
 		if (ioctl(sock, SIOCGIFHWADDR, &buf) < 0) {
 			fwts_log_error(fw, "Cannot get network information for device %s.", d->d_name);
-			fwts_hwinfo_net_free(net_config);
+			fwts_hwinfo_device_drop(devices);
 			continue;
 		}
-		net_config->hw_addr = strdup(ether_ntoa(((struct ether_addr *)&buf.ifr_hwaddr.sa_data)));
-		if (net_config->hw_addr == NULL) {
-			fwts_log_error(fw, "Cannot allocate net config address.");
-			fwts_hwinfo_net_free(net_config);
-			break;
-		}
+		device->fields[2] = strdup(ether_ntoa(((struct ether_addr *)&buf.ifr_hwaddr.sa_data)));
+
 		memset(&buf, 0, sizeof(buf));
 		strlcpy(buf.ifr_name, d->d_name, sizeof(buf.ifr_name));
 		if (ioctl(sock, SIOCGIFADDR, &buf) < 0) {
@@ -443,13 +374,10 @@ static int fwts_hwinfo_net_get(
 		}
 		/* GCC 4.4 is rather overly pedantic in strict aliasing warnings, this avoids it */
 		memcpy(&sockaddr, &buf.ifr_addr, sizeof(sockaddr));
-		net_config->addr = strdup(inet_ntoa((struct in_addr)sockaddr.sin_addr));
-		if (net_config->addr == NULL) {
-			fwts_log_error(fw, "Cannot allocate net config H/W address.");
-			fwts_hwinfo_net_free(net_config);
+		device->fields[1] = strdup(inet_ntoa((struct in_addr)sockaddr.sin_addr));
+
+		if (fwts_hwinfo_device_check(fw, devices, 3, "network") != FWTS_OK)
 			break;
-		}
-		fwts_list_add_ordered(devices, net_config, fwts_hwinfo_net_name_cmp);
 	}
 	(void)closedir(dp);
 	(void)close(sock);
@@ -457,509 +385,203 @@ static int fwts_hwinfo_net_get(
 	return FWTS_OK;
 }
 
-/*
- *  fwts_hwinfo_net_dump()
- *	simple net config dump
- */
-static void fwts_hwinfo_net_dump(fwts_framework *fw, fwts_list *devices)
-{
-	fwts_list_link *item;
-
-	fwts_list_foreach(item, devices) {
-		fwts_net_config *net_config = fwts_list_data(fwts_net_config *, item);
-
-		fwts_log_info_verbatim(fw, "  Device:      %s", net_config->name);
-		fwts_log_info_verbatim(fw, "  Address:     %s", net_config->addr);
-		fwts_log_info_verbatim(fw, "  H/W Address: %s", net_config->hw_addr);
-		fwts_log_nl(fw);
-	}
-}
-
 /*
  *  fwts_hwinfo_pci_get()
  * 	read a specific PCI config based on class code,
- *	retuning matching PCI configs into the configs list
+ *	retuning matching PCI configs into the devices list
  */
 static int fwts_hwinfo_pci_get(
 	fwts_framework *fw,
+	const fwts_pci_topology *topology,
 	const uint8_t class_code,
-	fwts_list *configs)
+	fwts_hwinfo_devices *devices)
 {
-	DIR *pci;
-	struct dirent *d;
+	fwts_pci_device *pci_device;
 
-	fwts_list_init(configs);
-	if ((pci = opendir(FWTS_PCI_DEV_PATH)) == NULL) {
-		fwts_log_error(fw, "Cannot open %s to scan PCI devices.", FWTS_PCI_DEV_PATH);
+	if (topology == NULL)
 		return FWTS_ERROR;
-	}
 
-	while ((d = readdir(pci)) != NULL) {
-		ssize_t	n;
-		int	fd;
-		fwts_pci_config *pci_config;
-		uint8_t	config[64];
-		char 	path[PATH_MAX];
+	fwts_pci_topology_foreach(pci_device, topology) {
+		const uint8_t *config = pci_device->config;
+		fwts_hwinfo_device *device;
+		char buffer[80];
+		size_t n, i;
+		int field = 3;
 
-		if (d->d_name[0] == '.')
-			continue;
-		snprintf(path, sizeof(path), FWTS_PCI_DEV_PATH "/%s/config", d->d_name);
-
-		if ((fd = open(path, O_RDONLY)) < 0) {
-			fwts_log_error(fw, "Cannot open PCI config from %s.", d->d_name);
+		if ((pci_device->config_len < FWTS_HWINFO_PCI_CONFIG_LEN) ||
+		    (config[FWTS_PCI_CONFIG_CLASS_CODE] != class_code))
 			continue;
-		}
 
-		if ((n = read(fd, config, sizeof(config))) < 0) {
-			fwts_log_error(fw, "Cannot read PCI config from %s.", d->d_name);
-			(void)close(fd);
-			continue;
-		}
-		(void)close(fd);
-
-		if (config[FWTS_PCI_CONFIG_CLASS_CODE] != class_code)
-			continue;
+		if ((device = fwts_hwinfo_device_add(fw, devices, pci_device->name)) == NULL)
+			break;
 
-		if ((pci_config = (fwts_pci_config *)calloc(1, sizeof(*pci_config))) == NULL) {
-			fwts_log_error(fw, "Cannot allocate PCI config.");
-			continue;
+		snprintf(buffer, sizeof(buffer), "%2.2" PRIx8 "%2.2" PRIx8 ":%2.2" PRIx8 "%2.2" PRIx8,
+			config[FWTS_PCI_CONFIG_VENDOR_ID + 1], config[FWTS_PCI_CONFIG_VENDOR_ID],
+			config[FWTS_PCI_CONFIG_DEVICE_ID + 1], config[FWTS_PCI_CONFIG_DEVICE_ID]);
+		device->fields[1] = strdup(buffer);
+		snprintf(buffer, sizeof(buffer), "%2.2" PRIx8 ":%2.2" PRIx8 " (%s)",
+			config[FWTS_PCI_CONFIG_CLASS_CODE], config[FWTS_PCI_CONFIG_SUBCLASS],
+			fwts_pci_description(config[FWTS_PCI_CONFIG_CLASS_CODE],
+				config[FWTS_PCI_CONFIG_SUBCLASS]));
+		device->fields[2] = strdup(buffer);
+
+		/* and the raw config space, 16 bytes per field */
+		for (n = 0; n < FWTS_HWINFO_PCI_CONFIG_LEN; n += 16) {
+			char *ptr = buffer;
+
+			for (i = 0; i < 16; i++)
+				ptr += snprintf(ptr, sizeof(buffer) - (ptr - buffer), "%s%2.2" PRIx8,
+					i ? " " : "", config[n + i]);
+			device->fields[field++] = strdup(buffer);
 		}
-		memcpy(pci_config->config, config, n);
-		pci_config->config_len = n;
-		strlcpy(pci_config->name, d->d_name, sizeof(pci_config->name));
 
-		fwts_list_append(configs, pci_config);
+		if (fwts_hwinfo_device_check(fw, devices, field, "PCI") != FWTS_OK)
+			break;
 	}
-	(void)closedir(pci);
 
 	return FWTS_OK;
 }
 
-/*
- *  fwts_hwinfo_pci_config_cmp()
- *	compare PCI configs
- */
-static int fwts_hwinfo_pci_config_cmp(void *data1, void *data2)
-{
-	fwts_pci_config *pci_config1 = (fwts_pci_config *)data1;
-	fwts_pci_config *pci_config2 = (fwts_pci_config *)data2;
-
-	return (pci_config1->config_len != pci_config2->config_len ||
-	    memcmp(pci_config1->config, pci_config2->config, pci_config1->config_len) ||
-	    strcmp(pci_config1->name, pci_config2->name));
-}
-
-/*
- *  fwts_hwinfo_pci_dump()
- *	simple PCI config dump
- */
-static void fwts_hwinfo_pci_dump(fwts_framework *fw, fwts_list *configs)
-{
-	fwts_list_link *item;
-
-	fwts_list_foreach(item, configs) {
-		ssize_t n;
-
-		fwts_pci_config *pci_config = fwts_list_data(fwts_pci_config *, item);
-		fwts_log_info_verbatim(fw, "  PCI: %s, VID: %2.2" PRIx8 ":%2.2" PRIx8
-			", Class: %2.2" PRIx8 ":%2.2" PRIx8 " (%s)",
-			pci_config->name,
-			pci_config->config[FWTS_PCI_CONFIG_VENDOR_ID],
-			pci_config->config[FWTS_PCI_CONFIG_DEVICE_ID],
-			pci_config->config[FWTS_PCI_CONFIG_CLASS_CODE],
-			pci_config->config[FWTS_PCI_CONFIG_SUBCLASS],
-			fwts_pci_description(pci_config->config[FWTS_PCI_CONFIG_CLASS_CODE],
-				pci_config->config[FWTS_PCI_CONFIG_SUBCLASS]));
-		fwts_log_info_verbatim(fw, "  Config:");
-
-		/* and do a raw hex dump of the config space */
-		for (n = 0; n < pci_config->config_len; n += 16) {
-			ssize_t left = pci_config->config_len - n;
-			char buffer[128];
-
-			fwts_dump_raw_data(buffer, sizeof(buffer), pci_config->config + n,
-				n, left > 16 ? 16 : left);
-			fwts_log_info_verbatim(fw, "  %s", buffer);
-		}
-		fwts_log_nl(fw);
-	}
-}
-
-/*
- *  fwts_hwinfo_typec_free()
- *	free Type-C data
- */
-static void fwts_hwinfo_typec_free(void *data)
-{
-	fwts_typec_config *config = (fwts_typec_config *)data;
-
-	free(config->name);
-	free(config->data_role);
-	free(config->port_type);
-	free(config->power_role);
-	free(config->power_operation_mode);
-	free(config);
-}
-
-/*
- *  fwts_hwinfo_typec_cmp()
- *	compare Type-C config data
- */
-static int fwts_hwinfo_typec_config_cmp(void *data1, void *data2)
-{
-
-	fwts_typec_config *config1 = (fwts_typec_config *)data1;
-	fwts_typec_config *config2 = (fwts_typec_config *)data2;
-
-	return strcmp(config1->name, config2->name) ||
-	       strcmp(config1->data_role, config2->data_role) ||
-	       strcmp(config1->port_type, config2->port_type) ||
-	       strcmp(config1->power_role, config2->power_role) ||
-	       strcmp(config1->power_operation_mode, config2->power_operation_mode);
-}
-
 /*
  *  fwts_hwinfo_typec_get()
- * 	read a specific Type-C device config
+ * 	read Type-C device configs
  */
 static int fwts_hwinfo_typec_get(
 	fwts_framework *fw,
-	fwts_list *devices)
-{
-	DIR *dp;
-	struct dirent *d;
-
-	fwts_list_init(devices);
-	if ((dp = opendir(FWTS_HWINFO_SYS_TYPEC)) == NULL) {
-		fwts_log_error(fw, "Cannot open %s to scan Type-C devices.", FWTS_HWINFO_SYS_TYPEC);
-		return FWTS_ERROR;
-	}
-
-	while ((d = readdir(dp)) != NULL) {
-		fwts_typec_config *typec_config;
-
-		if (d->d_name[0] == '.')
-			continue;
-
-		if ((typec_config = calloc(1, sizeof(*typec_config))) == NULL) {
-			fwts_log_error(fw, "Cannot allocate Type-C config data.");
-			break;
-		}
-		typec_config->name = strdup(d->d_name);
-		typec_config->data_role = fwts_hwinfo_data_get(FWTS_HWINFO_SYS_TYPEC, d->d_name, "data_role");
-		typec_config->port_type = fwts_hwinfo_data_get(FWTS_HWINFO_SYS_TYPEC, d->d_name, "port_type");
-		typec_config->power_role = fwts_hwinfo_data_get(FWTS_HWINFO_SYS_TYPEC, d->d_name, "power_role");
-		typec_config->power_operation_mode = fwts_hwinfo_data_get(FWTS_HWINFO_SYS_TYPEC, d->d_name, "power_operation_mode");
-
-		if (typec_config->name == NULL ||
-		    typec_config->data_role == NULL ||
-		    typec_config->port_type == NULL ||
-		    typec_config->power_role == NULL ||
-		    typec_config->power_operation_mode == NULL) {
-			fwts_log_error(fw, "Cannot allocate Type-C device attributes.");
-			fwts_hwinfo_typec_free(typec_config);
-			break;
-		}
-		fwts_list_append(devices, typec_config);
-	}
-	(void)closedir(dp);
-
-	return FWTS_OK;
-}
-
-/*
- *  fwts_hwinfo_typec_dump()
- *	simple Type-C config dump
- */
-static void fwts_hwinfo_typec_dump(fwts_framework *fw, fwts_list *devices)
-{
-	fwts_list_link *item;
-	fwts_list_foreach(item, devices) {
-		fwts_typec_config *typec_config = fwts_list_data(fwts_typec_config *, item);
-
-		fwts_log_info_verbatim(fw, "  Name:       %s", typec_config->name);
-		fwts_log_info_verbatim(fw, "  Data Role:  %s", typec_config->data_role);
-		fwts_log_info_verbatim(fw, "  Port Type:  %s", typec_config->port_type);
-		fwts_log_info_verbatim(fw, "  Power Role: %s", typec_config->power_role);
-		fwts_log_info_verbatim(fw, "  Power Mode: %s", typec_config->power_operation_mode);
-		fwts_log_nl(fw);
-	}
-}
-
-/*
- *  fwts_hwinfo_scsi_disk_free()
- *	free SCSI disk data
- */
-static void fwts_hwinfo_scsi_disk_free(void *data)
+	fwts_hwinfo_devices *devices)
 {
-	fwts_scsi_disk_config *config = (fwts_scsi_disk_config *)data;
+	static const fwts_hwinfo_sys_rule rules[] = {
+		{ NULL, { "data_role", "port_type", "power_role", "power_operation_mode", NULL } },
+	};
 
-	free(config->name);
-	free(config->model);
-	free(config->state);
-	free(config->vendor);
-	free(config);
-}
-
-/*
- *  fwts_hwinfo_scsi_disk_cmp()
- *	compare SCSI disk config data
- */
-static int fwts_hwinfo_scsi_disk_config_cmp(void *data1, void *data2)
-{
-
-	fwts_scsi_disk_config *config1 = (fwts_scsi_disk_config *)data1;
-	fwts_scsi_disk_config *config2 = (fwts_scsi_disk_config *)data2;
-
-	return strcmp(config1->name, config2->name) ||
-	       strcmp(config1->model, config2->model) ||
-	       strcmp(config1->state, config2->state) ||
-	       strcmp(config1->vendor, config2->vendor);
+	return fwts_hwinfo_sys_get(fw, FWTS_HWINFO_SYS_TYPEC,
+		rules, FWTS_ARRAY_SIZE(rules), "Type-C", devices);
 }
 
 /*
  *  fwts_hwinfo_scsi_disk_get()
- * 	read a specific SCSI disk device config
+ * 	read SCSI disk device configs
  */
 static int fwts_hwinfo_scsi_disk_get(
 	fwts_framework *fw,
-	fwts_list *devices)
-{
-	DIR *dp;
-	struct dirent *d;
-
-	fwts_list_init(devices);
-	if ((dp = opendir(FWTS_HWINFO_SYS_SCSI_DISK)) == NULL) {
-		fwts_log_error(fw, "Cannot open %s to scan SCSI disk devices.", FWTS_HWINFO_SYS_SCSI_DISK);
-		return FWTS_ERROR;
-	}
-
-	while ((d = readdir(dp)) != NULL) {
-		fwts_scsi_disk_config *scsi_disk_config;
-
-		if (d->d_name[0] == '.')
-			continue;
-
-		if ((scsi_disk_config = calloc(1, sizeof(*scsi_disk_config))) == NULL) {
-			fwts_log_error(fw, "Cannot allocate SCSI disk config data.");
-			break;
-		}
-		scsi_disk_config->name = strdup(d->d_name);
-		scsi_disk_config->model = fwts_hwinfo_data_get(FWTS_HWINFO_SYS_SCSI_DISK, d->d_name, "device/model");
-		scsi_disk_config->state = fwts_hwinfo_data_get(FWTS_HWINFO_SYS_SCSI_DISK, d->d_name, "device/state");
-		scsi_disk_config->vendor = fwts_hwinfo_data_get(FWTS_HWINFO_SYS_SCSI_DISK, d->d_name, "device/vendor");
-
-		if (scsi_disk_config->name == NULL ||
-		    scsi_disk_config->model == NULL ||
-		    scsi_disk_config->state == NULL ||
-		    scsi_disk_config->vendor == NULL) {
-			fwts_log_error(fw, "Cannot allocate SCSI disk device attributes.");
-			fwts_hwinfo_scsi_disk_free(scsi_disk_config);
-			break;
-		}
-		fwts_list_append(devices, scsi_disk_config);
-	}
-	(void)closedir(dp);
-
-	return FWTS_OK;
-}
-
-/*
- *  fwts_hwinfo_scsi_disk_dump()
- *	simple SCSI disk config dump
- */
-static void fwts_hwinfo_scsi_disk_dump(fwts_framework *fw, fwts_list *devices)
-{
-	fwts_list_link *item;
-	fwts_list_foreach(item, devices) {
-		fwts_scsi_disk_config *scsi_disk_config = fwts_list_data(fwts_scsi_disk_config *, item);
-
-		fwts_log_info_verbatim(fw, "  Name:       %s", scsi_disk_config->name);
-		fwts_log_info_verbatim(fw, "  Vendor:     %s", scsi_disk_config->vendor);
-		fwts_log_info_verbatim(fw, "  Model:      %s", scsi_disk_config->model);
-		fwts_log_info_verbatim(fw, "  State:      %s", scsi_disk_config->state);
-		fwts_log_nl(fw);
-	}
-}
-
-/*
- *  fwts_hwinfo_drm_free()
- *	free DRM data
- */
-static void fwts_hwinfo_drm_free(void *data)
+	fwts_hwinfo_devices *devices)
 {
-	fwts_drm_config *config = (fwts_drm_config *)data;
+	static const fwts_hwinfo_sys_rule rules[] = {
+		{ NULL, { "device/vendor", "device/model", "device/state", NULL } },
+	};
 
-	free(config->name);
-	free(config->status);
-	free(config->enabled);
-	free(config);
-}
-
-/*
- *  fwts_hwinfo_drm_cmp()
- *	compare DRM config data
- */
-static int fwts_hwinfo_drm_config_cmp(void *data1, void *data2)
-{
-
-	fwts_drm_config *config1 = (fwts_drm_config *)data1;
-	fwts_drm_config *config2 = (fwts_drm_config *)data2;
-
-	return strcmp(config1->name, config2->name) ||
-	       strcmp(config1->status, config2->status) ||
-	       strcmp(config1->enabled, config2->enabled);
+	return fwts_hwinfo_sys_get(fw, FWTS_HWINFO_SYS_SCSI_DISK,
+		rules, FWTS_ARRAY_SIZE(rules), "SCSI disk", devices);
 }
 
 /*
  *  fwts_hwinfo_drm_get()
- * 	read a specific DRM device config
+ * 	read DRM device configs
  */
 static int fwts_hwinfo_drm_get(
 	fwts_framework *fw,
-	fwts_list *devices)
-{
-	DIR *dp;
-	struct dirent *d;
-
-	fwts_list_init(devices);
-	if ((dp = opendir(FWTS_HWINFO_SYS_DRM)) == NULL) {
-		fwts_log_error(fw, "Cannot open %s to scan DRM devices.", FWTS_HWINFO_SYS_DRM);
-		return FWTS_ERROR;
-	}
-
-	while ((d = readdir(dp)) != NULL) {
-		fwts_drm_config *drm_config;
-
-		if (d->d_name[0] == '.')
-			continue;
-
-		if (strncmp(d->d_name, "card", strlen("card")) != 0)
-			continue;
-
-		if ((drm_config = calloc(1, sizeof(*drm_config))) == NULL) {
-			fwts_log_error(fw, "Cannot allocate DRM config data.");
-			break;
-		}
-		drm_config->name = strdup(d->d_name);
-		drm_config->status = fwts_hwinfo_data_get(FWTS_HWINFO_SYS_DRM, d->d_name, "status");
-		drm_config->enabled = fwts_hwinfo_data_get(FWTS_HWINFO_SYS_DRM, d->d_name, "enabled");
-
-		if (drm_config->name == NULL ||
-		    drm_config->status == NULL ||
-		    drm_config->enabled == NULL) {
-			fwts_log_error(fw, "Cannot allocate DRM device attributes.");
-			fwts_hwinfo_drm_free(drm_config);
-			break;
-		}
-		fwts_list_append(devices, drm_config);
-	}
-	(void)closedir(dp);
-
-	return FWTS_OK;
-}
-
-/*
- *  fwts_hwinfo_drm_dump()
- *	simple SCSI disk config dump
- */
-static void fwts_hwinfo_drm_dump(fwts_framework *fw, fwts_list *devices)
+	fwts_hwinfo_devices *devices)
 {
-	fwts_list_link *item;
-	fwts_list_foreach(item, devices) {
-		fwts_drm_config *drm_config = fwts_list_data(fwts_drm_config *, item);
+	static const fwts_hwinfo_sys_rule rules[] = {
+		{ "card", { "status", "enabled", NULL } },
+	};
 
-		fwts_log_info_verbatim(fw, "  Name:       %s", drm_config->name);
-		fwts_log_info_verbatim(fw, "  Status:     %s", drm_config->status);
-		fwts_log_info_verbatim(fw, "  Enabled:    %s", drm_config->enabled);
-		fwts_log_nl(fw);
-	}
+	return fwts_hwinfo_sys_get(fw, FWTS_HWINFO_SYS_DRM,
+		rules, FWTS_ARRAY_SIZE(rules), "DRM", devices);
 }
 
 /*
- *  fwts_hwinfo_lists_dump()
- *	dump out contents of two different lists
+ *  fwts_hwinfo_device_dump()
+ *	dump all the fields of a device
  */
-static void fwts_hwinfo_lists_dump(
+static void fwts_hwinfo_device_dump(
 	fwts_framework *fw,
-	hwinfo_dump dump,
-	fwts_list *l1,
-	fwts_list *l2,
-	const char *message)
-{
-	fwts_log_info(fw, "%s configurations differ, before:", message);
-	if (fwts_list_len(l1))
-		dump(fw, l1);
-	else
-		fwts_log_info(fw, "  (empty)");
-
-	fwts_log_info(fw, "versus after:");
-	if (fwts_list_len(l2))
-		dump(fw, l2);
-	else
-		fwts_log_info(fw, "  (empty)");
-
-	fwts_log_nl(fw);
-}
-
-/*
- *  fwts_hwinfo_lists_differ()
- *	check lists to see if their contents differ, return 1 for differ, 0 for match,
- *	-1 for out of memory error
- */
-static int fwts_hwinfo_lists_differ(
-	hwinfo_cmp cmp,
-	fwts_list *l1,
-	fwts_list *l2)
+	const fwts_hwinfo_class *class,
+	const fwts_hwinfo_device *device)
 {
-	fwts_list_link *item1;
-	fwts_list_link *item2;
-
-	/* Both null - both the same then */
-	if ((l1 == NULL) && (l2 == NULL))
-		return FWTS_HWINFO_LISTS_SAME;
-
-	/* Either null and the other not? */
-	if ((l1 == NULL) || (l2 == NULL))
-		return FWTS_HWINFO_LISTS_DIFFER;
+	int i;
 
-	/* Different length, then they differ */
-	if (fwts_list_len(l1) != fwts_list_len(l2))
-		return FWTS_HWINFO_LISTS_DIFFER;
-
-	item1 = fwts_list_head(l1);
-	item2 = fwts_list_head(l2);
-
-	while ((item1 != NULL) && (item2 != NULL)) {
-		if (cmp(fwts_list_data(void *, item1), fwts_list_data(void *, item2)))
-			return FWTS_HWINFO_LISTS_DIFFER;
-		item1 = fwts_list_next(item1);
-		item2 = fwts_list_next(item2);
-	}
-
-	if ((item1 == NULL) && (item2 == NULL))
-		return FWTS_HWINFO_LISTS_SAME;
-	else
-		return FWTS_HWINFO_LISTS_DIFFER;
+	for (i = 1; i < FWTS_HWINFO_FIELDS_MAX && class->labels[i]; i++)
+		fwts_log_info_verbatim(fw, "    %-14s %s", class->labels[i],
+			device->fields[i] ? device->fields[i] : "");
 }
 
 /*
- *  fwts_hwinfo_lists_compare()
- *	check for differences in a list and if any found, dump out both lists
+ *  fwts_hwinfo_devices_compare()
+ *	compare devices of a class from before and after by identity,
+ *	both are sorted so this is a single merge pass. Only the devices
+ *	that were removed, added or changed are logged, for changed
+ *	devices just the fields that differ are shown.
  */
-static void fwts_hwinfo_lists_compare(
+static void fwts_hwinfo_devices_compare(
 	fwts_framework *fw,
-	hwinfo_cmp cmp,
-	hwinfo_dump dump,
-	fwts_list *l1,
-	fwts_list *l2,
-	const char *message,
+	const fwts_hwinfo_class *class,
+	const fwts_hwinfo_devices *devices1,
+	const fwts_hwinfo_devices *devices2,
 	int *differences)
 {
-	if (fwts_hwinfo_lists_differ(cmp, l1, l2) == FWTS_HWINFO_LISTS_DIFFER) {
+	size_t i = 0, j = 0;
+	bool heading = false;
+
+	while ((i < devices1->len) || (j < devices2->len)) {
+		const fwts_hwinfo_device *device1 = i < devices1->len ? &devices1->devices[i] : NULL;
+		const fwts_hwinfo_device *device2 = j < devices2->len ? &devices2->devices[j] : NULL;
+		const fwts_hwinfo_device *device;
+		const char *what;
+		int cmp, k;
+
+		if (device1 && device2)
+			cmp = strcmp(device1->fields[0], device2->fields[0]);
+		else
+			cmp = device1 ? -1 : 1;
+
+		if (cmp == 0) {
+			bool changed = false;
+
+			for (k = 1; k < FWTS_HWINFO_FIELDS_MAX && class->labels[k]; k++) {
+				const char *field1 = device1->fields[k] ? device1->fields[k] : "";
+				const char *field2 = device2->fields[k] ? device2->fields[k] : "";
+
+				if ((class->ignore & (1U << k)) || !strcmp(field1, field2))
+					continue;
+				if (!heading) {
+					fwts_log_info(fw, "%s configurations differ:", class->message);
+					heading = true;
+				}
+				if (!changed) {
+					fwts_log_info_verbatim(fw, "  Changed %s %s:",
+						class->labels[0], device1->fields[0]);
+					(*differences)++;
+					changed = true;
+				}
+				fwts_log_info_verbatim(fw, "    %-14s before: %s", class->labels[k], field1);
+				fwts_log_info_verbatim(fw, "    %-14s after:  %s", "", field2);
+			}
+			i++;
+			j++;
+			continue;
+		}
+
+		if (cmp < 0) {
+			device = device1;
+			what = "Removed";
+			i++;
+		} else {
+			device = device2;
+			what = "Added";
+			j++;
+		}
+		if (!heading) {
+			fwts_log_info(fw, "%s configurations differ:", class->message);
+			heading = true;
+		}
+		fwts_log_info_verbatim(fw, "  %s %s %s:", what, class->labels[0], device->fields[0]);
+		fwts_hwinfo_device_dump(fw, class, device);
 		(*differences)++;
-		fwts_hwinfo_lists_dump(fw, dump, l1, l2, message);
 	}
+
+	if (heading)
+		fwts_log_nl(fw);
 }
 
 /*
@@ -968,11 +590,16 @@ static void fwts_hwinfo_lists_compare(
  */
 int fwts_hwinfo_get(fwts_framework *fw, fwts_hwinfo *hwinfo)
 {
-	FWTS_UNUSED(fw);
+	fwts_pci_topology *topology;
 
-	/* PCI devices */
-	fwts_hwinfo_pci_get(fw, FWTS_PCI_CLASS_CODE_NETWORK_CONTROLLER, &hwinfo->network);
-	fwts_hwinfo_pci_get(fw, FWTS_PCI_CLASS_CODE_DISPLAY_CONTROLLER, &hwinfo->videocard);
+	memset(hwinfo, 0, sizeof(*hwinfo));
+
+	/* PCI devices, a fresh snapshot as hwinfo is compared across suspend */
+	if ((topology = fwts_pci_topology_new_headers(fw)) == NULL)
+		fwts_log_error(fw, "Cannot scan PCI devices.");
+	fwts_hwinfo_pci_get(fw, topology, FWTS_PCI_CLASS_CODE_NETWORK_CONTROLLER, &hwinfo->network);
+	fwts_hwinfo_pci_get(fw, topology, FWTS_PCI_CLASS_CODE_DISPLAY_CONTROLLER, &hwinfo->videocard);
+	fwts_pci_topology_free(topology);
 	/* Network devices */
 	fwts_hwinfo_net_get(fw, &hwinfo->netdevs);
 	fwts_hwinfo_input_get(fw, &hwinfo->input);
@@ -985,46 +612,55 @@ int fwts_hwinfo_get(fwts_framework *fw, fwts_hwinfo *hwinfo)
 	/* DRM devices */
 	fwts_hwinfo_drm_get(fw, &hwinfo->drm);
 
+	fwts_hwinfo_devices_sort(&hwinfo->network);
+	fwts_hwinfo_devices_sort(&hwinfo->videocard);
+	fwts_hwinfo_devices_sort(&hwinfo->netdevs);
+	fwts_hwinfo_devices_sort(&hwinfo->input);
+	fwts_hwinfo_devices_sort(&hwinfo->bluetooth);
+	fwts_hwinfo_devices_sort(&hwinfo->typec);
+	fwts_hwinfo_devices_sort(&hwinfo->scsi_disk);
+	fwts_hwinfo_devices_sort(&hwinfo->drm);
+
 	return FWTS_OK;
 }
 
 /*
  *  fwts_hwinfo_compare()
- *	compare data in each hwinfo list, produce a diff comparison output
+ *	compare data in each hwinfo class, log the devices that differ,
+ *	differences is the number of devices that differ
  */
 void fwts_hwinfo_compare(fwts_framework *fw, fwts_hwinfo *hwinfo1, fwts_hwinfo *hwinfo2, int *differences)
 {
 	*differences = 0;
 
 	/* PCI devices */
-	fwts_hwinfo_lists_compare(fw, fwts_hwinfo_pci_config_cmp, fwts_hwinfo_pci_dump,
-		&hwinfo1->network, &hwinfo2->network, "Network Controller", differences);
-	fwts_hwinfo_lists_compare(fw, fwts_hwinfo_pci_config_cmp, fwts_hwinfo_pci_dump,
-		&hwinfo1->videocard, &hwinfo2->videocard, "Video", differences);
+	fwts_hwinfo_devices_compare(fw, &hwinfo_pci_network,
+		&hwinfo1->network, &hwinfo2->network, differences);
+	fwts_hwinfo_devices_compare(fw, &hwinfo_pci_video,
+		&hwinfo1->videocard, &hwinfo2->videocard, differences);
 	/* Network devices */
-	fwts_hwinfo_lists_compare(fw, fwts_hwinfo_net_cmp, fwts_hwinfo_net_dump,
-		&hwinfo1->netdevs, &hwinfo2->netdevs, "Network", differences);
+	fwts_hwinfo_devices_compare(fw, &hwinfo_net,
+		&hwinfo1->netdevs, &hwinfo2->netdevs, differences);
 	/* Input devices */
-	fwts_hwinfo_lists_compare(fw, fwts_hwinfo_input_config_cmp, fwts_hwinfo_input_dump,
-		&hwinfo1->input, &hwinfo2->input, "Input Devices", differences);
+	fwts_hwinfo_devices_compare(fw, &hwinfo_input,
+		&hwinfo1->input, &hwinfo2->input, differences);
 	/* Bluetooth devices */
-	fwts_hwinfo_lists_compare(fw, fwts_hwinfo_bluetooth_config_cmp, fwts_hwinfo_bluetooth_dump,
-		&hwinfo1->bluetooth, &hwinfo2->bluetooth, "Bluetooth Device", differences);
+	fwts_hwinfo_devices_compare(fw, &hwinfo_bluetooth,
+		&hwinfo1->bluetooth, &hwinfo2->bluetooth, differences);
 	/* Type-C devices */
-	fwts_hwinfo_lists_compare(fw, fwts_hwinfo_typec_config_cmp, fwts_hwinfo_typec_dump,
-		&hwinfo1->typec, &hwinfo2->typec, "Type-C Device", differences);
+	fwts_hwinfo_devices_compare(fw, &hwinfo_typec,
+		&hwinfo1->typec, &hwinfo2->typec, differences);
 	/* SCSI disk devices */
-	fwts_hwinfo_lists_compare(fw, fwts_hwinfo_scsi_disk_config_cmp, fwts_hwinfo_scsi_disk_dump,
-		&hwinfo1->scsi_disk, &hwinfo2->scsi_disk, "SCSI Disk Device", differences);
+	fwts_hwinfo_devices_compare(fw, &hwinfo_scsi_disk,
+		&hwinfo1->scsi_disk, &hwinfo2->scsi_disk, differences);
 	/* DRM devices */
-	fwts_hwinfo_lists_compare(fw, fwts_hwinfo_drm_config_cmp, fwts_hwinfo_drm_dump,
-		&hwinfo1->drm, &hwinfo2->drm, "DRM Device", differences);
-
+	fwts_hwinfo_devices_compare(fw, &hwinfo_drm,
+		&hwinfo1->drm, &hwinfo2->drm, differences);
 }
 
 /*
  *  fwts_hwinfo_free()
- *	free hwinfo lists
+ *	free hwinfo devices
  */
 int fwts_hwinfo_free(fwts_hwinfo *hwinfo)
 {
@@ -1032,20 +668,20 @@ int fwts_hwinfo_free(fwts_hwinfo *hwinfo)
 		return FWTS_ERROR;
 
 	/* PCI devices */
-	fwts_list_free_items(&hwinfo->network, free);
-	fwts_list_free_items(&hwinfo->videocard, free);
+	fwts_hwinfo_devices_free(&hwinfo->network);
+	fwts_hwinfo_devices_free(&hwinfo->videocard);
 	/* Network devices */
-	fwts_list_free_items(&hwinfo->netdevs, fwts_hwinfo_net_free);
+	fwts_hwinfo_devices_free(&hwinfo->netdevs);
 	/* Input devices */
-	fwts_list_free_items(&hwinfo->input, fwts_hwinfo_input_free);
+	fwts_hwinfo_devices_free(&hwinfo->input);
 	/* Bluetooth devices */
-	fwts_list_free_items(&hwinfo->bluetooth, fwts_hwinfo_bluetooth_free);
+	fwts_hwinfo_devices_free(&hwinfo->bluetooth);
 	/* Type-C devices */
-	fwts_list_free_items(&hwinfo->typec, fwts_hwinfo_typec_free);
+	fwts_hwinfo_devices_free(&hwinfo->typec);
 	/* SCSI disk devices */
-	fwts_list_free_items(&hwinfo->scsi_disk, fwts_hwinfo_scsi_disk_free);
+	fwts_hwinfo_devices_free(&hwinfo->scsi_disk);
 	/* DRM devices */
-	fwts_list_free_items(&hwinfo->drm, fwts_hwinfo_drm_free);
+	fwts_hwinfo_devices_free(&hwinfo->drm);
 
 	return FWTS_OK;
 }
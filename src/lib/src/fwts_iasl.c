@@ -26,59 +26,161 @@
 #include <string.h>
 #include <fcntl.h>
 #include <limits.h>
+#include <poll.h>
 
 #include "fwts.h"
 
 #include "fwts_iasl_interface.h"
 #include "fwts_acpica.h"
 
+/* Most iasl jobs run at once by fwts_iasl_reassemble_all() */
+#define FWTS_IASL_JOBS_MAX	(16)
+
 /* For ACPICA interface */
 static char *iasl_cached_table_filename[ACPI_MAX_TABLES];
 static char *iasl_cached_table_name[ACPI_MAX_TABLES];
+static int iasl_cached_table_fd[ACPI_MAX_TABLES];
 
 static bool iasl_init = false;
 static int cached_max = 0;
 
 /*
- *  fwts_iasl_dump_aml_to_file()
- *	write AML data of given length to file amlfile.
+ *  iasl reassembly of a table run in a worker process
  */
-static int fwts_iasl_dump_aml_to_file(
-	fwts_framework *fw,
-	const uint8_t *data,
-	const int length,
-	const char *filename)
+typedef struct {
+	const fwts_acpi_table_info *info;
+	pid_t pid;			/* worker, -1 if not running */
+	int fd;				/* closed when worker exits */
+	int dsl_fd;			/* disassembly memory file */
+	int stdout_fd;			/* iasl stdout memory file */
+	int stderr_fd;			/* iasl stderr memory file */
+	char dsl_name[64];		/* iasl name for disassembly */
+	bool done;			/* result is ready */
+	int ret;			/* result */
+	fwts_list *iasl_disassembly;
+	fwts_list *iasl_stdout;
+	fwts_list *iasl_stderr;
+} fwts_iasl_job;
+
+/*
+ *  fwts_iasl_write()
+ *	write all of data to fd
+ */
+static int fwts_iasl_write(const int fd, const void *data, size_t len)
 {
-	int fd;
+	const uint8_t *ptr = data;
 
-	/* Dump the AML bytecode into a tempoary file so we can disassemble it */
-	if ((fd = open(filename, O_WRONLY | O_CREAT | O_EXCL, S_IWUSR | S_IRUSR)) < 0) {
-		fwts_log_error(fw, "Cannot create temporary file %s", filename);
-		return FWTS_ERROR;
+	while (len > 0) {
+		const ssize_t n = write(fd, ptr, len);
+
+		if (n < 0) {
+			if (errno == EINTR)
+				continue;
+			return FWTS_ERROR;
+		}
+		ptr += n;
+		len -= n;
 	}
 
-	if (write(fd, data, length) != length) {
-		fwts_log_error(fw, "Cannot write all data to temporary file");
+	return FWTS_OK;
+}
+
+/*
+ *  fwts_iasl_mem_file_new()
+ *	create a memory file holding len bytes of data that iasl
+ *	can open as name, returns the memory file or -1 on failure
+ */
+static int fwts_iasl_mem_file_new(
+	const char *name,
+	const void *data,
+	const size_t len)
+{
+	int fd;
+
+	if ((fd = fwts_iasl_mem_fd()) < 0)
+		return -1;
+
+	if ((fwts_iasl_write(fd, data, len) != FWTS_OK) ||
+	    (fwts_iasl_mem_file_add(name, fd) < 0)) {
 		(void)close(fd);
-		(void)unlink(filename);
-		return FWTS_ERROR;
+		return -1;
 	}
+
+	return fd;
+}
+
+/*
+ *  fwts_iasl_mem_file_free()
+ *	remove and close memory file
+ */
+static void fwts_iasl_mem_file_free(const char *name, const int fd)
+{
+	fwts_iasl_mem_file_remove(name);
 	(void)close(fd);
+}
 
-	return FWTS_OK;
+/*
+ *  fwts_iasl_mem_file_read()
+ *	read memory file and return contents as a list of lines
+ */
+static fwts_list *fwts_iasl_mem_file_read(const int fd)
+{
+	FILE *fp;
+	fwts_list *list;
+	int dup_fd;
+
+	if ((dup_fd = dup(fd)) < 0)
+		return NULL;
+	if ((fp = fdopen(dup_fd, "r")) == NULL) {
+		(void)close(dup_fd);
+		return NULL;
+	}
+	rewind(fp);
+	list = fwts_file_read(fp);
+	(void)fclose(fp);
+
+	return list;
+}
+
+/*
+ *  fwts_iasl_mem_file_text()
+ *	read memory file and return contents as a string
+ */
+static char *fwts_iasl_mem_file_text(const int fd)
+{
+	struct stat buf;
+	char *text;
+	size_t len = 0;
+
+	if (fstat(fd, &buf) < 0)
+		return NULL;
+	if ((text = malloc((size_t)buf.st_size + 1)) == NULL)
+		return NULL;
+
+	while (len < (size_t)buf.st_size) {
+		const ssize_t n = pread(fd, text + len, (size_t)buf.st_size - len, (off_t)len);
+
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			break;
+		len += n;
+	}
+	text[len] = '\0';
+
+	return text;
 }
 
 /*
- *  fwts_iasl_cache_tables_to_file()
- *	to disassemble an APCPI table we need to dump it
- *	to file. To save effort in saving these to file
- *	multiple times, we dump out all the tables and
- *	cache the references to these.
+ *  fwts_iasl_cache_tables()
+ *	to disassemble an APCPI table iasl needs to read it
+ *	from file. To save effort in doing this multiple times
+ *	all the tables are copied to memory files that iasl can
+ *	open by name and we cache the references to these.
  */
-static int fwts_iasl_cache_tables_to_file(fwts_framework *fw)
+static int fwts_iasl_cache_tables(fwts_framework *fw)
 {
-	pid_t pid = getpid();
-	char tmpname[PATH_MAX];
+	char name[64];
 	fwts_acpi_table_info *table;
 
 	for (cached_max = 0; cached_max < ACPI_MAX_TABLES; cached_max++) {
@@ -88,16 +190,17 @@ static int fwts_iasl_cache_tables_to_file(fwts_framework *fw)
 		if (table == NULL)
 			continue;
 
-		snprintf(tmpname, sizeof(tmpname),
-			"/tmp/fwts_tmp_table_%d_%s_%d.dsl",
-			pid, table->name, cached_max);
-		iasl_cached_table_filename[cached_max] = strdup(tmpname);
+		snprintf(name, sizeof(name), FWTS_IASL_MEM_PATH "table_%s_%d.aml",
+			table->name, cached_max);
+		iasl_cached_table_filename[cached_max] = strdup(name);
 		iasl_cached_table_name[cached_max] = table->name;
 		if (iasl_cached_table_filename[cached_max] == NULL) {
 			fwts_log_error(fw, "Cannot allocate cached table file name.");
 			return FWTS_ERROR;
 		}
-		if (fwts_iasl_dump_aml_to_file(fw, table->data, table->length, tmpname) != FWTS_OK) {
+		iasl_cached_table_fd[cached_max] = fwts_iasl_mem_file_new(name, table->data, table->length);
+		if (iasl_cached_table_fd[cached_max] < 0) {
+			fwts_log_error(fw, "Cannot cache table %s for iasl.", table->name);
 			free(iasl_cached_table_filename[cached_max]);
 			iasl_cached_table_filename[cached_max] = NULL;
 			iasl_cached_table_name[cached_max] = NULL;
@@ -116,7 +219,8 @@ void fwts_iasl_deinit(void)
 
 	for (i = 0; i < cached_max; i++) {
 		if (iasl_cached_table_filename[i]) {
-			(void)unlink(iasl_cached_table_filename[i]);
+			fwts_iasl_mem_file_free(iasl_cached_table_filename[i],
+				iasl_cached_table_fd[i]);
 			free(iasl_cached_table_filename[i]);
 		}
 		iasl_cached_table_filename[i] = NULL;
@@ -124,11 +228,12 @@ void fwts_iasl_deinit(void)
 	}
 	memset(iasl_cached_table_filename, 0, sizeof(iasl_cached_table_filename));
 	cached_max = 0;
+	iasl_init = false;
 }
 
 /*
  *  fwts_iasl_init()
- *	initialise iasl - cache DSDT and SSDT to file
+ *	initialise iasl - cache DSDT and SSDT to memory files
  */
 int fwts_iasl_init(fwts_framework *fw)
 {
@@ -139,7 +244,7 @@ int fwts_iasl_init(fwts_framework *fw)
 
 	memset(iasl_cached_table_filename, 0, sizeof(iasl_cached_table_filename));
 
-	ret = fwts_iasl_cache_tables_to_file(fw);
+	ret = fwts_iasl_cache_tables(fw);
 	if (ret != FWTS_OK)
 		return ret;
 
@@ -181,9 +286,8 @@ int fwts_iasl_disassemble(fwts_framework *fw,
 	const bool use_externals,
 	fwts_list **iasl_output)
 {
-	char tmpfile[PATH_MAX];
-	int pid = getpid();
-	int ret;
+	char name[64];
+	int ret, fd;
 
 	if (!iasl_init)
 		return FWTS_ERROR;
@@ -192,20 +296,21 @@ int fwts_iasl_disassemble(fwts_framework *fw,
 
 	*iasl_output = NULL;
 
-	snprintf(tmpfile, sizeof(tmpfile),
-		"/tmp/fwts_iasl_disassemble_%d_%s_%d.dsl",
-		pid, info->name, info->index);
+	snprintf(name, sizeof(name), FWTS_IASL_MEM_PATH "disassemble_%s_%d.dsl",
+		info->name, info->index);
+	if ((fd = fwts_iasl_mem_file_new(name, NULL, 0)) < 0)
+		return FWTS_ERROR;
 
-	if ((ret = fwts_iasl_disassemble_to_file(fw, info, use_externals, tmpfile)) != FWTS_OK)
-		return ret;
+	if ((ret = fwts_iasl_disassemble_to_file(fw, info, use_externals, name)) == FWTS_OK)
+		*iasl_output = fwts_iasl_mem_file_read(fd);
+	fwts_iasl_mem_file_free(name, fd);
 
-	*iasl_output = fwts_file_open_and_read(tmpfile);
-	(void)unlink(tmpfile);
+	if (ret != FWTS_OK)
+		return ret;
 
 	return *iasl_output ? FWTS_OK : FWTS_ERROR;
 }
 
-
 /*
  *  fwts_iasl_disassemble_all_to_file()
  * 	Disassemble DSDT and SSDT tables to separate files.
@@ -254,6 +359,40 @@ int fwts_iasl_disassemble_all_to_file(
 	return FWTS_OK;
 }
 
+/*
+ *  fwts_iasl_reassemble_aml()
+ *	disassemble a table to iasl file dsl_name and re-assemble it,
+ *	returning what iasl writes to stdout and stderr
+ */
+static int fwts_iasl_reassemble_aml(fwts_framework *fw,
+	const fwts_acpi_table_info *info,
+	const char *dsl_name,
+	char **stdout_output,
+	char **stderr_output)
+{
+	*stdout_output = NULL;
+	*stderr_output = NULL;
+
+	fwts_acpica_set_fwts_framework(fw);
+
+	if (fwts_iasl_disassemble_aml(
+		iasl_cached_table_filename,
+		iasl_cached_table_name,
+		cached_max, info->index, true, dsl_name) < 0)
+		return FWTS_ERROR;
+
+	/* Now we have a disassembled source in dsl_name, so let's assemble it */
+	if (fwts_iasl_assemble_aml(dsl_name, stdout_output, stderr_output) < 0) {
+		free(*stdout_output);
+		free(*stderr_output);
+		*stdout_output = NULL;
+		*stderr_output = NULL;
+		return FWTS_ERROR;
+	}
+
+	return FWTS_OK;
+}
+
 /*
  *  fwts_iasl_reassemble()
  *	given a ACPI table go and disassemble it
@@ -266,9 +405,9 @@ int fwts_iasl_reassemble(fwts_framework *fw,
 	fwts_list **iasl_stdout,
 	fwts_list **iasl_stderr)
 {
-	char tmpfile[PATH_MAX];
-	char *stdout_output = NULL, *stderr_output = NULL;
-	int pid = getpid();
+	char name[64];
+	char *stdout_output, *stderr_output;
+	int fd, ret;
 
 	if ((!iasl_init) ||
 	    (iasl_disassembly == NULL) ||
@@ -277,38 +416,253 @@ int fwts_iasl_reassemble(fwts_framework *fw,
 	    (info == NULL))
 		return FWTS_ERROR;
 
-	fwts_acpica_set_fwts_framework(fw);
 	*iasl_disassembly = NULL;
-	snprintf(tmpfile, sizeof(tmpfile), "/tmp/fwts_iasl_reassemble_%d.dsl", pid);
+	snprintf(name, sizeof(name), FWTS_IASL_MEM_PATH "reassemble_%d.dsl", info->index);
+	if ((fd = fwts_iasl_mem_file_new(name, NULL, 0)) < 0)
+		return FWTS_ERROR;
 
-	if (fwts_iasl_disassemble_aml(
-		iasl_cached_table_filename,
-		iasl_cached_table_name,
-		cached_max, info->index, true, tmpfile) < 0) {
-		(void)unlink(tmpfile);
+	ret = fwts_iasl_reassemble_aml(fw, info, name, &stdout_output, &stderr_output);
+
+	/* Read in the disassembled text to return later */
+	*iasl_disassembly = fwts_iasl_mem_file_read(fd);
+	fwts_iasl_mem_file_free(name, fd);
+
+	if (ret != FWTS_OK)
+		return FWTS_ERROR;
+
+	*iasl_stdout = fwts_list_from_text(stdout_output);
+	*iasl_stderr = fwts_list_from_text(stderr_output);
+	free(stdout_output);
+	free(stderr_output);
+
+	return FWTS_OK;
+}
+
+/*
+ *  fwts_iasl_jobs()
+ *	number of iasl jobs to run at once, one per online CPU
+ */
+static int fwts_iasl_jobs(void)
+{
+	const long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+	if (cpus < 1)
+		return 1;
+
+	return cpus > FWTS_IASL_JOBS_MAX ? FWTS_IASL_JOBS_MAX : (int)cpus;
+}
+
+/*
+ *  fwts_iasl_job_free()
+ *	free what a job used to get its result
+ */
+static void fwts_iasl_job_free(fwts_iasl_job *job)
+{
+	if (job->fd >= 0)
+		(void)close(job->fd);
+	if (job->dsl_fd >= 0)
+		fwts_iasl_mem_file_free(job->dsl_name, job->dsl_fd);
+	if (job->stdout_fd >= 0)
+		(void)close(job->stdout_fd);
+	if (job->stderr_fd >= 0)
+		(void)close(job->stderr_fd);
+
+	job->fd = -1;
+	job->dsl_fd = -1;
+	job->stdout_fd = -1;
+	job->stderr_fd = -1;
+}
+
+/*
+ *  fwts_iasl_job_start()
+ *	fork a worker to re-assemble a table, the disassembly and
+ *	iasl output are passed back in memory files
+ */
+static int fwts_iasl_job_start(fwts_framework *fw, fwts_iasl_job *job)
+{
+	int fds[2];
+
+	job->pid = -1;
+	job->fd = -1;
+	job->stdout_fd = fwts_iasl_mem_fd();
+	job->stderr_fd = fwts_iasl_mem_fd();
+	snprintf(job->dsl_name, sizeof(job->dsl_name),
+		FWTS_IASL_MEM_PATH "reassemble_%d.dsl", job->info->index);
+	job->dsl_fd = fwts_iasl_mem_file_new(job->dsl_name, NULL, 0);
+
+	if ((job->stdout_fd < 0) || (job->stderr_fd < 0) || (job->dsl_fd < 0) ||
+	    (pipe(fds) < 0)) {
+		fwts_iasl_job_free(job);
 		return FWTS_ERROR;
 	}
 
-	/* Read in the disassembled text to return later */
-	*iasl_disassembly = fwts_file_open_and_read(tmpfile);
+	fflush(stdout);
+	fflush(stderr);
 
-	/* Now we have a disassembled source in tmpfile, so let's assemble it */
-	if (fwts_iasl_assemble_aml(tmpfile, &stdout_output, &stderr_output) < 0) {
-		(void)unlink(tmpfile);
-		free(stdout_output);
+	switch (job->pid = fork()) {
+	case -1:
+		(void)close(fds[0]);
+		(void)close(fds[1]);
+		fwts_iasl_job_free(job);
 		return FWTS_ERROR;
+	case 0: {
+		/* Child, the parent sees fds[1] close when we exit */
+		char *stdout_output, *stderr_output;
+		int ret;
+
+		(void)close(fds[0]);
+		ret = fwts_iasl_reassemble_aml(fw, job->info, job->dsl_name,
+			&stdout_output, &stderr_output);
+		if ((ret == FWTS_OK) && stdout_output)
+			ret = fwts_iasl_write(job->stdout_fd, stdout_output, strlen(stdout_output));
+		if ((ret == FWTS_OK) && stderr_output)
+			ret = fwts_iasl_write(job->stderr_fd, stderr_output, strlen(stderr_output));
+		_exit(ret == FWTS_OK ? EXIT_SUCCESS : EXIT_FAILURE);
+	}
+	default:
+		(void)close(fds[1]);
+		job->fd = fds[0];
+		break;
 	}
 
-	/* Remove these now we don't need them */
-	(void)unlink(tmpfile);
+	return FWTS_OK;
+}
 
-	/* And remove aml file generated from ACPICA compiler */
-	snprintf(tmpfile, sizeof(tmpfile), "/tmp/fwts_iasl_reassemble_%d.aml", pid);
-	(void)unlink(tmpfile);
+/*
+ *  fwts_iasl_job_finish()
+ *	reap a worker that has exited and collect its result
+ */
+static void fwts_iasl_job_finish(fwts_iasl_job *job)
+{
+	int status = 0;
+
+	while (waitpid(job->pid, &status, 0) < 0 && errno == EINTR)
+		;
+
+	job->ret = (WIFEXITED(status) && (WEXITSTATUS(status) == EXIT_SUCCESS)) ?
+		FWTS_OK : FWTS_ERROR;
+	job->iasl_disassembly = fwts_iasl_mem_file_read(job->dsl_fd);
+	if (job->ret == FWTS_OK) {
+		char *text;
+
+		text = fwts_iasl_mem_file_text(job->stdout_fd);
+		job->iasl_stdout = (text && *text) ? fwts_list_from_text(text) : NULL;
+		free(text);
+		text = fwts_iasl_mem_file_text(job->stderr_fd);
+		job->iasl_stderr = (text && *text) ? fwts_list_from_text(text) : NULL;
+		free(text);
+	}
+	fwts_iasl_job_free(job);
+	job->pid = -1;
+	job->done = true;
+}
 
-	*iasl_stdout = fwts_list_from_text(stdout_output);
-	*iasl_stderr = fwts_list_from_text(stderr_output);
-	free(stdout_output);
+/*
+ *  fwts_iasl_job_wait()
+ *	wait for one or more running workers to exit
+ */
+static int fwts_iasl_job_wait(fwts_iasl_job *jobs, const int from, const int to)
+{
+	struct pollfd pollfds[FWTS_IASL_JOBS_MAX];
+	fwts_iasl_job *polled[FWTS_IASL_JOBS_MAX];
+	int i, n = 0, finished = 0;
+
+	for (i = from; (i < to) && (n < FWTS_IASL_JOBS_MAX); i++) {
+		if (jobs[i].pid > 0) {
+			pollfds[n].fd = jobs[i].fd;
+			pollfds[n].events = POLLIN;
+			pollfds[n].revents = 0;
+			polled[n++] = &jobs[i];
+		}
+	}
+	if (n == 0)
+		return 0;
+
+	if (poll(pollfds, n, -1) < 0)
+		return (errno == EINTR) ? 0 : -1;
+
+	for (i = 0; i < n; i++) {
+		if (pollfds[i].revents) {
+			fwts_iasl_job_finish(polled[i]);
+			finished++;
+		}
+	}
+
+	return finished;
+}
+
+/*
+ *  fwts_iasl_reassemble_all()
+ *	disassemble and re-assemble all the tables containing AML,
+ *	running up to one worker per CPU at once. func is called
+ *	with the result for each table in table order.
+ */
+int fwts_iasl_reassemble_all(fwts_framework *fw,
+	fwts_iasl_reassemble_func func,
+	void *data)
+{
+	fwts_iasl_job *jobs;
+	int i, n = 0, started = 0, done = 0, running = 0;
+	const int max_jobs = fwts_iasl_jobs();
+
+	if (!iasl_init || !func)
+		return FWTS_ERROR;
+
+	if ((jobs = calloc(ACPI_MAX_TABLES, sizeof(*jobs))) == NULL)
+		return FWTS_ERROR;
+
+	for (i = 0; i < cached_max; i++) {
+		fwts_acpi_table_info *info;
+
+		if (fwts_acpi_get_table(fw, i, &info) != FWTS_OK)
+			break;
+		if (info && info->has_aml) {
+			jobs[n].info = info;
+			jobs[n].pid = -1;
+			n++;
+		}
+	}
+
+	while (done < n) {
+		/* Keep workers busy, but don't get too far ahead of results */
+		while ((running < max_jobs) && (started < n) &&
+		       (started - done < max_jobs * 2)) {
+			fwts_iasl_job *job = &jobs[started++];
+
+			if (fwts_iasl_job_start(fw, job) == FWTS_OK) {
+				running++;
+			} else {
+				/* Can't fork, so just do it here */
+				job->ret = fwts_iasl_reassemble(fw, job->info,
+					&job->iasl_disassembly,
+					&job->iasl_stdout,
+					&job->iasl_stderr);
+				job->done = true;
+			}
+		}
+
+		/* Hand back results in table order */
+		if (jobs[done].done) {
+			fwts_iasl_job *job = &jobs[done++];
+
+			func(fw, job->info, job->ret, job->iasl_disassembly,
+				job->iasl_stdout, job->iasl_stderr, data);
+			fwts_text_list_free(job->iasl_disassembly);
+			fwts_text_list_free(job->iasl_stdout);
+			fwts_text_list_free(job->iasl_stderr);
+			continue;
+		}
+
+		i = fwts_iasl_job_wait(jobs, done, started);
+		if (i < 0) {
+			/* Can't poll, so wait for the next result */
+			fwts_iasl_job_finish(&jobs[done]);
+			i = 1;
+		}
+		running -= i;
+	}
+
+	free(jobs);
 
 	return FWTS_OK;
 }
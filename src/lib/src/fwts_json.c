@@ -1047,3 +1047,28 @@ json_object *json_object_object_get(json_object *obj, const char *key)
 	return NULL;
 }
 
+
+/*
+ *  fwts_json_escape()
+ *	write str to fp as a quoted JSON string, escaping quotes,
+ *	backslashes and control characters
+ */
+void fwts_json_escape(FILE *fp, const char *str)
+{
+	const unsigned char *ptr;
+
+	fputc('"', fp);
+	for (ptr = (const unsigned char *)str; *ptr; ptr++) {
+		const int esc = (*ptr == '\\') ? '\\' : char_escape(*ptr);
+
+		if (esc) {
+			fputc('\\', fp);
+			fputc(esc, fp);
+		} else if (*ptr < 0x20) {
+			fprintf(fp, "\\u%04x", *ptr);
+		} else {
+			fputc(*ptr, fp);
+		}
+	}
+	fputc('"', fp);
+}
@@ -27,6 +27,9 @@
 #include <sys/stat.h>
 #include <regex.h>
 #include <fcntl.h>
+#include <errno.h>
+#include <unistd.h>
+#include <inttypes.h>
 
 #include "fwts.h"
 
@@ -40,6 +43,11 @@
  */
 #define UNIQUE_KLOG_LABEL		"Klog"
 
+/*
+ *  largest /dev/kmsg record the kernel returns in one read
+ */
+#define FWTS_KLOG_KMSG_RECORD_MAX	(8192)
+
 /*
  *  fwts_klog_free()
  *	free kernel log list
@@ -86,6 +94,196 @@ fwts_list *fwts_klog_read(void)
 	return list;
 }
 
+/*
+ *  fwts_klog_index_read_klogctl()
+ *	read the kernel log into the end of a log index in place
+ */
+static int fwts_klog_index_read_klogctl(fwts_log_index *klog)
+{
+	int len;
+	char *buffer;
+
+	if ((len = klogctl(10, NULL, 0)) < 0)
+		return FWTS_ERROR;
+	if ((buffer = fwts_log_index_reserve(klog, len)) == NULL)
+		return FWTS_ERROR;
+	if ((len = klogctl(3, buffer, len)) <= 0)
+		return FWTS_ERROR;
+
+	return fwts_log_index_split(klog, len);
+}
+
+/*
+ *  fwts_klog_kmsg_unescape()
+ *	undo the \xNN escaping of non-printable characters in
+ *	a /dev/kmsg record message, returns the new length
+ */
+static size_t fwts_klog_kmsg_unescape(char *msg, const size_t len)
+{
+	const char *src = msg;
+	const char *end = msg + len;
+	char *dst = msg;
+
+	while (src < end) {
+		if ((src[0] == '\\') && (end - src >= 4) && (src[1] == 'x') &&
+		    isxdigit((unsigned char)src[2]) && isxdigit((unsigned char)src[3])) {
+			char hex[3] = { src[2], src[3], '\0' };
+
+			*dst++ = (char)strtoul(hex, NULL, 16);
+			src += 4;
+		} else {
+			*dst++ = *src++;
+		}
+	}
+
+	return dst - msg;
+}
+
+/*
+ *  fwts_klog_kmsg_add()
+ *	add a /dev/kmsg record to the log index in the same
+ *	"<prio>[seconds] text" form as klogctl() returns, a
+ *	multi-line message becomes lines with the same prefix
+ */
+static int fwts_klog_kmsg_add(fwts_log_index *klog, char *record, const size_t len)
+{
+	char *msg, *end, *ptr;
+	char prefix[64];
+	unsigned long long prio, seq, usec;
+	int prefix_len;
+	size_t msg_len;
+
+	/* Record is "prio,seq,usec,flags;message\n" + optional dictionary */
+	if ((msg = memchr(record, ';', len)) == NULL)
+		return FWTS_OK;
+	msg++;
+	if (sscanf(record, "%llu,%llu,%llu", &prio, &seq, &usec) != 3)
+		return FWTS_OK;
+
+	/* Already seen, e.g. a re-opened reader */
+	if (seq < klog->kmsg_seq)
+		return FWTS_OK;
+	if (klog->kmsg_seq)
+		klog->kmsg_lost += seq - klog->kmsg_seq;
+	klog->kmsg_seq = seq + 1;
+
+	if ((end = memchr(msg, '\n', len - (msg - record))) == NULL)
+		end = record + len;
+	msg_len = fwts_klog_kmsg_unescape(msg, end - msg);
+	end = msg + msg_len;
+
+	prefix_len = snprintf(prefix, sizeof(prefix), "<%llu>[%5llu.%06llu] ",
+		prio, usec / 1000000, usec % 1000000);
+
+	for (ptr = msg; ptr <= end; ) {
+		char *nl = memchr(ptr, '\n', end - ptr);
+		const size_t line_len = nl ? (size_t)(nl - ptr) : (size_t)(end - ptr);
+		char *line;
+
+		if ((line = fwts_log_index_reserve(klog, prefix_len + line_len)) == NULL)
+			return FWTS_ERROR;
+		memcpy(line, prefix, prefix_len);
+		memcpy(line + prefix_len, ptr, line_len);
+		if (fwts_log_index_split(klog, prefix_len + line_len) != FWTS_OK)
+			return FWTS_ERROR;
+		if (!nl)
+			break;
+		ptr = nl + 1;
+	}
+
+	return FWTS_OK;
+}
+
+/*
+ *  fwts_klog_index_read_kmsg()
+ *	append all /dev/kmsg records not yet read to the log index
+ */
+static int fwts_klog_index_read_kmsg(fwts_log_index *klog)
+{
+	char record[FWTS_KLOG_KMSG_RECORD_MAX];
+
+	for (;;) {
+		const ssize_t len = read(klog->kmsg_fd, record, sizeof(record) - 1);
+
+		if (len < 0) {
+			if (errno == EINTR)
+				continue;
+			/* Records overwritten before we got to them */
+			if (errno == EPIPE)
+				continue;
+			if (errno == EAGAIN)
+				return FWTS_OK;
+			return FWTS_ERROR;
+		}
+		if (len == 0)
+			return FWTS_OK;
+		record[len] = '\0';
+		if (fwts_klog_kmsg_add(klog, record, (size_t)len) != FWTS_OK)
+			return FWTS_ERROR;
+	}
+}
+
+/*
+ *  fwts_klog_index_update()
+ *	append lines added to the kernel log since it was last read.
+ *	With /dev/kmsg only the new records are read, otherwise the
+ *	kernel log is re-read and the lines after the last line we
+ *	already have are appended.
+ */
+int fwts_klog_index_update(fwts_log_index *klog)
+{
+	fwts_log_index *klog_new;
+	const fwts_log_line *line;
+	const char *last;
+
+	if (!klog)
+		return FWTS_ERROR;
+	if (klog->kmsg_fd >= 0)
+		return fwts_klog_index_read_kmsg(klog);
+
+	if ((klog_new = fwts_log_index_new()) == NULL)
+		return FWTS_ERROR;
+	if (fwts_klog_index_read_klogctl(klog_new) != FWTS_OK) {
+		fwts_log_index_free(klog_new);
+		return FWTS_ERROR;
+	}
+
+	line = klog_new->lines;
+	if (klog->len) {
+		last = fwts_log_index_line(klog, &klog->lines[klog->len - 1]);
+		fwts_log_index_foreach(line, klog_new) {
+			if (!strcmp(fwts_log_index_line(klog_new, line), last)) {
+				line++;
+				break;
+			}
+		}
+	}
+	for (; line < klog_new->lines + klog_new->len; line++) {
+		if (fwts_log_index_append(klog, fwts_log_index_line(klog_new, line), line->len) != FWTS_OK) {
+			fwts_log_index_free(klog_new);
+			return FWTS_ERROR;
+		}
+	}
+	fwts_log_index_free(klog_new);
+
+	return FWTS_OK;
+}
+
+/*
+ *  fwts_klog_index_scan()
+ *	scan kernel log index lines from line number from onwards
+ */
+int fwts_klog_index_scan(fwts_framework *fw,
+	fwts_log_index *klog,
+	const size_t from,
+	fwts_klog_scan_func scan_func,
+	fwts_klog_progress_func progress_func,
+	void *private,
+	int *match)
+{
+	return fwts_log_index_scan(fw, klog, from, scan_func, progress_func, private, match, true);
+}
+
 char *fwts_klog_remove_timestamp(char *text)
 {
 	return fwts_log_remove_timestamp(text);
@@ -106,6 +304,10 @@ char *fwts_klog_unique_label(const char *str)
 	return fwts_log_unique_label(str, UNIQUE_KLOG_LABEL);
 }
 
+static const char *fwts_klog_advice =
+	"This is a bug picked up by the kernel, but as yet, the "
+	"firmware test suite has no diagnostic advice for this particular problem.";
+
 void fwts_klog_scan_patterns(fwts_framework *fw,
 	char *line,
 	int  repeated,
@@ -113,11 +315,7 @@ void fwts_klog_scan_patterns(fwts_framework *fw,
 	void *private,
 	int *errors)
 {
-    static char *advice =
-        "This is a bug picked up by the kernel, but as yet, the "
-        "firmware test suite has no diagnostic advice for this particular problem.";
-
-    fwts_log_scan_patterns(fw, line, repeated, prevline, private, errors, "Kernel", advice);
+    fwts_log_scan_patterns(fw, line, repeated, prevline, private, errors, "Kernel", fwts_klog_advice);
 }
 
 /*
@@ -129,6 +327,20 @@ fwts_compare_mode fwts_klog_compare_mode_str_to_val(const char *str)
 	return fwts_log_compare_mode_str_to_val(str);
 }
 
+/*
+ *  fwts_klog_json_data_path()
+ *	path of the klog pattern json data file
+ */
+static void fwts_klog_json_data_path(fwts_framework *fw, char *json_data_path, const size_t len)
+{
+	if (fw->json_data_file) {
+		snprintf(json_data_path, len, "%s/%s", fw->json_data_path,(fw->json_data_file));
+	}
+	else { /* use the hard coded KLOG JSON as default */
+		snprintf(json_data_path, len, "%s/%s", fw->json_data_path, KLOG_DATA_JSON_FILE);
+	}
+}
+
 static int fwts_klog_check(fwts_framework *fw,
 	const char *table,
 	fwts_klog_progress_func progress,
@@ -137,12 +349,7 @@ static int fwts_klog_check(fwts_framework *fw,
 {
 	char json_data_path[PATH_MAX];
 
-	if (fw->json_data_file) {
-		snprintf(json_data_path, sizeof(json_data_path), "%s/%s", fw->json_data_path,(fw->json_data_file));
-	}
-	else { /* use the hard coded KLOG JSON as default */
-		snprintf(json_data_path, sizeof(json_data_path), "%s/%s", fw->json_data_path, KLOG_DATA_JSON_FILE);
-	}
+	fwts_klog_json_data_path(fw, json_data_path, sizeof(json_data_path));
 	return fwts_log_check(fw, table, fwts_klog_scan_patterns, progress, klog, errors, json_data_path, UNIQUE_KLOG_LABEL, true);
 }
 
@@ -160,6 +367,263 @@ int fwts_klog_pm_check(fwts_framework *fw, fwts_klog_progress_func progress,
 		progress, klog, errors);
 }
 
+/*
+ *  fwts_klog_follower_keep_last()
+ *	drop all but the last line of a klogctl() read kernel log,
+ *	the last line is needed to find where the new lines start
+ */
+static int fwts_klog_follower_keep_last(fwts_log_index *klog)
+{
+	char *last;
+	int ret;
+
+	if (klog->len == 0)
+		return FWTS_OK;
+	if ((last = strdup(fwts_log_index_line(klog, &klog->lines[klog->len - 1]))) == NULL)
+		return FWTS_ERROR;
+	fwts_log_index_clear(klog);
+	ret = fwts_log_index_append(klog, last, strlen(last));
+	free(last);
+
+	return ret;
+}
+
+/*
+ *  fwts_klog_follower_new()
+ *	start following the kernel log, lines already in the log
+ *	are skipped. /dev/kmsg is opened once and read from where
+ *	the last read finished, otherwise klogctl() is used.
+ *	Free with fwts_klog_follower_free().
+ */
+fwts_klog_follower *fwts_klog_follower_new(void)
+{
+	fwts_klog_follower *follower;
+	fwts_log_index *klog;
+
+	if ((follower = calloc(1, sizeof(*follower))) == NULL)
+		return NULL;
+	fwts_list_init(&follower->labels);
+	if ((klog = fwts_log_index_new()) == NULL) {
+		free(follower);
+		return NULL;
+	}
+	follower->klog = klog;
+
+	klog->kmsg_fd = open("/dev/kmsg", O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+	if (klog->kmsg_fd >= 0) {
+		/* Skip to the end, just the records added from now on are read */
+		if (lseek(klog->kmsg_fd, 0, SEEK_END) >= 0)
+			return follower;
+		(void)close(klog->kmsg_fd);
+		klog->kmsg_fd = -1;
+	}
+	if ((fwts_klog_index_read_klogctl(klog) != FWTS_OK) ||
+	    (fwts_klog_follower_keep_last(klog) != FWTS_OK)) {
+		fwts_klog_follower_free(follower);
+		return NULL;
+	}
+	follower->from = klog->len;
+
+	return follower;
+}
+
+static void fwts_klog_follower_label_free(void *data)
+{
+	fwts_klog_follower_label *label = (fwts_klog_follower_label *)data;
+
+	free(label->label);
+	free(label);
+}
+
+/*
+ *  fwts_klog_follower_free()
+ *	free a kernel log follower
+ */
+void fwts_klog_follower_free(fwts_klog_follower *follower)
+{
+	if (follower) {
+		fwts_log_index_free(follower->klog);
+		fwts_list_free_items(&follower->labels, fwts_klog_follower_label_free);
+		free(follower);
+	}
+}
+
+/*
+ *  fwts_klog_follower_read()
+ *	start a new cycle and read the lines added to the kernel log
+ *	since the last read, lines from earlier cycles are dropped
+ */
+int fwts_klog_follower_read(fwts_klog_follower *follower)
+{
+	fwts_log_index *klog = follower->klog;
+
+	if (klog->kmsg_fd >= 0)
+		fwts_log_index_clear(klog);
+	else if (fwts_klog_follower_keep_last(klog) != FWTS_OK)
+		return FWTS_ERROR;
+	follower->from = klog->len;
+	follower->cycle++;
+
+	return fwts_klog_index_update(klog);
+}
+
+/*
+ *  fwts_klog_follower_list()
+ *	list the lines read by the last read for use with the fwts_list
+ *	based log helpers, valid until the next read and must be freed
+ *	with fwts_list_free(list, NULL);
+ */
+fwts_list *fwts_klog_follower_list(const fwts_klog_follower *follower)
+{
+	return fwts_log_index_to_list(follower->klog, follower->from);
+}
+
+typedef struct {
+	fwts_klog_follower *follower;
+	fwts_log_matcher *matcher;
+} fwts_klog_follower_scan;
+
+/*
+ *  fwts_klog_follower_label_get()
+ *	find or add the per label error totals for a pattern
+ */
+static fwts_klog_follower_label *fwts_klog_follower_label_get(
+	fwts_klog_follower *follower,
+	const fwts_log_pattern *pattern)
+{
+	fwts_klog_follower_label *label;
+	fwts_list_link *item;
+
+	if (!pattern->label)
+		return NULL;
+
+	fwts_list_foreach(item, &follower->labels) {
+		label = fwts_list_data(fwts_klog_follower_label *, item);
+		if (!strcmp(label->label, pattern->label))
+			return label;
+	}
+
+	if ((label = calloc(1, sizeof(*label))) == NULL)
+		return NULL;
+	if ((label->label = strdup(pattern->label)) == NULL) {
+		free(label);
+		return NULL;
+	}
+	label->level = pattern->level;
+	label->first_cycle = follower->cycle;
+	if (fwts_list_append(&follower->labels, label) == NULL) {
+		fwts_klog_follower_label_free(label);
+		return NULL;
+	}
+
+	return label;
+}
+
+/*
+ *  fwts_klog_follower_scan_patterns()
+ *	count lines matching a pattern by label, matching lines are
+ *	only reported in the cycle a label is first seen, after that
+ *	they are just counted and totalled up by the report
+ */
+static void fwts_klog_follower_scan_patterns(fwts_framework *fw,
+	char *line,
+	int  repeated,
+	char *prevline,
+	void *private,
+	int *errors)
+{
+	fwts_klog_follower_scan *scan = (fwts_klog_follower_scan *)private;
+	fwts_klog_follower *follower = scan->follower;
+	fwts_klog_follower_label *label;
+	fwts_log_pattern *pattern;
+
+	FWTS_UNUSED(prevline);
+
+	if ((pattern = fwts_log_matcher_match(fw, scan->matcher, line)) == NULL)
+		return;
+
+	if ((label = fwts_klog_follower_label_get(follower, pattern)) == NULL) {
+		fwts_log_scan_pattern_report(fw, pattern, line, repeated, errors,
+			"Kernel", fwts_klog_advice);
+		return;
+	}
+	if (label->last_cycle != follower->cycle || label->cycles == 0) {
+		label->cycles++;
+		label->last_cycle = follower->cycle;
+	}
+	label->count += repeated + 1;
+
+	if (label->first_cycle == follower->cycle)
+		fwts_log_scan_pattern_report(fw, pattern, line, repeated, errors,
+			"Kernel", fwts_klog_advice);
+	else if (pattern->level != LOG_LEVEL_INFO)
+		fwts_error_inc(fw, pattern->label, errors);
+}
+
+static int fwts_klog_follower_check(fwts_framework *fw,
+	fwts_klog_follower *follower,
+	const char *table,
+	int *errors)
+{
+	char json_data_path[PATH_MAX];
+	fwts_klog_follower_scan scan;
+
+	*errors = 0;
+
+	fwts_klog_json_data_path(fw, json_data_path, sizeof(json_data_path));
+	if ((scan.matcher = fwts_log_pattern_cache_get(fw, json_data_path, table, UNIQUE_KLOG_LABEL)) == NULL)
+		return FWTS_ERROR;
+	scan.follower = follower;
+
+	return fwts_klog_index_scan(fw, follower->klog, follower->from,
+		fwts_klog_follower_scan_patterns, NULL, &scan, errors);
+}
+
+int fwts_klog_follower_firmware_check(fwts_framework *fw,
+	fwts_klog_follower *follower, int *errors)
+{
+	return fwts_klog_follower_check(fw, follower,
+		"firmware_error_warning_patterns", errors);
+}
+
+int fwts_klog_follower_pm_check(fwts_framework *fw,
+	fwts_klog_follower *follower, int *errors)
+{
+	return fwts_klog_follower_check(fw, follower,
+		"pm_error_warning_patterns", errors);
+}
+
+/*
+ *  fwts_klog_follower_report()
+ *	summarise the kernel log errors found over all the cycles
+ */
+void fwts_klog_follower_report(fwts_framework *fw, const fwts_klog_follower *follower)
+{
+	fwts_list_link *item;
+
+	if (follower->klog->kmsg_lost)
+		fwts_log_info(fw, "%" PRIu64 " kernel log records were overwritten "
+			"before they could be checked.", follower->klog->kmsg_lost);
+
+	if (follower->labels.len == 0)
+		return;
+
+	fwts_log_info(fw, "Kernel log errors over %" PRIu32 " cycle(s):", follower->cycle);
+	fwts_log_info_verbatim(fw, "  %-40s %-8s %7s %7s %7s %7s",
+		"Label", "Level", "Count", "Cycles", "First", "Last");
+	fwts_list_foreach(item, &follower->labels) {
+		const fwts_klog_follower_label *label =
+			fwts_list_data(fwts_klog_follower_label *, item);
+
+		fwts_log_info_verbatim(fw, "  %-40.40s %-8s %7" PRIu32 " %7" PRIu32
+			" %7" PRIu32 " %7" PRIu32,
+			label->label, fwts_log_level_to_str(label->level),
+			label->count, label->cycles,
+			label->first_cycle, label->last_cycle);
+	}
+	fwts_log_nl(fw);
+}
+
 /*
  * fwts_klog_regex_find()
  * 	scan a kernel log list of lines for a given regex pattern
@@ -38,6 +38,38 @@ fwts_log_field fwts_log_filter = ~0;
 
 const char *fwts_log_format = "";
 
+/*
+ *  When capturing, fwts_log_printf() and the log section, owner,
+ *  underline, newline and summary helpers append a record to the
+ *  capture buffer rather than writing to the log files, so that a
+ *  forked worker can pass its log output back to the parent to be
+ *  replayed with fwts_log_capture_replay()
+ */
+typedef enum {
+	LOG_CAPTURE_PRINTF,
+	LOG_CAPTURE_UNDERLINE,
+	LOG_CAPTURE_NEWLINE,
+	LOG_CAPTURE_SET_OWNER,
+	LOG_CAPTURE_SECTION_BEGIN,
+	LOG_CAPTURE_SECTION_END,
+	LOG_CAPTURE_SUMMARY,
+} fwts_log_capture_type;
+
+typedef struct {
+	uint32_t type;		/* fwts_log_capture_type */
+	uint32_t field;		/* log field */
+	uint32_t level;		/* log level */
+	uint32_t status_len;	/* status length, including '\0' */
+	uint32_t label_len;	/* label length, including '\0' */
+	uint32_t prefix_len;	/* prefix length, including '\0' */
+	uint32_t text_len;	/* log text length, including '\0' */
+} fwts_log_capture_record;
+
+static bool log_capture;
+static char *log_capture_buf;
+static size_t log_capture_len;
+static size_t log_capture_size;
+
 /*
  *  fwts_log_set_line_width()
  * 	set width of a log
@@ -392,6 +424,183 @@ static char *fwts_log_filename(const char *filename, const fwts_log_type type)
 	return new_name;
 }
 
+/*
+ *  fwts_log_capture_append()
+ *	append a log record to the capture buffer
+ */
+static void fwts_log_capture_append(
+	const fwts_log_capture_type type,
+	const fwts_log_field field,
+	const fwts_log_level level,
+	const char *status,
+	const char *label,
+	const char *prefix,
+	const char *text)
+{
+	fwts_log_capture_record record;
+	size_t len;
+	char *ptr;
+
+	status = status ? status : "";
+	label = label ? label : "";
+	prefix = prefix ? prefix : "";
+	text = text ? text : "";
+
+	record.type = type;
+	record.field = field;
+	record.level = level;
+	record.status_len = strlen(status) + 1;
+	record.label_len = strlen(label) + 1;
+	record.prefix_len = strlen(prefix) + 1;
+	record.text_len = strlen(text) + 1;
+
+	len = sizeof(record) + record.status_len + record.label_len +
+	      record.prefix_len + record.text_len;
+
+	if (log_capture_len + len > log_capture_size) {
+		size_t size = log_capture_size ? log_capture_size : 4096;
+		char *buf;
+
+		while (size < log_capture_len + len)
+			size <<= 1;
+		if ((buf = realloc(log_capture_buf, size)) == NULL)
+			return;		/* Drop the record */
+		log_capture_buf = buf;
+		log_capture_size = size;
+	}
+
+	ptr = log_capture_buf + log_capture_len;
+	memcpy(ptr, &record, sizeof(record));
+	ptr += sizeof(record);
+	memcpy(ptr, status, record.status_len);
+	ptr += record.status_len;
+	memcpy(ptr, label, record.label_len);
+	ptr += record.label_len;
+	memcpy(ptr, prefix, record.prefix_len);
+	ptr += record.prefix_len;
+	memcpy(ptr, text, record.text_len);
+
+	log_capture_len += len;
+}
+
+/*
+ *  fwts_log_capture_begin()
+ *	start capturing log output
+ */
+void fwts_log_capture_begin(void)
+{
+	free(log_capture_buf);
+	log_capture_buf = NULL;
+	log_capture_len = 0;
+	log_capture_size = 0;
+	log_capture = true;
+}
+
+/*
+ *  fwts_log_capture_end()
+ *	stop capturing log output, return the captured records and
+ *	their size in len, the caller must free the returned buffer
+ */
+void *fwts_log_capture_end(size_t *len)
+{
+	void *buf = log_capture_buf;
+
+	*len = buf ? log_capture_len : 0;
+
+	log_capture_buf = NULL;
+	log_capture_len = 0;
+	log_capture_size = 0;
+	log_capture = false;
+
+	return buf;
+}
+
+/*
+ *  fwts_log_capturing()
+ *	return true if log output is being captured
+ */
+bool fwts_log_capturing(void)
+{
+	return log_capture;
+}
+
+/*
+ *  fwts_log_capture_summary()
+ *	capture a test error summary to be added to the summaries
+ *	when the capture is replayed
+ */
+void fwts_log_capture_summary(
+	const char *test,
+	const fwts_log_level level,
+	const char *text)
+{
+	fwts_log_capture_append(LOG_CAPTURE_SUMMARY, 0, level, NULL, test, NULL, text);
+}
+
+/*
+ *  fwts_log_capture_replay()
+ *	write captured log records out to the log
+ */
+int fwts_log_capture_replay(
+	fwts_framework *fw,
+	const void *buf,
+	const size_t len)
+{
+	const char *ptr = buf;
+	const char *end = ptr + len;
+
+	while (ptr + sizeof(fwts_log_capture_record) <= end) {
+		fwts_log_capture_record record;
+		const char *status, *label, *prefix, *text;
+
+		memcpy(&record, ptr, sizeof(record));
+		ptr += sizeof(record);
+		if ((size_t)(end - ptr) < (size_t)record.status_len + record.label_len +
+		    record.prefix_len + record.text_len)
+			return FWTS_ERROR;
+
+		status = ptr;
+		label = status + record.status_len;
+		prefix = label + record.label_len;
+		text = prefix + record.prefix_len;
+		ptr = text + record.text_len;
+
+		if (!record.status_len || status[record.status_len - 1] ||
+		    !record.label_len || label[record.label_len - 1] ||
+		    !record.prefix_len || prefix[record.prefix_len - 1] ||
+		    !record.text_len || text[record.text_len - 1])
+			return FWTS_ERROR;
+
+		switch (record.type) {
+		case LOG_CAPTURE_PRINTF:
+			fwts_log_printf(fw, record.field, record.level,
+				status, label, prefix, "%s", text);
+			break;
+		case LOG_CAPTURE_UNDERLINE:
+			fwts_log_underline(fw->results, record.level);
+			break;
+		case LOG_CAPTURE_NEWLINE:
+			fwts_log_newline(fw->results);
+			break;
+		case LOG_CAPTURE_SET_OWNER:
+			fwts_log_set_owner(fw->results, text);
+			break;
+		case LOG_CAPTURE_SECTION_BEGIN:
+			fwts_log_section_begin(fw->results, text);
+			break;
+		case LOG_CAPTURE_SECTION_END:
+			fwts_log_section_end(fw->results);
+			break;
+		case LOG_CAPTURE_SUMMARY:
+			fwts_summary_add(fw, label, record.level, text);
+			break;
+		default:
+			return FWTS_ERROR;
+		}
+	}
+	return (ptr == end) ? FWTS_OK : FWTS_ERROR;
+}
+
 /*
  *  fwts_log_printf()
  *	printf to a log
@@ -414,6 +623,19 @@ int fwts_log_printf(
 	if (FWTS_LEVEL_IGNORE(fw, level))
 		return ret;
 
+	if (log_capture) {
+		char buffer[LOG_MAX_BUF_SIZE];
+		va_list	args;
+
+		va_start(args, fmt);
+		ret = vsnprintf(buffer, sizeof(buffer), fmt, args);
+		if (ret >= 0)
+			fwts_log_capture_append(LOG_CAPTURE_PRINTF, field, level,
+				status, label, prefix, buffer);
+		va_end(args);
+		return ret;
+	}
+
 	if (log && log->magic == LOG_MAGIC) {
 		char buffer[LOG_MAX_BUF_SIZE];
 		va_list	args;
@@ -476,6 +698,10 @@ void _fwts_log_info_simp_int(
  */
 void fwts_log_underline(fwts_log *log, const int ch)
 {
+	if (log_capture) {
+		fwts_log_capture_append(LOG_CAPTURE_UNDERLINE, 0, ch, NULL, NULL, NULL, NULL);
+		return;
+	}
 	if (log && log->magic == LOG_MAGIC) {
 		fwts_list_link *item;
 
@@ -494,6 +720,10 @@ void fwts_log_underline(fwts_log *log, const int ch)
  */
 void fwts_log_newline(fwts_log *log)
 {
+	if (log_capture) {
+		fwts_log_capture_append(LOG_CAPTURE_NEWLINE, 0, 0, NULL, NULL, NULL, NULL);
+		return;
+	}
 	if (log && log->magic == LOG_MAGIC) {
 		fwts_list_link *item;
 
@@ -508,6 +738,10 @@ void fwts_log_newline(fwts_log *log)
 
 int fwts_log_set_owner(fwts_log *log, const char *owner)
 {
+	if (log_capture) {
+		fwts_log_capture_append(LOG_CAPTURE_SET_OWNER, 0, 0, NULL, NULL, NULL, owner);
+		return FWTS_OK;
+	}
 	if (log && (log->magic == LOG_MAGIC)) {
 		char *newowner = strdup(owner);
 		if (newowner) {
@@ -527,6 +761,10 @@ int fwts_log_set_owner(fwts_log *log, const char *owner)
  */
 void fwts_log_section_begin(fwts_log *log, const char *name)
 {
+	if (log_capture) {
+		fwts_log_capture_append(LOG_CAPTURE_SECTION_BEGIN, 0, 0, NULL, NULL, NULL, name);
+		return;
+	}
 	if (log && log->magic == LOG_MAGIC) {
 		fwts_list_link *item;
 
@@ -546,6 +784,10 @@ void fwts_log_section_begin(fwts_log *log, const char *name)
  */
 void fwts_log_section_end(fwts_log *log)
 {
+	if (log_capture) {
+		fwts_log_capture_append(LOG_CAPTURE_SECTION_END, 0, 0, NULL, NULL, NULL, NULL);
+		return;
+	}
 	if (log && log->magic == LOG_MAGIC) {
 		fwts_list_link *item;
 
@@ -0,0 +1,186 @@
+/*
+ * Copyright (C) 2026 Canonical
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "fwts.h"
+
+#define FWTS_LOG_DEDUP_MIN_SIZE		(64)
+
+#define FNV1A_64_OFFSET			(0xcbf29ce484222325ULL)
+#define FNV1A_64_PRIME			(0x00000100000001b3ULL)
+
+/*
+ *  fwts_log_dedup_hash()
+ *	64 bit FNV-1a hash of a string, the string length
+ *	is returned in len if len is non-null
+ */
+uint64_t fwts_log_dedup_hash(const char *str, size_t *len)
+{
+	register uint64_t hash = FNV1A_64_OFFSET;
+	const char *ptr;
+
+	for (ptr = str; *ptr; ptr++) {
+		hash ^= (uint8_t)*ptr;
+		hash *= FNV1A_64_PRIME;
+	}
+	if (len)
+		*len = ptr - str;
+
+	return hash;
+}
+
+/*
+ *  fwts_log_dedup_slots_alloc()
+ *	(re)allocate hash slots so that the table is at most
+ *	half full for n items and re-insert existing items
+ */
+static int fwts_log_dedup_slots_alloc(fwts_log_dedup *dedup, const size_t n)
+{
+	size_t size = FWTS_LOG_DEDUP_MIN_SIZE;
+	uint32_t *slots;
+	size_t i;
+
+	while (size < n * 2)
+		size <<= 1;
+
+	if ((slots = calloc(size, sizeof(*slots))) == NULL)
+		return FWTS_ERROR;
+
+	for (i = 0; i < dedup->len; i++) {
+		size_t slot = dedup->items[i].hash & (size - 1);
+
+		while (slots[slot])
+			slot = (slot + 1) & (size - 1);
+		slots[slot] = i + 1;
+	}
+	free(dedup->slots);
+	dedup->slots = slots;
+	dedup->slots_size = size;
+
+	return FWTS_OK;
+}
+
+/*
+ *  fwts_log_dedup_new()
+ *	create a new log line de-duplication table, size_hint
+ *	is the expected number of lines to be added, which avoids
+ *	re-sizing the table when the log size is known up-front
+ */
+fwts_log_dedup *fwts_log_dedup_new(const size_t size_hint, const bool remove_timestamp)
+{
+	fwts_log_dedup *dedup;
+	const size_t n = size_hint ? size_hint : FWTS_LOG_DEDUP_MIN_SIZE;
+
+	if ((dedup = calloc(1, sizeof(*dedup))) == NULL)
+		return NULL;
+
+	if ((dedup->items = calloc(n, sizeof(*dedup->items))) == NULL) {
+		free(dedup);
+		return NULL;
+	}
+	dedup->items_size = n;
+	dedup->remove_timestamp = remove_timestamp;
+
+	if (fwts_log_dedup_slots_alloc(dedup, n) != FWTS_OK) {
+		free(dedup->items);
+		free(dedup);
+		return NULL;
+	}
+
+	return dedup;
+}
+
+/*
+ *  fwts_log_dedup_free()
+ *	free a de-duplication table, the log lines are not free'd
+ *	as they are owned by the caller
+ */
+void fwts_log_dedup_free(fwts_log_dedup *dedup)
+{
+	if (dedup) {
+		free(dedup->slots);
+		free(dedup->items);
+		free(dedup);
+	}
+}
+
+/*
+ *  fwts_log_dedup_add()
+ *	add a line to the de-duplication table. If an identical
+ *	line (ignoring timestamps if required) has been seen before
+ *	its repeat count is bumped, otherwise the line is appended
+ *	as a new unique line. Returns the unique item, or NULL if
+ *	out of memory.
+ */
+fwts_log_dedup_item *fwts_log_dedup_add(fwts_log_dedup *dedup, char *line)
+{
+	fwts_log_dedup_item *item;
+	const char *key;
+	uint64_t hash;
+	size_t slot;
+
+	if (!dedup || !line)
+		return NULL;
+
+	key = dedup->remove_timestamp ? fwts_log_remove_timestamp(line) : line;
+	hash = fwts_log_dedup_hash(key, NULL);
+
+	for (slot = hash & (dedup->slots_size - 1); dedup->slots[slot];
+	     slot = (slot + 1) & (dedup->slots_size - 1)) {
+		item = &dedup->items[dedup->slots[slot] - 1];
+
+		if ((item->hash == hash) && !strcmp(item->key, key)) {
+			item->repeated++;
+			return item;
+		}
+	}
+
+	if (dedup->len == dedup->items_size) {
+		fwts_log_dedup_item *items;
+		const size_t size = dedup->items_size * 2;
+
+		if ((items = realloc(dedup->items, size * sizeof(*items))) == NULL)
+			return NULL;
+		dedup->items = items;
+		dedup->items_size = size;
+	}
+
+	if (dedup->len * 2 >= dedup->slots_size) {
+		if (fwts_log_dedup_slots_alloc(dedup, dedup->len + 1) != FWTS_OK)
+			return NULL;
+		/* Table has been rebuilt, find a free slot again */
+		for (slot = hash & (dedup->slots_size - 1); dedup->slots[slot];
+		     slot = (slot + 1) & (dedup->slots_size - 1))
+			;
+	}
+
+	item = &dedup->items[dedup->len];
+	item->line = line;
+	item->key = key;
+	item->hash = hash;
+	item->repeated = 0;
+	dedup->len++;
+	dedup->slots[slot] = dedup->len;
+
+	return item;
+}
@@ -0,0 +1,205 @@
+/*
+ * Copyright (C) 2026 Canonical
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <unistd.h>
+
+#include "fwts.h"
+
+#define FWTS_LOG_INDEX_BUFFER_MIN	(4096)
+#define FWTS_LOG_INDEX_LINES_MIN	(256)
+
+/*
+ *  fwts_log_index_new()
+ *	create a new empty log index
+ */
+fwts_log_index *fwts_log_index_new(void)
+{
+	fwts_log_index *index;
+
+	if ((index = calloc(1, sizeof(*index))) == NULL)
+		return NULL;
+	index->kmsg_fd = -1;
+
+	return index;
+}
+
+/*
+ *  fwts_log_index_free()
+ *	free a log index and its buffer
+ */
+void fwts_log_index_free(fwts_log_index *index)
+{
+	if (index) {
+		if (index->kmsg_fd >= 0)
+			(void)close(index->kmsg_fd);
+		free(index->buffer);
+		free(index->lines);
+		free(index);
+	}
+}
+
+/*
+ *  fwts_log_index_clear()
+ *	drop all lines from a log index, the buffers and any
+ *	/dev/kmsg read position are kept for reuse
+ */
+void fwts_log_index_clear(fwts_log_index *index)
+{
+	if (index) {
+		index->buffer_len = 0;
+		index->len = 0;
+	}
+}
+
+/*
+ *  fwts_log_index_reserve()
+ *	make room for len bytes of text plus a terminator at the
+ *	end of the buffer, returns where the text should be written
+ *	or NULL if out of memory. The text is indexed with
+ *	fwts_log_index_split().
+ */
+char *fwts_log_index_reserve(fwts_log_index *index, const size_t len)
+{
+	const size_t needed = index->buffer_len + len + 1;
+
+	if (needed > UINT32_MAX)
+		return NULL;
+
+	if (needed > index->buffer_size) {
+		size_t size = index->buffer_size ? index->buffer_size : FWTS_LOG_INDEX_BUFFER_MIN;
+		char *buffer;
+
+		while (size < needed)
+			size <<= 1;
+		if ((buffer = realloc(index->buffer, size)) == NULL)
+			return NULL;
+		index->buffer = buffer;
+		index->buffer_size = size;
+	}
+
+	return index->buffer + index->buffer_len;
+}
+
+/*
+ *  fwts_log_index_add_line()
+ *	add a line starting at offset to the index
+ */
+static int fwts_log_index_add_line(
+	fwts_log_index *index,
+	const size_t offset,
+	const size_t len)
+{
+	fwts_log_line *line;
+	char *text;
+
+	if (index->len == index->lines_size) {
+		const size_t size = index->lines_size ?
+			index->lines_size * 2 : FWTS_LOG_INDEX_LINES_MIN;
+		fwts_log_line *lines;
+
+		if ((lines = realloc(index->lines, size * sizeof(*lines))) == NULL)
+			return FWTS_ERROR;
+		index->lines = lines;
+		index->lines_size = size;
+	}
+
+	text = fwts_log_remove_timestamp(index->buffer + offset);
+	line = &index->lines[index->len++];
+	line->offset = (uint32_t)offset;
+	line->text = (uint32_t)(text - index->buffer);
+	line->len = (uint32_t)len;
+
+	return FWTS_OK;
+}
+
+/*
+ *  fwts_log_index_split()
+ *	index len bytes of text written to the space returned by
+ *	fwts_log_index_reserve(), newlines are replaced in place by
+ *	'\0' terminators, a final line without a newline is kept
+ */
+int fwts_log_index_split(fwts_log_index *index, const size_t len)
+{
+	char *start = index->buffer + index->buffer_len;
+	char *const end = start + len;
+
+	*end = '\0';
+
+	while (start < end) {
+		char *nl = memchr(start, '\n', end - start);
+		const size_t line_len = nl ? (size_t)(nl - start) : (size_t)(end - start);
+
+		if (nl)
+			*nl = '\0';
+		if (fwts_log_index_add_line(index, start - index->buffer, line_len) != FWTS_OK)
+			return FWTS_ERROR;
+		start += line_len + 1;
+	}
+	index->buffer_len += len + 1;
+
+	return FWTS_OK;
+}
+
+/*
+ *  fwts_log_index_append()
+ *	copy text into the log index and index its lines
+ */
+int fwts_log_index_append(fwts_log_index *index, const char *text, const size_t len)
+{
+	char *ptr;
+
+	if ((ptr = fwts_log_index_reserve(index, len)) == NULL)
+		return FWTS_ERROR;
+	memcpy(ptr, text, len);
+
+	return fwts_log_index_split(index, len);
+}
+
+/*
+ *  fwts_log_index_to_list()
+ *	list the lines from line number from onwards for use with
+ *	the fwts_list based log helpers. The lines are not copied, so
+ *	the list is only valid until the index is appended to or free'd
+ *	and must be freed with fwts_list_free(list, NULL);
+ */
+fwts_list *fwts_log_index_to_list(const fwts_log_index *index, const size_t from)
+{
+	fwts_list *list;
+	const fwts_log_line *line;
+
+	if (!index)
+		return NULL;
+	if ((list = fwts_list_new()) == NULL)
+		return NULL;
+	if (from >= index->len)
+		return list;
+
+	fwts_log_index_foreach_from(line, index, from) {
+		if (fwts_list_append(list, fwts_log_index_line(index, line)) == NULL) {
+			fwts_list_free(list, NULL);
+			return NULL;
+		}
+	}
+
+	return list;
+}
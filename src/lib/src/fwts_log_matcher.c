@@ -0,0 +1,528 @@
+/*
+ * Copyright (C) 2026 Canonical
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <ctype.h>
+#include <regex.h>
+
+#include "fwts.h"
+
+/*
+ *  The matcher finds the first pattern (in table order) that matches
+ *  a log line, giving identical results to scanning the pattern table
+ *  in order with strstr() and regexec(), but in a single pass over the
+ *  line:
+ *
+ *  - all string patterns are built into one Aho-Corasick automaton,
+ *    each state records the lowest pattern index that is matched
+ *    on reaching it, so one walk over the line yields the lowest
+ *    matching string pattern.
+ *  - regex patterns have a literal string that any match must contain
+ *    extracted at build time, these are also added to the automaton so
+ *    that regexec() is only run on lines that contain the literal.
+ */
+
+#define FWTS_LOG_MATCHER_LITERAL_MAX	(256)
+
+/*
+ *  trie node used while building the automaton
+ */
+typedef struct {
+	uint32_t first_child;		/* 0 = none */
+	uint32_t next_sibling;		/* 0 = none */
+	uint32_t min_string;		/* lowest string pattern index ending here */
+	uint32_t regex_keys;		/* regexes with literal ending here, index + 1 */
+	uint8_t ch;			/* char transitioning to this node */
+} fwts_log_matcher_node;
+
+typedef struct {
+	fwts_log_matcher_node *nodes;
+	uint32_t n_nodes;
+	uint32_t size;
+} fwts_log_matcher_trie;
+
+/*
+ *  fwts_log_matcher_regex_literal()
+ *	find the longest literal string that must appear in any
+ *	line that matches the POSIX extended regex. This is
+ *	deliberately conservative, if in doubt no literal is
+ *	returned. Returns the length of the literal, 0 if none found.
+ */
+size_t fwts_log_matcher_regex_literal(const char *regex, char *literal, const size_t size)
+{
+	char run[FWTS_LOG_MATCHER_LITERAL_MAX];
+	size_t run_len = 0, best_len = 0;
+	bool last_literal = false;
+	const char *ptr = regex;
+
+	if (!size)
+		return 0;
+	*literal = '\0';
+
+#define END_RUN()						\
+	do {							\
+		if (run_len > best_len && run_len < size) {	\
+			memcpy(literal, run, run_len);		\
+			literal[run_len] = '\0';		\
+			best_len = run_len;			\
+		}						\
+		run_len = 0;					\
+		last_literal = false;				\
+	} while (0)
+
+	while (*ptr) {
+		switch (*ptr) {
+		case '|':
+			/* Alternation at the top level, no single literal is required */
+			*literal = '\0';
+			return 0;
+		case '(': {
+			int depth = 0;
+
+			/* Skip over the entire group */
+			for (; *ptr; ptr++) {
+				if (*ptr == '\\') {
+					if (!*++ptr)
+						break;
+				} else if (*ptr == '[') {
+					ptr++;
+					if (*ptr == '^')
+						ptr++;
+					if (*ptr == ']')
+						ptr++;
+					while (*ptr && *ptr != ']')
+						ptr++;
+					if (!*ptr)
+						break;
+				} else if (*ptr == '(') {
+					depth++;
+				} else if (*ptr == ')') {
+					if (--depth == 0)
+						break;
+				}
+			}
+			if (!*ptr) {
+				*literal = '\0';
+				return 0;
+			}
+			ptr++;
+			END_RUN();
+			break;
+		}
+		case '[':
+			/* Bracket expression, skip it */
+			ptr++;
+			if (*ptr == '^')
+				ptr++;
+			if (*ptr == ']')
+				ptr++;
+			while (*ptr && *ptr != ']') {
+				if (*ptr == '[' && (ptr[1] == ':' || ptr[1] == '.' || ptr[1] == '=')) {
+					const char delim = ptr[1];
+
+					for (ptr += 2; *ptr && !(ptr[0] == delim && ptr[1] == ']'); ptr++)
+						;
+					if (!*ptr)
+						break;
+					ptr++;
+				}
+				ptr++;
+			}
+			if (!*ptr) {
+				*literal = '\0';
+				return 0;
+			}
+			ptr++;
+			END_RUN();
+			break;
+		case '*':
+		case '?':
+		case '{':
+			/* Previous atom may not appear, so drop it from the run */
+			if (last_literal && run_len)
+				run_len--;
+			END_RUN();
+			if (*ptr == '{') {
+				while (*ptr && *ptr != '}')
+					ptr++;
+				if (!*ptr) {
+					*literal = '\0';
+					return 0;
+				}
+			}
+			ptr++;
+			break;
+		case '+':
+			/* Previous atom must appear at least once, but may repeat */
+			END_RUN();
+			ptr++;
+			break;
+		case '.':
+		case '^':
+		case '$':
+			END_RUN();
+			ptr++;
+			break;
+		case '\\':
+			if (!ptr[1]) {
+				*literal = '\0';
+				return 0;
+			}
+			/* \w, \b, \<, back references etc are not literals */
+			if (isalnum((unsigned char)ptr[1]) ||
+			    (ptr[1] == '<') || (ptr[1] == '>') ||
+			    (ptr[1] == '`') || (ptr[1] == '\'')) {
+				END_RUN();
+			} else {
+				if (run_len < sizeof(run) - 1)
+					run[run_len++] = ptr[1];
+				last_literal = true;
+			}
+			ptr += 2;
+			break;
+		default:
+			if (run_len < sizeof(run) - 1)
+				run[run_len++] = *ptr;
+			last_literal = true;
+			ptr++;
+			break;
+		}
+	}
+	END_RUN();
+
+#undef END_RUN
+
+	return best_len;
+}
+
+/*
+ *  fwts_log_matcher_trie_insert()
+ *	insert a key into the trie, returns the node index
+ *	of the end of the key or FWTS_LOG_MATCHER_NONE if out of memory
+ */
+static uint32_t fwts_log_matcher_trie_insert(fwts_log_matcher_trie *trie, const char *key)
+{
+	uint32_t node = 0;
+	const uint8_t *ptr;
+
+	for (ptr = (const uint8_t *)key; *ptr; ptr++) {
+		uint32_t child;
+
+		for (child = trie->nodes[node].first_child; child; child = trie->nodes[child].next_sibling)
+			if (trie->nodes[child].ch == *ptr)
+				break;
+
+		if (!child) {
+			fwts_log_matcher_node *new_node;
+
+			if (trie->n_nodes == trie->size) {
+				fwts_log_matcher_node *nodes;
+				const uint32_t size = trie->size * 2;
+
+				if ((nodes = realloc(trie->nodes, size * sizeof(*nodes))) == NULL)
+					return FWTS_LOG_MATCHER_NONE;
+				trie->nodes = nodes;
+				trie->size = size;
+			}
+			child = trie->n_nodes++;
+			new_node = &trie->nodes[child];
+			new_node->first_child = 0;
+			new_node->min_string = FWTS_LOG_MATCHER_NONE;
+			new_node->regex_keys = 0;
+			new_node->ch = *ptr;
+			new_node->next_sibling = trie->nodes[node].first_child;
+			trie->nodes[node].first_child = child;
+		}
+		node = child;
+	}
+	return node;
+}
+
+static int fwts_log_matcher_edge_cmp(const void *a, const void *b)
+{
+	const fwts_log_matcher_edge *e1 = (const fwts_log_matcher_edge *)a;
+	const fwts_log_matcher_edge *e2 = (const fwts_log_matcher_edge *)b;
+
+	return (int)e1->ch - (int)e2->ch;
+}
+
+/*
+ *  fwts_log_matcher_goto()
+ *	find transition from state on char ch, returns 0 if there is none
+ */
+static inline uint32_t fwts_log_matcher_goto(
+	const fwts_log_matcher *matcher,
+	const uint32_t state,
+	const uint8_t ch)
+{
+	const fwts_log_matcher_state *s = &matcher->states[state];
+	const fwts_log_matcher_edge *edges = matcher->edges + s->edges;
+	uint32_t lo = 0, hi = s->n_edges;
+
+	if (state == 0)
+		return matcher->root_next[ch];
+
+	while (lo < hi) {
+		const uint32_t mid = (lo + hi) >> 1;
+
+		if (edges[mid].ch == ch)
+			return edges[mid].next;
+		if (edges[mid].ch < ch)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return 0;
+}
+
+/*
+ *  fwts_log_matcher_compile()
+ *	turn the trie into the automaton, edges are stored in one
+ *	array sorted by char per state and failure links are computed
+ *	breadth first so that matches from shorter suffixes propagate
+ */
+static int fwts_log_matcher_compile(fwts_log_matcher *matcher, fwts_log_matcher_trie *trie)
+{
+	uint32_t *queue;
+	uint32_t head = 0, tail = 0, i, n_edges = 0;
+
+	matcher->n_states = trie->n_nodes;
+	if ((matcher->states = calloc(trie->n_nodes, sizeof(*matcher->states))) == NULL)
+		return FWTS_ERROR;
+	/* Every node except root has exactly one incoming edge */
+	if ((matcher->edges = calloc(trie->n_nodes, sizeof(*matcher->edges))) == NULL)
+		return FWTS_ERROR;
+	if ((queue = calloc(trie->n_nodes, sizeof(*queue))) == NULL)
+		return FWTS_ERROR;
+
+	for (i = 0; i < trie->n_nodes; i++) {
+		fwts_log_matcher_state *state = &matcher->states[i];
+		uint32_t child;
+
+		state->edges = n_edges;
+		for (child = trie->nodes[i].first_child; child; child = trie->nodes[child].next_sibling) {
+			matcher->edges[n_edges].ch = trie->nodes[child].ch;
+			matcher->edges[n_edges].next = child;
+			n_edges++;
+		}
+		state->n_edges = n_edges - state->edges;
+		qsort(matcher->edges + state->edges, state->n_edges,
+			sizeof(*matcher->edges), fwts_log_matcher_edge_cmp);
+		state->min_string = trie->nodes[i].min_string;
+		state->regex_keys = trie->nodes[i].regex_keys;
+	}
+
+	memset(matcher->root_next, 0, sizeof(matcher->root_next));
+	for (i = 0; i < matcher->states[0].n_edges; i++) {
+		const fwts_log_matcher_edge *edge = &matcher->edges[matcher->states[0].edges + i];
+
+		matcher->root_next[edge->ch] = edge->next;
+		matcher->states[edge->next].fail = 0;
+		queue[tail++] = edge->next;
+	}
+	matcher->states[0].fail = 0;
+	matcher->states[0].regex_out = 0;
+
+	while (head < tail) {
+		const uint32_t s = queue[head++];
+		fwts_log_matcher_state *state = &matcher->states[s];
+		const fwts_log_matcher_state *fail = &matcher->states[state->fail];
+
+		/* State is now complete as its failure state has already been visited */
+		if (fail->min_string < state->min_string)
+			state->min_string = fail->min_string;
+		state->regex_out = state->regex_keys ? s : fail->regex_out;
+
+		for (i = 0; i < state->n_edges; i++) {
+			const fwts_log_matcher_edge *edge = &matcher->edges[state->edges + i];
+			uint32_t f = state->fail, next;
+
+			while ((next = fwts_log_matcher_goto(matcher, f, edge->ch)) == 0 && f)
+				f = matcher->states[f].fail;
+
+			matcher->states[edge->next].fail = next;
+			queue[tail++] = edge->next;
+		}
+	}
+	free(queue);
+
+	return FWTS_OK;
+}
+
+/*
+ *  fwts_log_matcher_free()
+ *	free a matcher, the pattern table is not free'd
+ */
+void fwts_log_matcher_free(fwts_log_matcher *matcher)
+{
+	if (matcher) {
+		free(matcher->states);
+		free(matcher->edges);
+		free(matcher->regexes);
+		free(matcher);
+	}
+}
+
+/*
+ *  fwts_log_matcher_new()
+ *	build a matcher for a NULL pattern terminated pattern table,
+ *	the table must remain valid for the lifetime of the matcher
+ */
+fwts_log_matcher *fwts_log_matcher_new(fwts_log_pattern *patterns)
+{
+	fwts_log_matcher *matcher;
+	fwts_log_matcher_trie trie;
+	fwts_log_pattern *pattern;
+	uint32_t n_regexes = 0;
+
+	if (!patterns)
+		return NULL;
+
+	if ((matcher = calloc(1, sizeof(*matcher))) == NULL)
+		return NULL;
+	matcher->patterns = patterns;
+
+	for (pattern = patterns; pattern->pattern; pattern++) {
+		matcher->n_patterns++;
+		if (pattern->compare_mode == FWTS_COMPARE_REGEX)
+			n_regexes++;
+	}
+	if (n_regexes &&
+	    (matcher->regexes = calloc(n_regexes, sizeof(*matcher->regexes))) == NULL) {
+		free(matcher);
+		return NULL;
+	}
+
+	trie.size = 256;
+	trie.n_nodes = 1;
+	if ((trie.nodes = calloc(trie.size, sizeof(*trie.nodes))) == NULL)
+		goto fail;
+	trie.nodes[0].min_string = FWTS_LOG_MATCHER_NONE;
+
+	for (pattern = patterns; pattern->pattern; pattern++) {
+		const uint32_t index = pattern - patterns;
+		uint32_t node;
+
+		if (pattern->compare_mode == FWTS_COMPARE_REGEX) {
+			char literal[FWTS_LOG_MATCHER_LITERAL_MAX];
+			fwts_log_matcher_regex *regex;
+
+			/* Regex failed to compile so it can never match */
+			if (!pattern->compiled_ok)
+				continue;
+
+			regex = &matcher->regexes[matcher->n_regexes];
+			regex->pattern = index;
+			if (fwts_log_matcher_regex_literal(pattern->pattern, literal, sizeof(literal)) > 0) {
+				if ((node = fwts_log_matcher_trie_insert(&trie, literal)) == FWTS_LOG_MATCHER_NONE)
+					goto fail;
+				regex->has_literal = true;
+				regex->next_key = trie.nodes[node].regex_keys;
+				trie.nodes[node].regex_keys = matcher->n_regexes + 1;
+			}
+			matcher->n_regexes++;
+		} else {
+			/* String and unknown compare modes both use strstr() */
+			if ((node = fwts_log_matcher_trie_insert(&trie, pattern->pattern)) == FWTS_LOG_MATCHER_NONE)
+				goto fail;
+			if (index < trie.nodes[node].min_string)
+				trie.nodes[node].min_string = index;
+		}
+	}
+
+	if (fwts_log_matcher_compile(matcher, &trie) != FWTS_OK)
+		goto fail;
+
+	free(trie.nodes);
+	return matcher;
+
+fail:
+	free(trie.nodes);
+	fwts_log_matcher_free(matcher);
+	return NULL;
+}
+
+/*
+ *  fwts_log_matcher_match()
+ *	return the first pattern in table order that matches
+ *	the line, or NULL if there is no match
+ */
+fwts_log_pattern *fwts_log_matcher_match(
+	fwts_framework *fw,
+	fwts_log_matcher *matcher,
+	const char *line)
+{
+	const uint8_t *ptr;
+	uint32_t state = 0, best, i;
+
+	if (!matcher || !line)
+		return NULL;
+
+	if (++matcher->generation == 0) {
+		/* Generation wrapped, forget all previously seen literals */
+		for (i = 0; i < matcher->n_regexes; i++)
+			matcher->regexes[i].seen = 0;
+		matcher->generation = 1;
+	}
+
+	best = matcher->states[0].min_string;
+	for (ptr = (const uint8_t *)line; *ptr; ptr++) {
+		uint32_t next, r;
+
+		while ((next = fwts_log_matcher_goto(matcher, state, *ptr)) == 0 && state)
+			state = matcher->states[state].fail;
+		state = next;
+
+		if (matcher->states[state].min_string < best)
+			best = matcher->states[state].min_string;
+
+		for (r = matcher->states[state].regex_out; r; r = matcher->states[matcher->states[r].fail].regex_out) {
+			uint32_t key;
+
+			for (key = matcher->states[r].regex_keys; key; key = matcher->regexes[key - 1].next_key)
+				matcher->regexes[key - 1].seen = matcher->generation;
+		}
+	}
+
+	/* Only regexes earlier in the table than the best string match can win */
+	for (i = 0; i < matcher->n_regexes && matcher->regexes[i].pattern < best; i++) {
+		const fwts_log_matcher_regex *regex = &matcher->regexes[i];
+		fwts_log_pattern *pattern = &matcher->patterns[regex->pattern];
+		int ret;
+
+		if (regex->has_literal && regex->seen != matcher->generation)
+			continue;
+
+		ret = regexec(&pattern->compiled, line, 0, NULL, 0);
+		if (!ret) {
+			/* A successful regular expression match! */
+			return pattern;
+		} else if (ret != REG_NOMATCH) {
+			char msg[1024];
+
+			regerror(ret, &pattern->compiled, msg, sizeof(msg));
+			fwts_log_info(fw, "regular expression engine error: %s.", msg);
+		}
+	}
+
+	return (best == FWTS_LOG_MATCHER_NONE) ? NULL : &matcher->patterns[best];
+}
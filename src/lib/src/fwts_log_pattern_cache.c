@@ -0,0 +1,410 @@
+/*
+ * Copyright (C) 2026 Canonical
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <limits.h>
+#include <libgen.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+#include "fwts.h"
+
+/*
+ *  Pattern tables are loaded from json and compiled once per fwts run,
+ *  keyed on json file, table name and label with the json file
+ *  modification time used to detect changes. If --log-pattern-cache
+ *  is specified the parsed tables are also saved in a binary form
+ *  so that subsequent runs can skip parsing the json.
+ */
+typedef struct {
+	char *json_data_path;		/* json file table was loaded from */
+	char *table;			/* table name */
+	char *label;			/* label prefix for auto generated labels */
+	struct timespec mtime;		/* json file modification time */
+	off_t size;			/* json file size */
+	fwts_log_pattern *patterns;	/* loaded table */
+	fwts_log_matcher *matcher;	/* compiled matcher for table */
+} fwts_log_pattern_cache_item;
+
+static fwts_list fwts_log_pattern_cache = FWTS_LIST_INIT;
+static int fwts_log_pattern_cache_dir_state;	/* 0 unchecked, 1 ok, -1 failed */
+
+static void fwts_log_pattern_cache_item_free(void *data)
+{
+	fwts_log_pattern_cache_item *item = (fwts_log_pattern_cache_item *)data;
+
+	fwts_log_matcher_free(item->matcher);
+	fwts_log_patterns_free(item->patterns);
+	free(item->json_data_path);
+	free(item->table);
+	free(item->label);
+	free(item);
+}
+
+/*
+ *  fwts_log_pattern_cache_free()
+ *	free all cached pattern tables
+ */
+void fwts_log_pattern_cache_free(void)
+{
+	fwts_list_free_items(&fwts_log_pattern_cache, fwts_log_pattern_cache_item_free);
+	fwts_list_init(&fwts_log_pattern_cache);
+}
+
+/*
+ *  fwts_log_pattern_cache_filename()
+ *	form the on-disk cache filename for a table
+ */
+static int fwts_log_pattern_cache_filename(
+	fwts_framework *fw,
+	const char *json_data_path,
+	const char *table,
+	const char *label,
+	char *filename,
+	const size_t len)
+{
+	char path[PATH_MAX];
+	int n;
+
+	strncpy(path, json_data_path, sizeof(path) - 1);
+	path[sizeof(path) - 1] = '\0';
+
+	n = snprintf(filename, len, "%s/%s-%s-%s.cache",
+		fw->log_pattern_cache_path, basename(path), table, label);
+
+	return ((n < 0) || ((size_t)n >= len)) ? FWTS_ERROR : FWTS_OK;
+}
+
+/*
+ *  fwts_log_pattern_cache_mkdir()
+ *	create the cache directory and any missing parents, this is
+ *	only attempted once per run and a failure is only logged once
+ */
+static int fwts_log_pattern_cache_mkdir(fwts_framework *fw)
+{
+	char path[PATH_MAX], *ptr;
+
+	if (fwts_log_pattern_cache_dir_state)
+		return fwts_log_pattern_cache_dir_state > 0 ? FWTS_OK : FWTS_ERROR;
+
+	fwts_log_pattern_cache_dir_state = -1;
+	if (!*fw->log_pattern_cache_path ||
+	    (strlen(fw->log_pattern_cache_path) >= sizeof(path)))
+		goto fail;
+	strcpy(path, fw->log_pattern_cache_path);
+
+	for (ptr = path + 1; ; ptr++) {
+		const char ch = *ptr;
+
+		if ((ch != '/') && (ch != '\0'))
+			continue;
+		*ptr = '\0';
+		if ((mkdir(path, 0755) < 0) && (errno != EEXIST))
+			goto fail;
+		if (!ch)
+			break;
+		*ptr = ch;
+	}
+	fwts_log_pattern_cache_dir_state = 1;
+
+	return FWTS_OK;
+fail:
+	fwts_log_info(fw, "Cannot create log pattern cache directory %s, "
+		"the log pattern cache will not be saved.", fw->log_pattern_cache_path);
+	return FWTS_ERROR;
+}
+
+/*
+ *  fwts_log_pattern_cache_save()
+ *	save a pattern table in binary form, the file is written
+ *	to a temporary file and renamed so that concurrent fwts
+ *	runs sharing a cache never see a partially written file
+ */
+int fwts_log_pattern_cache_save(
+	fwts_framework *fw,
+	const char *filename,
+	fwts_log_pattern *patterns,
+	const struct stat *json_stat)
+{
+	fwts_log_pattern_cache_header header;
+	fwts_log_pattern_cache_entry *entries;
+	fwts_log_pattern *pattern;
+	char tmpname[PATH_MAX];
+	char *strings, *ptr;
+	size_t strings_size = 0, entries_size;
+	uint32_t i, n = 0;
+	int fd, ret = FWTS_ERROR;
+
+	if (fwts_log_pattern_cache_mkdir(fw) != FWTS_OK)
+		return FWTS_ERROR;
+
+	for (pattern = patterns; pattern->pattern; pattern++) {
+		strings_size += strlen(pattern->pattern) + 1;
+		strings_size += strlen(pattern->advice) + 1;
+		strings_size += strlen(pattern->label) + 1;
+		n++;
+	}
+	if (strings_size > UINT32_MAX)
+		return FWTS_ERROR;
+
+	entries_size = n * sizeof(*entries);
+	if ((entries = calloc(1, entries_size + strings_size)) == NULL)
+		return FWTS_ERROR;
+	strings = (char *)entries + entries_size;
+
+#define ADD_STRING(field, str)				\
+	do {						\
+		const size_t len = strlen(str) + 1;	\
+							\
+		field = ptr - strings;			\
+		memcpy(ptr, str, len);			\
+		ptr += len;				\
+	} while (0)
+
+	ptr = strings;
+	for (i = 0; i < n; i++) {
+		entries[i].compare_mode = patterns[i].compare_mode;
+		entries[i].level = patterns[i].level;
+		ADD_STRING(entries[i].pattern, patterns[i].pattern);
+		ADD_STRING(entries[i].advice, patterns[i].advice);
+		ADD_STRING(entries[i].label, patterns[i].label);
+	}
+#undef ADD_STRING
+
+	memset(&header, 0, sizeof(header));
+	header.magic = FWTS_LOG_PATTERN_CACHE_MAGIC;
+	header.version = FWTS_LOG_PATTERN_CACHE_VERSION;
+	header.n_patterns = n;
+	header.json_size = json_stat->st_size;
+	header.json_mtime_sec = json_stat->st_mtim.tv_sec;
+	header.json_mtime_nsec = json_stat->st_mtim.tv_nsec;
+	header.strings_size = strings_size;
+
+	snprintf(tmpname, sizeof(tmpname), "%s.XXXXXX", filename);
+	if ((fd = mkstemp(tmpname)) < 0) {
+		fwts_log_info(fw, "Cannot create log pattern cache file %s.", tmpname);
+		free(entries);
+		return FWTS_ERROR;
+	}
+	if ((write(fd, &header, sizeof(header)) == (ssize_t)sizeof(header)) &&
+	    (write(fd, entries, entries_size + strings_size) == (ssize_t)(entries_size + strings_size)) &&
+	    (fchmod(fd, 0644) == 0)) {
+		if (rename(tmpname, filename) == 0)
+			ret = FWTS_OK;
+	}
+	(void)close(fd);
+	if (ret != FWTS_OK) {
+		fwts_log_info(fw, "Cannot write log pattern cache file %s.", filename);
+		(void)unlink(tmpname);
+	}
+	free(entries);
+
+	return ret;
+}
+
+/*
+ *  fwts_log_pattern_cache_string()
+ *	sanity check a string offset, return NULL if it is out of bounds
+ *	or not terminated inside the string area
+ */
+static const char *fwts_log_pattern_cache_string(
+	const char *strings,
+	const uint32_t size,
+	const uint32_t offset)
+{
+	if (offset >= size)
+		return NULL;
+	if (memchr(strings + offset, '\0', size - offset) == NULL)
+		return NULL;
+
+	return strings + offset;
+}
+
+/*
+ *  fwts_log_pattern_cache_load()
+ *	load a binary pattern table, returns NULL if the file does not
+ *	exist, is corrupt or is stale compared to the json file
+ */
+fwts_log_pattern *fwts_log_pattern_cache_load(
+	fwts_framework *fw,
+	const char *filename,
+	const struct stat *json_stat)
+{
+	const fwts_log_pattern_cache_header *header;
+	const fwts_log_pattern_cache_entry *entries;
+	const char *strings;
+	fwts_log_pattern *patterns = NULL;
+	struct stat buf;
+	void *mem;
+	uint32_t i;
+	int fd;
+
+	if ((fd = open(filename, O_RDONLY)) < 0)
+		return NULL;
+	if ((fstat(fd, &buf) < 0) || (buf.st_size < (off_t)sizeof(*header))) {
+		(void)close(fd);
+		return NULL;
+	}
+	mem = mmap(NULL, buf.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	(void)close(fd);
+	if (mem == MAP_FAILED)
+		return NULL;
+
+	header = (const fwts_log_pattern_cache_header *)mem;
+	entries = (const fwts_log_pattern_cache_entry *)(header + 1);
+	strings = (const char *)(entries + header->n_patterns);
+
+	if ((header->magic != FWTS_LOG_PATTERN_CACHE_MAGIC) ||
+	    (header->version != FWTS_LOG_PATTERN_CACHE_VERSION) ||
+	    (header->json_size != (uint64_t)json_stat->st_size) ||
+	    (header->json_mtime_sec != json_stat->st_mtim.tv_sec) ||
+	    (header->json_mtime_nsec != json_stat->st_mtim.tv_nsec) ||
+	    ((uint64_t)buf.st_size != sizeof(*header) +
+		((uint64_t)header->n_patterns * sizeof(*entries)) + header->strings_size))
+		goto out;
+
+	/* Last entry is null to indicate end, so alloc n+1 items */
+	if ((patterns = calloc(header->n_patterns + 1, sizeof(fwts_log_pattern))) == NULL)
+		goto out;
+
+	for (i = 0; i < header->n_patterns; i++) {
+		const char *pattern = fwts_log_pattern_cache_string(strings, header->strings_size, entries[i].pattern);
+		const char *advice = fwts_log_pattern_cache_string(strings, header->strings_size, entries[i].advice);
+		const char *label = fwts_log_pattern_cache_string(strings, header->strings_size, entries[i].label);
+
+		if (!pattern || !advice || !label)
+			goto fail;
+
+		patterns[i].compare_mode = entries[i].compare_mode;
+		patterns[i].level = entries[i].level;
+		patterns[i].advice = strdup(advice);
+		patterns[i].label = strdup(label);
+		/* Set pattern last, it terminates the table */
+		patterns[i].pattern = strdup(pattern);
+		if (!patterns[i].advice || !patterns[i].label || !patterns[i].pattern)
+			goto fail;
+
+		fwts_log_pattern_compile(fw, &patterns[i]);
+	}
+out:
+	(void)munmap(mem, buf.st_size);
+
+	return patterns;
+
+fail:
+	/* Free any partially filled in last entry */
+	if (!patterns[i].pattern) {
+		free(patterns[i].advice);
+		free(patterns[i].label);
+	}
+	fwts_log_patterns_free(patterns);
+	(void)munmap(mem, buf.st_size);
+
+	return NULL;
+}
+
+/*
+ *  fwts_log_pattern_cache_get()
+ *	get the compiled matcher for a pattern table, loading it
+ *	on first use. The matcher is owned by the cache and must
+ *	not be free'd by the caller.
+ */
+fwts_log_matcher *fwts_log_pattern_cache_get(
+	fwts_framework *fw,
+	const char *json_data_path,
+	const char *table,
+	const char *label)
+{
+	fwts_log_pattern_cache_item *item;
+	fwts_list_link *link;
+	struct stat buf;
+	char filename[PATH_MAX];
+	bool use_file = false;
+
+	if (stat(json_data_path, &buf) < 0) {
+		fwts_log_error(fw, "Cannot read file %s, check the path and check that the file exists, you may need to specify -j or -J.", json_data_path);
+		return NULL;
+	}
+
+	fwts_list_foreach(link, &fwts_log_pattern_cache) {
+		item = fwts_list_data(fwts_log_pattern_cache_item *, link);
+
+		if (strcmp(item->json_data_path, json_data_path) ||
+		    strcmp(item->table, table) ||
+		    strcmp(item->label, label))
+			continue;
+
+		if (item->matcher &&
+		    (item->size == buf.st_size) &&
+		    (item->mtime.tv_sec == buf.st_mtim.tv_sec) &&
+		    (item->mtime.tv_nsec == buf.st_mtim.tv_nsec))
+			return item->matcher;
+
+		/* Json file has changed, reload it */
+		fwts_log_matcher_free(item->matcher);
+		fwts_log_patterns_free(item->patterns);
+		item->matcher = NULL;
+		item->patterns = NULL;
+		break;
+	}
+
+	if (!link) {
+		if ((item = calloc(1, sizeof(*item))) == NULL)
+			goto nomem;
+		item->json_data_path = strdup(json_data_path);
+		item->table = strdup(table);
+		item->label = strdup(label);
+		if (!item->json_data_path || !item->table || !item->label ||
+		    (fwts_list_append(&fwts_log_pattern_cache, item) == NULL)) {
+			fwts_log_pattern_cache_item_free(item);
+			goto nomem;
+		}
+	}
+	item->mtime = buf.st_mtim;
+	item->size = buf.st_size;
+
+	if (fw->log_pattern_cache_path &&
+	    (fwts_log_pattern_cache_filename(fw, json_data_path, table, label,
+		filename, sizeof(filename)) == FWTS_OK)) {
+		use_file = true;
+		item->patterns = fwts_log_pattern_cache_load(fw, filename, &buf);
+	}
+
+	if (!item->patterns) {
+		if ((item->patterns = fwts_log_patterns_load(fw, json_data_path, table, label)) == NULL)
+			return NULL;
+		if (use_file)
+			(void)fwts_log_pattern_cache_save(fw, filename, item->patterns, &buf);
+	}
+
+	if ((item->matcher = fwts_log_matcher_new(item->patterns)) == NULL)
+		goto nomem;
+
+	return item->matcher;
+
+nomem:
+	fwts_log_error(fw, "Cannot allocate pattern matcher.");
+	return NULL;
+}
@@ -108,6 +108,44 @@ char *fwts_log_remove_timestamp(char *text)
         return ptr;
 }
 
+/*
+ *  fwts_log_scan_reduced()
+ *      pass each unique line of a reduced log to scan_func
+ */
+static void fwts_log_scan_reduced(fwts_framework *fw,
+        fwts_log_dedup *log_reduced,
+        fwts_log_scan_func scan_func,
+        fwts_log_progress_func progress_func,
+        void *private,
+        int *match)
+{
+        fwts_log_dedup_item *reduced;
+        char *prev = "";
+        int i = 0;
+
+        fwts_log_dedup_foreach(reduced, log_reduced) {
+                char *line = reduced->line;
+
+                if ((line[0] == '<') && (line[2] == '>'))
+                        line += 3;
+
+                scan_func(fw, line, reduced->repeated, prev, private, match);
+                if (progress_func  && ((i % 25) == 0))
+                        progress_func(fw, (50+(50 * i)) / (int)fwts_log_dedup_len(log_reduced));
+                prev = line;
+                i++;
+        }
+        if (progress_func)
+                progress_func(fw, 100);
+}
+
+/*
+ *  fwts_log_scan()
+ *      scan a log, duplicate lines (ignoring the timestamp if
+ *      remove_timestamp is true) are reduced to a single line with
+ *      a repeat count, and each unique line is passed to scan_func
+ *      in the order it first appeared in the log
+ */
 int fwts_log_scan(fwts_framework *fw,
         fwts_list *log,
         fwts_log_scan_func scan_func,
@@ -116,23 +154,17 @@ int fwts_log_scan(fwts_framework *fw,
         int *match,
         bool remove_timestamp)
 {
-        typedef struct {
-                char *line;
-                int repeated;
-        } log_reduced_item;
-
-        char *prev;
         fwts_list_link *item;
-        fwts_list *log_reduced;
+        fwts_log_dedup *log_reduced;
         int i;
-        char *newline = NULL;
+        const int len = fwts_list_len(log);
 
         *match = 0;
 
         if (!log)
                 return FWTS_ERROR;
 
-        if ((log_reduced = fwts_list_new()) == NULL)
+        if ((log_reduced = fwts_log_dedup_new(len, remove_timestamp)) == NULL)
                 return FWTS_ERROR;
 
         /*
@@ -140,68 +172,77 @@ int fwts_log_scan(fwts_framework *fw,
          */
         i = 0;
         fwts_list_foreach(item, log) {
-                if (remove_timestamp) {
-                        newline = fwts_log_remove_timestamp(fwts_list_data(char *, item));
-                } else {
-                        newline = fwts_list_data(char *, item);
-                }
+                char *line = fwts_list_data(char *, item);
+                const char *newline = remove_timestamp ?
+                        fwts_log_remove_timestamp(line) : line;
 
                 if (progress_func  && ((i % 25) == 0))
-                        progress_func(fw, 50 * i / fwts_list_len(log));
+                        progress_func(fw, 50 * i / len);
                 if (*newline) {
-                        bool matched = false;
-                        fwts_list_link *l;
-                        fwts_list_foreach(l, log_reduced) {
-                                char *line;
-                                log_reduced_item *reduced = fwts_list_data(log_reduced_item *, l);
-
-                                if (remove_timestamp)
-                                        line = fwts_log_remove_timestamp(reduced->line);
-                                else
-                                        line = reduced->line;
-
-                                if (strcmp(newline, line) == 0) {
-                                        reduced->repeated++;
-                                        matched = true;
-                                        break;
-                                }
-                        }
-                        if (!matched) {
-                                log_reduced_item *new;
-
-                                if ((new = calloc(1, sizeof(log_reduced_item))) == NULL) {
-                                        fwts_list_free(log_reduced, free);
-                                        return FWTS_ERROR;
-                                }
-                                new->line = fwts_list_data(char *, item);
-                                new->repeated = 0;
-
-                                fwts_list_append(log_reduced, new);
+                        if (fwts_log_dedup_add(log_reduced, line) == NULL) {
+                                fwts_log_dedup_free(log_reduced);
+                                return FWTS_ERROR;
                         }
                 }
                 i++;
         }
 
-        prev = "";
+        fwts_log_scan_reduced(fw, log_reduced, scan_func, progress_func, private, match);
+        fwts_log_dedup_free(log_reduced);
 
-        i = 0;
-        fwts_list_foreach(item, log_reduced) {
-                log_reduced_item *reduced = fwts_list_data(log_reduced_item *, item);
-                char *line = reduced->line;
+        return FWTS_OK;
+}
 
-                if ((line[0] == '<') && (line[2] == '>'))
-                        line += 3;
+/*
+ *  fwts_log_index_scan()
+ *      scan the lines of a log index from line number from onwards,
+ *      in the same way as fwts_log_scan() scans a log list
+ */
+int fwts_log_index_scan(fwts_framework *fw,
+        fwts_log_index *index,
+        const size_t from,
+        fwts_log_scan_func scan_func,
+        fwts_log_progress_func progress_func,
+        void *private,
+        int *match,
+        bool remove_timestamp)
+{
+        fwts_log_line *line;
+        fwts_log_dedup *log_reduced;
+        int i;
+        int len;
 
-                scan_func(fw, line, reduced->repeated, prev, private, match);
-                if (progress_func  && ((i % 25) == 0))
-                        progress_func(fw, (50+(50 * i)) / fwts_list_len(log_reduced));
-                prev = line;
-                i++;
+        *match = 0;
+
+        if (!index)
+                return FWTS_ERROR;
+
+        len = from < index->len ? (int)(index->len - from) : 0;
+        if ((log_reduced = fwts_log_dedup_new(len, remove_timestamp)) == NULL)
+                return FWTS_ERROR;
+
+        i = 0;
+        if (len) {
+                fwts_log_index_foreach_from(line, index, from) {
+                        const char *text = remove_timestamp ?
+                                fwts_log_index_text(index, line) :
+                                fwts_log_index_line(index, line);
+
+                        if (progress_func  && ((i % 25) == 0))
+                                progress_func(fw, 50 * i / len);
+                        if (*text) {
+                                if (fwts_log_dedup_add(log_reduced,
+                                    fwts_log_index_line(index, line)) == NULL) {
+                                        fwts_log_dedup_free(log_reduced);
+                                        return FWTS_ERROR;
+                                }
+                        }
+                        i++;
+                }
         }
-        if (progress_func)
-                progress_func(fw, 100);
 
-        fwts_list_free(log_reduced, free);
+        fwts_log_scan_reduced(fw, log_reduced, scan_func, progress_func, private, match);
+        fwts_log_dedup_free(log_reduced);
 
         return FWTS_OK;
 }
@@ -241,6 +282,39 @@ char *fwts_log_unique_label(const char *str, const char *label)
         return buffer;
 }
 
+/*
+ *  fwts_log_scan_pattern_report()
+ *      report a line that matched a pattern
+ */
+void fwts_log_scan_pattern_report(fwts_framework *fw,
+        const fwts_log_pattern *pattern,
+        const char *line,
+        int  repeated,
+        int *errors,
+        const char *name,
+        const char *advice)
+{
+        if (pattern->level == LOG_LEVEL_INFO)
+                fwts_log_info(fw, "%s message: %s", name, line);
+        else {
+                fwts_failed(fw, pattern->level, pattern->label,
+                        "%s %s message: %s", fwts_log_level_to_str(pattern->level), name, line);
+                fwts_error_inc(fw, pattern->label, errors);
+        }
+        if (repeated)
+                fwts_log_info(fw, "Message repeated %d times.", repeated);
+
+        if ((pattern->advice) != NULL && (*pattern->advice))
+                fwts_advice(fw, "%s", pattern->advice);
+        else
+                fwts_advice(fw, "%s", advice);
+}
+
+/*
+ *  fwts_log_scan_patterns()
+ *      scan a line against a compiled pattern matcher (passed in private),
+ *      the first pattern in the table that matches is reported
+ */
 void fwts_log_scan_patterns(fwts_framework *fw,
         char *line,
         int  repeated,
@@ -250,52 +324,14 @@ void fwts_log_scan_patterns(fwts_framework *fw,
         const char *name,
         const char *advice)
 {
-        fwts_log_pattern *pattern = (fwts_log_pattern *)private;
+        fwts_log_matcher *matcher = (fwts_log_matcher *)private;
+        fwts_log_pattern *pattern;
 
         FWTS_UNUSED(prevline);
 
-        while (pattern->pattern != NULL) {
-                bool matched = false;
-                switch (pattern->compare_mode) {
-                case FWTS_COMPARE_REGEX:
-                        if (pattern->compiled_ok) {
-                                int ret = regexec(&pattern->compiled, line, 0, NULL, 0);
-                                if (!ret) {
-                                        /* A successful regular expression match! */
-                                        matched = true;
-                                } else if (ret != REG_NOMATCH) {
-                                        char msg[1024];
-
-                                        regerror(ret, &pattern->compiled, msg, sizeof(msg));
-                                        fwts_log_info(fw, "regular expression engine error: %s.", msg);
-                                }
-                        }
-                        break;
-                case FWTS_COMPARE_STRING:
-                default:
-                        matched = (strstr(line, pattern->pattern) != NULL) ;
-                        break;
-                }
-
-                if (matched) {
-                        if (pattern->level == LOG_LEVEL_INFO)
-                                fwts_log_info(fw, "%s message: %s", name, line);
-                        else {
-                                fwts_failed(fw, pattern->level, pattern->label,
-                                        "%s %s message: %s", fwts_log_level_to_str(pattern->level), name, line);
-                                fwts_error_inc(fw, pattern->label, errors);
-                        }
-                        if (repeated)
-                                fwts_log_info(fw, "Message repeated %d times.", repeated);
-
-                        if ((pattern->advice) != NULL && (*pattern->advice))
-                                fwts_advice(fw, "%s", pattern->advice);
-                        else
-                                fwts_advice(fw, "%s", advice);
-                        return;
-                }
-                pattern++;
-        }
+        pattern = fwts_log_matcher_match(fw, matcher, line);
+        if (pattern)
+                fwts_log_scan_pattern_report(fw, pattern, line, repeated, errors, name, advice);
 }
 
 /*
@@ -347,25 +383,64 @@ nullobj:
 	return NULL;
 }
 
-int fwts_log_check(fwts_framework *fw,
-        const char *table,
-        fwts_log_scan_func fwts_log_scan_patterns_func,
-        fwts_log_progress_func progress,
-        fwts_list *log,
-        int *errors,
+/*
+ *  fwts_log_pattern_compile()
+ *      compile a regex pattern, compiled_ok is set if
+ *      the pattern is a regex and compiled successfully
+ */
+void fwts_log_pattern_compile(fwts_framework *fw, fwts_log_pattern *pattern)
+{
+        pattern->compiled_ok = false;
+
+        if (pattern->compare_mode == FWTS_COMPARE_REGEX) {
+                int rc;
+
+                rc = regcomp(&pattern->compiled, pattern->pattern, REG_EXTENDED);
+                if (rc)
+                        fwts_log_error(fw, "Regex %s failed to compile: %d.", pattern->pattern, rc);
+                else
+                        pattern->compiled_ok = true;
+        }
+}
+
+/*
+ *  fwts_log_patterns_free()
+ *      free a pattern table loaded by fwts_log_patterns_load()
+ */
+void fwts_log_patterns_free(fwts_log_pattern *patterns)
+{
+        fwts_log_pattern *pattern;
+
+        if (!patterns)
+                return;
+
+        for (pattern = patterns; pattern->pattern; pattern++) {
+                if (pattern->compiled_ok)
+                        regfree(&pattern->compiled);
+                free(pattern->pattern);
+                free(pattern->advice);
+                free(pattern->label);
+        }
+        free(patterns);
+}
+
+/*
+ *  fwts_log_patterns_load()
+ *      load the named pattern table from a json data file and compile
+ *      the regex patterns, returns a NULL pattern terminated table
+ *      that must be freed with fwts_log_patterns_free(), or NULL on error
+ */
+fwts_log_pattern *fwts_log_patterns_load(fwts_framework *fw,
         const char *json_data_path,
-        const char *label,
-        bool remove_timestamp)
+        const char *table,
+        const char *label)
 {
-        int ret = FWTS_ERROR;
         int n;
         int i;
         int fd;
         json_object *log_objs;
         json_object *log_table;
-        fwts_log_pattern *patterns;
-
-	*errors = 0;
+        fwts_log_pattern *patterns = NULL;
 
         /*
          * json_object_from_file() can fail when files aren't readable
@@ -373,14 +448,14 @@ int fwts_log_check(fwts_framework *fw,
          */
         if ((fd = open(json_data_path, O_RDONLY)) < 0) {
                 fwts_log_error(fw, "Cannot read file %s, check the path and check that the file exists, you may need to specify -j or -J.", json_data_path);
-                return FWTS_ERROR;
+                return NULL;
         }
         (void)close(fd);
 
         log_objs = json_object_from_file(json_data_path);
         if (FWTS_JSON_ERROR(log_objs)) {
                 fwts_log_error(fw, "Cannot load log data from %s.", json_data_path);
-                return FWTS_ERROR;
+                return NULL;
         }
 
 #if JSON_HAS_GET_EX
@@ -406,7 +481,7 @@ int fwts_log_check(fwts_framework *fw,
 
         /* Now fetch json objects and compile regex */
         for (i = 0; i < n; i++) {
-                const char *str;
+                const char *str, *pattern, *advice;
                 json_object *obj;
 
                 obj = json_object_array_get_idx(log_table, i);
@@ -422,10 +497,10 @@ int fwts_log_check(fwts_framework *fw,
                         goto fail;
                 patterns[i].level   = fwts_log_str_to_level(str);
 
-                if ((patterns[i].pattern = fwts_json_str(fw, table, i, obj, "pattern", true)) == NULL)
+                if ((pattern = fwts_json_str(fw, table, i, obj, "pattern", true)) == NULL)
                         goto fail;
 
-                if ((patterns[i].advice = fwts_json_str(fw, table, i, obj, "advice", true)) == NULL)
+                if ((advice = fwts_json_str(fw, table, i, obj, "advice", true)) == NULL)
                         goto fail;
 
                 /* Labels appear in fwts 0.26.0, so are optional with older versions */
@@ -434,38 +509,57 @@ int fwts_log_check(fwts_framework *fw,
                         patterns[i].label = strdup(str);
                 } else {
                         /* if not specified, auto-magically generate */
-                        patterns[i].label = strdup(fwts_log_unique_label(patterns[i].pattern, label));
+                        patterns[i].label = strdup(fwts_log_unique_label(pattern, label));
                 }
-                if (patterns[i].label == NULL)
+                patterns[i].advice = strdup(advice);
+                /* Set pattern last, it terminates the table */
+                patterns[i].pattern = strdup(pattern);
+                if (!patterns[i].label || !patterns[i].advice || !patterns[i].pattern) {
+                        fwts_log_error(fw, "Cannot allocate pattern table.");
                         goto fail;
-
-                if (patterns[i].compare_mode == FWTS_COMPARE_REGEX) {
-                        int rc;
-
-                        rc = regcomp(&patterns[i].compiled, patterns[i].pattern, REG_EXTENDED);
-                        if (rc) {
-                                fwts_log_error(fw, "Regex %s failed to compile: %d.", patterns[i].pattern, rc);
-                                patterns[i].compiled_ok = false;
-                        } else {
-                                patterns[i].compiled_ok = true;
-                        }
                 }
+
+                fwts_log_pattern_compile(fw, &patterns[i]);
         }
-        /* We've now collected up the scan patterns, lets scan the log for errors */
-        ret = fwts_log_scan(fw, log, fwts_log_scan_patterns_func, progress, patterns, errors, remove_timestamp);
+        json_object_put(log_objs);
+
+        return patterns;
 
 fail:
         for (i = 0; i < n; i++) {
                 if (patterns[i].compiled_ok)
                         regfree(&patterns[i].compiled);
-                if (patterns[i].label)
-                        free(patterns[i].label);
+                free(patterns[i].pattern);
+                free(patterns[i].advice);
+                free(patterns[i].label);
         }
         free(patterns);
 fail_put:
         json_object_put(log_objs);
 
-        return ret;
+        return NULL;
+}
+
+int fwts_log_check(fwts_framework *fw,
+        const char *table,
+        fwts_log_scan_func fwts_log_scan_patterns_func,
+        fwts_log_progress_func progress,
+        fwts_list *log,
+        int *errors,
+        const char *json_data_path,
+        const char *label,
+        bool remove_timestamp)
+{
+        fwts_log_matcher *matcher;
+
+	*errors = 0;
+
+        /* Pattern tables are loaded and compiled once and then cached */
+        if ((matcher = fwts_log_pattern_cache_get(fw, json_data_path, table, label)) == NULL)
+                return FWTS_ERROR;
+
+        /* We've now collected up the scan patterns, lets scan the log for errors */
+        return fwts_log_scan(fw, log, fwts_log_scan_patterns_func, progress, matcher, errors, remove_timestamp);
 }
 
 static void fwts_log_regex_find_callback(fwts_framework *fw, char *line, int repeated,
@@ -0,0 +1,491 @@
+/*
+ * Copyright (C) 2026 Canonical
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <limits.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <bsd/string.h>
+
+#include "fwts.h"
+
+#define FWTS_PCI_TOPOLOGY_DEVICES_MIN	(64)
+#define FWTS_PCI_CONFIG_BUFFER_MIN	(64 * 1024)
+#define FWTS_PCI_CAP_LIST		(0x10)	/* status register, has capability list */
+#define FWTS_PCI_CAP_MAX		(48)	/* max capabilities in 256 byte config */
+#define FWTS_PCI_EXT_CAP_MAX		(960)	/* max capabilities in 4K config */
+
+/* Snapshot shared by all tests in a run */
+static fwts_pci_topology *pci_topology;
+
+/*
+ *  fwts_pci_topology_key()
+ *	segment, bus and devfn packed into a sortable key
+ */
+static inline uint32_t fwts_pci_topology_key(
+	const uint16_t segment,
+	const uint8_t bus,
+	const uint8_t dev,
+	const uint8_t func)
+{
+	return ((uint32_t)segment << 16) | ((uint32_t)bus << 8) |
+		((uint32_t)(dev & 0x1f) << 3) | (func & 0x07);
+}
+
+static inline uint32_t fwts_pci_topology_device_key(const fwts_pci_device *device)
+{
+	return fwts_pci_topology_key(device->segment, device->bus, device->dev, device->func);
+}
+
+static inline uint32_t fwts_pci_topology_hash(const uint32_t key, const uint32_t size)
+{
+	return (key * 2654435761U) & (size - 1);
+}
+
+/*
+ *  fwts_pci_topology_cmp()
+ *	sort devices by segment, bus and devfn
+ */
+static int fwts_pci_topology_cmp(const void *data1, const void *data2)
+{
+	const uint32_t key1 = fwts_pci_topology_device_key((const fwts_pci_device *)data1);
+	const uint32_t key2 = fwts_pci_topology_device_key((const fwts_pci_device *)data2);
+
+	return (key1 > key2) - (key1 < key2);
+}
+
+/*
+ *  fwts_pci_topology_scan()
+ *	find all the PCI devices in sysfs
+ */
+static int fwts_pci_topology_scan(fwts_framework *fw, fwts_pci_topology *topology)
+{
+	DIR *dirp;
+	struct dirent *entry;
+	uint32_t size = 0;
+
+	if ((dirp = opendir(FWTS_PCI_DEV_PATH)) == NULL) {
+		fwts_log_warning(fw, "Could not open %s.", FWTS_PCI_DEV_PATH);
+		return FWTS_ERROR;
+	}
+
+	while ((entry = readdir(dirp)) != NULL) {
+		fwts_pci_device *device;
+		uint16_t segment;
+		uint8_t bus, dev, func;
+
+		if (entry->d_name[0] == '.')
+			continue;
+		if (sscanf(entry->d_name, "%" SCNx16 ":%" SCNx8 ":%" SCNx8 ".%" SCNx8,
+		    &segment, &bus, &dev, &func) != 4)
+			continue;
+
+		if (topology->len == size) {
+			fwts_pci_device *devices;
+
+			size = size ? size * 2 : FWTS_PCI_TOPOLOGY_DEVICES_MIN;
+			if ((devices = realloc(topology->devices, size * sizeof(*devices))) == NULL) {
+				fwts_log_error(fw, "Cannot allocate PCI device list.");
+				(void)closedir(dirp);
+				return FWTS_ERROR;
+			}
+			topology->devices = devices;
+		}
+		device = &topology->devices[topology->len++];
+		memset(device, 0, sizeof(*device));
+		device->segment = segment;
+		device->bus = bus;
+		device->dev = dev;
+		device->func = func;
+		strlcpy(device->name, entry->d_name, sizeof(device->name));
+	}
+	(void)closedir(dirp);
+
+	qsort(topology->devices, topology->len, sizeof(*topology->devices), fwts_pci_topology_cmp);
+
+	return FWTS_OK;
+}
+
+/*
+ *  fwts_pci_topology_read_config()
+ *	read up to max_len bytes of the config space of a device onto
+ *	the end of the config buffer
+ */
+static int fwts_pci_topology_read_config(
+	fwts_framework *fw,
+	fwts_pci_topology *topology,
+	fwts_pci_device *device,
+	const size_t max_len,
+	size_t *config_size)
+{
+	char path[PATH_MAX];
+	size_t len = 0;
+	int fd;
+
+	if (topology->config_len + max_len > *config_size) {
+		size_t size = *config_size ? *config_size * 2 : FWTS_PCI_CONFIG_BUFFER_MIN;
+		uint8_t *config;
+
+		if ((config = realloc(topology->config, size)) == NULL) {
+			fwts_log_error(fw, "Cannot allocate PCI config space buffer.");
+			return FWTS_ERROR;
+		}
+		topology->config = config;
+		*config_size = size;
+	}
+
+	snprintf(path, sizeof(path), FWTS_PCI_DEV_PATH "/%s/config", device->name);
+	if ((fd = open(path, O_RDONLY)) < 0) {
+		fwts_log_warning(fw, "Could not open config from PCI device %s.", device->name);
+		return FWTS_ERROR;
+	}
+
+	while (len < max_len) {
+		const ssize_t n = read(fd, topology->config + topology->config_len + len,
+			max_len - len);
+
+		if (n < 0) {
+			fwts_log_warning(fw, "Could not read config from PCI device %s.", device->name);
+			(void)close(fd);
+			return FWTS_ERROR;
+		}
+		if (n == 0)
+			break;
+		len += (size_t)n;
+	}
+	(void)close(fd);
+
+	/* Offset for now, turned into a pointer once the buffer is complete */
+	device->config = (uint8_t *)(uintptr_t)topology->config_len;
+	device->config_len = (uint16_t)len;
+	topology->config_len += len;
+
+	return FWTS_OK;
+}
+
+/*
+ *  fwts_pci_topology_caps()
+ *	find the capability offsets of a device
+ */
+static void fwts_pci_topology_caps(fwts_pci_device *device)
+{
+	const uint8_t *config = device->config;
+	uint16_t status;
+	uint32_t offset;
+	int i;
+
+	if (device->config_len < 64)
+		return;
+
+	device->header_type = config[FWTS_PCI_CONFIG_HEADER_TYPE] & 0x7f;
+	if ((device->header_type == FWTS_PCI_CONFIG_HEADER_TYPE_PCI_BRIDGE) ||
+	    (device->header_type == FWTS_PCI_CONFIG_HEADER_TYPE_CARDBUS_BRIDGE)) {
+		device->secondary_bus = config[FWTS_PCI_CONFIG_TYPE1_SECONDARY_BUS_NUMBER];
+		device->subordinate_bus = config[FWTS_PCI_CONFIG_TYPE1_SUBORDINATE_BUS_NUMBER];
+	}
+
+	memcpy(&status, config + FWTS_PCI_CONFIG_STATUS, sizeof(status));
+	if (!(status & FWTS_PCI_CAP_LIST))
+		return;
+
+	offset = (device->header_type == FWTS_PCI_CONFIG_HEADER_TYPE_CARDBUS_BRIDGE) ?
+		config[FWTS_PCI_CONFIG_TYPE2_CAPABILITY_POINTER] :
+		config[FWTS_PCI_CONFIG_TYPE0_CAPABILITIES_POINTER];
+
+	for (i = 0; i < FWTS_PCI_CAP_MAX; i++) {
+		uint8_t id;
+
+		offset &= ~3U;
+		if ((offset < 0x40) || (offset + 2 > device->config_len))
+			break;
+		id = config[offset];
+		if ((id < FWTS_PCI_CAP_ID_MAX) && !device->cap[id])
+			device->cap[id] = (uint8_t)offset;
+		offset = config[offset + FWTS_PCI_CAPABILITIES_NEXT_POINTER];
+	}
+
+	/* Extended capabilities always start at 0x100 */
+	for (offset = FWTS_PCI_CONFIG_SIZE, i = 0; i < FWTS_PCI_EXT_CAP_MAX; i++) {
+		uint32_t header;
+		uint16_t id;
+
+		if ((offset < FWTS_PCI_CONFIG_SIZE) || (offset + 4 > device->config_len))
+			break;
+		memcpy(&header, config + offset, sizeof(header));
+		if ((header == 0) || (header == 0xffffffff))
+			break;
+		id = header & 0xffff;
+		if ((id < FWTS_PCI_EXT_CAP_ID_MAX) && !device->ext_cap[id])
+			device->ext_cap[id] = (uint16_t)offset;
+		offset = (header >> 20) & 0xffc;
+	}
+}
+
+/*
+ *  fwts_pci_topology_index()
+ *	build the segment/bus/devfn lookup table and link each
+ *	device to its upstream bridge and its bus siblings
+ */
+static int fwts_pci_topology_index(fwts_framework *fw, fwts_pci_topology *topology)
+{
+	uint32_t i, nsegments = 0, *bus_first;
+	uint16_t *segments;
+
+	topology->hash_size = 16;
+	while (topology->hash_size < topology->len * 2)
+		topology->hash_size <<= 1;
+	if ((topology->hash = malloc(topology->hash_size * sizeof(*topology->hash))) == NULL) {
+		fwts_log_error(fw, "Cannot allocate PCI device lookup table.");
+		return FWTS_ERROR;
+	}
+	memset(topology->hash, 0xff, topology->hash_size * sizeof(*topology->hash));
+	if (!topology->len)
+		return FWTS_OK;
+
+	/* Devices are sorted, so each segment and bus is a contiguous run */
+	if ((segments = calloc(topology->len + 1, sizeof(*segments))) == NULL) {
+		fwts_log_error(fw, "Cannot allocate PCI segment list.");
+		return FWTS_ERROR;
+	}
+	for (i = 0; i < topology->len; i++) {
+		fwts_pci_device *device = &topology->devices[i];
+		uint32_t h = fwts_pci_topology_hash(fwts_pci_topology_device_key(device), topology->hash_size);
+
+		while (topology->hash[h] != FWTS_PCI_DEVICE_NONE)
+			h = (h + 1) & (topology->hash_size - 1);
+		topology->hash[h] = i;
+
+		device->parent = FWTS_PCI_DEVICE_NONE;
+		device->child = FWTS_PCI_DEVICE_NONE;
+		device->sibling = FWTS_PCI_DEVICE_NONE;
+		if ((i + 1 < topology->len) &&
+		    (device[1].segment == device->segment) &&
+		    (device[1].bus == device->bus))
+			device->sibling = i + 1;
+
+		if (!nsegments || segments[nsegments - 1] != device->segment)
+			segments[nsegments++] = device->segment;
+	}
+
+	if ((bus_first = malloc(nsegments * 256 * sizeof(*bus_first))) == NULL) {
+		fwts_log_error(fw, "Cannot allocate PCI bus list.");
+		free(segments);
+		return FWTS_ERROR;
+	}
+	memset(bus_first, 0xff, nsegments * 256 * sizeof(*bus_first));
+
+	for (nsegments = 0, i = 0; i < topology->len; i++) {
+		const fwts_pci_device *device = &topology->devices[i];
+
+		if (segments[nsegments] != device->segment)
+			nsegments++;
+		if (bus_first[nsegments * 256 + device->bus] == FWTS_PCI_DEVICE_NONE)
+			bus_first[nsegments * 256 + device->bus] = i;
+	}
+
+	/* Connect bridges to the devices on their secondary bus */
+	for (nsegments = 0, i = 0; i < topology->len; i++) {
+		fwts_pci_device *bridge = &topology->devices[i];
+		uint32_t child;
+
+		if (segments[nsegments] != bridge->segment)
+			nsegments++;
+		if (bridge->secondary_bus <= bridge->bus)
+			continue;
+
+		child = bus_first[nsegments * 256 + bridge->secondary_bus];
+		if ((child == FWTS_PCI_DEVICE_NONE) ||
+		    (topology->devices[child].parent != FWTS_PCI_DEVICE_NONE))
+			continue;
+
+		bridge->child = child;
+		for (; child != FWTS_PCI_DEVICE_NONE; child = topology->devices[child].sibling)
+			topology->devices[child].parent = i;
+	}
+
+	free(bus_first);
+	free(segments);
+
+	return FWTS_OK;
+}
+
+/*
+ *  fwts_pci_topology_read()
+ *	enumerate all PCI devices and read up to max_len bytes
+ *	of their config space
+ */
+static fwts_pci_topology *fwts_pci_topology_read(fwts_framework *fw, const size_t max_len)
+{
+	fwts_pci_topology *topology;
+	size_t config_size = 0;
+	uint32_t i, n;
+
+	if ((topology = calloc(1, sizeof(*topology))) == NULL) {
+		fwts_log_error(fw, "Cannot allocate PCI topology.");
+		return NULL;
+	}
+
+	if (fwts_pci_topology_scan(fw, topology) != FWTS_OK) {
+		fwts_pci_topology_free(topology);
+		return NULL;
+	}
+
+	/* Drop devices where the config can't be read */
+	for (n = 0, i = 0; i < topology->len; i++) {
+		if (fwts_pci_topology_read_config(fw, topology,
+		    &topology->devices[i], max_len, &config_size) != FWTS_OK)
+			continue;
+		if (n != i)
+			topology->devices[n] = topology->devices[i];
+		n++;
+	}
+	topology->len = n;
+
+	for (i = 0; i < topology->len; i++) {
+		fwts_pci_device *device = &topology->devices[i];
+
+		device->config = topology->config + (uintptr_t)device->config;
+	}
+
+	return topology;
+}
+
+/*
+ *  fwts_pci_topology_new()
+ *	enumerate all PCI devices and read their config space, this
+ *	takes a fresh snapshot, fwts_pci_topology_get() should be used
+ *	unless config space is expected to have changed
+ */
+fwts_pci_topology *fwts_pci_topology_new(fwts_framework *fw)
+{
+	fwts_pci_topology *topology;
+	uint32_t i;
+
+	/* Extended config space is read where the kernel provides it */
+	if ((topology = fwts_pci_topology_read(fw, FWTS_PCI_CONFIG_EXT_SIZE)) == NULL)
+		return NULL;
+
+	for (i = 0; i < topology->len; i++)
+		fwts_pci_topology_caps(&topology->devices[i]);
+
+	if (fwts_pci_topology_index(fw, topology) != FWTS_OK) {
+		fwts_pci_topology_free(topology);
+		return NULL;
+	}
+
+	return topology;
+}
+
+/*
+ *  fwts_pci_topology_new_headers()
+ *	enumerate all PCI devices and read just the 64 byte config
+ *	header of each, for callers that only walk the devices. The
+ *	capabilities, bridge links and lookup table are not filled in
+ */
+fwts_pci_topology *fwts_pci_topology_new_headers(fwts_framework *fw)
+{
+	return fwts_pci_topology_read(fw, FWTS_PCI_CONFIG_HEADER_SIZE);
+}
+
+/*
+ *  fwts_pci_topology_free()
+ *	free a PCI topology
+ */
+void fwts_pci_topology_free(fwts_pci_topology *topology)
+{
+	if (topology) {
+		free(topology->devices);
+		free(topology->config);
+		free(topology->hash);
+		free(topology);
+	}
+}
+
+/*
+ *  fwts_pci_topology_get()
+ *	get the PCI topology snapshot shared by all tests, it is
+ *	taken on first use and kept until fwts_pci_topology_put()
+ */
+fwts_pci_topology *fwts_pci_topology_get(fwts_framework *fw)
+{
+	if (!pci_topology)
+		pci_topology = fwts_pci_topology_new(fw);
+
+	return pci_topology;
+}
+
+/*
+ *  fwts_pci_topology_put()
+ *	drop the shared PCI topology snapshot
+ */
+void fwts_pci_topology_put(void)
+{
+	fwts_pci_topology_free(pci_topology);
+	pci_topology = NULL;
+}
+
+/*
+ *  fwts_pci_topology_find()
+ *	find a device by segment, bus, device and function
+ */
+fwts_pci_device *fwts_pci_topology_find(
+	const fwts_pci_topology *topology,
+	const uint16_t segment,
+	const uint8_t bus,
+	const uint8_t dev,
+	const uint8_t func)
+{
+	const uint32_t key = fwts_pci_topology_key(segment, bus, dev, func);
+	uint32_t h;
+
+	if (!topology || !topology->hash)
+		return NULL;
+
+	for (h = fwts_pci_topology_hash(key, topology->hash_size);
+	     topology->hash[h] != FWTS_PCI_DEVICE_NONE;
+	     h = (h + 1) & (topology->hash_size - 1)) {
+		fwts_pci_device *device = &topology->devices[topology->hash[h]];
+
+		if (fwts_pci_topology_device_key(device) == key)
+			return device;
+	}
+
+	return NULL;
+}
+
+/*
+ *  fwts_pci_topology_find_name()
+ *	find a device by sysfs name, e.g. 0000:00:1c.0
+ */
+fwts_pci_device *fwts_pci_topology_find_name(const fwts_pci_topology *topology, const char *name)
+{
+	uint16_t segment;
+	uint8_t bus, dev, func;
+
+	if (sscanf(name, "%" SCNx16 ":%" SCNx8 ":%" SCNx8 ".%" SCNx8,
+	    &segment, &bus, &dev, &func) != 4)
+		return NULL;
+
+	return fwts_pci_topology_find(topology, segment, bus, dev, func);
+}
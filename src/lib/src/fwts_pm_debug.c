@@ -20,6 +20,7 @@
 #include "fwts.h"
 
 static const char pm_debug[] = "/sys/power/pm_debug_messages";
+static const char pm_print_times[] = "/sys/power/pm_print_times";
 
 /*
  *  fwts_pm_debug_get
@@ -45,3 +46,29 @@ int fwts_pm_debug_set(const int value)
 {
 	return fwts_set_int(pm_debug, value);
 }
+
+/*
+ *  fwts_pm_print_times_get
+ *	get the current pm_print_times setting, value
+ *	is also set to -1 if there is an error
+ */
+int fwts_pm_print_times_get(int *value)
+{
+	int ret;
+
+	ret = fwts_get_int(pm_print_times, value);
+	if (ret != FWTS_OK)
+		*value = -1;
+
+	return ret;
+}
+
+/*
+ *  fwts_pm_print_times_set
+ *	set the pm_print_times setting, when set the kernel logs
+ *	how long each device suspend and resume callback takes
+ */
+int fwts_pm_print_times_set(const int value)
+{
+	return fwts_set_int(pm_print_times, value);
+}
@@ -0,0 +1,602 @@
+/*
+ * Copyright (C) 2026 Canonical
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <inttypes.h>
+#include <limits.h>
+
+#include "fwts.h"
+
+#define FPDT_RESUME_COUNT	"/sys/firmware/acpi/fpdt/resume/resume_count"
+#define FPDT_RESUME_PREV_NS	"/sys/firmware/acpi/fpdt/resume/resume_prev_ns"
+
+#define PM_TIMING_CYCLES_MIN	(64)
+#define PM_TIMING_DEVICES_MIN	(64)
+#define PM_TIMING_DEVICES_TOP	(10)
+
+/* Fewest cycles to look for drift, and fewest per window */
+#define PM_TIMING_DRIFT_CYCLES	(10)
+#define PM_TIMING_DRIFT_WINDOW	(5)
+/* Drift smaller than this is ignored however large in percent, us */
+#define PM_TIMING_DRIFT_MIN	(10000)
+
+static const struct {
+	const char *name;		/* report and export name */
+	const char *label;		/* drift failure label */
+} pm_timing_phases[FWTS_PM_TIMING_PHASES] = {
+	{ "suspend",		"SuspendTimeDrift" },
+	{ "firmware_resume",	"FirmwareResumeTimeDrift" },
+	{ "kernel_resume",	"KernelResumeTimeDrift" },
+};
+
+/*
+ *  fwts_pm_timing_new()
+ *	create an empty timing series, free with fwts_pm_timing_free()
+ */
+fwts_pm_timing *fwts_pm_timing_new(void)
+{
+	fwts_pm_timing *timing;
+
+	if ((timing = calloc(1, sizeof(*timing))) == NULL)
+		return NULL;
+
+	/* Only FPDT resume records made after now are used */
+	(void)fwts_get_uint64(FPDT_RESUME_COUNT, &timing->fpdt_resume_count);
+
+	return timing;
+}
+
+/*
+ *  fwts_pm_timing_free()
+ *	free a timing series
+ */
+void fwts_pm_timing_free(fwts_pm_timing *timing)
+{
+	size_t i;
+
+	if (!timing)
+		return;
+
+	for (i = 0; i < timing->devices_len; i++)
+		free(timing->devices[i].name);
+	free(timing->devices);
+	free(timing->cycles);
+	free(timing);
+}
+
+/*
+ *  fwts_pm_timing_add()
+ *	add the timings of a cycle to the series
+ */
+int fwts_pm_timing_add(fwts_pm_timing *timing, const fwts_pm_timing_cycle *cycle)
+{
+	if (timing->len == timing->size) {
+		const size_t size = timing->size ? timing->size * 2 : PM_TIMING_CYCLES_MIN;
+		fwts_pm_timing_cycle *cycles;
+
+		if ((cycles = realloc(timing->cycles, size * sizeof(*cycles))) == NULL)
+			return FWTS_ERROR;
+		timing->cycles = cycles;
+		timing->size = size;
+	}
+	timing->cycles[timing->len++] = *cycle;
+
+	return FWTS_OK;
+}
+
+/*
+ *  pm_timing_device_get()
+ *	find or add a device by name, the devices are
+ *	kept sorted so a device is found with a binary search
+ */
+static fwts_pm_timing_device *pm_timing_device_get(
+	fwts_pm_timing *timing,
+	const char *name,
+	const size_t name_len)
+{
+	fwts_pm_timing_device *device;
+	size_t lo = 0, hi = timing->devices_len;
+
+	while (lo < hi) {
+		const size_t mid = (lo + hi) / 2;
+		const char *mid_name = timing->devices[mid].name;
+		int cmp = strncmp(mid_name, name, name_len);
+
+		if (cmp == 0)
+			cmp = mid_name[name_len] ? 1 : 0;
+		if (cmp == 0)
+			return &timing->devices[mid];
+		if (cmp < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	if (timing->devices_len == timing->devices_size) {
+		const size_t size = timing->devices_size ?
+			timing->devices_size * 2 : PM_TIMING_DEVICES_MIN;
+		fwts_pm_timing_device *devices;
+
+		if ((devices = realloc(timing->devices, size * sizeof(*devices))) == NULL)
+			return NULL;
+		timing->devices = devices;
+		timing->devices_size = size;
+	}
+
+	device = &timing->devices[lo];
+	memmove(device + 1, device, (timing->devices_len - lo) * sizeof(*device));
+	memset(device, 0, sizeof(*device));
+	if ((device->name = strndup(name, name_len)) == NULL) {
+		memmove(device, device + 1, (timing->devices_len - lo) * sizeof(*device));
+		return NULL;
+	}
+	timing->devices_len++;
+
+	return device;
+}
+
+/*
+ *  fwts_pm_timing_device_line()
+ *	add the time of a device PM callback from a kernel log line
+ *	(timestamp removed) of the form:
+ *	  "pci 0000:00:1f.3: pci_pm_resume+0x0/0xe0 returned 0 after 1234 usecs"
+ *	or on older kernels:
+ *	  "call 0000:00:1f.3+ returned 0 after 1234 usecs"
+ *	the time is added to the cycle after the last cycle added.
+ *	Returns FWTS_OK if the line was a device time.
+ */
+int fwts_pm_timing_device_line(fwts_pm_timing *timing, const char *line)
+{
+	fwts_pm_timing_device *device;
+	const char *returned, *name, *end;
+	unsigned long long usecs;
+	int ret;
+
+	if ((returned = strstr(line, " returned ")) == NULL)
+		return FWTS_ERROR;
+	if (sscanf(returned, " returned %d after %llu usecs", &ret, &usecs) != 2)
+		return FWTS_ERROR;
+
+	if (!strncmp(line, "call ", 5)) {
+		name = line + 5;
+		if ((end = memchr(name, '+', returned - name)) == NULL)
+			end = returned;
+	} else {
+		/* Device name is ahead of the callback, "driver device: callback" */
+		name = line;
+		for (end = returned; end > line; end--)
+			if ((end[-1] == ' ') && (end - 1 > line) && (end[-2] == ':'))
+				break;
+		if (end == line)
+			return FWTS_ERROR;
+		end -= 2;
+	}
+	if (end <= name)
+		return FWTS_ERROR;
+
+	if ((device = pm_timing_device_get(timing, name, end - name)) == NULL)
+		return FWTS_ERROR;
+	if (usecs > UINT32_MAX)
+		usecs = UINT32_MAX;
+	device->count++;
+	device->total += usecs;
+	if (usecs > device->max) {
+		device->max = (uint32_t)usecs;
+		device->max_cycle = (uint32_t)timing->len + 1;
+	}
+
+	return FWTS_OK;
+}
+
+/*
+ *  fwts_pm_timing_firmware_resume()
+ *	firmware resume time in us of the last resume from the ACPI
+ *	FPDT S3 performance record, FWTS_PM_TIMING_UNKNOWN if there has
+ *	been no new record since the last call
+ */
+uint32_t fwts_pm_timing_firmware_resume(fwts_pm_timing *timing)
+{
+	uint64_t count, ns;
+
+	if (fwts_get_uint64(FPDT_RESUME_COUNT, &count) != FWTS_OK)
+		return FWTS_PM_TIMING_UNKNOWN;
+	if (count == timing->fpdt_resume_count)
+		return FWTS_PM_TIMING_UNKNOWN;
+	timing->fpdt_resume_count = count;
+	if (fwts_get_uint64(FPDT_RESUME_PREV_NS, &ns) != FWTS_OK)
+		return FWTS_PM_TIMING_UNKNOWN;
+
+	return (ns / 1000) >= UINT32_MAX ? UINT32_MAX - 1 : (uint32_t)(ns / 1000);
+}
+
+static int pm_timing_us_cmp(const void *a, const void *b)
+{
+	const uint32_t us_a = *(const uint32_t *)a;
+	const uint32_t us_b = *(const uint32_t *)b;
+
+	return (us_a > us_b) - (us_a < us_b);
+}
+
+/*
+ *  pm_timing_percentile()
+ *	nearest rank percentile of n sorted times, in ms
+ */
+static double pm_timing_percentile(const uint32_t *us, const size_t n, const int percent)
+{
+	size_t rank = ((size_t)percent * n + 99) / 100;
+
+	if (rank < 1)
+		rank = 1;
+
+	return (double)us[rank - 1] / 1000.0;
+}
+
+/*
+ *  pm_timing_median()
+ *	median of n times, sorts them in place
+ */
+static uint32_t pm_timing_median(uint32_t *us, const size_t n)
+{
+	qsort(us, n, sizeof(*us), pm_timing_us_cmp);
+
+	return us[n / 2];
+}
+
+/*
+ *  pm_timing_phase_series()
+ *	fill us with the known times of a phase in cycle order,
+ *	returns how many there are
+ */
+static size_t pm_timing_phase_series(
+	const fwts_pm_timing *timing,
+	const fwts_pm_timing_phase phase,
+	uint32_t *us)
+{
+	size_t i, n = 0;
+
+	for (i = 0; i < timing->len; i++)
+		if (timing->cycles[i].phase[phase] != FWTS_PM_TIMING_UNKNOWN)
+			us[n++] = timing->cycles[i].phase[phase];
+
+	return n;
+}
+
+/*
+ *  pm_timing_slope()
+ *	least squares slope of n times in cycle order, in ms per cycle
+ */
+static double pm_timing_slope(const uint32_t *us, const size_t n)
+{
+	double sum_x = 0.0, sum_y = 0.0, sum_xy = 0.0, sum_xx = 0.0, d;
+	size_t i;
+
+	for (i = 0; i < n; i++) {
+		const double x = (double)i;
+		const double y = (double)us[i] / 1000.0;
+
+		sum_x += x;
+		sum_y += y;
+		sum_xy += x * y;
+		sum_xx += x * x;
+	}
+	d = (double)n * sum_xx - sum_x * sum_x;
+
+	return d > 0.0 ? ((double)n * sum_xy - sum_x * sum_y) / d : 0.0;
+}
+
+/*
+ *  pm_timing_drift()
+ *	compare the median time of the first and last cycles of a
+ *	run, fail if the later cycles have got slower by more than
+ *	drift percent. us must hold n times in cycle order.
+ */
+static void pm_timing_drift(
+	fwts_framework *fw,
+	const fwts_pm_timing_phase phase,
+	uint32_t *us,
+	const size_t n,
+	const int drift)
+{
+	size_t window = n / 10;
+	uint32_t first, last;
+	double slope;
+
+	if (n < PM_TIMING_DRIFT_CYCLES)
+		return;
+	if (window < PM_TIMING_DRIFT_WINDOW)
+		window = PM_TIMING_DRIFT_WINDOW;
+
+	slope = pm_timing_slope(us, n);
+	first = pm_timing_median(us, window);
+	last = pm_timing_median(us + n - window, window);
+
+	if ((last > first) &&
+	    (last - first > PM_TIMING_DRIFT_MIN) &&
+	    ((double)(last - first) * 100.0 > (double)first * (double)drift)) {
+		fwts_failed(fw, LOG_LEVEL_MEDIUM, pm_timing_phases[phase].label,
+			"Median %s time went from %.3f ms over the first %zu cycles "
+			"to %.3f ms over the last %zu cycles (%+.3f ms per cycle), "
+			"more than the %d%% allowed.",
+			pm_timing_phases[phase].name,
+			(double)first / 1000.0, window,
+			(double)last / 1000.0, window, slope, drift);
+	} else {
+		fwts_log_info(fw, "No %s time drift, median %.3f ms over the first "
+			"%zu cycles and %.3f ms over the last %zu cycles "
+			"(%+.3f ms per cycle).",
+			pm_timing_phases[phase].name,
+			(double)first / 1000.0, window,
+			(double)last / 1000.0, window, slope);
+	}
+}
+
+/*
+ *  pm_timing_report_row()
+ *	log min, mean, p50, p90, p99 and max of n times in ms
+ */
+static void pm_timing_report_row(
+	fwts_framework *fw,
+	const char *name,
+	uint32_t *us,
+	const size_t n)
+{
+	uint64_t total = 0;
+	size_t i;
+
+	if (n == 0) {
+		fwts_log_info_verbatim(fw, "  %-18s %7zu", name, n);
+		return;
+	}
+	for (i = 0; i < n; i++)
+		total += us[i];
+	qsort(us, n, sizeof(*us), pm_timing_us_cmp);
+
+	fwts_log_info_verbatim(fw,
+		"  %-18s %7zu %10.3f %10.3f %10.3f %10.3f %10.3f %10.3f",
+		name, n, (double)us[0] / 1000.0,
+		(double)total / (double)n / 1000.0,
+		pm_timing_percentile(us, n, 50),
+		pm_timing_percentile(us, n, 90),
+		pm_timing_percentile(us, n, 99),
+		(double)us[n - 1] / 1000.0);
+}
+
+static int pm_timing_device_cmp(const void *a, const void *b)
+{
+	const fwts_pm_timing_device *dev_a = *(fwts_pm_timing_device * const *)a;
+	const fwts_pm_timing_device *dev_b = *(fwts_pm_timing_device * const *)b;
+
+	return (dev_a->total < dev_b->total) - (dev_a->total > dev_b->total);
+}
+
+/*
+ *  pm_timing_report_devices()
+ *	log the devices that took longest to resume in total
+ */
+static void pm_timing_report_devices(fwts_framework *fw, const fwts_pm_timing *timing)
+{
+	fwts_pm_timing_device **devices;
+	size_t i, n;
+
+	if (timing->devices_len == 0)
+		return;
+	if ((devices = calloc(timing->devices_len, sizeof(*devices))) == NULL)
+		return;
+	for (i = 0; i < timing->devices_len; i++)
+		devices[i] = &timing->devices[i];
+	qsort(devices, timing->devices_len, sizeof(*devices), pm_timing_device_cmp);
+
+	n = timing->devices_len < PM_TIMING_DEVICES_TOP ?
+		timing->devices_len : PM_TIMING_DEVICES_TOP;
+	fwts_log_info(fw, "Slowest of %zu devices to resume:", timing->devices_len);
+	fwts_log_info_verbatim(fw, "  %-40s %7s %10s %10s %7s",
+		"Device", "Calls", "Mean ms", "Max ms", "Cycle");
+	for (i = 0; i < n; i++) {
+		const fwts_pm_timing_device *device = devices[i];
+
+		fwts_log_info_verbatim(fw, "  %-40.40s %7" PRIu32 " %10.3f %10.3f %7" PRIu32,
+			device->name, device->count,
+			(double)device->total / (double)device->count / 1000.0,
+			(double)device->max / 1000.0, device->max_cycle);
+	}
+	free(devices);
+}
+
+/*
+ *  fwts_pm_timing_check()
+ *	report the phase time distributions and slowest devices to
+ *	resume, and fail phases that drift by more than drift percent
+ *	over the run
+ */
+int fwts_pm_timing_check(fwts_framework *fw, fwts_pm_timing *timing, const int drift)
+{
+	uint32_t *us;
+	size_t i, n;
+	int phase;
+
+	if (timing->len == 0)
+		return FWTS_OK;
+	if ((us = calloc(timing->len, sizeof(*us))) == NULL)
+		return FWTS_ERROR;
+
+	fwts_log_info(fw, "Suspend/Resume Timings over %zu cycles:", timing->len);
+	fwts_log_info_verbatim(fw, "  %-18s %7s %10s %10s %10s %10s %10s %10s",
+		"Phase (ms)", "Cycles", "Min", "Mean", "P50", "P90", "P99", "Max");
+	for (phase = 0; phase < FWTS_PM_TIMING_PHASES; phase++) {
+		n = pm_timing_phase_series(timing, phase, us);
+		pm_timing_report_row(fw, pm_timing_phases[phase].name, us, n);
+	}
+	for (i = 0, n = 0; i < timing->len; i++) {
+		const uint64_t residency = timing->cycles[i].s2idle_residency;
+
+		if (residency)
+			us[n++] = residency > UINT32_MAX ? UINT32_MAX : (uint32_t)residency;
+	}
+	if (n)
+		pm_timing_report_row(fw, "s2idle_residency", us, n);
+	fwts_log_nl(fw);
+
+	pm_timing_report_devices(fw, timing);
+	fwts_log_nl(fw);
+
+	for (phase = 0; phase < FWTS_PM_TIMING_PHASES; phase++) {
+		n = pm_timing_phase_series(timing, phase, us);
+		pm_timing_drift(fw, phase, us, n, drift);
+	}
+	free(us);
+
+	return FWTS_OK;
+}
+
+static void pm_timing_json_us(FILE *fp, const char *name, const uint32_t us)
+{
+	if (us == FWTS_PM_TIMING_UNKNOWN)
+		fprintf(fp, ", \"%s_us\": null", name);
+	else
+		fprintf(fp, ", \"%s_us\": %" PRIu32, name, us);
+}
+
+/*
+ *  pm_timing_export_json()
+ *	write the cycle and device timings as JSON
+ */
+static void pm_timing_export_json(FILE *fp, const fwts_pm_timing *timing)
+{
+	size_t i;
+	int phase;
+
+	fprintf(fp, "{\n  \"pm_timing\": {\n    \"cycles\": [");
+	for (i = 0; i < timing->len; i++) {
+		const fwts_pm_timing_cycle *cycle = &timing->cycles[i];
+
+		fprintf(fp, "%s\n      { \"cycle\": %zu", i ? "," : "", i + 1);
+		for (phase = 0; phase < FWTS_PM_TIMING_PHASES; phase++)
+			pm_timing_json_us(fp, pm_timing_phases[phase].name, cycle->phase[phase]);
+		fprintf(fp, ", \"s2idle_residency_us\": %" PRIu64 " }", cycle->s2idle_residency);
+	}
+	fprintf(fp, "\n    ],\n    \"devices\": [");
+	for (i = 0; i < timing->devices_len; i++) {
+		const fwts_pm_timing_device *device = &timing->devices[i];
+
+		fprintf(fp, "%s\n      { \"device\": ", i ? "," : "");
+		fwts_json_escape(fp, device->name);
+		fprintf(fp, ", \"count\": %" PRIu32 ", \"total_us\": %" PRIu64
+			", \"max_us\": %" PRIu32 ", \"max_cycle\": %" PRIu32 " }",
+			device->count, device->total, device->max, device->max_cycle);
+	}
+	fprintf(fp, "\n    ]\n  }\n}\n");
+}
+
+/*
+ *  pm_timing_export_csv()
+ *	write the cycle timings as CSV, unknown times are left empty
+ */
+static void pm_timing_export_csv(FILE *fp, const fwts_pm_timing *timing)
+{
+	size_t i;
+	int phase;
+
+	fprintf(fp, "cycle");
+	for (phase = 0; phase < FWTS_PM_TIMING_PHASES; phase++)
+		fprintf(fp, ",%s_us", pm_timing_phases[phase].name);
+	fprintf(fp, ",s2idle_residency_us\n");
+
+	for (i = 0; i < timing->len; i++) {
+		const fwts_pm_timing_cycle *cycle = &timing->cycles[i];
+
+		fprintf(fp, "%zu", i + 1);
+		for (phase = 0; phase < FWTS_PM_TIMING_PHASES; phase++) {
+			if (cycle->phase[phase] == FWTS_PM_TIMING_UNKNOWN)
+				fputc(',', fp);
+			else
+				fprintf(fp, ",%" PRIu32, cycle->phase[phase]);
+		}
+		fprintf(fp, ",%" PRIu64 "\n", cycle->s2idle_residency);
+	}
+}
+
+/*
+ *  pm_timing_export_devices_csv()
+ *	write the device timings as CSV
+ */
+static void pm_timing_export_devices_csv(FILE *fp, const fwts_pm_timing *timing)
+{
+	size_t i;
+
+	fprintf(fp, "device,count,total_us,max_us,max_cycle\n");
+	for (i = 0; i < timing->devices_len; i++) {
+		const fwts_pm_timing_device *device = &timing->devices[i];
+
+		fwts_csv_escape(fp, device->name);
+		fprintf(fp, ",%" PRIu32 ",%" PRIu64 ",%" PRIu32 ",%" PRIu32 "\n",
+			device->count, device->total,
+			device->max, device->max_cycle);
+	}
+}
+
+static int pm_timing_export_file(
+	fwts_framework *fw,
+	const fwts_pm_timing *timing,
+	const char *filename,
+	void (*export)(FILE *fp, const fwts_pm_timing *timing))
+{
+	FILE *fp;
+
+	if ((fp = fopen(filename, "w")) == NULL) {
+		fwts_log_error(fw, "Cannot write suspend/resume timings to %s.", filename);
+		return FWTS_ERROR;
+	}
+	export(fp, timing);
+	if (fclose(fp)) {
+		fwts_log_error(fw, "Failed to write suspend/resume timings to %s.", filename);
+		return FWTS_ERROR;
+	}
+
+	return FWTS_OK;
+}
+
+/*
+ *  fwts_pm_timing_export()
+ *	write the timings to a file, JSON if the file name ends in
+ *	.json, otherwise CSV with the device timings in a second
+ *	file with .devices.csv in place of any .csv
+ */
+int fwts_pm_timing_export(fwts_framework *fw, const fwts_pm_timing *timing, const char *filename)
+{
+	const size_t len = strlen(filename);
+	char devices[PATH_MAX];
+	size_t base = len;
+
+	if ((len > 5) && !strcasecmp(filename + len - 5, ".json"))
+		return pm_timing_export_file(fw, timing, filename, pm_timing_export_json);
+
+	if (pm_timing_export_file(fw, timing, filename, pm_timing_export_csv) != FWTS_OK)
+		return FWTS_ERROR;
+	if (timing->devices_len == 0)
+		return FWTS_OK;
+
+	if ((len > 4) && !strcasecmp(filename + len - 4, ".csv"))
+		base -= 4;
+	snprintf(devices, sizeof(devices), "%.*s.devices.csv", (int)base, filename);
+
+	return pm_timing_export_file(fw, timing, devices, pm_timing_export_devices_csv);
+}
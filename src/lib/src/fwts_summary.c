@@ -120,6 +120,12 @@ int fwts_summary_add(
 	if (FWTS_LEVEL_IGNORE(fw, level))
 		return FWTS_OK;
 
+	/* Forked test worker, the parent adds it when replaying the log */
+	if (fwts_log_capturing()) {
+		fwts_log_capture_summary(test, level, text);
+		return FWTS_OK;
+	}
+
 	/* Does the text already exist? - search for it */
 	fwts_list_foreach(item, fwts_summaries[index]) {
 		summary_item = fwts_list_data(fwts_summary_item *,item);
@@ -20,8 +20,27 @@
 #include "fwts.h"
 #include "fwts_tpm.h"
 
+#include <ctype.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
 #include <glib.h>
 
+#define FWTS_TPM_DEVICE_PATH	"/sys/class/tpm"
+
+#define TPM_REPLAY_EVENTS_MIN	(256)
+
+static const struct {
+	TPM2_ALG_ID alg;
+	const char *name;
+	GChecksumType type;
+} tpm_replay_banks[FWTS_TPM_REPLAY_BANKS] = {
+	{ TPM2_ALG_SHA1,	"sha1",		G_CHECKSUM_SHA1 },
+	{ TPM2_ALG_SHA256,	"sha256",	G_CHECKSUM_SHA256 },
+	{ TPM2_ALG_SHA384,	"sha384",	G_CHECKSUM_SHA384 },
+	{ TPM2_ALG_SHA512,	"sha512",	G_CHECKSUM_SHA512 },
+};
+
 /*
  *  fwts_tpm_data_hexdump
  *	hex dump of a tpm event log data
@@ -108,3 +127,224 @@ uint8_t fwts_tpm_get_hash_size(const TPM2_ALG_ID hash)
 
 	return sz;
 }
+
+/*
+ *  fwts_tpm_replay_init()
+ *	initialise an empty event log replay of all banks
+ */
+void fwts_tpm_replay_init(fwts_tpm_replay *replay)
+{
+	int i;
+
+	memset(replay, 0, sizeof(*replay));
+	for (i = 0; i < FWTS_TPM_REPLAY_BANKS; i++) {
+		fwts_tpm_replay_bank *bank = &replay->banks[i];
+
+		bank->alg = tpm_replay_banks[i].alg;
+		bank->name = tpm_replay_banks[i].name;
+		bank->size = fwts_tpm_get_hash_size(bank->alg);
+	}
+}
+
+/*
+ *  fwts_tpm_replay_free()
+ *	free the events held by an event log replay
+ */
+void fwts_tpm_replay_free(fwts_tpm_replay *replay)
+{
+	int i;
+
+	for (i = 0; i < FWTS_TPM_REPLAY_BANKS; i++) {
+		free(replay->banks[i].events);
+		free(replay->banks[i].digests);
+	}
+	fwts_tpm_replay_init(replay);
+}
+
+/*
+ *  fwts_tpm_replay_add()
+ *	add an event log digest to be extended into a PCR, the
+ *	digest is copied. Digests of banks that are not replayed
+ *	and PCRs beyond the firmware PCRs are ignored.
+ */
+int fwts_tpm_replay_add(
+	fwts_tpm_replay *replay,
+	const uint32_t event,
+	const uint32_t pcr,
+	const TPM2_ALG_ID alg,
+	const uint8_t *digest)
+{
+	fwts_tpm_replay_bank *bank = NULL;
+	int i;
+
+	if (pcr >= TPM2_FIRMWARE_PCR_COUNT)
+		return FWTS_OK;
+	for (i = 0; i < FWTS_TPM_REPLAY_BANKS; i++) {
+		if (replay->banks[i].alg == alg) {
+			bank = &replay->banks[i];
+			break;
+		}
+	}
+	if (!bank)
+		return FWTS_OK;
+
+	if (bank->len == bank->events_size) {
+		const size_t size = bank->events_size ?
+			bank->events_size * 2 : TPM_REPLAY_EVENTS_MIN;
+		fwts_tpm_replay_event *events;
+		uint8_t *digests;
+
+		if ((events = realloc(bank->events, size * sizeof(*events))) == NULL)
+			return FWTS_ERROR;
+		bank->events = events;
+		if ((digests = realloc(bank->digests, size * bank->size)) == NULL)
+			return FWTS_ERROR;
+		bank->digests = digests;
+		bank->events_size = size;
+	}
+	bank->events[bank->len].event = event;
+	bank->events[bank->len].pcr = (uint8_t)pcr;
+	memcpy(bank->digests + bank->len * bank->size, digest, bank->size);
+	bank->len++;
+
+	return FWTS_OK;
+}
+
+/*
+ *  tpm_replay_hex()
+ *	convert a hex digit, -1 if not a hex digit
+ */
+static int tpm_replay_hex(const char c)
+{
+	if (isdigit((unsigned char)c))
+		return c - '0';
+	if (isxdigit((unsigned char)c))
+		return toupper((unsigned char)c) - 'A' + 10;
+	return -1;
+}
+
+/*
+ *  tpm_replay_read_pcrs()
+ *	read the firmware PCRs of a bank from sysfs, the bank is
+ *	not active if the TPM does not have the bank enabled
+ */
+static int tpm_replay_read_pcrs(const char *tpm, fwts_tpm_replay_bank *bank)
+{
+	char path[PATH_MAX];
+	char buffer[TPM2_MAX_DIGEST_SIZE * 2 + 2];	/* Trailing \n + NUL */
+	int i, j;
+
+	for (i = 0; i < TPM2_FIRMWARE_PCR_COUNT; i++) {
+		ssize_t n;
+		int fd;
+
+		snprintf(path, sizeof(path), FWTS_TPM_DEVICE_PATH "/%s/pcr-%s/%d",
+			tpm, bank->name, i);
+		if ((fd = open(path, O_RDONLY)) < 0)
+			return FWTS_ERROR;
+		n = read(fd, buffer, sizeof(buffer) - 1);
+		(void)close(fd);
+
+		if ((n != bank->size * 2 + 1) || (buffer[n - 1] != '\n'))
+			return FWTS_ERROR;
+		for (j = 0; j < bank->size; j++) {
+			const int hi = tpm_replay_hex(buffer[j * 2]);
+			const int lo = tpm_replay_hex(buffer[j * 2 + 1]);
+
+			if ((hi < 0) || (lo < 0))
+				return FWTS_ERROR;
+			bank->actual[i][j] = (uint8_t)((hi << 4) | lo);
+		}
+	}
+	bank->active = true;
+
+	return FWTS_OK;
+}
+
+typedef struct {
+	fwts_tpm_replay_bank *bank;
+	GChecksumType type;
+	const char *tpm;
+	uint8_t locality;
+} tpm_replay_job;
+
+/*
+ *  tpm_replay_bank()
+ *	replay the events of a bank with one reused hasher, and find
+ *	the first event of each PCR that stops it matching the TPM.
+ *	A PCR that matched the TPM part way through the log diverges
+ *	at the next event extended into it, otherwise at its first.
+ */
+static void *tpm_replay_bank(void *arg)
+{
+	tpm_replay_job *job = (tpm_replay_job *)arg;
+	fwts_tpm_replay_bank *bank = job->bank;
+	GChecksum *hasher;
+	size_t i;
+
+	memset(bank->pcr, 0, sizeof(bank->pcr));
+	bank->pcr[0][bank->size - 1] = job->locality;
+	for (i = 0; i < TPM2_FIRMWARE_PCR_COUNT; i++) {
+		bank->pcr_events[i] = 0;
+		bank->diverge[i] = FWTS_TPM_REPLAY_EVENT_NONE;
+	}
+
+	if (tpm_replay_read_pcrs(job->tpm, bank) != FWTS_OK)
+		return NULL;
+	if ((hasher = g_checksum_new(job->type)) == NULL)
+		return NULL;
+
+	for (i = 0; i < bank->len; i++) {
+		const fwts_tpm_replay_event *event = &bank->events[i];
+		uint8_t *pcr = bank->pcr[event->pcr];
+		gsize hash_len = bank->size;
+
+		if ((bank->pcr_events[event->pcr] == 0) ||
+		    !memcmp(pcr, bank->actual[event->pcr], bank->size))
+			bank->diverge[event->pcr] = event->event;
+		bank->pcr_events[event->pcr]++;
+
+		g_checksum_update(hasher, pcr, bank->size);
+		g_checksum_update(hasher, bank->digests + i * bank->size, bank->size);
+		g_checksum_get_digest(hasher, pcr, &hash_len);
+		g_checksum_reset(hasher);
+	}
+	g_checksum_free(hasher);
+
+	return NULL;
+}
+
+/*
+ *  fwts_tpm_replay_verify()
+ *	replay the event log of all banks concurrently and read the
+ *	PCRs of each bank from the TPM to compare with, returns the
+ *	number of active banks replayed
+ */
+int fwts_tpm_replay_verify(fwts_tpm_replay *replay, const char *tpm)
+{
+	tpm_replay_job jobs[FWTS_TPM_REPLAY_BANKS];
+	pthread_t threads[FWTS_TPM_REPLAY_BANKS];
+	bool started[FWTS_TPM_REPLAY_BANKS];
+	int i, active = 0;
+
+	for (i = 0; i < FWTS_TPM_REPLAY_BANKS; i++) {
+		jobs[i].bank = &replay->banks[i];
+		jobs[i].type = tpm_replay_banks[i].type;
+		jobs[i].tpm = tpm;
+		jobs[i].locality = replay->locality;
+		jobs[i].bank->active = false;
+
+		/* Can't start a thread, so just do it here */
+		started[i] = (pthread_create(&threads[i], NULL, tpm_replay_bank, &jobs[i]) == 0);
+		if (!started[i])
+			(void)tpm_replay_bank(&jobs[i]);
+	}
+	for (i = 0; i < FWTS_TPM_REPLAY_BANKS; i++) {
+		if (started[i])
+			(void)pthread_join(threads[i], NULL);
+		if (replay->banks[i].active)
+			active++;
+	}
+
+	return active;
+}
@@ -0,0 +1,571 @@
+/*
+ * Copyright (C) 2026 Canonical
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <string.h>
+#include <strings.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/ioctl.h>
+
+#include "fwts.h"
+#include "fwts_uefi.h"
+#include "fwts_efi_runtime.h"
+#include "fwts_uefi_latency.h"
+
+/*
+ *  UEFI runtime service latency. When enabled with --uefi-latency
+ *  every runtime service call made with fwts_uefi_rt_ioctl() is timed,
+ *  fwts_uefi_latency_check() then reports and checks the calls made
+ *  by the current test.
+ */
+
+/* Latency histogram buckets, bucket n counts calls taking < 2^n us */
+#define LATENCY_BUCKETS		(24)
+
+typedef struct {
+	unsigned long request;		/* efi_runtime ioctl */
+	const char *name;		/* UEFI runtime service */
+	bool sized;			/* has a variable data size */
+} latency_service;
+
+static const latency_service latency_services[] = {
+	{ EFI_RUNTIME_GET_VARIABLE,		"GetVariable",			true },
+	{ EFI_RUNTIME_SET_VARIABLE,		"SetVariable",			true },
+	{ EFI_RUNTIME_GET_NEXTVARIABLENAME,	"GetNextVariableName",		true },
+	{ EFI_RUNTIME_QUERY_VARIABLEINFO,	"QueryVariableInfo",		false },
+	{ EFI_RUNTIME_GET_TIME,			"GetTime",			false },
+	{ EFI_RUNTIME_SET_TIME,			"SetTime",			false },
+	{ EFI_RUNTIME_GET_WAKETIME,		"GetWakeupTime",		false },
+	{ EFI_RUNTIME_SET_WAKETIME,		"SetWakeupTime",		false },
+	{ EFI_RUNTIME_GET_NEXTHIGHMONOTONICCOUNT, "GetNextHighMonotonicCount",	false },
+	{ EFI_RUNTIME_QUERY_CAPSULECAPABILITIES, "QueryCapsuleCapabilities",	false },
+};
+
+#define LATENCY_SERVICES	FWTS_ARRAY_SIZE(latency_services)
+
+/*
+ *  A timed runtime service call
+ */
+typedef struct {
+	const char *test;		/* test that made the call */
+	uint64_t ns;			/* time taken */
+	uint64_t size;			/* variable data size */
+	uint64_t status;		/* EFI status returned */
+	int ret;			/* ioctl() return */
+	uint8_t service;		/* index into latency_services[] */
+} latency_sample;
+
+static bool		latency_enabled;
+static const char	*latency_test = "";
+static latency_sample	*latency_samples;
+static size_t		latency_samples_len;
+static size_t		latency_samples_size;
+static size_t		latency_first;		/* first sample of current test */
+
+/* Outlier thresholds in us, 0 for the default */
+static uint64_t		latency_threshold[LATENCY_SERVICES];
+
+/*
+ *  fwts_uefi_latency_threshold_set()
+ *	set outlier thresholds from a comma separated list of
+ *	microseconds for all services or service=microseconds,
+ *	e.g. 50000,SetVariable=200000
+ */
+int fwts_uefi_latency_threshold_set(const char *str)
+{
+	char *tmp, *token, *saveptr = NULL;
+	int ret = FWTS_OK;
+
+	if ((tmp = strdup(str)) == NULL)
+		return FWTS_ERROR;
+
+	for (token = strtok_r(tmp, ",", &saveptr); token;
+	     token = strtok_r(NULL, ",", &saveptr)) {
+		char *value = strchr(token, '=');
+		char *end;
+		uint64_t us;
+		size_t i;
+
+		if (value)
+			*value++ = '\0';
+		else
+			value = token;
+
+		errno = 0;
+		us = strtoull(value, &end, 10);
+		if (errno || (end == value) || *end || (us == 0)) {
+			fprintf(stderr, "Invalid UEFI latency threshold '%s', "
+				"expecting microseconds.\n", value);
+			ret = FWTS_ERROR;
+			break;
+		}
+
+		if (value == token) {
+			for (i = 0; i < LATENCY_SERVICES; i++)
+				latency_threshold[i] = us;
+			continue;
+		}
+		for (i = 0; i < LATENCY_SERVICES; i++) {
+			if (!strcasecmp(token, latency_services[i].name)) {
+				latency_threshold[i] = us;
+				break;
+			}
+		}
+		if (i == LATENCY_SERVICES) {
+			fprintf(stderr, "Unknown UEFI runtime service '%s' "
+				"for latency threshold.\n", token);
+			ret = FWTS_ERROR;
+			break;
+		}
+	}
+	free(tmp);
+
+	return ret;
+}
+
+/*
+ *  fwts_uefi_latency_init()
+ *	start timing runtime service calls for a test if enabled
+ */
+void fwts_uefi_latency_init(fwts_framework *fw)
+{
+	latency_enabled = !!(fw->flags & FWTS_FLAG_UEFI_LATENCY);
+	latency_test = fw->current_major_test ? fw->current_major_test->name : "";
+	latency_first = latency_samples_len;
+}
+
+/*
+ *  latency_sample_add()
+ *	record a timed call, the data size and status are taken
+ *	from the ioctl argument after the call
+ */
+static void latency_sample_add(
+	const uint8_t service,
+	const void *arg,
+	const int ret,
+	const uint64_t ns)
+{
+	latency_sample *sample;
+	uint64_t *status = NULL;
+	uint64_t size = 0;
+
+	if (latency_samples_len == latency_samples_size) {
+		const size_t new_size = latency_samples_size ?
+			latency_samples_size * 2 : 1024;
+		latency_sample *samples;
+
+		samples = realloc(latency_samples, new_size * sizeof(*samples));
+		if (!samples)
+			return;
+		latency_samples = samples;
+		latency_samples_size = new_size;
+	}
+
+	if (arg) {
+		switch (latency_services[service].request) {
+		case EFI_RUNTIME_GET_VARIABLE: {
+			const struct efi_getvariable *v = arg;
+
+			if (v->DataSize)
+				size = *v->DataSize;
+			status = v->status;
+			break;
+		}
+		case EFI_RUNTIME_SET_VARIABLE: {
+			const struct efi_setvariable *v = arg;
+
+			size = v->DataSize;
+			status = v->status;
+			break;
+		}
+		case EFI_RUNTIME_GET_NEXTVARIABLENAME: {
+			const struct efi_getnextvariablename *v = arg;
+
+			if (v->VariableNameSize)
+				size = *v->VariableNameSize;
+			status = v->status;
+			break;
+		}
+		case EFI_RUNTIME_QUERY_VARIABLEINFO:
+			status = ((const struct efi_queryvariableinfo *)arg)->status;
+			break;
+		case EFI_RUNTIME_GET_TIME:
+			status = ((const struct efi_gettime *)arg)->status;
+			break;
+		case EFI_RUNTIME_SET_TIME:
+			status = ((const struct efi_settime *)arg)->status;
+			break;
+		case EFI_RUNTIME_GET_WAKETIME:
+			status = ((const struct efi_getwakeuptime *)arg)->status;
+			break;
+		case EFI_RUNTIME_SET_WAKETIME:
+			status = ((const struct efi_setwakeuptime *)arg)->status;
+			break;
+		case EFI_RUNTIME_GET_NEXTHIGHMONOTONICCOUNT:
+			status = ((const struct efi_getnexthighmonotoniccount *)arg)->status;
+			break;
+		case EFI_RUNTIME_QUERY_CAPSULECAPABILITIES:
+			status = ((const struct efi_querycapsulecapabilities *)arg)->status;
+			break;
+		}
+	}
+
+	sample = &latency_samples[latency_samples_len++];
+	sample->test = latency_test;
+	sample->ns = ns;
+	sample->size = size;
+	sample->status = status ? *status : ~0ULL;
+	sample->ret = ret;
+	sample->service = service;
+}
+
+/*
+ *  fwts_uefi_rt_ioctl()
+ *	call a runtime service via the efi_runtime device, timing
+ *	the call if latency checking is enabled
+ */
+int fwts_uefi_rt_ioctl(const int fd, const unsigned long request, void *arg)
+{
+	struct timespec start, end;
+	int ret, saved_errno;
+	size_t i;
+
+	if (!latency_enabled)
+		return ioctl(fd, request, arg);
+
+	for (i = 0; i < LATENCY_SERVICES; i++)
+		if (latency_services[i].request == request)
+			break;
+	if (i == LATENCY_SERVICES)
+		return ioctl(fd, request, arg);
+
+	(void)clock_gettime(CLOCK_MONOTONIC_RAW, &start);
+	ret = ioctl(fd, request, arg);
+	(void)clock_gettime(CLOCK_MONOTONIC_RAW, &end);
+	saved_errno = errno;
+
+	latency_sample_add((uint8_t)i, arg, ret,
+		(uint64_t)(end.tv_sec - start.tv_sec) * 1000000000ULL +
+		(uint64_t)end.tv_nsec - (uint64_t)start.tv_nsec);
+
+	errno = saved_errno;
+	return ret;
+}
+
+static int latency_ns_cmp(const void *a, const void *b)
+{
+	const uint64_t ns_a = *(const uint64_t *)a;
+	const uint64_t ns_b = *(const uint64_t *)b;
+
+	return (ns_a > ns_b) - (ns_a < ns_b);
+}
+
+/*
+ *  latency_percentile()
+ *	nearest rank percentile of n sorted times, in us
+ */
+static double latency_percentile(const uint64_t *ns, const size_t n, const int percent)
+{
+	size_t rank = ((size_t)percent * n + 99) / 100;
+
+	if (rank < 1)
+		rank = 1;
+
+	return (double)ns[rank - 1] / 1000.0;
+}
+
+/*
+ *  latency_size_class()
+ *	group variable sizes by the next power of 2
+ */
+static uint64_t latency_size_class(const uint64_t size)
+{
+	uint64_t class = 1;
+
+	if (size == 0)
+		return 0;
+	while ((class < size) && (class < (1ULL << 63)))
+		class <<= 1;
+
+	return class;
+}
+
+/*
+ *  latency_report_row()
+ *	log min, p50, p99 and max of calls to a service of a
+ *	given size class, or all sizes if size_class is NULL
+ */
+static void latency_report_row(
+	fwts_framework *fw,
+	const size_t service,
+	const uint64_t *size_class,
+	uint64_t *ns)
+{
+	const uint64_t threshold_ns = (latency_threshold[service] ?
+		latency_threshold[service] : FWTS_UEFI_LATENCY_THRESHOLD_DEFAULT) * 1000;
+	char size[32];
+	size_t i, n = 0, over = 0;
+
+	for (i = latency_first; i < latency_samples_len; i++) {
+		const latency_sample *sample = &latency_samples[i];
+
+		if ((sample->service != service) ||
+		    (size_class && (latency_size_class(sample->size) != *size_class)))
+			continue;
+		ns[n++] = sample->ns;
+		over += (sample->ns > threshold_ns);
+	}
+	if (n == 0)
+		return;
+
+	qsort(ns, n, sizeof(*ns), latency_ns_cmp);
+
+	if (size_class)
+		snprintf(size, sizeof(size), "<=%" PRIu64, *size_class);
+	else
+		strcpy(size, "all");
+
+	fwts_log_info_verbatim(fw,
+		"  %-26s %10s %7zu %10.3f %10.3f %10.3f %10.3f %5zu",
+		latency_services[service].name, size, n,
+		(double)ns[0] / 1000.0,
+		latency_percentile(ns, n, 50),
+		latency_percentile(ns, n, 99),
+		(double)ns[n - 1] / 1000.0, over);
+}
+
+/*
+ *  latency_report_histogram()
+ *	log a histogram of call times to a service
+ */
+static void latency_report_histogram(fwts_framework *fw, const size_t service)
+{
+	uint64_t buckets[LATENCY_BUCKETS];
+	char buf[512];
+	size_t i, len = 0;
+
+	memset(buckets, 0, sizeof(buckets));
+	*buf = '\0';
+	for (i = latency_first; i < latency_samples_len; i++) {
+		const latency_sample *sample = &latency_samples[i];
+		uint64_t us = sample->ns / 1000;
+		int bucket = 0;
+
+		if (sample->service != service)
+			continue;
+		while (us && (bucket < LATENCY_BUCKETS - 1)) {
+			us >>= 1;
+			bucket++;
+		}
+		buckets[bucket]++;
+	}
+
+	for (i = 0; i < LATENCY_BUCKETS; i++) {
+		if (!buckets[i])
+			continue;
+		len += snprintf(buf + len, sizeof(buf) - len, " %s%" PRIu64 ":%" PRIu64,
+			i == LATENCY_BUCKETS - 1 ? ">=" : "<",
+			(uint64_t)1 << (i == LATENCY_BUCKETS - 1 ? i - 1 : i),
+			buckets[i]);
+		if (len >= sizeof(buf))
+			break;
+	}
+	fwts_log_info_verbatim(fw, "  %-26s us%s", latency_services[service].name, buf);
+}
+
+/*
+ *  latency_export_json()
+ *	write all timed calls so far as a JSON array
+ */
+static void latency_export_json(FILE *fp)
+{
+	size_t i;
+
+	fprintf(fp, "{\n  \"uefi_runtime_latency\": [");
+	for (i = 0; i < latency_samples_len; i++) {
+		const latency_sample *sample = &latency_samples[i];
+
+		fprintf(fp, "%s\n    { \"test\": ", i ? "," : "");
+		fwts_json_escape(fp, sample->test);
+		fprintf(fp, ", \"service\": \"%s\", \"size\": %" PRIu64
+			", \"ret\": %d, \"status\": %" PRIu64 ", \"ns\": %" PRIu64 " }",
+			latency_services[sample->service].name, sample->size,
+			sample->ret, sample->status, sample->ns);
+	}
+	fprintf(fp, "\n  ]\n}\n");
+}
+
+/*
+ *  latency_export_csv()
+ *	write all timed calls so far as CSV
+ */
+static void latency_export_csv(FILE *fp)
+{
+	size_t i;
+
+	fprintf(fp, "test,service,size,ret,status,ns\n");
+	for (i = 0; i < latency_samples_len; i++) {
+		const latency_sample *sample = &latency_samples[i];
+
+		fwts_csv_escape(fp, sample->test);
+		fprintf(fp, ",%s,%" PRIu64 ",%d,%" PRIu64 ",%" PRIu64 "\n",
+			latency_services[sample->service].name,
+			sample->size, sample->ret, sample->status, sample->ns);
+	}
+}
+
+/*
+ *  latency_export()
+ *	rewrite the export file with the calls timed so far, JSON
+ *	if the file name ends in .json, CSV otherwise
+ */
+static int latency_export(fwts_framework *fw, const char *filename)
+{
+	const size_t len = strlen(filename);
+	FILE *fp;
+
+	if ((fp = fopen(filename, "w")) == NULL) {
+		fwts_log_error(fw, "Cannot write UEFI runtime service latency to %s.", filename);
+		return FWTS_ERROR;
+	}
+	if ((len > 5) && !strcasecmp(filename + len - 5, ".json"))
+		latency_export_json(fp);
+	else
+		latency_export_csv(fp);
+
+	if (fclose(fp)) {
+		fwts_log_error(fw, "Failed to write UEFI runtime service latency to %s.", filename);
+		return FWTS_ERROR;
+	}
+
+	return FWTS_OK;
+}
+
+/*
+ *  fwts_uefi_latency_check()
+ *	report the runtime service calls made by the current test and
+ *	fail services with calls that took longer than the threshold,
+ *	this can be used directly as a minor test
+ */
+int fwts_uefi_latency_check(fwts_framework *fw)
+{
+	const size_t n = latency_samples_len - latency_first;
+	uint64_t *ns;
+	size_t i, service;
+
+	if (!latency_enabled) {
+		fwts_skipped(fw, "UEFI runtime service latency checking is not "
+			"enabled, use --uefi-latency to enable it.");
+		return FWTS_SKIP;
+	}
+	if (n == 0) {
+		fwts_log_info(fw, "No UEFI runtime service calls were timed.");
+		return FWTS_OK;
+	}
+	if ((ns = calloc(n, sizeof(*ns))) == NULL) {
+		fwts_log_error(fw, "Cannot allocate UEFI runtime service latency report.");
+		return FWTS_ERROR;
+	}
+
+	fwts_log_info(fw, "UEFI runtime service latency, %zu calls timed:", n);
+	fwts_log_info_verbatim(fw, "  %-26s %10s %7s %10s %10s %10s %10s %5s",
+		"Service", "Size", "Calls", "Min us", "p50 us", "p99 us",
+		"Max us", "Over");
+
+	for (service = 0; service < LATENCY_SERVICES; service++) {
+		uint64_t classes[65];
+		size_t n_classes = 0;
+
+		latency_report_row(fw, service, NULL, ns);
+		if (!latency_services[service].sized)
+			continue;
+
+		/* Then by variable size */
+		for (i = latency_first; i < latency_samples_len; i++) {
+			const uint64_t class = latency_size_class(latency_samples[i].size);
+			size_t j;
+
+			if (latency_samples[i].service != service)
+				continue;
+			for (j = 0; j < n_classes; j++)
+				if (classes[j] == class)
+					break;
+			if ((j == n_classes) && (n_classes < FWTS_ARRAY_SIZE(classes)))
+				classes[n_classes++] = class;
+		}
+		if (n_classes < 2)
+			continue;
+		qsort(classes, n_classes, sizeof(*classes), latency_ns_cmp);
+		for (i = 0; i < n_classes; i++)
+			latency_report_row(fw, service, &classes[i], ns);
+	}
+	fwts_log_nl(fw);
+
+	fwts_log_info(fw, "Latency histograms:");
+	for (service = 0; service < LATENCY_SERVICES; service++) {
+		for (i = latency_first; i < latency_samples_len; i++)
+			if (latency_samples[i].service == service)
+				break;
+		if (i < latency_samples_len)
+			latency_report_histogram(fw, service);
+	}
+	fwts_log_nl(fw);
+
+	for (service = 0; service < LATENCY_SERVICES; service++) {
+		const uint64_t threshold = latency_threshold[service] ?
+			latency_threshold[service] : FWTS_UEFI_LATENCY_THRESHOLD_DEFAULT;
+		size_t calls = 0, over = 0;
+		uint64_t max_ns = 0;
+
+		for (i = latency_first; i < latency_samples_len; i++) {
+			const latency_sample *sample = &latency_samples[i];
+
+			if (sample->service != service)
+				continue;
+			calls++;
+			over += (sample->ns > threshold * 1000);
+			if (sample->ns > max_ns)
+				max_ns = sample->ns;
+		}
+		if (calls == 0)
+			continue;
+
+		if (over)
+			fwts_failed(fw, LOG_LEVEL_MEDIUM, "UEFIRuntimeServiceLatency",
+				"UEFI runtime service %s took longer than %" PRIu64
+				" us on %zu of %zu calls, the longest call took %.3f us.",
+				latency_services[service].name, threshold,
+				over, calls, (double)max_ns / 1000.0);
+		else
+			fwts_passed(fw, "UEFI runtime service %s completed all %zu "
+				"calls within %" PRIu64 " us.",
+				latency_services[service].name, calls, threshold);
+	}
+	free(ns);
+
+	if (fw->uefi_latency_path)
+		(void)latency_export(fw, fw->uefi_latency_path);
+
+	return FWTS_OK;
+}
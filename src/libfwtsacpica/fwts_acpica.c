@@ -26,6 +26,7 @@
 #include <stdlib.h>
 #include <sys/types.h>
 #include <sys/time.h>
+#include <time.h>
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <errno.h>
@@ -272,6 +273,7 @@ static ACPI_STATUS fwts_region_handler(
 		return AE_OK;
 
 	fwts_acpi_region_handler_called_set(true);
+	fwts_acpica_profile_region(regionobject->Region.SpaceId);
 
 	switch (regionobject->Region.SpaceId) {
 	case ACPI_ADR_SPACE_SYSTEM_IO:
@@ -591,11 +593,11 @@ static void sem_alarm(int dummy)
 }
 
 /*
- *  AcpiOsWaitSemaphore()
- *	Override ACPICA AcpiOsWaitSemaphore to keep track of semaphore acquires
+ *  fwts_acpica_wait_semaphore()
+ *	Wait on a semaphore and keep track of semaphore acquires
  *	so that we can see if any methods are sloppy in their releases.
  */
-ACPI_STATUS AcpiOsWaitSemaphore(ACPI_HANDLE handle, UINT32 Units, UINT16 Timeout)
+static ACPI_STATUS fwts_acpica_wait_semaphore(ACPI_HANDLE handle, UINT16 Timeout)
 {
 	sem_info *sem = (sem_info *)handle;
 	struct timespec	tm;
@@ -657,6 +659,30 @@ ACPI_STATUS AcpiOsWaitSemaphore(ACPI_HANDLE handle, UINT32 Units, UINT16 Timeout
 	return AE_OK;
 }
 
+/*
+ *  AcpiOsWaitSemaphore()
+ *	Override ACPICA AcpiOsWaitSemaphore to account semaphore acquires
+ *	and, when profiling, the time methods spend waiting on them.
+ */
+ACPI_STATUS AcpiOsWaitSemaphore(ACPI_HANDLE handle, UINT32 Units, UINT16 Timeout)
+{
+	struct timespec start, end;
+	ACPI_STATUS status;
+
+	if (!fwts_acpica_profile_enabled())
+		return fwts_acpica_wait_semaphore(handle, Timeout);
+
+	(void)clock_gettime(CLOCK_MONOTONIC, &start);
+	status = fwts_acpica_wait_semaphore(handle, Timeout);
+	(void)clock_gettime(CLOCK_MONOTONIC, &end);
+
+	fwts_acpica_profile_sem_wait(
+		((uint64_t)(end.tv_sec - start.tv_sec) * 1000000000ULL) +
+		(uint64_t)end.tv_nsec - (uint64_t)start.tv_nsec);
+
+	return status;
+}
+
 /*
  *  AcpiOsSignalSemaphore()
  *	Override ACPICA AcpiOsSignalSemaphore to keep track of semaphore releases
@@ -1216,6 +1242,9 @@ int fwts_acpica_init(fwts_framework *fw)
 		fwts_acpica_RSDP = NULL;
 	}
 
+	/* Profile from the start so that _REG evaluations are included */
+	fwts_acpica_profile_init(fw);
+
 	if (ACPI_FAILURE(AcpiInitializeSubsystem())) {
 		fwts_log_error(fw, "Failed to initialise ACPICA subsystem.");
 		goto failed;
@@ -1265,6 +1294,7 @@ int fwts_acpica_init(fwts_framework *fw)
 	return FWTS_OK;
 
 failed:
+	fwts_acpica_profile_deinit();
 	AcpiTerminate();
 	return FWTS_ERROR;
 }
@@ -1281,6 +1311,7 @@ int fwts_acpica_deinit(void)
 	if (!fwts_acpica_init_called)
 		return FWTS_ERROR;
 
+	fwts_acpica_profile_deinit();
 	AcpiTerminate();
 	pthread_mutex_destroy(&mutex_lock_sem_table);
 	pthread_mutex_destroy(&mutex_thread_info);
@@ -0,0 +1,602 @@
+/*
+ * Copyright (C) 2026 Canonical
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "fwts.h"
+
+/* ACPICA specific headers */
+#include "acpi.h"
+#include "accommon.h"
+#include "acnamesp.h"
+#include "acinterp.h"
+
+/*
+ *  ACPI method profiler. The ACPICA method and opcode trace points in
+ *  extrace.c are renamed at build time (see Makefile.am) so that we can
+ *  hook them here, time each method and attribute opcodes, region
+ *  accesses and semaphore waits to the method currently executing.
+ */
+
+#define PROFILE_REGION_SPACES	(ACPI_NUM_PREDEFINED_REGIONS + 1)
+#define PROFILE_REGION_OTHER	(ACPI_NUM_PREDEFINED_REGIONS)
+#define PROFILE_REPORT_TOP	(20)	/* Methods shown in the hot method report */
+#define PROFILE_NODES_MIN	(256)	/* Initial node lookup hash size */
+
+/*
+ *  Per method statistics, kept per test for the whole fwts run
+ */
+typedef struct {
+	char		*test;		/* Name of test that evaluated the method */
+	char		*path;		/* Full method path name */
+	uint32_t	session;	/* ACPICA init session it was last used in */
+	uint32_t	max_depth;	/* Deepest nesting level, 1 = top level */
+	uint64_t	calls;		/* Number of invocations */
+	uint64_t	total_ns;	/* Time including nested method calls */
+	uint64_t	self_ns;	/* Time excluding nested method calls */
+	uint64_t	max_ns;		/* Longest single invocation */
+	uint64_t	opcodes;	/* AML opcodes executed */
+	uint64_t	sem_waits;	/* Semaphore/mutex waits */
+	uint64_t	sem_wait_ns;	/* Time spent waiting on semaphores */
+	uint64_t	regions[PROFILE_REGION_SPACES];	/* Region accesses per space id */
+} profile_method;
+
+/*
+ *  Call stack frame of a currently executing method
+ */
+typedef struct {
+	ACPI_OPERAND_OBJECT *obj;	/* Method object, matches start/stop */
+	size_t		method;		/* Index into profile_methods */
+	uint64_t	start_ns;	/* Time method started */
+	uint64_t	child_ns;	/* Time spent in nested methods */
+} profile_frame;
+
+/*
+ *  Method node to profile_methods index, valid for one ACPICA session
+ */
+typedef struct {
+	ACPI_NAMESPACE_NODE *node;
+	size_t		method;
+} profile_node;
+
+/* Renamed ACPICA trace points from extrace_munged.c */
+void __AcpiExStartTraceMethod(ACPI_NAMESPACE_NODE *MethodNode,
+	ACPI_OPERAND_OBJECT *ObjDesc, ACPI_WALK_STATE *WalkState);
+void __AcpiExStopTraceMethod(ACPI_NAMESPACE_NODE *MethodNode,
+	ACPI_OPERAND_OBJECT *ObjDesc, ACPI_WALK_STATE *WalkState);
+void __AcpiExStartTraceOpcode(ACPI_PARSE_OBJECT *Op,
+	ACPI_WALK_STATE *WalkState);
+
+static pthread_mutex_t	profile_mutex = PTHREAD_MUTEX_INITIALIZER;
+static fwts_framework	*profile_fw;
+static bool		profile_enabled;
+static uint32_t		profile_session;
+
+static profile_method	*profile_methods;
+static size_t		profile_methods_len;
+static size_t		profile_methods_size;
+
+static profile_frame	*profile_stack;
+static size_t		profile_stack_len;
+static size_t		profile_stack_size;
+
+static profile_node	*profile_nodes;
+static size_t		profile_nodes_len;
+static size_t		profile_nodes_size;
+
+static uint64_t profile_now(void)
+{
+	struct timespec ts;
+
+	(void)clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+static inline size_t profile_node_hash(const ACPI_NAMESPACE_NODE *node, const size_t size)
+{
+	return (size_t)((((uintptr_t)node >> 4) * 0x9e3779b1U) & (size - 1));
+}
+
+/*
+ *  profile_nodes_grow()
+ *	double the node lookup hash and rehash the existing entries
+ */
+static int profile_nodes_grow(void)
+{
+	const size_t size = profile_nodes_size ? profile_nodes_size * 2 : PROFILE_NODES_MIN;
+	profile_node *nodes;
+	size_t i;
+
+	if ((nodes = calloc(size, sizeof(*nodes))) == NULL)
+		return FWTS_ERROR;
+
+	for (i = 0; i < profile_nodes_size; i++) {
+		size_t h;
+
+		if (!profile_nodes[i].node)
+			continue;
+		h = profile_node_hash(profile_nodes[i].node, size);
+		while (nodes[h].node)
+			h = (h + 1) & (size - 1);
+		nodes[h] = profile_nodes[i];
+	}
+	free(profile_nodes);
+	profile_nodes = nodes;
+	profile_nodes_size = size;
+
+	return FWTS_OK;
+}
+
+/*
+ *  profile_method_add()
+ *	add a new method entry for the current test, returns index or -1
+ */
+static ssize_t profile_method_add(const char *path)
+{
+	const char *test = (profile_fw && profile_fw->current_major_test) ?
+		profile_fw->current_major_test->name : "";
+	profile_method *method;
+
+	if (profile_methods_len == profile_methods_size) {
+		const size_t size = profile_methods_size ? profile_methods_size * 2 : 64;
+		profile_method *methods;
+
+		methods = realloc(profile_methods, size * sizeof(*methods));
+		if (!methods)
+			return -1;
+		profile_methods = methods;
+		profile_methods_size = size;
+	}
+	method = &profile_methods[profile_methods_len];
+	memset(method, 0, sizeof(*method));
+	method->test = strdup(test);
+	method->path = strdup(path);
+	if (!method->test || !method->path) {
+		free(method->test);
+		free(method->path);
+		return -1;
+	}
+
+	return (ssize_t)profile_methods_len++;
+}
+
+/*
+ *  profile_method_lookup()
+ *	find the method entry for a method node, resolving the node
+ *	path name only the first time it is seen in this session.
+ *	Returns index or -1.
+ */
+static ssize_t profile_method_lookup(ACPI_NAMESPACE_NODE *node)
+{
+	const char *test = (profile_fw && profile_fw->current_major_test) ?
+		profile_fw->current_major_test->name : "";
+	ACPI_BUFFER buffer;
+	char path[1024];
+	size_t h, i;
+	ssize_t index = -1;
+
+	if ((profile_nodes_len + 1) * 2 > profile_nodes_size)
+		if (profile_nodes_grow() != FWTS_OK)
+			return -1;
+
+	for (h = profile_node_hash(node, profile_nodes_size);
+	     profile_nodes[h].node;
+	     h = (h + 1) & (profile_nodes_size - 1)) {
+		if (profile_nodes[h].node == node)
+			return (ssize_t)profile_nodes[h].method;
+	}
+
+	buffer.Pointer = path;
+	buffer.Length = sizeof(path);
+	if (ACPI_FAILURE(AcpiNsHandleToPathname(node, &buffer, TRUE)))
+		return -1;
+
+	/* Same method may have been seen by this test in an earlier session */
+	for (i = 0; i < profile_methods_len; i++) {
+		if (!strcmp(profile_methods[i].path, path) &&
+		    !strcmp(profile_methods[i].test, test)) {
+			index = (ssize_t)i;
+			break;
+		}
+	}
+	if (index < 0)
+		index = profile_method_add(path);
+
+	if (index >= 0) {
+		profile_nodes[h].node = node;
+		profile_nodes[h].method = (size_t)index;
+		profile_nodes_len++;
+	}
+
+	return index;
+}
+
+/*
+ *  AcpiExStartTraceMethod()
+ *	Override ACPICA AcpiExStartTraceMethod to push a method call frame
+ */
+void AcpiExStartTraceMethod(
+	ACPI_NAMESPACE_NODE	*MethodNode,
+	ACPI_OPERAND_OBJECT	*ObjDesc,
+	ACPI_WALK_STATE		*WalkState)
+{
+	if (profile_enabled && MethodNode) {
+		ssize_t index;
+
+		pthread_mutex_lock(&profile_mutex);
+		if (profile_stack_len == profile_stack_size) {
+			const size_t size = profile_stack_size ? profile_stack_size * 2 : 32;
+			profile_frame *stack = realloc(profile_stack, size * sizeof(*stack));
+
+			if (stack) {
+				profile_stack = stack;
+				profile_stack_size = size;
+			}
+		}
+		if ((profile_stack_len < profile_stack_size) &&
+		    ((index = profile_method_lookup(MethodNode)) >= 0)) {
+			profile_frame *frame = &profile_stack[profile_stack_len++];
+			profile_method *method = &profile_methods[index];
+
+			frame->obj = ObjDesc;
+			frame->method = (size_t)index;
+			frame->child_ns = 0;
+			method->session = profile_session;
+			if (method->max_depth < profile_stack_len)
+				method->max_depth = profile_stack_len;
+			frame->start_ns = profile_now();
+		}
+		pthread_mutex_unlock(&profile_mutex);
+	}
+
+	__AcpiExStartTraceMethod(MethodNode, ObjDesc, WalkState);
+}
+
+/*
+ *  AcpiExStopTraceMethod()
+ *	Override ACPICA AcpiExStopTraceMethod to pop a method call frame.
+ *	ACPICA can stop a method twice on error paths, so frames are matched
+ *	on the method object and unmatched stops are ignored.
+ */
+void AcpiExStopTraceMethod(
+	ACPI_NAMESPACE_NODE	*MethodNode,
+	ACPI_OPERAND_OBJECT	*ObjDesc,
+	ACPI_WALK_STATE		*WalkState)
+{
+	if (profile_enabled) {
+		const uint64_t now = profile_now();
+		size_t i;
+
+		pthread_mutex_lock(&profile_mutex);
+		for (i = profile_stack_len; i > 0; i--)
+			if (profile_stack[i - 1].obj == ObjDesc)
+				break;
+
+		/* Pop the matching frame and any frames left above it */
+		while (i > 0 && profile_stack_len >= i) {
+			profile_frame *frame = &profile_stack[--profile_stack_len];
+			profile_method *method = &profile_methods[frame->method];
+			const uint64_t elapsed = now - frame->start_ns;
+
+			method->calls++;
+			method->total_ns += elapsed;
+			method->self_ns += elapsed > frame->child_ns ?
+				elapsed - frame->child_ns : 0;
+			if (method->max_ns < elapsed)
+				method->max_ns = elapsed;
+			if (profile_stack_len)
+				profile_stack[profile_stack_len - 1].child_ns += elapsed;
+		}
+		pthread_mutex_unlock(&profile_mutex);
+	}
+
+	__AcpiExStopTraceMethod(MethodNode, ObjDesc, WalkState);
+}
+
+/*
+ *  AcpiExStartTraceOpcode()
+ *	Override ACPICA AcpiExStartTraceOpcode to count executed opcodes
+ */
+void AcpiExStartTraceOpcode(
+	ACPI_PARSE_OBJECT	*Op,
+	ACPI_WALK_STATE		*WalkState)
+{
+	if (profile_enabled) {
+		pthread_mutex_lock(&profile_mutex);
+		if (profile_stack_len)
+			profile_methods[profile_stack[profile_stack_len - 1].method].opcodes++;
+		pthread_mutex_unlock(&profile_mutex);
+	}
+
+	__AcpiExStartTraceOpcode(Op, WalkState);
+}
+
+/*
+ *  fwts_acpica_profile_enabled()
+ *	true if method profiling is enabled for this ACPICA session
+ */
+bool fwts_acpica_profile_enabled(void)
+{
+	return profile_enabled;
+}
+
+/*
+ *  fwts_acpica_profile_region()
+ *	account an operation region access to the executing method
+ */
+void fwts_acpica_profile_region(const uint8_t space_id)
+{
+	if (!profile_enabled)
+		return;
+
+	pthread_mutex_lock(&profile_mutex);
+	if (profile_stack_len) {
+		profile_method *method = &profile_methods[profile_stack[profile_stack_len - 1].method];
+
+		method->regions[space_id < ACPI_NUM_PREDEFINED_REGIONS ?
+			space_id : PROFILE_REGION_OTHER]++;
+	}
+	pthread_mutex_unlock(&profile_mutex);
+}
+
+/*
+ *  fwts_acpica_profile_sem_wait()
+ *	account a semaphore wait to the executing method
+ */
+void fwts_acpica_profile_sem_wait(const uint64_t wait_ns)
+{
+	if (!profile_enabled)
+		return;
+
+	pthread_mutex_lock(&profile_mutex);
+	if (profile_stack_len) {
+		profile_method *method = &profile_methods[profile_stack[profile_stack_len - 1].method];
+
+		method->sem_waits++;
+		method->sem_wait_ns += wait_ns;
+	}
+	pthread_mutex_unlock(&profile_mutex);
+}
+
+/*
+ *  fwts_acpica_profile_init()
+ *	start a method profiling session, called when ACPICA is initialised
+ */
+void fwts_acpica_profile_init(fwts_framework *fw)
+{
+	pthread_mutex_lock(&profile_mutex);
+	profile_fw = fw;
+	profile_session++;
+	profile_stack_len = 0;
+	profile_enabled = !!(fw->flags & FWTS_FLAG_ACPICA_PROFILE);
+	pthread_mutex_unlock(&profile_mutex);
+}
+
+static const char *profile_region_name(const int space_id)
+{
+	return space_id == PROFILE_REGION_OTHER ?
+		"Other" : AcpiUtGetRegionName((UINT8)space_id);
+}
+
+/*
+ *  profile_method_cmp()
+ *	sort methods, most self time first
+ */
+static int profile_method_cmp(const void *a, const void *b)
+{
+	const profile_method *m1 = *(const profile_method **)a;
+	const profile_method *m2 = *(const profile_method **)b;
+
+	if (m1->self_ns != m2->self_ns)
+		return m1->self_ns < m2->self_ns ? 1 : -1;
+	return strcmp(m1->path, m2->path);
+}
+
+/*
+ *  profile_report()
+ *	log the methods that took the most time in this session
+ */
+static void profile_report(fwts_framework *fw)
+{
+	profile_method **sorted;
+	size_t i, n = 0;
+
+	if ((sorted = calloc(profile_methods_len + 1, sizeof(*sorted))) == NULL)
+		return;
+
+	for (i = 0; i < profile_methods_len; i++)
+		if (profile_methods[i].session == profile_session &&
+		    profile_methods[i].calls)
+			sorted[n++] = &profile_methods[i];
+
+	if (n == 0) {
+		free(sorted);
+		return;
+	}
+	qsort(sorted, n, sizeof(*sorted), profile_method_cmp);
+
+	fwts_log_nl(fw);
+	fwts_log_info(fw, "ACPI method profile, %zu methods evaluated, "
+		"%zu with the most self time:", n,
+		n < PROFILE_REPORT_TOP ? n : PROFILE_REPORT_TOP);
+	fwts_log_info_verbatim(fw, "  %-32s %7s %10s %10s %10s %9s %7s %6s %5s",
+		"Method", "Calls", "Self ms", "Total ms", "Max ms",
+		"Opcodes", "Regions", "Waits", "Depth");
+
+	for (i = 0; i < n && i < PROFILE_REPORT_TOP; i++) {
+		const profile_method *method = sorted[i];
+		uint64_t regions = 0;
+		int j;
+
+		for (j = 0; j < PROFILE_REGION_SPACES; j++)
+			regions += method->regions[j];
+
+		fwts_log_info_verbatim(fw,
+			"  %-32s %7" PRIu64 " %10.3f %10.3f %10.3f %9" PRIu64
+			" %7" PRIu64 " %6" PRIu64 " %5" PRIu32,
+			method->path, method->calls,
+			(double)method->self_ns / 1000000.0,
+			(double)method->total_ns / 1000000.0,
+			(double)method->max_ns / 1000000.0,
+			method->opcodes, regions, method->sem_waits,
+			method->max_depth);
+	}
+	fwts_log_nl(fw);
+	free(sorted);
+}
+
+/*
+ *  profile_export_json()
+ *	write all method statistics gathered so far as a JSON array
+ */
+static void profile_export_json(FILE *fp)
+{
+	size_t i;
+
+	fprintf(fp, "{\n  \"acpi_method_profile\": [");
+	for (i = 0; i < profile_methods_len; i++) {
+		const profile_method *method = &profile_methods[i];
+		bool first = true;
+		int j;
+
+		fprintf(fp, "%s\n    {\n      \"test\": ", i ? "," : "");
+		fwts_json_escape(fp, method->test);
+		fprintf(fp, ",\n      \"method\": ");
+		fwts_json_escape(fp, method->path);
+		fprintf(fp, ",\n"
+			"      \"calls\": %" PRIu64 ",\n"
+			"      \"total_ns\": %" PRIu64 ",\n"
+			"      \"self_ns\": %" PRIu64 ",\n"
+			"      \"max_ns\": %" PRIu64 ",\n"
+			"      \"opcodes\": %" PRIu64 ",\n"
+			"      \"sem_waits\": %" PRIu64 ",\n"
+			"      \"sem_wait_ns\": %" PRIu64 ",\n"
+			"      \"max_depth\": %" PRIu32 ",\n"
+			"      \"region_accesses\": {",
+			method->calls, method->total_ns, method->self_ns,
+			method->max_ns, method->opcodes, method->sem_waits,
+			method->sem_wait_ns, method->max_depth);
+		for (j = 0; j < PROFILE_REGION_SPACES; j++) {
+			if (!method->regions[j])
+				continue;
+			fprintf(fp, "%s\n        ", first ? "" : ",");
+			fwts_json_escape(fp, profile_region_name(j));
+			fprintf(fp, ": %" PRIu64, method->regions[j]);
+			first = false;
+		}
+		fprintf(fp, "%s}\n    }", first ? "" : "\n      ");
+	}
+	fprintf(fp, "\n  ]\n}\n");
+}
+
+/*
+ *  profile_export_csv()
+ *	write all method statistics gathered so far as CSV
+ */
+static void profile_export_csv(FILE *fp)
+{
+	size_t i;
+	int j;
+
+	fprintf(fp, "test,method,calls,total_ns,self_ns,max_ns,opcodes,"
+		"sem_waits,sem_wait_ns,max_depth");
+	for (j = 0; j < PROFILE_REGION_SPACES; j++) {
+		fputc(',', fp);
+		fwts_csv_escape(fp, profile_region_name(j));
+	}
+	fputc('\n', fp);
+
+	for (i = 0; i < profile_methods_len; i++) {
+		const profile_method *method = &profile_methods[i];
+
+		fwts_csv_escape(fp, method->test);
+		fputc(',', fp);
+		fwts_csv_escape(fp, method->path);
+		fprintf(fp, ",%" PRIu64 ",%" PRIu64 ",%" PRIu64
+			",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu32,
+			method->calls, method->total_ns, method->self_ns,
+			method->max_ns, method->opcodes, method->sem_waits,
+			method->sem_wait_ns, method->max_depth);
+		for (j = 0; j < PROFILE_REGION_SPACES; j++)
+			fprintf(fp, ",%" PRIu64, method->regions[j]);
+		fputc('\n', fp);
+	}
+}
+
+/*
+ *  profile_export()
+ *	rewrite the export file with the statistics of every session so
+ *	far, JSON if the file name ends in .json, CSV otherwise
+ */
+static int profile_export(fwts_framework *fw, const char *filename)
+{
+	const size_t len = strlen(filename);
+	FILE *fp;
+
+	if ((fp = fopen(filename, "w")) == NULL) {
+		fwts_log_error(fw, "Cannot write ACPI method profile to %s.", filename);
+		return FWTS_ERROR;
+	}
+	if ((len > 5) && !strcasecmp(filename + len - 5, ".json"))
+		profile_export_json(fp);
+	else
+		profile_export_csv(fp);
+
+	if (fclose(fp)) {
+		fwts_log_error(fw, "Failed to write ACPI method profile to %s.", filename);
+		return FWTS_ERROR;
+	}
+
+	return FWTS_OK;
+}
+
+/*
+ *  fwts_acpica_profile_deinit()
+ *	end a method profiling session, log the hot method report and
+ *	update the export file
+ */
+void fwts_acpica_profile_deinit(void)
+{
+	pthread_mutex_lock(&profile_mutex);
+	if (profile_enabled) {
+		profile_enabled = false;
+		profile_report(profile_fw);
+		if (profile_fw->acpica_profile_path)
+			(void)profile_export(profile_fw, profile_fw->acpica_profile_path);
+	}
+
+	/* Method nodes are freed by AcpiTerminate(), forget them */
+	free(profile_nodes);
+	profile_nodes = NULL;
+	profile_nodes_len = 0;
+	profile_nodes_size = 0;
+	free(profile_stack);
+	profile_stack = NULL;
+	profile_stack_len = 0;
+	profile_stack_size = 0;
+	pthread_mutex_unlock(&profile_mutex);
+}
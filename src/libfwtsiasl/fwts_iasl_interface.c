@@ -17,11 +17,19 @@
  *
  */
 
+#define _GNU_SOURCE
+
 #include <unistd.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
 #include <sys/types.h>
+#include <sys/stat.h>
 #include <sys/wait.h>
+#include <sys/syscall.h>
 
 #include "fwts_iasl_interface.h"
 
@@ -29,6 +37,231 @@
 #include "acdisasm.h"
 #include "acapps.h"
 
+/*
+ *  Memory backed files. ACPICA only reads and writes files by name,
+ *  so the ACPICA sources that open files fwts hands to iasl are built
+ *  to call fwts_iasl_fopen() and names starting with FWTS_IASL_MEM_PATH
+ *  are opened from the memory file they map to
+ */
+typedef struct fwts_iasl_mem_file {
+	struct fwts_iasl_mem_file *next;
+	int fd;				/* memory file */
+	char name[];			/* name it is opened by */
+} fwts_iasl_mem_file;
+
+/*
+ *  A stream on a memory file, each has its own file offset
+ */
+typedef struct {
+	int fd;				/* memory file, not owned */
+	off64_t offset;			/* current file offset */
+	bool append;			/* always write at the end */
+} fwts_iasl_mem_stream;
+
+static fwts_iasl_mem_file *mem_files;
+
+/*
+ *  fwts_iasl_mem_fd()
+ *	create an anonymous memory file, returns -1 on failure
+ */
+int fwts_iasl_mem_fd(void)
+{
+	char tmpfile[] = "/tmp/fwts_iasl_XXXXXX";
+	int fd;
+
+#if defined(__NR_memfd_create)
+	if ((fd = (int)syscall(__NR_memfd_create, "fwts_iasl", 0)) >= 0)
+		return fd;
+#endif
+	/* No memfd support, use a file that is unlinked straight away */
+	if ((fd = mkstemp(tmpfile)) >= 0)
+		(void)unlink(tmpfile);
+
+	return fd;
+}
+
+/*
+ *  fwts_iasl_mem_file_find()
+ *	find the memory file a name maps to
+ */
+static fwts_iasl_mem_file *fwts_iasl_mem_file_find(const char *name)
+{
+	fwts_iasl_mem_file *file;
+
+	for (file = mem_files; file; file = file->next)
+		if (!strcmp(file->name, name))
+			return file;
+
+	return NULL;
+}
+
+/*
+ *  fwts_iasl_mem_file_add()
+ *	map name onto memory file fd, the caller still owns fd
+ */
+int fwts_iasl_mem_file_add(const char *name, const int fd)
+{
+	fwts_iasl_mem_file *file;
+	const size_t len = strlen(name) + 1;
+
+	if (fwts_iasl_mem_file_find(name))
+		return -1;
+	if ((file = malloc(sizeof(*file) + len)) == NULL)
+		return -1;
+	memcpy(file->name, name, len);
+	file->fd = fd;
+	file->next = mem_files;
+	mem_files = file;
+
+	return 0;
+}
+
+/*
+ *  fwts_iasl_mem_file_remove()
+ *	remove mapping for name, does not close the memory file
+ */
+void fwts_iasl_mem_file_remove(const char *name)
+{
+	fwts_iasl_mem_file **prev, *file;
+
+	for (prev = &mem_files; (file = *prev) != NULL; prev = &file->next) {
+		if (!strcmp(file->name, name)) {
+			*prev = file->next;
+			free(file);
+			return;
+		}
+	}
+}
+
+static ssize_t fwts_iasl_mem_stream_read(void *cookie, char *buf, size_t size)
+{
+	fwts_iasl_mem_stream *stream = (fwts_iasl_mem_stream *)cookie;
+	const ssize_t n = pread(stream->fd, buf, size, stream->offset);
+
+	if (n > 0)
+		stream->offset += n;
+	return n;
+}
+
+static ssize_t fwts_iasl_mem_stream_write(void *cookie, const char *buf, size_t size)
+{
+	fwts_iasl_mem_stream *stream = (fwts_iasl_mem_stream *)cookie;
+	ssize_t n;
+
+	if (stream->append) {
+		struct stat buffer;
+
+		if (fstat(stream->fd, &buffer) < 0)
+			return 0;
+		stream->offset = buffer.st_size;
+	}
+	if ((n = pwrite(stream->fd, buf, size, stream->offset)) < 0)
+		return 0;
+	stream->offset += n;
+	return n;
+}
+
+static int fwts_iasl_mem_stream_seek(void *cookie, off64_t *offset, int whence)
+{
+	fwts_iasl_mem_stream *stream = (fwts_iasl_mem_stream *)cookie;
+	struct stat buffer;
+	off64_t new_offset;
+
+	switch (whence) {
+	case SEEK_SET:
+		new_offset = *offset;
+		break;
+	case SEEK_CUR:
+		new_offset = stream->offset + *offset;
+		break;
+	case SEEK_END:
+		if (fstat(stream->fd, &buffer) < 0)
+			return -1;
+		new_offset = buffer.st_size + *offset;
+		break;
+	default:
+		errno = EINVAL;
+		return -1;
+	}
+	if (new_offset < 0) {
+		errno = EINVAL;
+		return -1;
+	}
+	stream->offset = new_offset;
+	*offset = new_offset;
+
+	return 0;
+}
+
+static int fwts_iasl_mem_stream_close(void *cookie)
+{
+	free(cookie);
+	return 0;
+}
+
+/*
+ *  fwts_iasl_mem_stream_open()
+ *	open a stream on memory file fd with its own file offset,
+ *	the memory file stays open when the stream is closed
+ */
+static FILE *fwts_iasl_mem_stream_open(const int fd, const char *mode)
+{
+	static const cookie_io_functions_t funcs = {
+		.read	= fwts_iasl_mem_stream_read,
+		.write	= fwts_iasl_mem_stream_write,
+		.seek	= fwts_iasl_mem_stream_seek,
+		.close	= fwts_iasl_mem_stream_close,
+	};
+	fwts_iasl_mem_stream *stream;
+	FILE *fp;
+
+	if ((*mode == 'w') && (ftruncate(fd, 0) < 0))
+		return NULL;
+	if ((stream = calloc(1, sizeof(*stream))) == NULL)
+		return NULL;
+	stream->fd = fd;
+	stream->append = (*mode == 'a');
+
+	if ((fp = fopencookie(stream, mode, funcs)) == NULL)
+		free(stream);
+
+	return fp;
+}
+
+/*
+ *  fwts_iasl_fopen()
+ *	fopen() for the ACPICA sources in libfwtsiasl, names under
+ *	FWTS_IASL_MEM_PATH are opened from their memory file, files
+ *	that ACPICA creates there (such as the .aml output) are created
+ *	as memory files too and are lost when the process exits
+ */
+FILE *fwts_iasl_fopen(const char *path, const char *mode)
+{
+	fwts_iasl_mem_file *file;
+
+	if (strncmp(path, FWTS_IASL_MEM_PATH, sizeof(FWTS_IASL_MEM_PATH) - 1))
+		return fopen(path, mode);
+
+	if ((file = fwts_iasl_mem_file_find(path)) == NULL) {
+		int fd;
+
+		if (*mode == 'r') {
+			errno = ENOENT;
+			return NULL;
+		}
+		if ((fd = fwts_iasl_mem_fd()) < 0)
+			return NULL;
+		if (fwts_iasl_mem_file_add(path, fd) < 0) {
+			(void)close(fd);
+			errno = ENOMEM;
+			return NULL;
+		}
+		file = mem_files;
+	}
+
+	return fwts_iasl_mem_stream_open(file->fd, mode);
+}
+
 static void AslInitialize(void)
 {
 	AcpiGbl_DmOpt_Verbose = FALSE;
@@ -20,8 +20,17 @@
 #ifndef __FWTS_IASL_INTERFACE__
 #define __FWTS_IASL_INTERFACE__
 
+#include <stdbool.h>
 #include <stdint.h>
+#include <stdio.h>
 
+/* Files opened by fwts_iasl_fopen() under this path are memory files */
+#define FWTS_IASL_MEM_PATH	"/dev/fwts-iasl/"
+
+int fwts_iasl_mem_fd(void);
+int fwts_iasl_mem_file_add(const char *name, const int fd);
+void fwts_iasl_mem_file_remove(const char *name);
+FILE *fwts_iasl_fopen(const char *path, const char *mode);
 int fwts_iasl_disassemble_aml(
 	char *tables[], char *names[], const int table_entries,
 	const int which, const bool use_externals,
@@ -259,10 +259,16 @@ static fwts_framework_minor_test cpu_info_tests[] = {
 	{ NULL, NULL }
 };
 
+static const char * const cpu_info_dt_subtrees[] = {
+	"/xscom",
+	NULL
+};
+
 static fwts_framework_ops cpu_info_ops = {
 	.description = "OPAL CPU Info",
 	.init        = cpu_info_init,
-	.minor_tests = cpu_info_tests
+	.minor_tests = cpu_info_tests,
+	.dt_subtrees = cpu_info_dt_subtrees
 };
 
 FWTS_REGISTER_FEATURES("cpu_info", &cpu_info_ops, FWTS_TEST_ANYTIME,
@@ -461,10 +461,16 @@ static fwts_framework_minor_test mem_info_tests[] = {
 	{ NULL, NULL }
 };
 
+static const char * const mem_info_dt_subtrees[] = {
+	"/memory-buffer",
+	NULL
+};
+
 static fwts_framework_ops mem_info_ops = {
 	.description = "OPAL MEM Info",
 	.init        = mem_info_init,
-	.minor_tests = mem_info_tests
+	.minor_tests = mem_info_tests,
+	.dt_subtrees = mem_info_dt_subtrees
 };
 
 FWTS_REGISTER_FEATURES("mem_info", &mem_info_ops, FWTS_TEST_ANYTIME,
@@ -372,10 +372,16 @@ static fwts_framework_minor_test mtd_info_tests[] = {
 	{ NULL, NULL }
 };
 
+static const char * const mtd_info_dt_subtrees[] = {
+	"/ibm,opal/nvram",
+	NULL
+};
+
 static fwts_framework_ops mtd_info_ops = {
 	.description = "OPAL MTD Info",
 	.init        = mtd_info_init,
-	.minor_tests = mtd_info_tests
+	.minor_tests = mtd_info_tests,
+	.dt_subtrees = mtd_info_dt_subtrees
 };
 
 FWTS_REGISTER_FEATURES("mtd_info", &mtd_info_ops, FWTS_TEST_ANYTIME,
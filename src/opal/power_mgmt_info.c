@@ -407,10 +407,17 @@ static fwts_framework_minor_test power_mgmt_tests[] = {
 	{ NULL, NULL }
 };
 
+static const char * const power_mgmt_dt_subtrees[] = {
+	"/ibm,opal/power-mgt",
+	"/cpus",
+	NULL
+};
+
 static fwts_framework_ops power_mgmt_tests_ops = {
 	.description = "OPAL Processor Power Management DT Validation Tests",
 	.init        = power_mgmt_init,
-	.minor_tests = power_mgmt_tests
+	.minor_tests = power_mgmt_tests,
+	.dt_subtrees = power_mgmt_dt_subtrees
 };
 
 FWTS_REGISTER_FEATURES("power_mgmt", &power_mgmt_tests_ops, FWTS_TEST_EARLY,
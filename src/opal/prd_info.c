@@ -212,10 +212,16 @@ static fwts_framework_minor_test prd_info_tests[] = {
 	{ NULL, NULL }
 };
 
+static const char * const prd_info_dt_subtrees[] = {
+	"/ibm,opal/diagnostics",
+	NULL
+};
+
 static fwts_framework_ops prd_info_ops = {
 	.description = "OPAL Processor Recovery Diagnostics Info",
 	.init        = prd_info_init,
-	.minor_tests = prd_info_tests
+	.minor_tests = prd_info_tests,
+	.dt_subtrees = prd_info_dt_subtrees
 };
 
 FWTS_REGISTER_FEATURES("prd_info", &prd_info_ops, FWTS_TEST_EARLY,
@@ -311,10 +311,16 @@ static fwts_framework_minor_test reserv_mem_tests[] = {
 	{ NULL, NULL }
 };
 
+static const char * const reserv_mem_dt_subtrees[] = {
+	"/reserved-memory",
+	NULL
+};
+
 static fwts_framework_ops reserv_mem_tests_ops = {
 	.description = "OPAL Reserved memory DT Validation Test",
 	.init        = reserv_mem_init,
-	.minor_tests = reserv_mem_tests
+	.minor_tests = reserv_mem_tests,
+	.dt_subtrees = reserv_mem_dt_subtrees
 };
 
 FWTS_REGISTER_FEATURES("reserv_mem", &reserv_mem_tests_ops, FWTS_TEST_EARLY,
@@ -100,7 +100,7 @@ static int acpi_table_sbbr_namespace_check_test1(fwts_framework *fw)
 	int error_count = 0;
 
 	/* Initializing ACPICA library so we can call AcpiWalkNamespace. */
-	if (fwts_acpica_init(fw) != FWTS_OK)
+	if (fwts_acpi_init(fw) != FWTS_OK)
 		return FWTS_ERROR;
 
 PRAGMA_PUSH
@@ -111,7 +111,7 @@ PRAGMA_NULL_PTR_MATH
 PRAGMA_POP
 
 	/* Deinitializing ACPICA, if we don't call this the terminal will break on exit. */
-	fwts_acpica_deinit();
+	fwts_acpi_deinit(fw);
 
 	/* error_count variable counts the number of processors outside of the _SB_ namespace. */
 	if (error_count > 0)
@@ -402,6 +402,6 @@ static fwts_framework_ops acpi_table_sbbr_check_ops = {
 	.minor_tests = acpi_table_sbbr_check_tests
 };
 
-FWTS_REGISTER("acpi_sbbr", &acpi_table_sbbr_check_ops, FWTS_TEST_ANYTIME, FWTS_FLAG_SBBR)
+FWTS_REGISTER("acpi_sbbr", &acpi_table_sbbr_check_ops, FWTS_TEST_ANYTIME, FWTS_FLAG_SBBR | FWTS_FLAG_ACPI_NAMESPACE)
 
 #endif
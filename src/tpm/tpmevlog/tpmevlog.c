@@ -28,59 +28,10 @@
 #include "fwts_tpm.h"
 #include "fwts_uefi.h"
 
-#define FWTS_TPM_DEVICE_PATH	"/sys/class/tpm"
 #define FWTS_TPM_LOG_DIR_PATH	"/sys/kernel/security"
 
-struct tpm_pcr_state {
-	uint8_t pcr[TPM2_FIRMWARE_PCR_COUNT][TPM2_SHA256_DIGEST_SIZE];
-};
-
 static bool tpmevlog_parsed = false;
-static struct tpm_pcr_state tpmevlog_pcrs = {};
-
-static int tpmevlog_read_device_pcrs(fwts_framework *fw, const char *tpm, struct tpm_pcr_state *pcrs)
-{
-	char path[PATH_MAX];
-	char buffer[TPM2_SHA256_DIGEST_SIZE * 2 + 2]; /* Trailing \n + NUL */
-	int i, j;
-	int fd;
-
-	memset(pcrs, 0, sizeof(*pcrs));
-	for (i = 0; i < TPM2_FIRMWARE_PCR_COUNT; i++) {
-		snprintf(path, sizeof(path), FWTS_TPM_DEVICE_PATH "/%s/pcr-sha256/%d",
-			tpm, i);
-
-		if ((fd = open(path, O_RDONLY)) >= 0) {
-			const ssize_t n = read(fd, buffer, sizeof(buffer) - 1);
-
-			if (n <= 0 || buffer[n - 1] != '\n') {
-				fwts_log_info(fw, "Cannot read TPM PCR%d value.", i);
-				(void)close(fd);
-				return FWTS_ERROR;
-			}
-
-			for (j = 0; j < (n - 1); j++) {
-				char c = toupper(buffer[j]);
-
-				if (!isxdigit(c)) {
-					fwts_log_info(fw, "Cannot parse TPM PCR%d value.", i);
-					(void)close(fd);
-					return FWTS_ERROR;
-				}
-
-				if (j & 1) {
-					pcrs->pcr[i][j >> 1] |= isdigit(c) ? c - '0' : c - 'A' + 10;
-				} else {
-					pcrs->pcr[i][j >> 1] = (isdigit(c) ? c - '0' : c - 'A' + 10) << 4;
-				}
-			}
-
-			(void)close(fd);
-		}
-	}
-
-	return FWTS_OK;
-}
+static fwts_tpm_replay tpmevlog_replay;
 
 static int tpmevlog_pcrindex_value_check(fwts_framework *fw, const uint32_t pcr)
 {
@@ -255,6 +206,11 @@ static int tpmevlog_v2_check(
 	fwts_spec_id_event_alg_sz *alg_sz;
 	bool separator_seen[TPM2_FIRMWARE_PCR_COUNT] = { false };
 	bool startuplocality_seen = false;
+	uint32_t event = 0;
+
+	/* Start the replay again if an earlier log could not be parsed */
+	if (!tpmevlog_parsed)
+		fwts_tpm_replay_free(&tpmevlog_replay);
 
 	/* specid_event_check */
 	if (len < sizeof(fwts_pc_client_pcr_event)) {
@@ -384,6 +340,7 @@ static int tpmevlog_v2_check(
 		}
 
 		pcr_event2 = (fwts_tcg_pcr_event2 *)pdata;
+		event++;
 		ret = tpmevlog_pcrindex_value_check(fw, pcr_event2->pcr_index);
 		if (ret != FWTS_OK)
 			return ret;
@@ -416,15 +373,14 @@ static int tpmevlog_v2_check(
 			}
 
 			/*
-			 * Extend the current PCR hash with the new hash from the log
+			 * Save the hash from the log to replay into the PCR bank later
 			 */
-			if ((!tpmevlog_parsed) && (alg_id == TPM2_ALG_SHA256) &&
+			if ((!tpmevlog_parsed) &&
 			    (pcr_event2->event_type != EV_NO_ACTION) &&
-			    (pcr_event2->pcr_index < TPM2_FIRMWARE_PCR_COUNT)) {
-				fwts_tpm_extend_pcr(tpmevlog_pcrs.pcr[pcr_event2->pcr_index],
-						TPM2_SHA256_DIGEST_SIZE,
-						alg_id,
-						pdata);
+			    (fwts_tpm_replay_add(&tpmevlog_replay, event,
+					pcr_event2->pcr_index, alg_id, pdata) != FWTS_OK)) {
+				fwts_log_error(fw, "Cannot allocate memory to replay the event log.");
+				return FWTS_ERROR;
 			}
 
 			pdata += hash_size;
@@ -459,8 +415,7 @@ static int tpmevlog_v2_check(
 		    event_size == 17 &&
 		    memcmp(pdata, "StartupLocality", sizeof("StartupLocality")) == 0) {
 			if (!startuplocality_seen) {
-				tpmevlog_pcrs.pcr[0][TPM2_SHA256_DIGEST_SIZE - 1] =
-					pdata[sizeof("StartupLocality")];
+				tpmevlog_replay.locality = pdata[sizeof("StartupLocality")];
 				startuplocality_seen = true;
 			} else {
 				fwts_failed(fw, LOG_LEVEL_MEDIUM, "EventV2StartupLocalitySeenTwice",
@@ -530,51 +485,20 @@ static int tpmevlog_check(fwts_framework *fw, uint8_t *data, size_t len)
 	return FWTS_OK;
 }
 
-static uint8_t *tpmevlog_load_file(const int fd, size_t *length)
+/*
+ *  tpmevlog_is_v2()
+ *	check for the crypto agile Spec ID event at the start of the log,
+ *	the log is not '\0' terminated when it has been mapped
+ */
+static bool tpmevlog_is_v2(const uint8_t *data, const size_t length)
 {
-	uint8_t *ptr = NULL, *tmp;
-	size_t size = 0;
-	char buffer[4096];
-
-	*length = 0;
+	const size_t len = sizeof(FWTS_TPM_EVENTLOG_V2_SIGNATURE) - 1;
 
-	for (;;) {
-		const ssize_t n = read(fd, buffer, sizeof(buffer));
+	if (length < sizeof(fwts_pc_client_pcr_event) + len)
+		return false;
 
-		if (n == 0)
-			break;
-		if (n < 0) {
-			if (errno != EINTR && errno != EAGAIN) {
-				free(ptr);
-				return NULL;
-			}
-			continue;
-		}
-		if (n > (ssize_t)sizeof(buffer))
-			goto err;
-		if (size + n > 0xffffffff)
-			goto err;
-
-		if ((tmp = (uint8_t*)realloc(ptr, size + n + 1)) == NULL) {
-			free(ptr);
-			return NULL;
-		}
-		ptr = tmp;
-		memcpy(ptr + size, buffer, n);
-		size += n;
-	}
-
-	if (!ptr || !size)
-		goto err_no_data;
-
-	*length = size;
-	return ptr;
-
-err:
-	free(ptr);
-err_no_data:
-	*length = 0;
-	return NULL;
+	return memcmp(data + sizeof(fwts_pc_client_pcr_event),
+		FWTS_TPM_EVENTLOG_V2_SIGNATURE, len) == 0;
 }
 
 static int tpmevlog_test1(fwts_framework *fw)
@@ -592,37 +516,29 @@ static int tpmevlog_test1(fwts_framework *fw)
 		tpmdir = readdir(dir);
 		if (tpmdir && strstr(tpmdir->d_name, "tpm")) {
 			char path[PATH_MAX];
-			int fd;
-			size_t length;
+			fwts_blob blob;
 
 			fwts_log_nl(fw);
 			fwts_log_info_verbatim(fw, "%s", tpmdir->d_name);
 
 			snprintf(path, sizeof(path), FWTS_TPM_LOG_DIR_PATH "/%s/binary_bios_measurements", tpmdir->d_name);
 
-			if ((fd = open(path, O_RDONLY)) >= 0) {
-				uint8_t *data;
-
-				data = tpmevlog_load_file(fd, &length);
+			if (fwts_blob_load(&blob, path) == FWTS_OK) {
 				tpm_logfile_found = true;
-				if (data == NULL) {
+				if (blob.data == NULL) {
 					fwts_log_info(fw, "Cannot load the TPM event logs. Aborted.");
 					(void)closedir(dir);
-					(void)close(fd);
 					return FWTS_ABORTED;
+				}
+				/* check if the TPM2 eventlog */
+				if (tpmevlog_is_v2(blob.data, blob.len)) {
+					fwts_log_info_verbatim(fw, "Crypto agile log format (TPM2.0):");
+					tpmevlog_v2_check(fw, blob.data, blob.len);
 				} else {
-					/* check if the TPM2 eventlog */
-					if (strstr((char *)(data + sizeof(fwts_pc_client_pcr_event)), FWTS_TPM_EVENTLOG_V2_SIGNATURE)) {
-						fwts_log_info_verbatim(fw, "Crypto agile log format (TPM2.0):");
-						tpmevlog_v2_check(fw, data, length);
-					} else {
-						fwts_log_info_verbatim(fw, "SHA1 log format (TPM1.2):");
-						tpmevlog_check(fw, data, length);
-					}
-
-					free(data);
+					fwts_log_info_verbatim(fw, "SHA1 log format (TPM1.2):");
+					tpmevlog_check(fw, blob.data, blob.len);
 				}
-				(void)close(fd);
+				fwts_blob_free(&blob);
 			}
 		}
 	} while (tpmdir);
@@ -638,29 +554,65 @@ static int tpmevlog_test1(fwts_framework *fw)
 
 static int tpmevlog_test2(fwts_framework *fw)
 {
-	struct tpm_pcr_state pcrs_actual = {};
+	int i, j, banks;
+	bool failed = false;
+
 	if (!tpmevlog_parsed) {
 		fwts_skipped(fw, "No TPM 2.0 event log has not been parsed, skipping.");
 		return FWTS_SKIP;
 	}
 
-	if (tpmevlog_read_device_pcrs(fw, "tpm0", &pcrs_actual) != FWTS_OK) {
+	banks = fwts_tpm_replay_verify(&tpmevlog_replay, "tpm0");
+	if (banks == 0) {
 		fwts_skipped(fw, "Could not read PCRs from TPM, skipping.");
 		return FWTS_SKIP;
 	}
 
-	for (int i = 0; i < TPM2_FIRMWARE_PCR_COUNT; i++) {
-		if (memcmp(pcrs_actual.pcr[i], tpmevlog_pcrs.pcr[i], TPM2_SHA256_DIGEST_SIZE) != 0) {
-			fwts_failed(fw, LOG_LEVEL_HIGH, "PCRsMatchEvLog",
-				"PCR %d differs between actual value and log.", i);
-			return FWTS_ERROR;
+	for (i = 0; i < FWTS_TPM_REPLAY_BANKS; i++) {
+		const fwts_tpm_replay_bank *bank = &tpmevlog_replay.banks[i];
+
+		if (!bank->active)
+			continue;
+		if (bank->len == 0) {
+			fwts_log_info(fw, "TPM %s PCR bank is active but the event log "
+				"has no %s digests.", bank->name, bank->name);
+			continue;
+		}
+		for (j = 0; j < TPM2_FIRMWARE_PCR_COUNT; j++) {
+			if (memcmp(bank->actual[j], bank->pcr[j], bank->size) == 0)
+				continue;
+
+			failed = true;
+			if (bank->diverge[j] == FWTS_TPM_REPLAY_EVENT_NONE)
+				fwts_failed(fw, LOG_LEVEL_HIGH, "PCRsMatchEvLog",
+					"PCR %d differs between actual %s value and log, "
+					"the log has no events for PCR %d.",
+					j, bank->name, j);
+			else
+				fwts_failed(fw, LOG_LEVEL_HIGH, "PCRsMatchEvLog",
+					"PCR %d differs between actual %s value and log, "
+					"first diverging event is log event %" PRIu32
+					" (%" PRIu32 " events extended into PCR %d).",
+					j, bank->name, bank->diverge[j], bank->pcr_events[j], j);
 		}
 	}
 
+	if (failed)
+		return FWTS_ERROR;
+
 	fwts_passed(fw, "Check TPM event log machines actual TPM PCRs.");
 	return FWTS_OK;
 }
 
+static int tpmevlog_deinit(fwts_framework *fw)
+{
+	FWTS_UNUSED(fw);
+
+	fwts_tpm_replay_free(&tpmevlog_replay);
+
+	return FWTS_OK;
+}
+
 static fwts_framework_minor_test tpmevlog_tests[] = {
 	{ tpmevlog_test1, "Sanity check TPM event log." },
 	{ tpmevlog_test2, "Check TPM event log matches TPM PCRs." },
@@ -669,6 +621,7 @@ static fwts_framework_minor_test tpmevlog_tests[] = {
 
 static fwts_framework_ops tpmevlog_ops = {
 	.description = "Sanity check TPM event log.",
+	.deinit      = tpmevlog_deinit,
 	.minor_tests = tpmevlog_tests
 };
 
@@ -444,51 +444,20 @@ static void tpmevlogdump_event_dump(
 }
 
 
-static uint8_t *tpmevlogdump_load_file(const int fd, size_t *length)
+/*
+ *  tpmevlogdump_is_v2()
+ *	check for the crypto agile Spec ID event at the start of the log,
+ *	the log is not '\0' terminated when it has been mapped
+ */
+static bool tpmevlogdump_is_v2(const uint8_t *data, const size_t length)
 {
-	uint8_t *ptr = NULL, *tmp;
-	size_t size = 0;
-	char buffer[4096];
-
-	*length = 0;
-
-	for (;;) {
-		const ssize_t n = read(fd, buffer, sizeof(buffer));
-
-		if (n == 0)
-			break;
-		if (n < 0) {
-			if (errno != EINTR && errno != EAGAIN) {
-				free(ptr);
-				return NULL;
-			}
-			continue;
-		}
-		if (n > (ssize_t)sizeof(buffer))
-			goto err;
-		if (size + n > 0xffffffff)
-			goto err;
-
-		if ((tmp = (uint8_t*)realloc(ptr, size + n + 1)) == NULL) {
-			free(ptr);
-			return NULL;
-		}
-		ptr = tmp;
-		memcpy(ptr + size, buffer, n);
-		size += n;
-	}
+	const size_t len = sizeof(FWTS_TPM_EVENTLOG_V2_SIGNATURE) - 1;
 
-	if (!ptr || !size)
-		goto err_no_data;
+	if (length < sizeof(fwts_pc_client_pcr_event) + len)
+		return false;
 
-	*length = size;
-	return ptr;
-
-err:
-	free(ptr);
-err_no_data:
-	*length = 0;
-	return NULL;
+	return memcmp(data + sizeof(fwts_pc_client_pcr_event),
+		FWTS_TPM_EVENTLOG_V2_SIGNATURE, len) == 0;
 }
 
 static int tpmevlogdump_test1(fwts_framework *fw)
@@ -506,36 +475,29 @@ static int tpmevlogdump_test1(fwts_framework *fw)
 		tpmdir = readdir(dir);
 		if (tpmdir && strstr(tpmdir->d_name, "tpm")) {
 			char path[PATH_MAX];
-			int fd;
-			size_t length;
+			fwts_blob blob;
 
 			fwts_log_nl(fw);
 			fwts_log_info_verbatim(fw, "%s", tpmdir->d_name);
 
 			snprintf(path, sizeof(path), FWTS_TPM_LOG_DIR_PATH "/%s/binary_bios_measurements", tpmdir->d_name);
 
-			if ((fd = open(path, O_RDONLY)) >= 0) {
-				uint8_t *data;
-
-				data = tpmevlogdump_load_file(fd, &length);
+			if (fwts_blob_load(&blob, path) == FWTS_OK) {
 				tpm_logfile_found = true;
-				if (data == NULL) {
+				if (blob.data == NULL) {
 					fwts_log_info(fw, "Cannot load the tpm event logs. Aborted.");
 					(void)closedir(dir);
-					(void)close(fd);
 					return FWTS_ABORTED;
+				}
+				/* check if the TPM2 eventlog */
+				if (tpmevlogdump_is_v2(blob.data, blob.len)) {
+					fwts_log_info_verbatim(fw, "Crypto agile log format (TPM2.0):");
+					tpmevlogdump_parser(fw, blob.data, blob.len);
 				} else {
-					/* check if the TPM2 eventlog */
-					if (strstr((char *)(data + sizeof(fwts_pc_client_pcr_event)), FWTS_TPM_EVENTLOG_V2_SIGNATURE)) {
-						fwts_log_info_verbatim(fw, "Crypto agile log format (TPM2.0):");
-						tpmevlogdump_parser(fw, data, length);
-					} else {
-						fwts_log_info_verbatim(fw, "SHA1 log format (TPM1.2):");
-						(void)tpmevlogdump_event_dump(fw, data, length);
-					}
-					free(data);
+					fwts_log_info_verbatim(fw, "SHA1 log format (TPM1.2):");
+					(void)tpmevlogdump_event_dump(fw, blob.data, blob.len);
 				}
-				(void)close(fd);
+				fwts_blob_free(&blob);
 			}
 		}
 	} while (tpmdir);
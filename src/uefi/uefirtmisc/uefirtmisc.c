@@ -29,6 +29,7 @@
 #include "fwts_uefi.h"
 #include "fwts_efi_runtime.h"
 #include "fwts_efi_module.h"
+#include "fwts_uefi_latency.h"
 
 #define CAPSULE_FLAGS_PERSIST_ACROSS_RESET 0x00010000
 #define CAPSULE_FLAGS_POPULATE_SYSTEM_TABLE 0x00020000
@@ -86,7 +87,7 @@ static int getnexthighmonotoniccount_test(fwts_framework *fw, uint32_t multitest
 
 	for (i = 0; i < multitesttime; i++) {
 		status = ~0ULL;
-		long ioret = ioctl(fd, EFI_RUNTIME_GET_NEXTHIGHMONOTONICCOUNT, &getnexthighmonotoniccount);
+		long ioret = fwts_uefi_rt_ioctl(fd, EFI_RUNTIME_GET_NEXTHIGHMONOTONICCOUNT, &getnexthighmonotoniccount);
 
 		if (ioret == -1) {
 			if (status == EFI_UNSUPPORTED) {
@@ -144,7 +145,7 @@ static int querycapsulecapabilities_test(fwts_framework *fw, uint32_t multitestt
 
 	for (i = 0; i < multitesttime; i++) {
 		status = ~0ULL;
-		long ioret = ioctl(fd, EFI_RUNTIME_QUERY_CAPSULECAPABILITIES, &querycapsulecapabilities);
+		long ioret = fwts_uefi_rt_ioctl(fd, EFI_RUNTIME_QUERY_CAPSULECAPABILITIES, &querycapsulecapabilities);
 		if (ioret == -1) {
 			if (status == EFI_UNSUPPORTED) {
 				fwts_skipped(fw, "Not support the UEFI QueryCapsuleCapabilities runtime interface"
@@ -267,7 +268,7 @@ static int uefirtmisc_test3(fwts_framework *fw)
 	getnexthighmonotoniccount.HighCount = NULL;
 	getnexthighmonotoniccount.status = &status;
 
-	ioret = ioctl(fd, EFI_RUNTIME_GET_NEXTHIGHMONOTONICCOUNT, &getnexthighmonotoniccount);
+	ioret = fwts_uefi_rt_ioctl(fd, EFI_RUNTIME_GET_NEXTHIGHMONOTONICCOUNT, &getnexthighmonotoniccount);
 	if (ioret == -1) {
 		if (status == EFI_UNSUPPORTED) {
 			fwts_skipped(fw, "Skipping test, GetNextHighMonotonicCount runtime "
@@ -302,7 +303,7 @@ static int uefirtmisc_test4(fwts_framework *fw)
 		getnexthighmonotoniccount.status = &status;
 		status = ~0ULL;
 
-		ioret = ioctl(fd, EFI_RUNTIME_GET_NEXTHIGHMONOTONICCOUNT, &getnexthighmonotoniccount);
+		ioret = fwts_uefi_rt_ioctl(fd, EFI_RUNTIME_GET_NEXTHIGHMONOTONICCOUNT, &getnexthighmonotoniccount);
 		if (ioret == -1) {
 			if (status == EFI_UNSUPPORTED)
 				fwts_passed(fw, "UEFI GetNextHighMonotonicCount runtime "
@@ -387,6 +388,7 @@ static fwts_framework_minor_test uefirtmisc_tests[] = {
 	{ uefirtmisc_test2, "Stress test for UEFI miscellaneous runtime service interfaces." },
 	{ uefirtmisc_test3, "Test GetNextHighMonotonicCount with invalid NULL parameter." },
 	{ uefirtmisc_test4, "Test UEFI miscellaneous runtime services unsupported status." },
+	{ fwts_uefi_latency_check, "Check UEFI RT service call latency." },
 	{ NULL, NULL }
 };
 
@@ -30,6 +30,7 @@
 #include "fwts_uefi.h"
 #include "fwts_efi_runtime.h"
 #include "fwts_efi_module.h"
+#include "fwts_uefi_latency.h"
 
 #define UEFI_IGNORE_UNSET_BITS	(0)
 
@@ -210,7 +211,7 @@ static int uefirttime_test1(fwts_framework *fw)
 	gettime.Time = &efi_time;
 	gettime.status = &status;
 
-	ioret = ioctl(fd, EFI_RUNTIME_GET_TIME, &gettime);
+	ioret = fwts_uefi_rt_ioctl(fd, EFI_RUNTIME_GET_TIME, &gettime);
 
 	if (ioret == -1) {
 		if (status == EFI_UNSUPPORTED) {
@@ -251,7 +252,7 @@ static int uefirttime_test_gettime_invalid(
 	gettime.Time = efi_time;
 	gettime.status = &status;
 
-	ioret = ioctl(fd, EFI_RUNTIME_GET_TIME, &gettime);
+	ioret = fwts_uefi_rt_ioctl(fd, EFI_RUNTIME_GET_TIME, &gettime);
 	if (ioret == -1) {
 		if (status == EFI_UNSUPPORTED) {
 			fwts_skipped(fw, "Skipping test, GetTime runtime "
@@ -308,7 +309,7 @@ static int uefirttime_test4(fwts_framework *fw)
 	gettime.Capabilities = &efi_time_cap;
 	gettime.Time = &oldtime;
 	gettime.status = &status;
-	ioret = ioctl(fd, EFI_RUNTIME_GET_TIME, &gettime);
+	ioret = fwts_uefi_rt_ioctl(fd, EFI_RUNTIME_GET_TIME, &gettime);
 
 	if (ioret == -1) {
 		if (status == EFI_UNSUPPORTED) {
@@ -359,7 +360,7 @@ static int uefirttime_test4(fwts_framework *fw)
 	status = ~0ULL;
 	settime.status = &status;
 
-	ioret = ioctl(fd, EFI_RUNTIME_SET_TIME, &settime);
+	ioret = fwts_uefi_rt_ioctl(fd, EFI_RUNTIME_SET_TIME, &settime);
 	if (ioret == -1) {
 		if (status == EFI_UNSUPPORTED) {
 			fwts_skipped(fw, "Skipping test, SetTime runtime "
@@ -377,7 +378,7 @@ static int uefirttime_test4(fwts_framework *fw)
 	gettime.Time = &newtime;
 	status = ~0ULL;
 
-	ioret = ioctl(fd, EFI_RUNTIME_GET_TIME, &gettime);
+	ioret = fwts_uefi_rt_ioctl(fd, EFI_RUNTIME_GET_TIME, &gettime);
 
 	if (ioret == -1) {
 		if (status == EFI_UNSUPPORTED) {
@@ -429,7 +430,7 @@ static int uefirttime_test4(fwts_framework *fw)
 	/* restore the previous time. */
 	settime.Time = &oldtime;
 	status = ~0ULL;
-	ioret = ioctl(fd, EFI_RUNTIME_SET_TIME, &settime);
+	ioret = fwts_uefi_rt_ioctl(fd, EFI_RUNTIME_SET_TIME, &settime);
 	if (ioret == -1) {
 		if (status == EFI_UNSUPPORTED) {
 			fwts_skipped(fw, "Skipping test, SetTime runtime "
@@ -463,7 +464,7 @@ static int uefirttime_test_settime_invalid(
 	status = ~0ULL;
 	settime->status = &status;
 
-	ioret = ioctl(fd, EFI_RUNTIME_SET_TIME, settime);
+	ioret = fwts_uefi_rt_ioctl(fd, EFI_RUNTIME_SET_TIME, settime);
 	if (ioret == -1) {
 		if (status == EFI_UNSUPPORTED) {
 			fwts_skipped(fw, "Skipping test, SetTime runtime "
@@ -506,7 +507,7 @@ static int uefirttime_test_settime_invalid_time(
 	gettime.status = &status;
 	gettime.Capabilities = NULL;
 
-	ioret = ioctl(fd, EFI_RUNTIME_GET_TIME, &gettime);
+	ioret = fwts_uefi_rt_ioctl(fd, EFI_RUNTIME_GET_TIME, &gettime);
 	if (ioret == -1) {
 		if (status == EFI_UNSUPPORTED) {
 			fwts_skipped(fw, "Skipping test, GetTime runtime "
@@ -549,7 +550,7 @@ static int uefirttime_test_settime_invalid_time(
 	settime.Time = &oldtime;
 	status = ~0ULL;
 	settime.status = &status;
-	ioret = ioctl(fd, EFI_RUNTIME_SET_TIME, &settime);
+	ioret = fwts_uefi_rt_ioctl(fd, EFI_RUNTIME_SET_TIME, &settime);
 	if (ioret == -1) {
 		if (status == EFI_UNSUPPORTED) {
 			fwts_skipped(fw, "Skipping test, SetTime runtime "
@@ -710,7 +711,7 @@ static int uefirttime_test18(fwts_framework *fw)
 	getwakeuptime.Time = &efi_time;
 	getwakeuptime.status = &status;
 
-	ioret = ioctl(fd, EFI_RUNTIME_GET_WAKETIME, &getwakeuptime);
+	ioret = fwts_uefi_rt_ioctl(fd, EFI_RUNTIME_GET_WAKETIME, &getwakeuptime);
 	if (ioret == -1) {
 		if (status == EFI_UNSUPPORTED) {
 			fwts_skipped(fw, "Skipping test, GetWakeupTime runtime "
@@ -747,7 +748,7 @@ static int uefirttime_test_getwaketime_invalid(
 	status = ~0ULL;
 	getwakeuptime->status = &status;
 
-	ioret = ioctl(fd, EFI_RUNTIME_GET_WAKETIME, getwakeuptime);
+	ioret = fwts_uefi_rt_ioctl(fd, EFI_RUNTIME_GET_WAKETIME, getwakeuptime);
 	if (ioret == -1) {
 		if (status == EFI_UNSUPPORTED) {
 			fwts_skipped(fw, "Skipping test, GetTimeWakeupTime runtime "
@@ -844,7 +845,7 @@ static int uefirttime_test23(fwts_framework *fw)
 	gettime.Time = &oldtime;
 	gettime.status = &status;
 
-	ioret = ioctl(fd, EFI_RUNTIME_GET_TIME, &gettime);
+	ioret = fwts_uefi_rt_ioctl(fd, EFI_RUNTIME_GET_TIME, &gettime);
 
 	if (ioret == -1) {
 		if (status == EFI_UNSUPPORTED) {
@@ -872,7 +873,7 @@ static int uefirttime_test23(fwts_framework *fw)
 	setwakeuptime.status = &status;
 	setwakeuptime.Enabled = true;
 
-	ioret = ioctl(fd, EFI_RUNTIME_SET_WAKETIME, &setwakeuptime);
+	ioret = fwts_uefi_rt_ioctl(fd, EFI_RUNTIME_SET_WAKETIME, &setwakeuptime);
 	if (ioret == -1) {
 		if (status == EFI_UNSUPPORTED) {
 			fwts_skipped(fw, "Skipping test, SetWakeupTime runtime "
@@ -899,7 +900,7 @@ static int uefirttime_test23(fwts_framework *fw)
 	status = ~0ULL;
 	getwakeuptime.status = &status;
 
-	ioret = ioctl(fd, EFI_RUNTIME_GET_WAKETIME, &getwakeuptime);
+	ioret = fwts_uefi_rt_ioctl(fd, EFI_RUNTIME_GET_WAKETIME, &getwakeuptime);
 	if (ioret == -1) {
 		if (status == EFI_UNSUPPORTED) {
 			fwts_skipped(fw, "Skipping test, GetWakeupTime runtime "
@@ -934,7 +935,7 @@ static int uefirttime_test23(fwts_framework *fw)
 	setwakeuptime.Enabled = false;
 	status = ~0ULL;
 
-	ioret = ioctl(fd, EFI_RUNTIME_SET_WAKETIME, &setwakeuptime);
+	ioret = fwts_uefi_rt_ioctl(fd, EFI_RUNTIME_SET_WAKETIME, &setwakeuptime);
 	if (ioret == -1) {
 		if (status == EFI_UNSUPPORTED) {
 			fwts_skipped(fw, "Skipping test, SetWakeupTime runtime "
@@ -950,7 +951,7 @@ static int uefirttime_test23(fwts_framework *fw)
 	sleep(1);
 	status = ~0ULL;
 
-	ioret = ioctl(fd, EFI_RUNTIME_GET_WAKETIME, &getwakeuptime);
+	ioret = fwts_uefi_rt_ioctl(fd, EFI_RUNTIME_GET_WAKETIME, &getwakeuptime);
 	if (ioret == -1) {
 		if (status == EFI_UNSUPPORTED) {
 			fwts_skipped(fw, "Skipping test, GetWakeupTime runtime "
@@ -991,7 +992,7 @@ static int uefirttime_test_setwakeuptime_invalid(
 	status = ~0ULL;
 	setwakeuptime->status = &status;
 
-	ioret = ioctl(fd, EFI_RUNTIME_SET_WAKETIME, setwakeuptime);
+	ioret = fwts_uefi_rt_ioctl(fd, EFI_RUNTIME_SET_WAKETIME, setwakeuptime);
 	if (ioret == -1) {
 		if (status == EFI_UNSUPPORTED) {
 			fwts_skipped(fw, "Skipping test, SetWakeupTime runtime "
@@ -1046,7 +1047,7 @@ static int uefirttime_test_setwakeuptime_invalid_time(
 	getwakeuptime.Time = &oldtime;
 	getwakeuptime.status = &status;
 
-	ioret = ioctl(fd, EFI_RUNTIME_GET_WAKETIME, &getwakeuptime);
+	ioret = fwts_uefi_rt_ioctl(fd, EFI_RUNTIME_GET_WAKETIME, &getwakeuptime);
 	if (ioret == -1) {
 		if (status == EFI_UNSUPPORTED) {
 			fwts_skipped(fw, "Skipping test, GetWakeupTime runtime "
@@ -1091,7 +1092,7 @@ static int uefirttime_test_setwakeuptime_invalid_time(
 	status = ~0ULL;
 	setwakeuptime.status = &status;
 	setwakeuptime.Enabled = true;
-	ioret = ioctl(fd, EFI_RUNTIME_SET_WAKETIME, &setwakeuptime);
+	ioret = fwts_uefi_rt_ioctl(fd, EFI_RUNTIME_SET_WAKETIME, &setwakeuptime);
 	if (ioret == -1) {
 		if (status == EFI_UNSUPPORTED) {
 			fwts_skipped(fw, "Skipping test, SetWakeupTime runtime "
@@ -1252,7 +1253,7 @@ static int uefirttime_test38(fwts_framework *fw)
 		gettime.Time = &efi_time;
 		gettime.status = &status;
 
-		ioret = ioctl(fd, EFI_RUNTIME_GET_TIME, &gettime);
+		ioret = fwts_uefi_rt_ioctl(fd, EFI_RUNTIME_GET_TIME, &gettime);
 		if (ioret == -1) {
 			if (status == EFI_UNSUPPORTED)
 				fwts_passed(fw, "UEFI GetTime runtime service "
@@ -1289,7 +1290,7 @@ static int uefirttime_test38(fwts_framework *fw)
 		status = ~0ULL;
 		settime.status = &status;
 
-		ioret = ioctl(fd, EFI_RUNTIME_SET_TIME, &settime);
+		ioret = fwts_uefi_rt_ioctl(fd, EFI_RUNTIME_SET_TIME, &settime);
 		if (ioret == -1) {
 			if (status == EFI_UNSUPPORTED) {
 				fwts_passed(fw, "UEFI SetTime runtime service "
@@ -1321,7 +1322,7 @@ static int uefirttime_test38(fwts_framework *fw)
 		setwakeuptime.status = &status;
 		setwakeuptime.Enabled = false;
 
-		ioret = ioctl(fd, EFI_RUNTIME_SET_WAKETIME, &setwakeuptime);
+		ioret = fwts_uefi_rt_ioctl(fd, EFI_RUNTIME_SET_WAKETIME, &setwakeuptime);
 		if (ioret == -1) {
 			if (status == EFI_UNSUPPORTED)
 						fwts_passed(fw, "UEFI SetWakeupTime runtime service "
@@ -1354,7 +1355,7 @@ static int uefirttime_test38(fwts_framework *fw)
 		getwakeuptime.Time = &efi_time;
 		getwakeuptime.status = &status;
 
-		ioret = ioctl(fd, EFI_RUNTIME_GET_WAKETIME, &getwakeuptime);
+		ioret = fwts_uefi_rt_ioctl(fd, EFI_RUNTIME_GET_WAKETIME, &getwakeuptime);
 		if (ioret == -1) {
 			if (status == EFI_UNSUPPORTED)
 					fwts_passed(fw, "UEFI GetWakeupTime runtime service "
@@ -1429,6 +1430,7 @@ static fwts_framework_minor_test uefirttime_tests[] = {
 	{ uefirttime_test37, "Test UEFI RT service set wakeup time interface, invalid daylight 0xfc." },
 #endif
 	{ uefirttime_test38, "Test UEFI RT time services unsupported status." },
+	{ fwts_uefi_latency_check, "Check UEFI RT service call latency." },
 	{ NULL, NULL }
 };
 
@@ -29,6 +29,7 @@
 #include "fwts_uefi.h"
 #include "fwts_efi_runtime.h"
 #include "fwts_efi_module.h"
+#include "fwts_uefi_latency.h"
 
 #define TEST_GUID1 \
 { \
@@ -79,20 +80,20 @@ static void uefirtvariable_env_cleanup(void)
 	setvariable.Data = &data;
 	status = ~0ULL;
 	setvariable.status = &status;
-	(void)ioctl(fd, EFI_RUNTIME_SET_VARIABLE, &setvariable);
+	(void)fwts_uefi_rt_ioctl(fd, EFI_RUNTIME_SET_VARIABLE, &setvariable);
 
 	status = ~0ULL;
 	setvariable.VariableName = variablenametest2;
-	(void)ioctl(fd, EFI_RUNTIME_SET_VARIABLE, &setvariable);
+	(void)fwts_uefi_rt_ioctl(fd, EFI_RUNTIME_SET_VARIABLE, &setvariable);
 
 	status = ~0ULL;
 	setvariable.VariableName = variablenametest3;
-	(void)ioctl(fd, EFI_RUNTIME_SET_VARIABLE, &setvariable);
+	(void)fwts_uefi_rt_ioctl(fd, EFI_RUNTIME_SET_VARIABLE, &setvariable);
 
 	status = ~0ULL;
 	setvariable.VariableName = variablenametest;
 	setvariable.VendorGuid = &gtestguid2;
-	(void)ioctl(fd, EFI_RUNTIME_SET_VARIABLE, &setvariable);
+	(void)fwts_uefi_rt_ioctl(fd, EFI_RUNTIME_SET_VARIABLE, &setvariable);
 }
 
 static int uefirtvariable_init(fwts_framework *fw)
@@ -150,7 +151,7 @@ static int getvariable_test(
 	setvariable.Data = data;
 	setvariable.status = &status;
 
-	ioret = ioctl(fd, EFI_RUNTIME_SET_VARIABLE, &setvariable);
+	ioret = fwts_uefi_rt_ioctl(fd, EFI_RUNTIME_SET_VARIABLE, &setvariable);
 
 	if (ioret == -1) {
 		if (status == EFI_UNSUPPORTED) {
@@ -190,7 +191,7 @@ static int getvariable_test(
 
 	for (i = 0; i < multitesttime; i++) {
 		status = ~0ULL;
-		ioret = ioctl(fd, EFI_RUNTIME_GET_VARIABLE, &getvariable);
+		ioret = fwts_uefi_rt_ioctl(fd, EFI_RUNTIME_GET_VARIABLE, &getvariable);
 		if (ioret == -1) {
 			if (status == EFI_UNSUPPORTED) {
 				fwts_skipped(fw, "Skipping test, GetVariable runtime "
@@ -241,7 +242,7 @@ static int getvariable_test(
 	setvariable.DataSize = 0;
 	status = ~0ULL;
 
-	ioret = ioctl(fd, EFI_RUNTIME_SET_VARIABLE, &setvariable);
+	ioret = fwts_uefi_rt_ioctl(fd, EFI_RUNTIME_SET_VARIABLE, &setvariable);
 
 	if (ioret == -1) {
 		fwts_failed(fw, LOG_LEVEL_HIGH, "UEFIRuntimeSetVariable",
@@ -257,7 +258,7 @@ err_restore_env:
 	setvariable.DataSize = 0;
 	status = ~0ULL;
 
-	ioret = ioctl(fd, EFI_RUNTIME_SET_VARIABLE, &setvariable);
+	ioret = fwts_uefi_rt_ioctl(fd, EFI_RUNTIME_SET_VARIABLE, &setvariable);
 
 	if (ioret == -1) {
 		fwts_failed(fw, LOG_LEVEL_HIGH, "UEFIRuntimeSetVariable",
@@ -339,7 +340,7 @@ static int getnextvariable_test1(fwts_framework *fw)
 	setvariable.Data = data;
 	setvariable.status = &status;
 
-	ioret = ioctl(fd, EFI_RUNTIME_SET_VARIABLE, &setvariable);
+	ioret = fwts_uefi_rt_ioctl(fd, EFI_RUNTIME_SET_VARIABLE, &setvariable);
 
 	if (ioret == -1) {
 		if (status == EFI_UNSUPPORTED) {
@@ -389,7 +390,7 @@ static int getnextvariable_test1(fwts_framework *fw)
 	while (true) {
 		variablenamesize = maxvariablenamesize;
 		status = ~0ULL;
-		ioret = ioctl(fd, EFI_RUNTIME_GET_NEXTVARIABLENAME, &getnextvariablename);
+		ioret = fwts_uefi_rt_ioctl(fd, EFI_RUNTIME_GET_NEXTVARIABLENAME, &getnextvariablename);
 
 		if (ioret == -1) {
 			if (status == EFI_UNSUPPORTED) {
@@ -460,7 +461,7 @@ static int getnextvariable_test1(fwts_framework *fw)
 	setvariable.DataSize = 0;
 	status = ~0ULL;
 
-	ioret = ioctl(fd, EFI_RUNTIME_SET_VARIABLE, &setvariable);
+	ioret = fwts_uefi_rt_ioctl(fd, EFI_RUNTIME_SET_VARIABLE, &setvariable);
 
 	if (ioret == -1) {
 		fwts_failed(fw, LOG_LEVEL_HIGH, "UEFIRuntimeSetVariable",
@@ -476,7 +477,7 @@ err_restore_env:
 	setvariable.DataSize = 0;
 	status = ~0ULL;
 
-	ioret = ioctl(fd, EFI_RUNTIME_SET_VARIABLE, &setvariable);
+	ioret = fwts_uefi_rt_ioctl(fd, EFI_RUNTIME_SET_VARIABLE, &setvariable);
 	if (ioret == -1) {
 		fwts_failed(fw, LOG_LEVEL_HIGH, "UEFIRuntimeSetVariable",
 			"Failed to delete variable with UEFI runtime service.");
@@ -548,7 +549,7 @@ static int getnextvariable_test2(fwts_framework *fw)
 
 		status = ~0ULL;
 		variablenamesize = maxvariablenamesize;
-		ioret = ioctl(fd, EFI_RUNTIME_GET_NEXTVARIABLENAME, &getnextvariablename);
+		ioret = fwts_uefi_rt_ioctl(fd, EFI_RUNTIME_GET_NEXTVARIABLENAME, &getnextvariablename);
 
 		if (ioret == -1) {
 			if (status == EFI_UNSUPPORTED) {
@@ -719,7 +720,7 @@ static int getnextvariable_test3(fwts_framework *fw)
 
 		status = ~0ULL;
 		variablenamesize = maxvariablenamesize;
-		ioret = ioctl(fd, EFI_RUNTIME_GET_NEXTVARIABLENAME, &getnextvariablename);
+		ioret = fwts_uefi_rt_ioctl(fd, EFI_RUNTIME_GET_NEXTVARIABLENAME, &getnextvariablename);
 
 		if (ioret == -1) {
 			if (status == EFI_UNSUPPORTED) {
@@ -846,7 +847,7 @@ static int getnextvariable_test4(fwts_framework *fw)
 	 */
 	getnextvariablename.VariableName = NULL;
 
-	ioret = ioctl(fd, EFI_RUNTIME_GET_NEXTVARIABLENAME, &getnextvariablename);
+	ioret = fwts_uefi_rt_ioctl(fd, EFI_RUNTIME_GET_NEXTVARIABLENAME, &getnextvariablename);
 
 	if (ioret == -1) {
 		if (status == EFI_UNSUPPORTED) {
@@ -868,7 +869,7 @@ static int getnextvariable_test4(fwts_framework *fw)
 	getnextvariablename.VendorGuid = NULL;
 	status = ~0ULL;
 
-	ioret = ioctl(fd, EFI_RUNTIME_GET_NEXTVARIABLENAME, &getnextvariablename);
+	ioret = fwts_uefi_rt_ioctl(fd, EFI_RUNTIME_GET_NEXTVARIABLENAME, &getnextvariablename);
 
 	if (ioret != -1 || status != EFI_INVALID_PARAMETER) {
 		fwts_failed(fw, LOG_LEVEL_HIGH,
@@ -882,7 +883,7 @@ static int getnextvariable_test4(fwts_framework *fw)
 	getnextvariablename.VariableNameSize = NULL;
 	status = ~0ULL;
 
-	ioret = ioctl(fd, EFI_RUNTIME_GET_NEXTVARIABLENAME, &getnextvariablename);
+	ioret = fwts_uefi_rt_ioctl(fd, EFI_RUNTIME_GET_NEXTVARIABLENAME, &getnextvariablename);
 
 	if (ioret != -1 || status != EFI_INVALID_PARAMETER) {
 		fwts_failed(fw, LOG_LEVEL_HIGH,
@@ -904,7 +905,7 @@ static int getnextvariable_test4(fwts_framework *fw)
 		variablename[0] = '\0';
 		status = ~0ULL;
 
-		ioret = ioctl(fd, EFI_RUNTIME_GET_NEXTVARIABLENAME, &getnextvariablename);
+		ioret = fwts_uefi_rt_ioctl(fd, EFI_RUNTIME_GET_NEXTVARIABLENAME, &getnextvariablename);
 
 		/*
 		 * We expect this machine to have at least some UEFI
@@ -969,7 +970,7 @@ static int setvariable_insertvariable(
 	setvariable.DataSize = datasize;
 	setvariable.Data = data;
 	setvariable.status = &status;
-	ioret = ioctl(fd, EFI_RUNTIME_SET_VARIABLE, &setvariable);
+	ioret = fwts_uefi_rt_ioctl(fd, EFI_RUNTIME_SET_VARIABLE, &setvariable);
 
 	if (ioret == -1) {
 		if (status == EFI_UNSUPPORTED) {
@@ -1048,7 +1049,7 @@ static int setvariable_checkvariable(
 	getvariable.Data = testdata;
 	getvariable.status = &status;
 
-	ioret = ioctl(fd, EFI_RUNTIME_GET_VARIABLE, &getvariable);
+	ioret = fwts_uefi_rt_ioctl(fd, EFI_RUNTIME_GET_VARIABLE, &getvariable);
 	if (ioret == -1) {
 		if (status == EFI_UNSUPPORTED) {
 			fwts_skipped(fw, "Skipping test, GetVariable runtime "
@@ -1114,7 +1115,7 @@ static int setvariable_checkvariable_notfound(
 	getvariable.Data = testdata;
 	getvariable.status = &status;
 
-	ioret = ioctl(fd, EFI_RUNTIME_GET_VARIABLE, &getvariable);
+	ioret = fwts_uefi_rt_ioctl(fd, EFI_RUNTIME_GET_VARIABLE, &getvariable);
 	/* expect the uefi runtime interface return EFI_NOT_FOUND */
 	if (ioret == -1) {
 		if (status == EFI_UNSUPPORTED) {
@@ -1163,7 +1164,7 @@ static int setvariable_invalidattr(
 	setvariable.Data = data;
 	setvariable.status = &status;
 
-	ioret = ioctl(fd, EFI_RUNTIME_SET_VARIABLE, &setvariable);
+	ioret = fwts_uefi_rt_ioctl(fd, EFI_RUNTIME_SET_VARIABLE, &setvariable);
 
 	if (ioret == -1) {
 		if (status == EFI_UNSUPPORTED) {
@@ -1517,7 +1518,7 @@ static int setvariable_test8(fwts_framework *fw)
 	setvariable.Data = &data;
 	setvariable.status = &status;
 
-	ioret = ioctl(fd, EFI_RUNTIME_SET_VARIABLE, &setvariable);
+	ioret = fwts_uefi_rt_ioctl(fd, EFI_RUNTIME_SET_VARIABLE, &setvariable);
 
 	if (status == EFI_UNSUPPORTED && ioret == -1)
 		return FWTS_OK;
@@ -1547,7 +1548,7 @@ static int do_queryvariableinfo(
 	queryvariableinfo.status = status;
 	*status = ~0ULL;
 
-	ioret = ioctl(fd, EFI_RUNTIME_QUERY_VARIABLEINFO, &queryvariableinfo);
+	ioret = fwts_uefi_rt_ioctl(fd, EFI_RUNTIME_QUERY_VARIABLEINFO, &queryvariableinfo);
 
 	if (ioret == -1)
 		return FWTS_ERROR;
@@ -1589,7 +1590,7 @@ static int getnextvariable_multitest(
 	setvariable.Data = data;
 	setvariable.status = &status;
 
-	ioret = ioctl(fd, EFI_RUNTIME_SET_VARIABLE, &setvariable);
+	ioret = fwts_uefi_rt_ioctl(fd, EFI_RUNTIME_SET_VARIABLE, &setvariable);
 
 	if (ioret == -1) {
 		if (status == EFI_UNSUPPORTED) {
@@ -1628,7 +1629,7 @@ static int getnextvariable_multitest(
 		variablename[0] = '\0';
 		variablenamesize = MAX_DATA_LENGTH;
 		status = ~0ULL;
-		ioret = ioctl(fd, EFI_RUNTIME_GET_NEXTVARIABLENAME, &getnextvariablename);
+		ioret = fwts_uefi_rt_ioctl(fd, EFI_RUNTIME_GET_NEXTVARIABLENAME, &getnextvariablename);
 
 		if (ioret == -1) {
 			if (status == EFI_UNSUPPORTED) {
@@ -1647,7 +1648,7 @@ static int getnextvariable_multitest(
 	setvariable.DataSize = 0;
 	status = ~0ULL;
 
-	ioret = ioctl(fd, EFI_RUNTIME_SET_VARIABLE, &setvariable);
+	ioret = fwts_uefi_rt_ioctl(fd, EFI_RUNTIME_SET_VARIABLE, &setvariable);
 
 	if (ioret == -1) {
 		fwts_failed(fw, LOG_LEVEL_HIGH, "UEFIRuntimeSetVariable",
@@ -1662,7 +1663,7 @@ err_restore_env:
 	setvariable.DataSize = 0;
 	status = ~0ULL;
 
-	ioret = ioctl(fd, EFI_RUNTIME_SET_VARIABLE, &setvariable);
+	ioret = fwts_uefi_rt_ioctl(fd, EFI_RUNTIME_SET_VARIABLE, &setvariable);
 
 	if (ioret == -1) {
 		fwts_failed(fw, LOG_LEVEL_HIGH, "UEFIRuntimeSetVariable",
@@ -1996,7 +1997,7 @@ static void getvariable_test_invalid(
 	fwts_log_info(fw, "Testing GetVariable with %s.", test);
 	*(getvariable->status) = ~0ULL;
 
-	ioret = ioctl(fd, EFI_RUNTIME_GET_VARIABLE, getvariable);
+	ioret = fwts_uefi_rt_ioctl(fd, EFI_RUNTIME_GET_VARIABLE, getvariable);
 
 	if (ioret == -1) {
 		if (*(getvariable->status) == EFI_UNSUPPORTED) {
@@ -2052,7 +2053,7 @@ static int uefirtvariable_test8(fwts_framework *fw)
 	setvariable.Data = data;
 	setvariable.status = &status;
 
-	ioret = ioctl(fd, EFI_RUNTIME_SET_VARIABLE, &setvariable);
+	ioret = fwts_uefi_rt_ioctl(fd, EFI_RUNTIME_SET_VARIABLE, &setvariable);
 
 	if (ioret == -1) {
 		if (status == EFI_UNSUPPORTED) {
@@ -2119,7 +2120,7 @@ static int uefirtvariable_test8(fwts_framework *fw)
 	/* delete the variable */
 	setvariable.DataSize = 0;
 	status = ~0ULL;
-	ioret = ioctl(fd, EFI_RUNTIME_SET_VARIABLE, &setvariable);
+	ioret = fwts_uefi_rt_ioctl(fd, EFI_RUNTIME_SET_VARIABLE, &setvariable);
 	if (ioret == -1) {
 		fwts_failed(fw, LOG_LEVEL_HIGH, "UEFIRuntimeSetVariable",
 			"Failed to delete variable with UEFI runtime service.");
@@ -2159,7 +2160,7 @@ static int uefirtvariable_test9(fwts_framework *fw)
 		setvariable.Data = &data;
 		setvariable.status = &status;
 
-		ioret = ioctl(fd, EFI_RUNTIME_SET_VARIABLE, &setvariable);
+		ioret = fwts_uefi_rt_ioctl(fd, EFI_RUNTIME_SET_VARIABLE, &setvariable);
 		if (ioret == -1) {
 			if (status == EFI_UNSUPPORTED)
 				fwts_passed(fw, "UEFI SetVariable runtime service "
@@ -2194,7 +2195,7 @@ static int uefirtvariable_test9(fwts_framework *fw)
 		getvariable.Data = testdata;
 		getvariable.status = &status;
 
-		ioret = ioctl(fd, EFI_RUNTIME_GET_VARIABLE, &getvariable);
+		ioret = fwts_uefi_rt_ioctl(fd, EFI_RUNTIME_GET_VARIABLE, &getvariable);
 		if (ioret == -1) {
 			if (status == EFI_UNSUPPORTED)
 				fwts_passed(fw, "UEFI GetVariable runtime service "
@@ -2223,7 +2224,7 @@ static int uefirtvariable_test9(fwts_framework *fw)
 	/* delete the variable which was set */
 	setvariable.DataSize = 0;
 	status = ~0ULL;
-	(void)ioctl(fd, EFI_RUNTIME_SET_VARIABLE, &setvariable);
+	(void)fwts_uefi_rt_ioctl(fd, EFI_RUNTIME_SET_VARIABLE, &setvariable);
 
 	variablename = malloc(sizeof(uint16_t) * variablenamesize);
 	if (!variablename) {
@@ -2239,7 +2240,7 @@ static int uefirtvariable_test9(fwts_framework *fw)
 		variablename[0] = '\0';
 		status = ~0ULL;
 
-		ioret = ioctl(fd, EFI_RUNTIME_GET_NEXTVARIABLENAME, &getnextvariablename);
+		ioret = fwts_uefi_rt_ioctl(fd, EFI_RUNTIME_GET_NEXTVARIABLENAME, &getnextvariablename);
 		if (ioret == -1) {
 			if (status == EFI_UNSUPPORTED)
 				fwts_passed(fw, "UEFI GetNextVarName runtime service "
@@ -2273,7 +2274,7 @@ static int uefirtvariable_test9(fwts_framework *fw)
 		queryvariableinfo.status = &status;
 		status = ~0ULL;
 
-		ioret = ioctl(fd, EFI_RUNTIME_QUERY_VARIABLEINFO, &queryvariableinfo);
+		ioret = fwts_uefi_rt_ioctl(fd, EFI_RUNTIME_QUERY_VARIABLEINFO, &queryvariableinfo);
 		if (ioret == -1) {
 			if (status == EFI_UNSUPPORTED)
 				fwts_passed(fw, "UEFI QueryVarInfo runtime service "
@@ -2378,6 +2379,7 @@ static fwts_framework_minor_test uefirtvariable_tests[] = {
 	{ uefirtvariable_test7, "Test UEFI RT service query variable info interface stress test." },
 	{ uefirtvariable_test8, "Test UEFI RT service get variable interface, invalid parameters." },
 	{ uefirtvariable_test9, "Test UEFI RT variable services unsupported status." },
+	{ fwts_uefi_latency_check, "Check UEFI RT service call latency." },
 	{ NULL, NULL }
 };
 
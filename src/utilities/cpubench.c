@@ -0,0 +1,167 @@
+/*
+ * Copyright (C) 2026 Canonical
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+/*
+ *  cpubench: microbenchmark for the fwts CPU benchmark. Runs the
+ *  adaptive benchmark and the full length run a number of times on a
+ *  CPU and reports the spread of the results and how long each run
+ *  took, to check the adaptive run is as stable as the full run, e.g.:
+ *
+ *	cpubench -c 2 -n 50 -t 0.5
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <math.h>
+
+#include "fwts.h"
+
+#define DEFAULT_RUNS	(20)
+
+typedef struct {
+	double loops[2];	/* sum and sum of squares */
+	double cycles[2];
+	double instructions[2];
+	double duration;	/* total, ms */
+	int converged;
+	int cycles_valid;
+	int runs;
+} bench_stats;
+
+static void stats_add(double *stat, const double value)
+{
+	stat[0] += value;
+	stat[1] += value * value;
+}
+
+/*
+ *  stats_show()
+ *	print mean and coefficient of variation of a statistic
+ */
+static void stats_show(const char *name, const double *stat, const int runs)
+{
+	double mean = stat[0] / runs;
+	double var = (stat[1] / runs) - (mean * mean);
+	double cv = (mean > 0.0) ? 100.0 * sqrt(var > 0.0 ? var : 0.0) / mean : 0.0;
+
+	printf("  %-14s %16.0f /sec, cv %6.3f%%\n", name, mean, cv);
+}
+
+static int bench(const int cpu, const double tolerance, bench_stats *stats)
+{
+	fwts_cpu_benchmark_result result;
+
+	if (fwts_cpu_benchmark_thread(cpu, tolerance, &result) != FWTS_OK) {
+		fprintf(stderr, "Cannot benchmark CPU %d.\n", cpu);
+		return FWTS_ERROR;
+	}
+	stats_add(stats->loops, result.loops);
+	stats_add(stats->cycles, result.cycles);
+	stats_add(stats->instructions, result.instructions);
+	stats->duration += result.duration_ns / 1000000.0;
+	stats->converged += result.converged;
+	stats->cycles_valid += result.cycles_valid;
+	stats->runs++;
+
+	return FWTS_OK;
+}
+
+static void bench_show(const char *name, const bench_stats *stats)
+{
+	printf("%s: %d runs, %.1f ms per run, %d converged\n", name,
+		stats->runs, stats->duration / stats->runs, stats->converged);
+	stats_show("loops", stats->loops, stats->runs);
+	if (stats->cycles_valid == stats->runs) {
+		stats_show("cycles", stats->cycles, stats->runs);
+		stats_show("instructions", stats->instructions, stats->runs);
+	}
+}
+
+static void show_usage(void)
+{
+	printf("Usage: cpubench [-c cpu] [-n runs] [-t tolerance]\n");
+	printf("  -c cpu\t\tCPU to benchmark, default 0\n");
+	printf("  -n runs\tnumber of runs of each benchmark, default %d\n", DEFAULT_RUNS);
+	printf("  -t tolerance\tconvergence tolerance in percent, default %.1f\n",
+		FWTS_CPU_BENCHMARK_TOLERANCE * 100.0);
+}
+
+int main(int argc, char **argv)
+{
+	double tolerance = FWTS_CPU_BENCHMARK_TOLERANCE;
+	bench_stats adaptive, full;
+	int cpu = 0, runs = DEFAULT_RUNS, i, opt, ret = EXIT_FAILURE;
+
+	while ((opt = getopt(argc, argv, "c:n:t:h")) != -1) {
+		switch (opt) {
+		case 'c':
+			cpu = atoi(optarg);
+			break;
+		case 'n':
+			runs = atoi(optarg);
+			if (runs < 1) {
+				fprintf(stderr, "Invalid number of runs '%s'.\n", optarg);
+				exit(EXIT_FAILURE);
+			}
+			break;
+		case 't':
+			tolerance = atof(optarg) / 100.0;
+			if (tolerance <= 0.0) {
+				fprintf(stderr, "Invalid tolerance '%s'.\n", optarg);
+				exit(EXIT_FAILURE);
+			}
+			break;
+		case 'h':
+			show_usage();
+			exit(EXIT_SUCCESS);
+		default:
+			show_usage();
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	memset(&adaptive, 0, sizeof(adaptive));
+	memset(&full, 0, sizeof(full));
+
+	/* Warm up, then interleave the two so drift hits both the same */
+	if (bench(cpu, 0.0, &full) != FWTS_OK)
+		goto out;
+	memset(&full, 0, sizeof(full));
+
+	for (i = 0; i < runs; i++) {
+		if ((bench(cpu, tolerance, &adaptive) != FWTS_OK) ||
+		    (bench(cpu, 0.0, &full) != FWTS_OK))
+			goto out;
+	}
+
+	bench_show("adaptive", &adaptive);
+	bench_show("full", &full);
+	printf("speedup: %.2fx, loops differ by %.3f%%\n",
+		full.duration / adaptive.duration,
+		100.0 * fabs((adaptive.loops[0] / adaptive.runs) -
+			(full.loops[0] / full.runs)) / (full.loops[0] / full.runs));
+
+	ret = EXIT_SUCCESS;
+out:
+	fwts_cpu_benchmark_close();
+
+	exit(ret);
+}
@@ -0,0 +1,201 @@
+/*
+ * Copyright (C) 2026 Canonical
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+/*
+ *  logscanbench: microbenchmark for log pattern matching. Compares the
+ *  compiled fwts_log_matcher against a linear strstr()/regexec() walk of
+ *  the pattern table, checks that both pick the same pattern for every
+ *  line and reports the throughput of each in lines per second, e.g.:
+ *
+ *	logscanbench -j data/klog.json fwts-test/klog-000[12]/klog.txt
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <time.h>
+#include <regex.h>
+
+#include "fwts.h"
+
+#define DEFAULT_ITERATIONS	(10)
+
+/*
+ *  reference implementation, first pattern in table order to match
+ */
+static fwts_log_pattern *linear_match(fwts_log_pattern *patterns, const char *line)
+{
+	fwts_log_pattern *pattern;
+
+	for (pattern = patterns; pattern->pattern; pattern++) {
+		switch (pattern->compare_mode) {
+		case FWTS_COMPARE_REGEX:
+			if (pattern->compiled_ok &&
+			    !regexec(&pattern->compiled, line, 0, NULL, 0))
+				return pattern;
+			break;
+		case FWTS_COMPARE_STRING:
+		default:
+			if (strstr(line, pattern->pattern))
+				return pattern;
+			break;
+		}
+	}
+	return NULL;
+}
+
+static double timestamp(void)
+{
+	struct timespec ts;
+
+	(void)clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (double)ts.tv_sec + ((double)ts.tv_nsec / 1000000000.0);
+}
+
+static void show_usage(void)
+{
+	printf("Usage: logscanbench [-j json] [-t table] [-n iterations] logfile ...\n");
+	printf("  -j json\tpattern file, default %s/klog.json\n", FWTS_JSON_DATA_PATH);
+	printf("  -t table\tpattern table, default firmware_error_warning_patterns\n");
+	printf("  -n iterations\tnumber of passes over the logs, default %d\n", DEFAULT_ITERATIONS);
+}
+
+int main(int argc, char **argv)
+{
+	const char *json = FWTS_JSON_DATA_PATH "/klog.json";
+	const char *table = "firmware_error_warning_patterns";
+	int iterations = DEFAULT_ITERATIONS;
+	fwts_framework *fw;
+	fwts_log_pattern *patterns;
+	fwts_log_matcher *matcher;
+	fwts_list *lines;
+	fwts_list_link *item;
+	double t_start, t_linear, t_matcher;
+	long n_lines = 0, n_matched = 0, n_mismatch = 0;
+	int i, opt, ret = EXIT_FAILURE;
+
+	while ((opt = getopt(argc, argv, "j:t:n:h")) != -1) {
+		switch (opt) {
+		case 'j':
+			json = optarg;
+			break;
+		case 't':
+			table = optarg;
+			break;
+		case 'n':
+			iterations = atoi(optarg);
+			if (iterations < 1) {
+				fprintf(stderr, "Invalid number of iterations '%s'.\n", optarg);
+				exit(EXIT_FAILURE);
+			}
+			break;
+		case 'h':
+			show_usage();
+			exit(EXIT_SUCCESS);
+		default:
+			show_usage();
+			exit(EXIT_FAILURE);
+		}
+	}
+	if (optind >= argc) {
+		show_usage();
+		exit(EXIT_FAILURE);
+	}
+
+	/* Framework with no results log, pattern load errors are silent */
+	if ((fw = calloc(1, sizeof(*fw))) == NULL) {
+		fprintf(stderr, "Cannot allocate framework.\n");
+		exit(EXIT_FAILURE);
+	}
+	if ((lines = fwts_list_new()) == NULL) {
+		fprintf(stderr, "Cannot allocate log list.\n");
+		goto free_fw;
+	}
+
+	for (i = optind; i < argc; i++) {
+		fwts_list *log;
+
+		if ((log = fwts_file_open_and_read(argv[i])) == NULL) {
+			fprintf(stderr, "Cannot read log %s.\n", argv[i]);
+			goto free_lines;
+		}
+		/* Lines are handed over to the combined list */
+		fwts_list_foreach(item, log)
+			fwts_list_append(lines, item->data);
+		fwts_list_free(log, NULL);
+	}
+
+	if ((patterns = fwts_log_patterns_load(fw, json, table, "Bench")) == NULL) {
+		fprintf(stderr, "Cannot load table %s from %s.\n", table, json);
+		goto free_lines;
+	}
+	t_start = timestamp();
+	if ((matcher = fwts_log_matcher_new(patterns)) == NULL) {
+		fprintf(stderr, "Cannot build pattern matcher.\n");
+		goto free_patterns;
+	}
+	printf("%u patterns (%u regex), %u automaton states, build %.3f ms.\n",
+		matcher->n_patterns, matcher->n_regexes, matcher->n_states,
+		(timestamp() - t_start) * 1000.0);
+
+	/* Check both methods agree before timing them */
+	fwts_list_foreach(item, lines) {
+		const char *line = fwts_list_data(char *, item);
+		const fwts_log_pattern *expected = linear_match(patterns, line);
+
+		if (expected)
+			n_matched++;
+		if (fwts_log_matcher_match(fw, matcher, line) != expected) {
+			fprintf(stderr, "Mismatch on line: %s\n", line);
+			n_mismatch++;
+		}
+		n_lines++;
+	}
+	printf("%ld lines, %ld matched, %ld mismatches.\n", n_lines, n_matched, n_mismatch);
+
+	t_start = timestamp();
+	for (i = 0; i < iterations; i++)
+		fwts_list_foreach(item, lines)
+			(void)linear_match(patterns, fwts_list_data(char *, item));
+	t_linear = timestamp() - t_start;
+
+	t_start = timestamp();
+	for (i = 0; i < iterations; i++)
+		fwts_list_foreach(item, lines)
+			(void)fwts_log_matcher_match(fw, matcher, fwts_list_data(char *, item));
+	t_matcher = timestamp() - t_start;
+
+	printf("linear:  %12.0f lines/sec\n", (double)(n_lines * iterations) / t_linear);
+	printf("matcher: %12.0f lines/sec\n", (double)(n_lines * iterations) / t_matcher);
+	printf("speedup: %12.2fx\n", t_linear / t_matcher);
+
+	ret = n_mismatch ? EXIT_FAILURE : EXIT_SUCCESS;
+
+	fwts_log_matcher_free(matcher);
+free_patterns:
+	fwts_log_patterns_free(patterns);
+free_lines:
+	fwts_text_list_free(lines);
+free_fw:
+	free(fw);
+
+	exit(ret);
+}